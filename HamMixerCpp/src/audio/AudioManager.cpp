@@ -1,5 +1,9 @@
 #include "audio/AudioManager.h"
 #include <QDebug>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 AudioManager::AudioManager(QObject* parent)
     : QObject(parent)
@@ -24,12 +28,17 @@ bool AudioManager::initialize()
     }
 
     // Create components
-    m_mixer = std::make_unique<MixerCore>(SAMPLE_RATE, BUFFER_SIZE);
-    m_recorder = std::make_unique<Recorder>(SAMPLE_RATE, CHANNELS);
+    m_mixer = std::make_unique<MixerCore>(m_engineRate, BUFFER_SIZE);
+    m_recorder = std::make_unique<Recorder>(m_engineRate, CHANNELS);
 
     // Create ring buffers
     m_radioRing = std::make_unique<RingBuffer>(RING_BUFFER_SIZE, CHANNELS);
     m_loopbackRing = std::make_unique<RingBuffer>(RING_BUFFER_SIZE, CHANNELS);
+    m_sdrStreamRing = std::make_unique<RingBuffer>(SDR_STREAM_RING_SIZE, CHANNELS);
+    for (std::unique_ptr<RingBuffer>& ring : m_diversityRings) {
+        ring = std::make_unique<RingBuffer>(SDR_STREAM_RING_SIZE, CHANNELS);
+    }
+    m_probeRing = std::make_unique<RingBuffer>(SDR_STREAM_RING_SIZE, CHANNELS);
 
     // Enumerate devices
     refreshDevices();
@@ -46,6 +55,11 @@ void AudioManager::shutdown()
     m_recorder.reset();
     m_radioRing.reset();
     m_loopbackRing.reset();
+    m_sdrStreamRing.reset();
+    for (std::unique_ptr<RingBuffer>& ring : m_diversityRings) {
+        ring.reset();
+    }
+    m_probeRing.reset();
 
     if (m_initialized.load()) {
         WasapiDevice::uninitializeCOM();
@@ -53,6 +67,134 @@ void AudioManager::shutdown()
     }
 }
 
+void AudioManager::setEngineSampleRate(int sampleRate)
+{
+    if (sampleRate < 8000 || sampleRate > 384000) {
+        qWarning() << "AudioManager: Ignoring invalid engine sample rate" << sampleRate;
+        return;
+    }
+    m_engineRate = sampleRate;
+}
+
+AudioManager::LatencyProfile AudioManager::latencyProfileFromName(const QString& name)
+{
+    if (name == "safe") return LatencyProfile::Safe;
+    if (name == "low") return LatencyProfile::Low;
+    if (name == "exclusive") return LatencyProfile::Exclusive;
+    if (name == "auto") return LatencyProfile::Auto;
+    return LatencyProfile::Normal;
+}
+
+QString AudioManager::latencyProfileName(LatencyProfile profile)
+{
+    switch (profile) {
+        case LatencyProfile::Safe: return "safe";
+        case LatencyProfile::Low: return "low";
+        case LatencyProfile::Exclusive: return "exclusive";
+        case LatencyProfile::Auto: return "auto";
+        case LatencyProfile::Normal: break;
+    }
+    return "normal";
+}
+
+bool AudioManager::openDevice(WasapiDevice* device, const QString& deviceId,
+                              WasapiDevice::DeviceType type)
+{
+    using ShareMode = WasapiDevice::ShareMode;
+
+    struct Attempt {
+        ShareMode mode;
+        int bufferMs;
+    };
+
+    // Most aggressive first; every profile ends on the classic shared stream
+    std::vector<Attempt> attempts;
+    switch (m_latencyProfile) {
+        case LatencyProfile::Exclusive:
+            attempts = {{ShareMode::Exclusive, 0}, {ShareMode::LowLatencyShared, 0}, {ShareMode::Shared, 10}};
+            break;
+        case LatencyProfile::Low:
+            attempts = {{ShareMode::LowLatencyShared, 0}, {ShareMode::Shared, 10}};
+            break;
+        case LatencyProfile::Auto:
+            attempts = {{ShareMode::LowLatencyShared, 0}, {ShareMode::Shared, 10}, {ShareMode::Shared, 20}};
+            break;
+        case LatencyProfile::Safe:
+            attempts = {{ShareMode::Shared, 20}};
+            break;
+        case LatencyProfile::Normal:
+            attempts = {{ShareMode::Shared, 10}};
+            break;
+    }
+
+    for (const Attempt& attempt : attempts) {
+        if (device->open(deviceId, type, m_engineRate, CHANNELS, attempt.bufferMs, attempt.mode)) {
+            return true;
+        }
+        qDebug() << "AudioManager:" << WasapiDevice::shareModeName(attempt.mode)
+                 << "open failed:" << device->lastError();
+    }
+    return false;
+}
+
+AudioManager::LatencyReport AudioManager::estimateLatency() const
+{
+    LatencyReport report;
+    if (!m_running.load() || !m_outputDevice || !m_outputDevice->isOpen()) {
+        return report;
+    }
+
+    if (m_inputDevice && m_inputDevice->isOpen()) {
+        report.inputMs = m_inputDevice->latencyMs();
+        report.inputMode = WasapiDevice::shareModeName(m_inputDevice->shareMode());
+    }
+    report.bufferMs = m_radioRingFillAvg.load() * 1000.0f / m_engineRate;
+
+    if (m_radioResampler && !m_radioResampler->isPassthrough()) {
+        report.resamplerMs += Resampler::latencyFrames() * 1000.0f / m_radioResampler->inputRate();
+    }
+    if (m_outputResampler && !m_outputResampler->isPassthrough()) {
+        report.resamplerMs += Resampler::latencyFrames() * 1000.0f / m_outputResampler->inputRate();
+    }
+
+    report.outputMs = m_outputDevice->latencyMs()
+                    + m_outputFifoQueued.load() * 1000.0f / m_outputDevice->sampleRate();
+    report.outputMode = WasapiDevice::shareModeName(m_outputDevice->shareMode());
+
+    report.totalMs = report.inputMs + report.bufferMs + report.resamplerMs + report.outputMs;
+    report.valid = true;
+    return report;
+}
+
+AudioTelemetry::Snapshot AudioManager::telemetrySnapshot() const
+{
+    AudioTelemetry::Snapshot snap = m_telemetry.snapshot();
+    snap.sampleRate = m_engineRate;
+    snap.radioRing = m_radioRing->stats();
+    snap.loopbackRing = m_sdrStreamActive.load() ? m_sdrStreamRing->stats() : m_loopbackRing->stats();
+    return snap;
+}
+
+void AudioManager::resetTelemetry()
+{
+    m_telemetry.reset();
+    m_radioRing->resetStats();
+    m_loopbackRing->resetStats();
+    m_sdrStreamRing->resetStats();
+}
+
+std::unique_ptr<Resampler> AudioManager::createResampler(WasapiDevice* device, bool toEngine,
+                                                         const char* label)
+{
+    int deviceRate = device->sampleRate();
+    if (deviceRate != m_engineRate) {
+        qDebug() << label << "runs at" << deviceRate << "Hz, resampling"
+                 << (toEngine ? "to" : "from") << "engine rate" << m_engineRate << "Hz";
+    }
+    return toEngine ? std::make_unique<Resampler>(deviceRate, m_engineRate, CHANNELS)
+                    : std::make_unique<Resampler>(m_engineRate, deviceRate, CHANNELS);
+}
+
 void AudioManager::refreshDevices()
 {
     m_inputDevices = WasapiDevice::enumerateDevices(WasapiDevice::DeviceType::Capture);
@@ -77,75 +219,96 @@ bool AudioManager::startStreams(const QString& inputDeviceId,
     // Clear ring buffers
     m_radioRing->clear();
     m_loopbackRing->clear();
+    m_sdrStreamRing->clear();
+    for (std::unique_ptr<RingBuffer>& ring : m_diversityRings) {
+        ring->clear();
+    }
+    m_probeRing->clear();
+    m_probeActive.store(false);
 
-    // Reset mixer
+    // Apply engine rate and reset mixer
+    m_mixer->setSampleRate(m_engineRate);
     m_mixer->reset();
+    if (m_recorder) {
+        m_recorder->setSampleRate(m_engineRate);
+    }
+    m_outputFifoFrames = 0;
+    m_outputFifoQueued.store(0);
+    m_radioRingFillAvg.store(0.0f);
+    m_radioResampler.reset();
+    m_loopbackResampler.reset();
+    m_outputResampler.reset();
+    m_sdrStreamResampler.reset();
+    for (std::unique_ptr<Resampler>& resampler : m_diversityResamplers) {
+        resampler.reset();
+    }
+    m_probeResampler.reset();
+    resetTelemetry();
 
     // Create and open devices
     m_inputDevice = std::make_unique<WasapiDevice>();
     m_loopbackDevice = std::make_unique<WasapiDevice>();
     m_outputDevice = std::make_unique<WasapiDevice>();
+    m_inputDevice->setTelemetry(&m_telemetry.input());
+    m_loopbackDevice->setTelemetry(&m_telemetry.loopback());
+    m_outputDevice->setTelemetry(&m_telemetry.output());
 
     // Open input device (radio)
     if (!inputDeviceId.isEmpty()) {
-        if (!m_inputDevice->open(inputDeviceId, WasapiDevice::DeviceType::Capture,
-                                  SAMPLE_RATE, CHANNELS, 10)) {
+        if (!openDevice(m_inputDevice.get(), inputDeviceId, WasapiDevice::DeviceType::Capture)) {
             m_lastError = "Failed to open input device: " + m_inputDevice->lastError();
             qWarning() << m_lastError;
             emit errorOccurred(m_lastError);
             return false;
         }
         qDebug() << "Radio input device opened at" << m_inputDevice->sampleRate() << "Hz,"
-                 << m_inputDevice->channels() << "channels";
-        if (m_inputDevice->sampleRate() != SAMPLE_RATE) {
-            qWarning() << "WARNING: Radio device sample rate mismatch! Expected" << SAMPLE_RATE
-                       << "Hz, got" << m_inputDevice->sampleRate() << "Hz - audio may be distorted";
-        }
+                 << m_inputDevice->channels() << "channels,"
+                 << SampleFormat::bytesPerSample(m_inputDevice->sampleFormat()) * 8 << "bit"
+                 << (m_inputDevice->sampleFormat() == SampleFormat::Type::Float32 ? "float" : "PCM");
+        m_radioResampler = createResampler(m_inputDevice.get(), true, "Radio input device");
     }
 
     // Open loopback device (WebSDR)
     if (!loopbackDeviceId.isEmpty()) {
-        if (!m_loopbackDevice->open(loopbackDeviceId, WasapiDevice::DeviceType::Loopback,
-                                     SAMPLE_RATE, CHANNELS, 10)) {
+        if (!openDevice(m_loopbackDevice.get(), loopbackDeviceId, WasapiDevice::DeviceType::Loopback)) {
             m_lastError = "Failed to open loopback device: " + m_loopbackDevice->lastError();
             qWarning() << m_lastError;
             emit errorOccurred(m_lastError);
             return false;
         }
         qDebug() << "Loopback device opened at" << m_loopbackDevice->sampleRate() << "Hz,"
-                 << m_loopbackDevice->channels() << "channels";
-        if (m_loopbackDevice->sampleRate() != SAMPLE_RATE) {
-            qWarning() << "WARNING: Loopback device sample rate mismatch! Expected" << SAMPLE_RATE
-                       << "Hz, got" << m_loopbackDevice->sampleRate() << "Hz";
-        }
+                 << m_loopbackDevice->channels() << "channels,"
+                 << SampleFormat::bytesPerSample(m_loopbackDevice->sampleFormat()) * 8 << "bit"
+                 << (m_loopbackDevice->sampleFormat() == SampleFormat::Type::Float32 ? "float" : "PCM");
+        m_loopbackResampler = createResampler(m_loopbackDevice.get(), true, "Loopback device");
     }
 
     // Open output device
     if (!outputDeviceId.isEmpty()) {
-        if (!m_outputDevice->open(outputDeviceId, WasapiDevice::DeviceType::Render,
-                                   SAMPLE_RATE, CHANNELS, 10)) {
+        if (!openDevice(m_outputDevice.get(), outputDeviceId, WasapiDevice::DeviceType::Render)) {
             m_lastError = "Failed to open output device: " + m_outputDevice->lastError();
             qWarning() << m_lastError;
             emit errorOccurred(m_lastError);
             return false;
         }
         qDebug() << "Output device opened at" << m_outputDevice->sampleRate() << "Hz,"
-                 << m_outputDevice->channels() << "channels";
-        if (m_outputDevice->sampleRate() != SAMPLE_RATE) {
-            qWarning() << "WARNING: Output device sample rate mismatch! Expected" << SAMPLE_RATE
-                       << "Hz, got" << m_outputDevice->sampleRate() << "Hz";
-            qWarning() << "Please set your Windows audio device to 48000 Hz (DVD Quality)";
-        }
-        // Update recorder sample rate to match actual output device rate
-        if (m_recorder) {
-            m_recorder->setSampleRate(m_outputDevice->sampleRate());
-            qDebug() << "Recorder sample rate set to" << m_outputDevice->sampleRate() << "Hz";
-        }
+                 << m_outputDevice->channels() << "channels,"
+                 << SampleFormat::bytesPerSample(m_outputDevice->sampleFormat()) * 8 << "bit"
+                 << (m_outputDevice->sampleFormat() == SampleFormat::Type::Float32 ? "float" : "PCM");
+        m_outputResampler = createResampler(m_outputDevice.get(), false, "Output device");
+
+        // Room for one device period plus one resampled mixing block
+        int fifoFrames = m_outputDevice->bufferFrames() * 2 + BUFFER_SIZE;
+        m_outputFifo.assign(static_cast<size_t>(fifoFrames) * CHANNELS, 0.0f);
+        m_outputMix.assign(static_cast<size_t>(BUFFER_SIZE) * CHANNELS, 0.0f);
+
+        // The fast path mixes a whole device request, up to the device buffer
+        m_mixer->setMaxBlockFrames(std::max(BUFFER_SIZE, m_outputDevice->bufferFrames()));
     }
 
     // Start input stream
     if (m_inputDevice->isOpen()) {
-        if (!m_inputDevice->start([this](int16_t* data, int frames, int channels) {
+        if (!m_inputDevice->start([this](float* data, int frames, int channels) {
             onRadioInput(data, frames, channels);
         })) {
             m_lastError = "Failed to start input stream: " + m_inputDevice->lastError();
@@ -156,7 +319,7 @@ bool AudioManager::startStreams(const QString& inputDeviceId,
 
     // Start loopback stream
     if (m_loopbackDevice->isOpen()) {
-        if (!m_loopbackDevice->start([this](int16_t* data, int frames, int channels) {
+        if (!m_loopbackDevice->start([this](float* data, int frames, int channels) {
             onLoopbackInput(data, frames, channels);
         })) {
             m_lastError = "Failed to start loopback stream: " + m_loopbackDevice->lastError();
@@ -167,7 +330,7 @@ bool AudioManager::startStreams(const QString& inputDeviceId,
 
     // Start output stream
     if (m_outputDevice->isOpen()) {
-        if (!m_outputDevice->start([this](int16_t* data, int frames, int channels) {
+        if (!m_outputDevice->start([this](float* data, int frames, int channels) {
             onOutputNeeded(data, frames, channels);
         })) {
             m_lastError = "Failed to start output stream: " + m_outputDevice->lastError();
@@ -178,7 +341,19 @@ bool AudioManager::startStreams(const QString& inputDeviceId,
 
     m_running.store(true);
     emit streamsStarted();
-    qDebug() << "Audio streams started";
+    qDebug() << "Audio streams started with latency profile" << latencyProfileName(m_latencyProfile);
+
+    // Report the estimated latency once the rings have settled
+    QTimer::singleShot(LATENCY_REPORT_DELAY_MS, this, [this]() {
+        LatencyReport report = estimateLatency();
+        if (!report.valid) return;
+
+        qDebug().nospace() << "Audio latency estimate: " << report.totalMs << " ms total (input "
+                           << report.inputMs << " [" << report.inputMode << "], ring "
+                           << report.bufferMs << ", resampler " << report.resamplerMs
+                           << ", output " << report.outputMs << " [" << report.outputMode << "])";
+        emit latencyEstimated(report);
+    });
 
     return true;
 }
@@ -215,61 +390,258 @@ void AudioManager::stopStreams()
     qDebug() << "Audio streams stopped";
 }
 
-void AudioManager::onRadioInput(int16_t* data, int frames, int channels)
+void AudioManager::captureToRing(float* data, int frames, int channels, Resampler* resampler,
+                                 std::vector<float>& stereo, std::vector<float>& resampled,
+                                 RingBuffer* ring)
 {
-    if (!m_running.load()) return;
-
-    // Handle channel mismatch
-    if (channels == 1) {
-        // Convert mono to stereo
-        std::vector<int16_t> stereo(frames * 2);
+    // Bring the device layout to interleaved stereo
+    const float* source = data;
+    if (channels != CHANNELS) {
+        stereo.resize(static_cast<size_t>(frames) * CHANNELS);
         for (int i = 0; i < frames; i++) {
-            stereo[i * 2] = data[i];
-            stereo[i * 2 + 1] = data[i];
+            float left = data[i * channels];
+            float right = (channels > 1) ? data[i * channels + 1] : left;
+            stereo[i * 2] = left;
+            stereo[i * 2 + 1] = right;
         }
-        m_radioRing->write(stereo.data(), frames);
-    } else {
-        m_radioRing->write(data, frames);
+        source = stereo.data();
+    }
+
+    if (!resampler || resampler->isPassthrough()) {
+        ring->write(source, frames);
+        return;
     }
+
+    int maxFrames = resampler->maxOutputFrames(frames);
+    resampled.resize(static_cast<size_t>(maxFrames) * CHANNELS);
+    int produced = resampler->process(source, frames, resampled.data(), maxFrames);
+    ring->write(resampled.data(), produced);
 }
 
-void AudioManager::onLoopbackInput(int16_t* data, int frames, int channels)
+void AudioManager::onRadioInput(float* data, int frames, int channels)
 {
     if (!m_running.load()) return;
 
-    // Handle channel mismatch
-    if (channels == 1) {
-        // Convert mono to stereo
-        std::vector<int16_t> stereo(frames * 2);
-        for (int i = 0; i < frames; i++) {
-            stereo[i * 2] = data[i];
-            stereo[i * 2 + 1] = data[i];
-        }
-        m_loopbackRing->write(stereo.data(), frames);
-    } else {
-        m_loopbackRing->write(data, frames);
+    captureToRing(data, frames, channels, m_radioResampler.get(),
+                  m_radioStereo, m_radioResampled, m_radioRing.get());
+}
+
+void AudioManager::onLoopbackInput(float* data, int frames, int channels)
+{
+    if (!m_running.load()) return;
+    if (m_sdrStreamActive.load()) return;  // Channel 2 comes from the network stream
+
+    captureToRing(data, frames, channels, m_loopbackResampler.get(),
+                  m_loopbackStereo, m_loopbackResampled, m_loopbackRing.get());
+}
+
+void AudioManager::setSdrStreamActive(bool active)
+{
+    if (!m_initialized.load() || m_sdrStreamActive.load() == active) return;
+
+    m_sdrStreamRing->clear();
+    m_sdrStreamResampler.reset();
+    m_sdrStreamActive.store(active);
+    if (!active) {
+        m_loopbackRing->clear();  // Drop whatever the loopback queued before the switch
     }
+    qDebug() << "AudioManager: Channel 2 source:" << (active ? "SDR stream" : "loopback");
 }
 
-void AudioManager::onOutputNeeded(int16_t* data, int frames, int channels)
+void AudioManager::writeSdrStream(const float* mono, int frames, double sampleRate)
 {
-    if (!m_running.load()) {
-        memset(data, 0, frames * channels * sizeof(int16_t));
+    if (!m_running.load() || !m_sdrStreamActive.load() || frames <= 0 || sampleRate <= 0) {
+        return;
+    }
+
+    queueNetworkAudio(mono, frames, sampleRate, m_sdrStreamResampler,
+                      m_sdrStreamStereo, m_sdrStreamResampled, m_sdrStreamRing.get(), "SDR stream");
+}
+
+void AudioManager::setDiversitySourceActive(int source, bool active)
+{
+    if (!m_initialized.load() || source < 1 || source > DIVERSITY_SOURCES) return;
+
+    int index = source - 1;
+    if (m_diversityActive[index].load() == active) return;
+
+    // Disconnect before touching the ring so the mixer never reads it half-cleared
+    if (!active) {
+        m_diversityActive[index].store(false);
+    }
+    m_diversityRings[index]->clear();
+    m_diversityResamplers[index].reset();
+    if (active) {
+        m_diversityActive[index].store(true);
+    }
+    qDebug() << "AudioManager: Diversity source" << source << (active ? "connected" : "disconnected");
+}
+
+bool AudioManager::isDiversitySourceActive(int source) const
+{
+    if (source < 1 || source > DIVERSITY_SOURCES) return false;
+    return m_diversityActive[source - 1].load();
+}
+
+void AudioManager::writeDiversitySource(int source, const float* mono, int frames, double sampleRate)
+{
+    if (!m_running.load() || !isDiversitySourceActive(source) || frames <= 0 || sampleRate <= 0) {
+        return;
+    }
+
+    int index = source - 1;
+    queueNetworkAudio(mono, frames, sampleRate, m_diversityResamplers[index],
+                      m_diversityStereo, m_diversityResampled, m_diversityRings[index].get(),
+                      "Diversity source");
+}
+
+void AudioManager::writeProbe(const float* mono, int frames, double sampleRate)
+{
+    if (!m_running.load() || frames <= 0 || sampleRate <= 0) {
         return;
     }
 
-    // Read from ring buffers
-    std::vector<int16_t> radioData(frames * 2);
-    std::vector<int16_t> loopbackData(frames * 2);
+    if (!m_probeActive.load()) {
+        m_probeRing->clear();
+        m_probeResampler.reset();
+        m_probeActive.store(true);
+    }
+    queueNetworkAudio(mono, frames, sampleRate, m_probeResampler,
+                      m_probeStereo, m_probeResampled, m_probeRing.get(), "Probe");
+}
+
+void AudioManager::stopProbe()
+{
+    if (!m_initialized.load() || !m_probeActive.load()) return;
+
+    m_probeActive.store(false);
+    m_mixer->cancelProbeSync();
+    m_probeRing->clear();
+    m_probeResampler.reset();
+}
+
+void AudioManager::queueNetworkAudio(const float* mono, int frames, double sampleRate,
+                                     std::unique_ptr<Resampler>& resampler, std::vector<float>& stereo,
+                                     std::vector<float>& resampled, RingBuffer* ring, const char* label)
+{
+    // (Re)create the converter when the sender or engine rate changes. Rates
+    // are given in mHz so a fractional sender rate is converted exactly
+    int inputRate = static_cast<int>(std::lround(sampleRate * NETWORK_RATE_SCALE));
+    int outputRate = m_engineRate * NETWORK_RATE_SCALE;
+    if (!resampler || resampler->inputRate() != inputRate
+        || resampler->outputRate() != outputRate) {
+        resampler = std::make_unique<Resampler>(inputRate, outputRate, CHANNELS);
+        qDebug() << "AudioManager:" << label << sampleRate << "Hz ->" << m_engineRate << "Hz";
+    }
+
+    // Packets arrive in bursts: keep a cushion so the mixer never catches up
+    int available = ring->available();
+    if (available == 0) {
+        int prefill = m_engineRate * SDR_STREAM_PREFILL_MS / 1000;
+        stereo.assign(static_cast<size_t>(prefill) * CHANNELS, 0.0f);
+        ring->write(stereo.data(), prefill);
+        available = prefill;
+    }
+
+    stereo.resize(static_cast<size_t>(frames) * CHANNELS);
+    for (int i = 0; i < frames; i++) {
+        stereo[i * 2] = mono[i];
+        stereo[i * 2 + 1] = mono[i];
+    }
+
+    const float* source = stereo.data();
+    int produced = frames;
+    if (!resampler->isPassthrough()) {
+        int maxFrames = resampler->maxOutputFrames(frames);
+        resampled.resize(static_cast<size_t>(maxFrames) * CHANNELS);
+        produced = resampler->process(source, frames, resampled.data(), maxFrames);
+        source = resampled.data();
+    }
 
-    m_radioRing->read(radioData.data(), frames);
-    m_loopbackRing->read(loopbackData.data(), frames);
+    // The sender's clock still runs slightly fast or slow against the sound
+    // card's; trim the excess
+    int maxFill = m_engineRate * SDR_STREAM_MAX_FILL_MS / 1000;
+    int room = std::max(0, maxFill - available);
+    ring->write(source, std::min(produced, room));
+}
 
-    // Process through mixer
-    m_mixer->process(radioData.data(), loopbackData.data(), data, frames);
+void AudioManager::mixEngineFrames(float* output, int frames)
+{
+    // Track queued radio audio for latency reporting
+    float fill = static_cast<float>(m_radioRing->available());
+    m_radioRingFillAvg.store(m_radioRingFillAvg.load() * 0.95f + fill * 0.05f);
+
+    // Mixer pulls straight from the rings into the output buffer
+    int64_t mixStartUs = Telemetry::nowUs();
+    RingBuffer& sdrRing = m_sdrStreamActive.load() ? *m_sdrStreamRing : *m_loopbackRing;
+    RingBuffer* diversityRings[DIVERSITY_SOURCES];
+    for (int i = 0; i < DIVERSITY_SOURCES; i++) {
+        diversityRings[i] = m_diversityActive[i].load() ? m_diversityRings[i].get() : nullptr;
+    }
+    RingBuffer* probeRing = m_probeActive.load() ? m_probeRing.get() : nullptr;
+    m_mixer->process(*m_radioRing, sdrRing, output, frames, diversityRings, probeRing);
+    m_telemetry.mixerProcess().record(Telemetry::nowUs() - mixStartUs);
 
-    // Record if active
+    // Record if active: taps the same buffer (engine rate, before any output resampling)
     if (m_recorder && m_recorder->isRecording()) {
-        m_recorder->writeSamples(data, frames);
+        m_recorder->writeSamples(output, frames);
+    }
+}
+
+void AudioManager::onOutputNeeded(float* data, int frames, int channels)
+{
+    if (!m_running.load()) {
+        memset(data, 0, frames * channels * sizeof(float));
+        return;
+    }
+
+    // Fast path: engine and device agree, mix straight into the device buffer
+    bool passthrough = !m_outputResampler || m_outputResampler->isPassthrough();
+    if (passthrough && channels == CHANNELS) {
+        mixEngineFrames(data, frames);
+        return;
+    }
+
+    // Fill the device-rate FIFO until it covers this period
+    while (m_outputFifoFrames < frames) {
+        int needed = frames - m_outputFifoFrames;
+        int engineFrames = passthrough
+            ? needed
+            : static_cast<int>((static_cast<int64_t>(needed) * m_engineRate
+                                + m_outputResampler->outputRate() - 1) / m_outputResampler->outputRate());
+        engineFrames = std::clamp(engineFrames, 1, BUFFER_SIZE);
+
+        float* mixed = m_outputMix.data();
+        mixEngineFrames(mixed, engineFrames);
+
+        int capacity = static_cast<int>(m_outputFifo.size()) / CHANNELS - m_outputFifoFrames;
+        float* dst = m_outputFifo.data() + static_cast<size_t>(m_outputFifoFrames) * CHANNELS;
+        if (passthrough) {
+            int count = std::min(engineFrames, capacity);
+            std::memcpy(dst, mixed, static_cast<size_t>(count) * CHANNELS * sizeof(float));
+            m_outputFifoFrames += count;
+        } else {
+            m_outputFifoFrames += m_outputResampler->process(mixed, engineFrames, dst, capacity);
+        }
+
+        if (capacity <= 0) break;
+    }
+
+    // Hand one period to the device, expanding stereo to the device layout
+    int available = std::min(frames, m_outputFifoFrames);
+    for (int i = 0; i < available; i++) {
+        for (int ch = 0; ch < channels; ch++) {
+            data[i * channels + ch] = (ch < CHANNELS) ? m_outputFifo[i * CHANNELS + ch] : 0.0f;
+        }
+    }
+    if (available < frames) {
+        memset(data + available * channels, 0, (frames - available) * channels * sizeof(float));
+    }
+
+    m_outputFifoFrames -= available;
+    if (m_outputFifoFrames > 0) {
+        std::memmove(m_outputFifo.data(), m_outputFifo.data() + static_cast<size_t>(available) * CHANNELS,
+                     static_cast<size_t>(m_outputFifoFrames) * CHANNELS * sizeof(float));
     }
+    m_outputFifoQueued.store(m_outputFifoFrames);
 }
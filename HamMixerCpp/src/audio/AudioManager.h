@@ -11,8 +11,10 @@
 #include "audio/DeviceInfo.h"
 #include "audio/WasapiDevice.h"
 #include "audio/RingBuffer.h"
+#include "audio/Resampler.h"
 #include "audio/MixerCore.h"
 #include "audio/Recorder.h"
+#include "audio/AudioTelemetry.h"
 
 /**
  * @brief Audio stream manager for HamMixer
@@ -21,15 +23,53 @@
  * - Radio input (transceiver USB audio or other audio device)
  * - Loopback capture (WebSDR system audio)
  * - Output (mixed audio to speakers/headphones)
+ *
+ * Mixing runs at a configurable engine rate. Each device is opened at
+ * that rate when possible; otherwise a per-device Resampler converts
+ * between the device's native rate and the engine rate.
  */
 class AudioManager : public QObject {
     Q_OBJECT
 
 public:
-    static constexpr int SAMPLE_RATE = 48000;
+    static constexpr int DEFAULT_SAMPLE_RATE = 48000;
     static constexpr int CHANNELS = 2;
     static constexpr int BUFFER_SIZE = 1024;
     static constexpr int RING_BUFFER_SIZE = 4096;
+    static constexpr int SDR_STREAM_RING_SIZE = 32768;  // Network audio arrives in bursts
+    static constexpr int SDR_STREAM_PREFILL_MS = 150;   // Jitter cushion after an underrun
+    static constexpr int SDR_STREAM_MAX_FILL_MS = 400;  // Drop audio above this (clock drift)
+    static constexpr int NETWORK_RATE_SCALE = 1000;     // Network resamplers run in mHz (fractional rates)
+    static constexpr int DIVERSITY_SOURCES = DiversityCombiner::MAX_SOURCES - 1;  // Extra SDR receivers
+
+    /**
+     * @brief Trade-off between latency and robustness for device streams
+     */
+    enum class LatencyProfile {
+        Safe,       // Shared mode, 20 ms buffers
+        Normal,     // Shared mode, 10 ms buffers
+        Low,        // Shared mode at the engine's minimum period (IAudioClient3)
+        Exclusive,  // Exclusive mode at the device's minimum period
+        Auto        // Smallest period that opens without taking devices exclusively
+    };
+
+    /**
+     * @brief Estimated radio-to-output latency of the running streams
+     *
+     * Built from what the devices report and what is queued in the engine,
+     * not from a loopback measurement: sound card and driver delays beyond
+     * the reported stream latency are not included.
+     */
+    struct LatencyReport {
+        bool valid = false;
+        float inputMs = 0.0f;      // Capture stream + one period
+        float bufferMs = 0.0f;     // Average radio ring fill
+        float resamplerMs = 0.0f;  // Resampler group delay (input + output)
+        float outputMs = 0.0f;     // Render stream + device buffer + output FIFO
+        float totalMs = 0.0f;
+        QString inputMode;
+        QString outputMode;
+    };
 
     explicit AudioManager(QObject* parent = nullptr);
     ~AudioManager();
@@ -81,6 +121,118 @@ public:
      */
     void stopStreams();
 
+    /**
+     * @brief Set the engine (mixing) sample rate
+     *
+     * Takes effect on the next startStreams(). Devices running at other
+     * rates are resampled to this rate.
+     * @param sampleRate Engine rate in Hz (e.g. 44100, 48000, 96000)
+     */
+    void setEngineSampleRate(int sampleRate);
+
+    /**
+     * @brief Get the engine (mixing) sample rate
+     */
+    int engineSampleRate() const { return m_engineRate; }
+
+    /**
+     * @brief Set the latency profile (takes effect on next startStreams())
+     */
+    void setLatencyProfile(LatencyProfile profile) { m_latencyProfile = profile; }
+
+    /**
+     * @brief Get the latency profile
+     */
+    LatencyProfile latencyProfile() const { return m_latencyProfile; }
+
+    /**
+     * @brief Parse a profile name from settings ("safe", "normal", "low", "exclusive", "auto")
+     * @return Parsed profile, Normal if unknown
+     */
+    static LatencyProfile latencyProfileFromName(const QString& name);
+
+    /**
+     * @brief Get the settings name for a profile
+     */
+    static QString latencyProfileName(LatencyProfile profile);
+
+    /**
+     * @brief Estimate the current radio-to-output latency (see LatencyReport)
+     */
+    LatencyReport estimateLatency() const;
+
+    /**
+     * @brief Snapshot engine health: device timing, ring xruns, mixer cost
+     */
+    AudioTelemetry::Snapshot telemetrySnapshot() const;
+
+    /**
+     * @brief Clear all telemetry counters and restart the window
+     */
+    void resetTelemetry();
+
+    /**
+     * @brief Feed channel 2 from a network SDR stream instead of the loopback device
+     *
+     * While active, loopback capture is ignored and the mixer reads the
+     * SDR stream ring filled by writeSdrStream(). Call from the GUI thread.
+     */
+    void setSdrStreamActive(bool active);
+
+    /**
+     * @brief Check if channel 2 is fed by a network SDR stream
+     */
+    bool isSdrStreamActive() const { return m_sdrStreamActive.load(); }
+
+    /**
+     * @brief Queue decoded SDR audio for channel 2 (GUI thread)
+     *
+     * Audio is upmixed to stereo and resampled to the engine rate. The
+     * ring is primed with SDR_STREAM_PREFILL_MS of silence whenever it has
+     * run dry, and input beyond SDR_STREAM_MAX_FILL_MS is dropped so the
+     * sender's clock cannot build up latency.
+     * @param mono Mono samples in the -1..1 range
+     * @param frames Number of samples
+     * @param sampleRate Sender's exact sample rate in Hz (may be fractional)
+     */
+    void writeSdrStream(const float* mono, int frames, double sampleRate);
+
+    /**
+     * @brief Connect or disconnect an extra SDR receiver on channel 2 (GUI thread)
+     *
+     * Extra receivers are mixed with channel 2's own source by the mixer's
+     * DiversityCombiner, each with its own alignment delay and SNR estimate.
+     * @param source Combiner source, 1 to DIVERSITY_SOURCES
+     */
+    void setDiversitySourceActive(int source, bool active);
+
+    /**
+     * @brief Check if an extra SDR receiver is connected
+     */
+    bool isDiversitySourceActive(int source) const;
+
+    /**
+     * @brief Queue decoded audio of an extra SDR receiver (GUI thread)
+     *
+     * Same conversion, jitter cushion and fill limit as writeSdrStream().
+     * @param source Combiner source, 1 to DIVERSITY_SOURCES
+     */
+    void writeDiversitySource(int source, const float* mono, int frames, double sampleRate);
+
+    /**
+     * @brief Queue audio of an SDR being probed (GUI thread)
+     *
+     * The probe input is never mixed; it only feeds the mixer's probe sync
+     * (MixerCore::startProbeSync()), which measures the candidate's delay
+     * against the radio. It is live from the first write until stopProbe().
+     */
+    void writeProbe(const float* mono, int frames, double sampleRate);
+
+    /**
+     * @brief Disconnect the probe input and abandon its measurement (GUI thread)
+     */
+    void stopProbe();
+
     /**
      * @brief Check if streams are running
      */
@@ -105,6 +257,7 @@ signals:
     void errorOccurred(const QString& error);
     void streamsStarted();
     void streamsStopped();
+    void latencyEstimated(const AudioManager::LatencyReport& report);
 
 private:
     // Devices
@@ -117,9 +270,48 @@ private:
     std::unique_ptr<WasapiDevice> m_loopbackDevice;
     std::unique_ptr<WasapiDevice> m_outputDevice;
 
-    // Ring buffers for inter-stream communication
+    // Ring buffers for inter-stream communication (engine rate, stereo)
     std::unique_ptr<RingBuffer> m_radioRing;
     std::unique_ptr<RingBuffer> m_loopbackRing;
+    std::unique_ptr<RingBuffer> m_sdrStreamRing;  // Replaces m_loopbackRing while streaming
+    std::unique_ptr<RingBuffer> m_diversityRings[DIVERSITY_SOURCES];  // Extra SDR receivers
+    std::unique_ptr<RingBuffer> m_probeRing;  // SDR being probed (measured, not mixed)
+
+    // Device <-> engine rate converters (passthrough when rates match)
+    int m_engineRate = DEFAULT_SAMPLE_RATE;
+    std::unique_ptr<Resampler> m_radioResampler;
+    std::unique_ptr<Resampler> m_loopbackResampler;
+    std::unique_ptr<Resampler> m_outputResampler;
+    std::unique_ptr<Resampler> m_sdrStreamResampler;  // Sender rate -> engine rate
+    std::atomic<bool> m_sdrStreamActive{false};
+    std::unique_ptr<Resampler> m_diversityResamplers[DIVERSITY_SOURCES];
+    std::atomic<bool> m_diversityActive[DIVERSITY_SOURCES] = {};
+    std::unique_ptr<Resampler> m_probeResampler;
+    std::atomic<bool> m_probeActive{false};
+
+    // Scratch buffers, only touched from their own device thread
+    std::vector<float> m_radioStereo;
+    std::vector<float> m_radioResampled;
+    std::vector<float> m_loopbackStereo;
+    std::vector<float> m_loopbackResampled;
+    std::vector<float> m_sdrStreamStereo;       // GUI thread (writeSdrStream)
+    std::vector<float> m_sdrStreamResampled;
+    std::vector<float> m_diversityStereo;       // GUI thread (writeDiversitySource)
+    std::vector<float> m_diversityResampled;
+    std::vector<float> m_probeStereo;           // GUI thread (writeProbe)
+    std::vector<float> m_probeResampled;
+    std::vector<float> m_outputFifo;     // Device-rate stereo frames awaiting render
+    int m_outputFifoFrames = 0;          // Render thread only
+    std::atomic<int> m_outputFifoQueued{0};  // Left in the FIFO after the last period, for estimateLatency()
+    std::vector<float> m_outputMix;      // Engine-rate mix block feeding the FIFO
+
+    // Latency
+    LatencyProfile m_latencyProfile = LatencyProfile::Normal;
+    std::atomic<float> m_radioRingFillAvg{0.0f};  // Smoothed frames queued in the radio ring
+    static constexpr int LATENCY_REPORT_DELAY_MS = 2000;  // Let rings settle before estimating
+
+    // Health counters, written lock-free from the device threads
+    AudioTelemetry m_telemetry;
 
     // Audio processing
     std::unique_ptr<MixerCore> m_mixer;
@@ -131,10 +323,20 @@ private:
     QString m_lastError;
     std::mutex m_mutex;
 
+    // Stream helpers
+    bool openDevice(WasapiDevice* device, const QString& deviceId, WasapiDevice::DeviceType type);
+    std::unique_ptr<Resampler> createResampler(WasapiDevice* device, bool toEngine, const char* label);
+    void captureToRing(float* data, int frames, int channels, Resampler* resampler,
+                       std::vector<float>& stereo, std::vector<float>& resampled, RingBuffer* ring);
+    void queueNetworkAudio(const float* mono, int frames, double sampleRate,
+                           std::unique_ptr<Resampler>& resampler, std::vector<float>& stereo,
+                           std::vector<float>& resampled, RingBuffer* ring, const char* label);
+    void mixEngineFrames(float* output, int frames);
+
     // Callback handlers
-    void onRadioInput(int16_t* data, int frames, int channels);
-    void onLoopbackInput(int16_t* data, int frames, int channels);
-    void onOutputNeeded(int16_t* data, int frames, int channels);
+    void onRadioInput(float* data, int frames, int channels);
+    void onLoopbackInput(float* data, int frames, int channels);
+    void onOutputNeeded(float* data, int frames, int channels);
 };
 
 #endif // AUDIOMANAGER_H
@@ -8,8 +8,10 @@
 #define M_PI 3.14159265358979323846
 #endif
 
-AudioSync::AudioSync()
-    : m_targetSamples(static_cast<int>(SAMPLE_RATE * CAPTURE_SECONDS))
+AudioSync::AudioSync(int sampleRate)
+    : m_sampleRate(sampleRate)
+    , m_vadFrameSize(sampleRate * VAD_FRAME_MS / 1000)
+    , m_targetSamples(static_cast<int>(sampleRate * CAPTURE_SECONDS))
 {
     // FFT size must be power of 2, large enough for both signals + max delay
     m_fftSize = nextPowerOf2(m_targetSamples * 2);
@@ -17,7 +19,7 @@ AudioSync::AudioSync()
     m_radioBuffer.reserve(m_targetSamples);
     m_websdrBuffer.reserve(m_targetSamples);
 
-    qDebug() << "AudioSync initialized: target samples =" << m_targetSamples
+    qDebug() << "AudioSync initialized:" << m_sampleRate << "Hz, target samples =" << m_targetSamples
              << ", FFT size =" << m_fftSize;
 }
 
@@ -59,7 +61,7 @@ void AudioSync::startCapture(SignalMode mode)
 
     // Adjust capture duration based on mode (CW is shorter - patterns repeat faster)
     float captureSeconds = (mode == CW) ? CAPTURE_SECONDS_CW : CAPTURE_SECONDS;
-    m_targetSamples = static_cast<int>(SAMPLE_RATE * captureSeconds);
+    m_targetSamples = static_cast<int>(m_sampleRate * captureSeconds);
     m_fftSize = nextPowerOf2(m_targetSamples * 2);
 
     // Clear previous data
@@ -206,12 +208,12 @@ void AudioSync::normalizeSignal(std::vector<float>& signal)
 // Voice Activity Detection - returns mask of active frames
 std::vector<bool> AudioSync::detectVoiceActivity(const std::vector<float>& signal)
 {
-    int numFrames = static_cast<int>(signal.size()) / VAD_FRAME_SIZE;
+    int numFrames = static_cast<int>(signal.size()) / m_vadFrameSize;
     std::vector<bool> mask(numFrames, false);
 
     for (int frame = 0; frame < numFrames; frame++) {
-        int start = frame * VAD_FRAME_SIZE;
-        int end = std::min(start + VAD_FRAME_SIZE, static_cast<int>(signal.size()));
+        int start = frame * m_vadFrameSize;
+        int end = std::min(start + m_vadFrameSize, static_cast<int>(signal.size()));
 
         // Compute frame energy (RMS)
         float sumSq = 0.0f;
@@ -234,8 +236,8 @@ void AudioSync::applyVadMask(std::vector<float>& signal, const std::vector<bool>
 
     for (int frame = 0; frame < numFrames; frame++) {
         if (!mask[frame]) {
-            int start = frame * VAD_FRAME_SIZE;
-            int end = std::min(start + VAD_FRAME_SIZE, static_cast<int>(signal.size()));
+            int start = frame * m_vadFrameSize;
+            int end = std::min(start + m_vadFrameSize, static_cast<int>(signal.size()));
             for (int i = start; i < end; i++) {
                 signal[i] = 0.0f;
             }
@@ -335,7 +337,7 @@ float AudioSync::findSecondPeak(const std::vector<std::complex<float>>& gcc,
                                  int bestLagIndex, int minLag, int maxLag)
 {
     float secondPeak = 0.0f;
-    int exclusionZone = SAMPLE_RATE / 100;  // 10ms exclusion around main peak
+    int exclusionZone = m_sampleRate / 100;  // 10ms exclusion around main peak
     int fftSize = static_cast<int>(gcc.size());
 
     // Search positive lags
@@ -497,8 +499,8 @@ void AudioSync::analyzeWithRobustGccPhat()
     qDebug() << "Step 4: Multiband GCC-PHAT-beta analysis (" << NUM_BANDS << " bands)...";
     qDebug() << "  Bandpass:" << bpLow << "-" << bpHigh << "Hz";
 
-    int lowBin = static_cast<int>(bpLow * m_fftSize / SAMPLE_RATE);
-    int highBin = static_cast<int>(bpHigh * m_fftSize / SAMPLE_RATE);
+    int lowBin = static_cast<int>(bpLow * m_fftSize / m_sampleRate);
+    int highBin = static_cast<int>(bpHigh * m_fftSize / m_sampleRate);
     int bandWidth = (highBin - lowBin) / NUM_BANDS;
 
     // Store GCC results for each band
@@ -513,8 +515,8 @@ void AudioSync::analyzeWithRobustGccPhat()
         bandSnr[band] = computeBandGccPhat(radioFFT, websdrFFT, bandLow, bandHigh,
                                            PHAT_BETA, bandGccResults[band]);
 
-        float bandFreqLow = bandLow * SAMPLE_RATE / static_cast<float>(m_fftSize);
-        float bandFreqHigh = bandHigh * SAMPLE_RATE / static_cast<float>(m_fftSize);
+        float bandFreqLow = bandLow * m_sampleRate / static_cast<float>(m_fftSize);
+        float bandFreqHigh = bandHigh * m_sampleRate / static_cast<float>(m_fftSize);
         qDebug() << "  Band" << band << ":" << bandFreqLow << "-" << bandFreqHigh
                  << "Hz, SNR estimate:" << bandSnr[band];
     }
@@ -541,8 +543,8 @@ void AudioSync::analyzeWithRobustGccPhat()
     // ========== PEAK FINDING (SYMMETRIC - NO BIAS) ==========
     // Search both positive and negative lags equally
     qDebug() << "Step 6: Peak detection (symmetric search)...";
-    int maxDelaySamples = static_cast<int>(MAX_DELAY_MS * SAMPLE_RATE / 1000.0f);
-    int minDelaySamples = static_cast<int>(10.0f * SAMPLE_RATE / 1000.0f);
+    int maxDelaySamples = static_cast<int>(MAX_DELAY_MS * m_sampleRate / 1000.0f);
+    int minDelaySamples = static_cast<int>(10.0f * m_sampleRate / 1000.0f);
 
     float maxPosCorrelation = -1e30f;
     int bestPosLag = 0;
@@ -629,7 +631,7 @@ void AudioSync::analyzeWithRobustGccPhat()
     // Convert lag to SIGNED milliseconds
     // Positive = WebSDR behind Radio (add delay to Radio channel)
     // Negative = WebSDR ahead of Radio (reduce delay / add delay to WebSDR channel)
-    float delayMs = static_cast<float>(finalLagMagnitude) * 1000.0f / SAMPLE_RATE;
+    float delayMs = static_cast<float>(finalLagMagnitude) * 1000.0f / m_sampleRate;
     if (isNegativeLag) {
         delayMs = -delayMs;  // Negative delay means WebSDR is ahead
     }
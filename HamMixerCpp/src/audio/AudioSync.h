@@ -34,7 +34,7 @@ public:
         CW      // CW, RTTY - no VAD, narrower bandpass (400-1000 Hz), envelope correlation
     };
 
-    static constexpr int SAMPLE_RATE = 48000;
+    static constexpr int DEFAULT_SAMPLE_RATE = 48000;
     static constexpr float CAPTURE_SECONDS = 1.5f;  // 1.5 second capture - sweet spot for short CQ calls
     static constexpr float CAPTURE_SECONDS_CW = 2.0f;  // 2.0 seconds for CW
     static constexpr int MAX_DELAY_MS = 2000;       // Max search window (matches delay slider)
@@ -64,8 +64,8 @@ public:
     // Lower threshold (0.005) accepts quieter frames for weak signal detection
     static constexpr float VAD_THRESHOLD = 0.005f;
 
-    // VAD frame size in samples (20ms frames)
-    static constexpr int VAD_FRAME_SIZE = SAMPLE_RATE / 50;
+    // VAD frame length (20ms frames, converted to samples at the engine rate)
+    static constexpr int VAD_FRAME_MS = 20;
 
     struct SyncResult {
         float delayMs = 0.0f;       // Signed: positive = WebSDR behind (add delay), negative = WebSDR ahead (reduce delay)
@@ -73,7 +73,11 @@ public:
         bool success = false;
     };
 
-    AudioSync();
+    /**
+     * @brief Construct sync analyser
+     * @param sampleRate Engine sample rate of the samples passed to addSamples()
+     */
+    explicit AudioSync(int sampleRate = DEFAULT_SAMPLE_RATE);
     ~AudioSync();
 
     // Non-copyable
@@ -129,6 +133,8 @@ private:
 
     std::unique_ptr<std::thread> m_analysisThread;
 
+    int m_sampleRate;
+    int m_vadFrameSize;
     int m_targetSamples;
     int m_fftSize;
 
@@ -0,0 +1,264 @@
+#include "audio/AudioTelemetry.h"
+#include <QDateTime>
+#include <QStringList>
+#include <cstdlib>
+
+namespace {
+
+// Bucket upper edges in microseconds; the last bucket catches everything above
+constexpr int BUCKET_EDGES_US[TimingHistogram::BUCKETS - 1] = {
+    50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000
+};
+
+QJsonObject histogramToJson(const TimingHistogram::Snapshot& h)
+{
+    QJsonObject obj;
+    obj["count"] = static_cast<qint64>(h.count);
+    obj["mean_us"] = h.meanUs;
+    obj["min_us"] = h.minUs;
+    obj["max_us"] = h.maxUs;
+
+    QJsonObject buckets;
+    for (int i = 0; i < TimingHistogram::BUCKETS; i++) {
+        buckets[TimingHistogram::bucketLabel(i)] = static_cast<qint64>(h.counts[i]);
+    }
+    obj["buckets"] = buckets;
+    return obj;
+}
+
+QJsonObject deviceToJson(const DeviceTelemetry::Snapshot& d)
+{
+    QJsonObject obj;
+    obj["callbacks"] = static_cast<qint64>(d.callbacks);
+    obj["discontinuities"] = static_cast<qint64>(d.discontinuities);
+    obj["timestamp_errors"] = static_cast<qint64>(d.timestampErrors);
+    obj["starved"] = static_cast<qint64>(d.starved);
+    obj["expected_period_us"] = d.expectedPeriodUs;
+    obj["max_jitter_us"] = d.maxJitterUs;
+    obj["intervals"] = histogramToJson(d.intervals);
+    return obj;
+}
+
+QJsonObject ringToJson(const RingStats& r)
+{
+    QJsonObject obj;
+    obj["underruns"] = static_cast<qint64>(r.underruns);
+    obj["underrun_frames"] = static_cast<qint64>(r.underrunFrames);
+    obj["overruns"] = static_cast<qint64>(r.overruns);
+    obj["overrun_frames"] = static_cast<qint64>(r.overrunFrames);
+    obj["fill_min"] = r.fillMin;
+    obj["fill_max"] = r.fillMax;
+    obj["capacity"] = r.capacity;
+    return obj;
+}
+
+} // namespace
+
+// ========== TimingHistogram ==========
+
+void TimingHistogram::record(int64_t us)
+{
+    if (us < 0) us = 0;
+
+    int bucket = BUCKETS - 1;
+    for (int i = 0; i < BUCKETS - 1; i++) {
+        if (us < BUCKET_EDGES_US[i]) {
+            bucket = i;
+            break;
+        }
+    }
+
+    int clamped = us > INT_MAX ? INT_MAX : static_cast<int>(us);
+    m_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sumUs.fetch_add(us, std::memory_order_relaxed);
+    Telemetry::updateMin(m_minUs, clamped);
+    Telemetry::updateMax(m_maxUs, clamped);
+}
+
+TimingHistogram::Snapshot TimingHistogram::snapshot() const
+{
+    Snapshot snap;
+    for (int i = 0; i < BUCKETS; i++) {
+        snap.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+    }
+    snap.count = m_count.load(std::memory_order_relaxed);
+    if (snap.count > 0) {
+        snap.meanUs = static_cast<double>(m_sumUs.load(std::memory_order_relaxed)) / snap.count;
+        snap.minUs = m_minUs.load(std::memory_order_relaxed);
+        snap.maxUs = m_maxUs.load(std::memory_order_relaxed);
+    }
+    return snap;
+}
+
+void TimingHistogram::reset()
+{
+    for (auto& count : m_counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sumUs.store(0, std::memory_order_relaxed);
+    m_minUs.store(INT_MAX, std::memory_order_relaxed);
+    m_maxUs.store(0, std::memory_order_relaxed);
+}
+
+int TimingHistogram::bucketUpperUs(int bucket)
+{
+    if (bucket < 0 || bucket >= BUCKETS - 1) {
+        return INT_MAX;
+    }
+    return BUCKET_EDGES_US[bucket];
+}
+
+QString TimingHistogram::bucketLabel(int bucket)
+{
+    auto format = [](int us) {
+        return (us >= 1000) ? QString("%1ms").arg(us / 1000) : QString("%1us").arg(us);
+    };
+
+    if (bucket >= BUCKETS - 1) {
+        return ">=" + format(BUCKET_EDGES_US[BUCKETS - 2]);
+    }
+    return "<" + format(BUCKET_EDGES_US[bucket]);
+}
+
+// ========== DeviceTelemetry ==========
+
+void DeviceTelemetry::onCallback(int64_t nowUs)
+{
+    m_callbacks.fetch_add(1, std::memory_order_relaxed);
+
+    int64_t last = m_lastCallbackUs.exchange(nowUs, std::memory_order_relaxed);
+    if (last == 0) {
+        return;  // First wake-up has no interval
+    }
+
+    int64_t interval = nowUs - last;
+    m_intervals.record(interval);
+
+    int expected = m_expectedPeriodUs.load(std::memory_order_relaxed);
+    if (expected > 0) {
+        int64_t jitter = std::llabs(interval - expected);
+        Telemetry::updateMax(m_maxJitterUs, jitter > INT_MAX ? INT_MAX : static_cast<int>(jitter));
+    }
+}
+
+DeviceTelemetry::Snapshot DeviceTelemetry::snapshot() const
+{
+    Snapshot snap;
+    snap.callbacks = m_callbacks.load(std::memory_order_relaxed);
+    snap.discontinuities = m_discontinuities.load(std::memory_order_relaxed);
+    snap.timestampErrors = m_timestampErrors.load(std::memory_order_relaxed);
+    snap.starved = m_starved.load(std::memory_order_relaxed);
+    snap.expectedPeriodUs = m_expectedPeriodUs.load(std::memory_order_relaxed);
+    snap.maxJitterUs = m_maxJitterUs.load(std::memory_order_relaxed);
+    snap.intervals = m_intervals.snapshot();
+    return snap;
+}
+
+void DeviceTelemetry::reset()
+{
+    m_lastCallbackUs.store(0, std::memory_order_relaxed);
+    m_callbacks.store(0, std::memory_order_relaxed);
+    m_discontinuities.store(0, std::memory_order_relaxed);
+    m_timestampErrors.store(0, std::memory_order_relaxed);
+    m_starved.store(0, std::memory_order_relaxed);
+    m_maxJitterUs.store(0, std::memory_order_relaxed);
+    m_intervals.reset();
+}
+
+// ========== AudioTelemetry ==========
+
+AudioTelemetry::AudioTelemetry()
+{
+    m_windowStartUs.store(Telemetry::nowUs());
+}
+
+AudioTelemetry::Snapshot AudioTelemetry::snapshot() const
+{
+    Snapshot snap;
+    snap.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    snap.windowMs = (Telemetry::nowUs() - m_windowStartUs.load()) / 1000;
+    snap.input = m_input.snapshot();
+    snap.loopback = m_loopback.snapshot();
+    snap.output = m_output.snapshot();
+    snap.mixerProcess = m_mixerProcess.snapshot();
+    return snap;
+}
+
+void AudioTelemetry::reset()
+{
+    m_input.reset();
+    m_loopback.reset();
+    m_output.reset();
+    m_mixerProcess.reset();
+    m_windowStartUs.store(Telemetry::nowUs());
+}
+
+QJsonObject AudioTelemetry::Snapshot::toJson() const
+{
+    QJsonObject root;
+    root["timestamp"] = QDateTime::fromMSecsSinceEpoch(timestampMs).toString(Qt::ISODateWithMs);
+    root["window_ms"] = windowMs;
+    root["sample_rate"] = sampleRate;
+
+    QJsonObject devices;
+    devices["radio_input"] = deviceToJson(input);
+    devices["loopback"] = deviceToJson(loopback);
+    devices["output"] = deviceToJson(output);
+    root["devices"] = devices;
+
+    QJsonObject rings;
+    rings["radio"] = ringToJson(radioRing);
+    rings["loopback"] = ringToJson(loopbackRing);
+    root["rings"] = rings;
+
+    root["mixer_process"] = histogramToJson(mixerProcess);
+    return root;
+}
+
+QString AudioTelemetry::Snapshot::csvHeader()
+{
+    QStringList columns = {"timestamp", "window_ms"};
+    for (const char* dev : {"in", "loop", "out"}) {
+        for (const char* field : {"callbacks", "discontinuities", "starved", "max_jitter_us",
+                                  "interval_mean_us", "interval_max_us"}) {
+            columns << QString("%1_%2").arg(dev, field);
+        }
+    }
+    for (const char* ring : {"radio_ring", "loop_ring"}) {
+        for (const char* field : {"underruns", "underrun_frames", "overruns", "overrun_frames",
+                                  "fill_min", "fill_max"}) {
+            columns << QString("%1_%2").arg(ring, field);
+        }
+    }
+    columns << "mix_mean_us" << "mix_max_us";
+    return columns.join(',');
+}
+
+QString AudioTelemetry::Snapshot::toCsvRow() const
+{
+    QStringList values;
+    values << QDateTime::fromMSecsSinceEpoch(timestampMs).toString(Qt::ISODateWithMs)
+           << QString::number(windowMs);
+
+    for (const DeviceTelemetry::Snapshot* d : {&input, &loopback, &output}) {
+        values << QString::number(d->callbacks)
+               << QString::number(d->discontinuities)
+               << QString::number(d->starved)
+               << QString::number(d->maxJitterUs)
+               << QString::number(d->intervals.meanUs, 'f', 1)
+               << QString::number(d->intervals.maxUs);
+    }
+    for (const RingStats* r : {&radioRing, &loopbackRing}) {
+        values << QString::number(r->underruns)
+               << QString::number(r->underrunFrames)
+               << QString::number(r->overruns)
+               << QString::number(r->overrunFrames)
+               << QString::number(r->fillMin)
+               << QString::number(r->fillMax);
+    }
+    values << QString::number(mixerProcess.meanUs, 'f', 1)
+           << QString::number(mixerProcess.maxUs);
+    return values.join(',');
+}
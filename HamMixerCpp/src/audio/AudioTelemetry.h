@@ -0,0 +1,193 @@
+#ifndef AUDIOTELEMETRY_H
+#define AUDIOTELEMETRY_H
+
+#include <QString>
+#include <QJsonObject>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+
+/**
+ * @brief Lock-free counters for audio engine health
+ *
+ * Written from the audio threads with relaxed atomics only (no locks,
+ * no allocation) and read from the UI thread as plain snapshots.
+ */
+namespace Telemetry {
+
+/**
+ * @brief Monotonic timestamp in microseconds
+ */
+inline int64_t nowUs()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+inline void updateMin(std::atomic<int>& target, int value)
+{
+    int current = target.load(std::memory_order_relaxed);
+    while (value < current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+inline void updateMax(std::atomic<int>& target, int value)
+{
+    int current = target.load(std::memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace Telemetry
+
+/**
+ * @brief Ring buffer health counters (snapshot)
+ */
+struct RingStats {
+    uint64_t underruns = 0;      // Reads that came up short
+    uint64_t underrunFrames = 0; // Frames padded with silence
+    uint64_t overruns = 0;       // Writes that did not fit
+    uint64_t overrunFrames = 0;  // Frames dropped
+    int fillMin = 0;             // Lowest fill seen at read time (frames)
+    int fillMax = 0;             // Highest fill seen after a write (frames)
+    int capacity = 0;
+};
+
+/**
+ * @brief Fixed log-spaced histogram of durations in microseconds
+ */
+class TimingHistogram {
+public:
+    static constexpr int BUCKETS = 11;
+
+    struct Snapshot {
+        std::array<uint64_t, BUCKETS> counts{};
+        uint64_t count = 0;
+        double meanUs = 0.0;
+        int minUs = 0;
+        int maxUs = 0;
+    };
+
+    /**
+     * @brief Record one duration (audio-thread safe)
+     */
+    void record(int64_t us);
+
+    Snapshot snapshot() const;
+    void reset();
+
+    /**
+     * @brief Upper edge of a bucket in microseconds (last bucket is open-ended)
+     */
+    static int bucketUpperUs(int bucket);
+
+    /**
+     * @brief Short label for a bucket, e.g. "<500us" or ">=50ms"
+     */
+    static QString bucketLabel(int bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> m_counts{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<int64_t> m_sumUs{0};
+    std::atomic<int> m_minUs{INT_MAX};
+    std::atomic<int> m_maxUs{0};
+};
+
+/**
+ * @brief Per-device callback timing and WASAPI glitch counters
+ */
+class DeviceTelemetry {
+public:
+    struct Snapshot {
+        uint64_t callbacks = 0;
+        uint64_t discontinuities = 0;  // AUDCLNT_BUFFERFLAGS_DATA_DISCONTINUITY
+        uint64_t timestampErrors = 0;  // AUDCLNT_BUFFERFLAGS_TIMESTAMP_ERROR
+        uint64_t starved = 0;          // Render woke to an empty device buffer
+        int expectedPeriodUs = 0;
+        int maxJitterUs = 0;           // Largest |interval - expected period|
+        TimingHistogram::Snapshot intervals;
+    };
+
+    /**
+     * @brief Set the nominal callback period used for jitter
+     */
+    void setExpectedPeriodUs(int us) { m_expectedPeriodUs.store(us, std::memory_order_relaxed); }
+
+    /**
+     * @brief Record a device wake-up at the given time
+     */
+    void onCallback(int64_t nowUs);
+
+    void onDiscontinuity() { m_discontinuities.fetch_add(1, std::memory_order_relaxed); }
+    void onTimestampError() { m_timestampErrors.fetch_add(1, std::memory_order_relaxed); }
+    void onStarved() { m_starved.fetch_add(1, std::memory_order_relaxed); }
+
+    Snapshot snapshot() const;
+    void reset();
+
+private:
+    std::atomic<int64_t> m_lastCallbackUs{0};
+    std::atomic<uint64_t> m_callbacks{0};
+    std::atomic<uint64_t> m_discontinuities{0};
+    std::atomic<uint64_t> m_timestampErrors{0};
+    std::atomic<uint64_t> m_starved{0};
+    std::atomic<int> m_expectedPeriodUs{0};
+    std::atomic<int> m_maxJitterUs{0};
+    TimingHistogram m_intervals;
+};
+
+/**
+ * @brief Audio engine telemetry: devices, rings and mixer timing
+ *
+ * Owned by AudioManager. Device and mixer counters live here; ring
+ * counters live in each RingBuffer and are folded into snapshots.
+ */
+class AudioTelemetry {
+public:
+    struct Snapshot {
+        qint64 timestampMs = 0;   // Wall clock (ms since epoch)
+        qint64 windowMs = 0;      // Time since last reset
+        int sampleRate = 0;
+        DeviceTelemetry::Snapshot input;
+        DeviceTelemetry::Snapshot loopback;
+        DeviceTelemetry::Snapshot output;
+        RingStats radioRing;
+        RingStats loopbackRing;
+        TimingHistogram::Snapshot mixerProcess;
+
+        QJsonObject toJson() const;
+        QString toCsvRow() const;
+        static QString csvHeader();
+    };
+
+    AudioTelemetry();
+
+    DeviceTelemetry& input() { return m_input; }
+    DeviceTelemetry& loopback() { return m_loopback; }
+    DeviceTelemetry& output() { return m_output; }
+    TimingHistogram& mixerProcess() { return m_mixerProcess; }
+
+    /**
+     * @brief Snapshot device and mixer counters (ring stats filled by caller)
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * @brief Clear device and mixer counters and restart the window
+     */
+    void reset();
+
+private:
+    DeviceTelemetry m_input;
+    DeviceTelemetry m_loopback;
+    DeviceTelemetry m_output;
+    TimingHistogram m_mixerProcess;
+    std::atomic<int64_t> m_windowStartUs{0};
+};
+
+#endif // AUDIOTELEMETRY_H
@@ -14,13 +14,12 @@
 class DelayBuffer {
 public:
     static constexpr int MAX_DELAY_MS = 2000;  // Extended for distant KiwiSDR sites
-    static constexpr int SAMPLE_RATE = 48000;
     static constexpr int CROSSFADE_MS = 50;
 
     /**
      * @brief Construct a new Delay Buffer
      * @param maxDelaySamples Maximum delay in samples (default: 2000ms at 48kHz)
-     * @param sampleRate Audio sample rate in Hz
+     * @param sampleRate Engine sample rate in Hz (all ms <-> samples conversions use it)
      */
     DelayBuffer(int maxDelaySamples = 96000, int sampleRate = 48000);
     ~DelayBuffer() = default;
@@ -0,0 +1,269 @@
+#include "audio/DiversityCombiner.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+DiversityCombiner::DiversityCombiner(int sampleRate)
+    : m_sampleRate(sampleRate)
+{
+    int maxDelaySamples = static_cast<int>(
+        static_cast<float>(DelayBuffer::MAX_DELAY_MS) * m_sampleRate / 1000.0f);
+    for (Source& source : m_sources) {
+        source.delay = std::make_unique<DelayBuffer>(maxDelaySamples, m_sampleRate);
+        source.sync = std::make_unique<AudioSync>(m_sampleRate);
+    }
+
+    m_snrFrameSize = std::max(1, static_cast<int>(SNR_FRAME_MS * m_sampleRate / 1000.0f));
+    m_signalCoeff = 1.0f - std::exp(-SNR_FRAME_MS / SIGNAL_SMOOTH_MS);
+    m_noiseRise = std::pow(10.0f, NOISE_RISE_DB_PER_S * SNR_FRAME_MS / 1000.0f / 10.0f);
+    m_holdFrames = static_cast<int>(SWITCH_HOLD_MS / SNR_FRAME_MS);
+    m_fadeLength = std::max(1, static_cast<int>(SWITCH_FADE_MS * m_sampleRate / 1000.0f));
+    m_fadeProgress = m_fadeLength;
+}
+
+void DiversityCombiner::setSourceDelayMs(int source, float delayMs)
+{
+    if (source < 0 || source >= MAX_SOURCES) return;
+    m_sources[source].delay->setDelayMs(delayMs);
+}
+
+float DiversityCombiner::sourceDelayMs(int source) const
+{
+    if (source < 0 || source >= MAX_SOURCES) return 0.0f;
+    return m_sources[source].delay->getTargetDelayMs();
+}
+
+bool DiversityCombiner::isSourcePresent(int source) const
+{
+    if (source < 0 || source >= MAX_SOURCES) return false;
+    return m_sources[source].present.load();
+}
+
+float DiversityCombiner::sourceSnrDb(int source) const
+{
+    if (source < 0 || source >= MAX_SOURCES) return 0.0f;
+    return m_sources[source].snrDb.load();
+}
+
+void DiversityCombiner::setMaxBlockFrames(int maxFrames)
+{
+    if (maxFrames <= m_maxBlockFrames) {
+        return;
+    }
+
+    m_maxBlockFrames = maxFrames;
+    for (Source& source : m_sources) {
+        source.aligned.assign(maxFrames, 0.0f);
+    }
+}
+
+void DiversityCombiner::process(const float* const* inputs, float* output, int frameCount)
+{
+    // MixerCore keeps blocks within what setMaxBlockFrames() sized
+    assert(frameCount <= m_maxBlockFrames);
+
+    // Line the sources up; a missing source contributes silence
+    for (int s = 0; s < MAX_SOURCES; s++) {
+        Source& source = m_sources[s];
+        bool connected = inputs[s] != nullptr;
+        source.present.store(connected);
+        if (connected) {
+            source.delay->process(inputs[s], source.aligned.data(), frameCount);
+        } else {
+            std::fill(source.aligned.begin(), source.aligned.begin() + frameCount, 0.0f);
+        }
+    }
+
+    Mode mode = m_mode.load();
+    int position = 0;
+    while (position < frameCount) {
+        // Work up to the next SNR frame boundary
+        int chunk = std::min(frameCount - position, m_snrFrameSize - m_snrFrameFill);
+
+        int connected = 0;
+        for (Source& source : m_sources) {
+            if (!source.present.load()) continue;
+            connected++;
+            const float* samples = source.aligned.data() + position;
+            double power = 0.0;
+            for (int i = 0; i < chunk; i++) {
+                power += static_cast<double>(samples[i]) * samples[i];
+            }
+            source.framePower += power;
+        }
+
+        float* out = output + position;
+        if (mode == Mode::Sum) {
+            float scale = connected > 0 ? 1.0f / static_cast<float>(connected) : 0.0f;
+            std::fill(out, out + chunk, 0.0f);
+            for (Source& source : m_sources) {
+                if (!source.present.load()) continue;
+                const float* samples = source.aligned.data() + position;
+                for (int i = 0; i < chunk; i++) {
+                    out[i] += samples[i] * scale;
+                }
+            }
+        } else {
+            const float* current = m_sources[m_selected.load()].aligned.data() + position;
+            const float* previous = m_sources[m_fadeFrom].aligned.data() + position;
+            for (int i = 0; i < chunk; i++) {
+                if (m_fadeProgress < m_fadeLength) {
+                    float gain = static_cast<float>(m_fadeProgress++) / m_fadeLength;
+                    out[i] = current[i] * gain + previous[i] * (1.0f - gain);
+                } else {
+                    out[i] = current[i];
+                }
+            }
+        }
+
+        position += chunk;
+        m_snrFrameFill += chunk;
+        if (m_snrFrameFill >= m_snrFrameSize) {
+            finishSnrFrame();
+            updateSelection();
+            m_snrFrameFill = 0;
+        }
+    }
+}
+
+void DiversityCombiner::finishSnrFrame()
+{
+    for (Source& source : m_sources) {
+        float power = static_cast<float>(source.framePower / m_snrFrameSize);
+        source.framePower = 0.0;
+
+        if (!source.present.load() || power < SILENCE_POWER) {
+            // Not connected or stalled (stream underrun): restart when audio returns
+            source.live = false;
+            source.snrDb.store(0.0f);
+            continue;
+        }
+
+        if (!source.live) {
+            source.signalPower = power;
+            source.noisePower = power;
+            source.live = true;
+        } else {
+            source.signalPower += m_signalCoeff * (power - source.signalPower);
+            source.noisePower = std::min(source.noisePower * m_noiseRise, source.signalPower);
+        }
+
+        float noise = std::max(source.noisePower, SILENCE_POWER);
+        source.snrDb.store(10.0f * std::log10(source.signalPower / noise));
+    }
+}
+
+void DiversityCombiner::updateSelection()
+{
+    m_framesSinceSwitch++;
+
+    int current = m_selected.load();
+    int best = -1;
+    float bestSnr = 0.0f;
+    for (int s = 0; s < MAX_SOURCES; s++) {
+        const Source& source = m_sources[s];
+        if (!source.live) continue;
+        float snr = source.snrDb.load();
+        if (best < 0 || snr > bestSnr) {
+            best = s;
+            bestSnr = snr;
+        }
+    }
+    if (best < 0 || best == current) {
+        return;
+    }
+
+    // Leave a source that went quiet at once; otherwise only for a clear gain
+    bool currentLive = m_sources[current].live;
+    if (currentLive) {
+        if (m_framesSinceSwitch < m_holdFrames) return;
+        if (bestSnr < m_sources[current].snrDb.load() + SWITCH_HYSTERESIS_DB) return;
+    }
+
+    m_fadeFrom = current;
+    m_fadeProgress = 0;
+    m_framesSinceSwitch = 0;
+    m_selected.store(best);
+}
+
+void DiversityCombiner::addSyncSamples(const float* radio, const float* const* inputs, int frameCount)
+{
+    for (int s = 1; s < MAX_SOURCES; s++) {
+        Source& source = m_sources[s];
+        if (!source.syncStarted.load() || !source.sync->isCapturing()) continue;
+
+        if (inputs[s]) {
+            source.sync->addSamples(radio, inputs[s], frameCount);
+        } else {
+            // Receiver went away mid-capture: nothing to measure
+            source.sync->cancel();
+            source.syncStarted.store(false);
+        }
+    }
+}
+
+void DiversityCombiner::startSyncCapture(AudioSync::SignalMode mode)
+{
+    for (int s = 1; s < MAX_SOURCES; s++) {
+        Source& source = m_sources[s];
+        if (!source.present.load()) continue;
+        source.sync->startCapture(mode);
+        source.syncStarted.store(true);
+    }
+}
+
+void DiversityCombiner::cancelSyncCapture()
+{
+    for (Source& source : m_sources) {
+        source.sync->cancel();
+        source.syncStarted.store(false);
+    }
+}
+
+bool DiversityCombiner::isSyncCapturing() const
+{
+    for (const Source& source : m_sources) {
+        if (source.syncStarted.load() && source.sync->isCapturing()) return true;
+    }
+    return false;
+}
+
+bool DiversityCombiner::isSyncPending() const
+{
+    for (const Source& source : m_sources) {
+        if (source.syncStarted.load() && !source.sync->hasResult()) return true;
+    }
+    return false;
+}
+
+bool DiversityCombiner::takeSyncResult(int source, AudioSync::SyncResult& result)
+{
+    if (source < 1 || source >= MAX_SOURCES) return false;
+    Source& entry = m_sources[source];
+    if (!entry.syncStarted.load() || !entry.sync->hasResult()) return false;
+
+    result = entry.sync->getResult();
+    entry.syncStarted.store(false);
+    return true;
+}
+
+void DiversityCombiner::reset()
+{
+    cancelSyncCapture();
+    for (Source& source : m_sources) {
+        float delayMs = source.delay->getTargetDelayMs();
+        source.delay->reset();
+        source.delay->setDelayMs(delayMs);
+        source.present.store(false);
+        source.snrDb.store(0.0f);
+        source.live = false;
+        source.framePower = 0.0;
+        source.signalPower = 0.0f;
+        source.noisePower = 0.0f;
+    }
+    m_snrFrameFill = 0;
+    m_framesSinceSwitch = 0;
+    m_fadeFrom = 0;
+    m_fadeProgress = m_fadeLength;
+    m_selected.store(0);
+}
@@ -0,0 +1,166 @@
+#ifndef DIVERSITYCOMBINER_H
+#define DIVERSITYCOMBINER_H
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "audio/DelayBuffer.h"
+#include "audio/AudioSync.h"
+
+/**
+ * @brief Combines several SDR receivers into channel 2
+ *
+ * Source 0 is channel 2's own input (loopback or the native stream of the
+ * live site); sources 1..MAX_SOURCES-1 are extra receivers streamed at the
+ * same time. Each source has its own delay line so the receivers line up
+ * with each other (the radio delay then lines the radio up with all of
+ * them), and its own running SNR estimate:
+ *
+ * - signal: frame power smoothed over SIGNAL_SMOOTH_MS
+ * - noise: the smallest smoothed power seen, allowed to rise by
+ *   NOISE_RISE_DB_PER_S so it follows a rising band noise
+ *
+ * Both are ratios of the same receiver's audio, so the estimate does not
+ * depend on each site's AGC or volume. In BestOf mode only the source with
+ * the highest SNR is heard; another source must beat it by
+ * SWITCH_HYSTERESIS_DB, and a choice is held for at least SWITCH_HOLD_MS,
+ * so fading does not make it flap. Switches are crossfaded. Sum mode
+ * averages all sources.
+ *
+ * process() runs on the audio thread; the setters and the read-outs are
+ * atomics and may be used from the GUI thread.
+ */
+class DiversityCombiner {
+public:
+    static constexpr int MAX_SOURCES = 3;  // Channel 2 plus two extra receivers
+
+    static constexpr float SNR_FRAME_MS = 20.0f;
+    static constexpr float SIGNAL_SMOOTH_MS = 300.0f;
+    static constexpr float NOISE_RISE_DB_PER_S = 3.0f;
+    static constexpr float SILENCE_POWER = 1e-10f;   // Below this the source is not delivering audio
+    static constexpr float SWITCH_HYSTERESIS_DB = 3.0f;
+    static constexpr int SWITCH_HOLD_MS = 500;
+    static constexpr float SWITCH_FADE_MS = 20.0f;
+
+    enum class Mode {
+        Sum,     // Average of all sources
+        BestOf   // Highest-SNR source only
+    };
+
+    explicit DiversityCombiner(int sampleRate = 48000);
+    ~DiversityCombiner() = default;
+
+    // Non-copyable
+    DiversityCombiner(const DiversityCombiner&) = delete;
+    DiversityCombiner& operator=(const DiversityCombiner&) = delete;
+
+    void setMode(Mode mode) { m_mode.store(mode); }
+    Mode mode() const { return m_mode.load(); }
+
+    /**
+     * @brief Size the per-source buffers for blocks of up to maxFrames
+     * (call while streams are stopped; process() never allocates)
+     */
+    void setMaxBlockFrames(int maxFrames);
+
+    /**
+     * @brief Alignment delay of one source (0 to DelayBuffer::MAX_DELAY_MS)
+     */
+    void setSourceDelayMs(int source, float delayMs);
+    float sourceDelayMs(int source) const;
+
+    /**
+     * @brief Whether a source delivered audio in the last processed block
+     */
+    bool isSourcePresent(int source) const;
+
+    /**
+     * @brief Current SNR estimate of a source in dB (0 if it is not present)
+     */
+    float sourceSnrDb(int source) const;
+
+    /**
+     * @brief Source heard in BestOf mode
+     */
+    int selectedSource() const { return m_selected.load(); }
+
+    /**
+     * @brief Align and combine one block
+     * @param inputs Mono input per source (nullptr = source not connected)
+     * @param output Combined mono output
+     * @param frameCount Number of frames
+     */
+    void process(const float* const* inputs, float* output, int frameCount);
+
+    /**
+     * @brief Feed the per-source sync analysers (undelayed radio and sources)
+     */
+    void addSyncSamples(const float* radio, const float* const* inputs, int frameCount);
+
+    /**
+     * @brief Start measuring every connected extra source against the radio
+     *
+     * Source 0 is measured by the mixer's own AudioSync.
+     */
+    void startSyncCapture(AudioSync::SignalMode mode);
+    void cancelSyncCapture();
+    bool isSyncCapturing() const;
+
+    /**
+     * @brief True while a started measurement is still capturing or analysing
+     */
+    bool isSyncPending() const;
+
+    /**
+     * @brief Collect the result of a finished measurement (once per capture)
+     * @return false if the source was not measured
+     */
+    bool takeSyncResult(int source, AudioSync::SyncResult& result);
+
+    /**
+     * @brief Reset delay lines, estimates and selection (keeps mode and delays)
+     */
+    void reset();
+
+private:
+    struct Source {
+        std::unique_ptr<DelayBuffer> delay;
+        std::unique_ptr<AudioSync> sync;
+        std::vector<float> aligned;
+        std::atomic<bool> present{false};
+        std::atomic<float> snrDb{0.0f};
+        std::atomic<bool> syncStarted{false};
+
+        // Estimator state (audio thread)
+        bool live = false;        // Delivering audio, candidate for selection
+        double framePower = 0.0;
+        float signalPower = 0.0f;
+        float noisePower = 0.0f;
+    };
+
+    void finishSnrFrame();
+    void updateSelection();
+
+    int m_sampleRate;
+    int m_maxBlockFrames = 0;
+    std::array<Source, MAX_SOURCES> m_sources;
+    std::atomic<Mode> m_mode{Mode::BestOf};
+    std::atomic<int> m_selected{0};
+
+    // SNR framing (audio thread)
+    int m_snrFrameSize;
+    int m_snrFrameFill = 0;
+    float m_signalCoeff;
+    float m_noiseRise;
+
+    // Selection hold and switch crossfade (audio thread)
+    int m_holdFrames;
+    int m_framesSinceSwitch = 0;
+    int m_fadeFrom = 0;
+    int m_fadeLength;
+    int m_fadeProgress = 0;
+};
+
+#endif // DIVERSITYCOMBINER_H
@@ -1,4 +1,5 @@
 #include "audio/MixerCore.h"
+#include <cassert>
 #include <cmath>
 #include <algorithm>
 
@@ -8,14 +9,54 @@
 
 MixerCore::MixerCore(int sampleRate, int bufferSize)
     : m_sampleRate(sampleRate)
-    , m_bufferSize(bufferSize)
+    , m_bufferSize(0)
+{
+    createRateDependents();
+    setMaxBlockFrames(bufferSize);
+}
+
+void MixerCore::createRateDependents()
 {
     // Create delay buffer (max 2000ms at sample rate for distant KiwiSDR sites)
-    int maxDelaySamples = static_cast<int>(2000.0f * sampleRate / 1000.0f);
-    m_delayBuffer = std::make_unique<DelayBuffer>(maxDelaySamples, sampleRate);
+    int maxDelaySamples = static_cast<int>(
+        static_cast<float>(DelayBuffer::MAX_DELAY_MS) * m_sampleRate / 1000.0f);
+    m_delayBuffer = std::make_unique<DelayBuffer>(maxDelaySamples, m_sampleRate);
 
     // Create audio sync
-    m_audioSync = std::make_unique<AudioSync>();
+    m_audioSync = std::make_unique<AudioSync>(m_sampleRate);
+
+    // Create channel 2 combiner
+    m_diversity = std::make_unique<DiversityCombiner>(m_sampleRate);
+    m_diversity->setMaxBlockFrames(m_bufferSize);
+
+    // Create probe sync
+    m_probeSync = std::make_unique<AudioSync>(m_sampleRate);
+
+    m_fadeInDuration = static_cast<int>(FADE_IN_MS * m_sampleRate / 1000.0f);
+    m_fadeInSamples = 0;
+}
+
+void MixerCore::setSampleRate(int sampleRate)
+{
+    if (sampleRate <= 0 || sampleRate == m_sampleRate) {
+        return;
+    }
+
+    float targetDelayMs = m_delayBuffer ? m_delayBuffer->getTargetDelayMs() : 0.0f;
+    DiversityCombiner::Mode diversityMode = m_diversity->mode();
+    float sourceDelayMs[DiversityCombiner::MAX_SOURCES];
+    for (int s = 0; s < DiversityCombiner::MAX_SOURCES; s++) {
+        sourceDelayMs[s] = m_diversity->sourceDelayMs(s);
+    }
+
+    m_sampleRate = sampleRate;
+    createRateDependents();
+
+    m_delayBuffer->setDelayMs(targetDelayMs);
+    m_diversity->setMode(diversityMode);
+    for (int s = 0; s < DiversityCombiner::MAX_SOURCES; s++) {
+        m_diversity->setSourceDelayMs(s, sourceDelayMs[s]);
+    }
 }
 
 // Channel 1 controls
@@ -151,23 +192,94 @@ float MixerCore::softClip(float sample) const
     return sign * (SOFT_CLIP_THRESHOLD + (1.0f - SOFT_CLIP_THRESHOLD) * std::tanh(excess));
 }
 
-void MixerCore::updateLevels(float left, float right,
-                             std::atomic<float>& levelLeft,
-                             std::atomic<float>& levelRight)
+void MixerCore::setMaxBlockFrames(int maxFrames)
+{
+    if (maxFrames <= m_bufferSize) {
+        return;
+    }
+
+    m_bufferSize = maxFrames;
+    m_ch1Mono.assign(maxFrames, 0.0f);
+    m_ch2Mono.assign(maxFrames, 0.0f);
+    m_ch1Delayed.assign(maxFrames, 0.0f);
+    m_ch2Combined.assign(maxFrames, 0.0f);
+    for (std::vector<float>& mono : m_diversityMono) {
+        mono.assign(maxFrames, 0.0f);
+    }
+    m_probeMono.assign(maxFrames, 0.0f);
+    m_diversity->setMaxBlockFrames(maxFrames);
+}
+
+void MixerCore::downmix(RingBuffer& ring, float* mono, int frameCount)
+{
+    // Read the ring in place (up to two contiguous spans), then release it
+    RingBuffer::ReadRegion region = ring.peek(frameCount);
+    const int channels = ring.channels();
+
+    auto downmixSpan = [&](const float* src, int frames, float* dst) {
+        if (channels == 2) {
+            for (int i = 0; i < frames; i++) {
+                dst[i] = (src[i * 2] + src[i * 2 + 1]) * 0.5f;
+            }
+        } else {
+            for (int i = 0; i < frames; i++) {
+                dst[i] = src[i * channels];
+            }
+        }
+    };
+
+    downmixSpan(region.first, region.firstFrames, mono);
+    downmixSpan(region.second, region.secondFrames, mono + region.firstFrames);
+
+    int got = region.frames();
+    ring.consume(got);
+
+    // Underrun: pad with silence
+    if (got < frameCount) {
+        std::fill(mono + got, mono + frameCount, 0.0f);
+    }
+}
+
+void MixerCore::process(RingBuffer& radioIn, RingBuffer& websdrIn,
+                        float* output, int frameCount,
+                        RingBuffer* const* diversityIn,
+                        RingBuffer* probeIn)
 {
-    float absLeft = std::abs(left);
-    float absRight = std::abs(right);
+    // A block larger than setMaxBlockFrames() allowed for is a bug; release
+    // builds mix it in pieces rather than allocate on the audio thread
+    assert(frameCount <= m_bufferSize);
+    while (frameCount > m_bufferSize) {
+        process(radioIn, websdrIn, output, m_bufferSize, diversityIn, probeIn);
+        output += static_cast<size_t>(m_bufferSize) * 2;
+        frameCount -= m_bufferSize;
+    }
+
+    downmix(radioIn, m_ch1Mono.data(), frameCount);
+    downmix(websdrIn, m_ch2Mono.data(), frameCount);
+
+    m_ch2Sources[0] = m_ch2Mono.data();
+    for (int s = 1; s < DiversityCombiner::MAX_SOURCES; s++) {
+        RingBuffer* ring = diversityIn ? diversityIn[s - 1] : nullptr;
+        if (ring) {
+            downmix(*ring, m_diversityMono[s - 1].data(), frameCount);
+            m_ch2Sources[s] = m_diversityMono[s - 1].data();
+        } else {
+            m_ch2Sources[s] = nullptr;
+        }
+    }
 
-    // Peak hold with decay
-    float currentLeft = levelLeft.load();
-    float currentRight = levelRight.load();
+    // A probed SDR is only compared against the undelayed radio
+    if (probeIn) {
+        downmix(*probeIn, m_probeMono.data(), frameCount);
+        if (m_probeSync->isCapturing()) {
+            m_probeSync->addSamples(m_ch1Mono.data(), m_probeMono.data(), frameCount);
+        }
+    }
 
-    levelLeft.store(std::max(absLeft, currentLeft * PEAK_DECAY));
-    levelRight.store(std::max(absRight, currentRight * PEAK_DECAY));
+    mixMono(output, frameCount);
 }
 
-void MixerCore::process(const int16_t* radioIn, const int16_t* websdrIn,
-                        int16_t* output, int frameCount)
+void MixerCore::mixMono(float* output, int frameCount)
 {
     // Get control values
     float ch1Vol = m_ch1Volume.load();
@@ -181,36 +293,27 @@ void MixerCore::process(const int16_t* radioIn, const int16_t* websdrIn,
     float masterVol = m_masterVolume.load();
     bool masterMuted = m_masterMuted.load();
 
-    // Temporary buffers for mono processing
-    std::vector<float> ch1Mono(frameCount);
-    std::vector<float> ch2Mono(frameCount);
-    std::vector<float> ch1Delayed(frameCount);
+    const float* ch1Mono = m_ch1Mono.data();
+    const float* ch2Mono = m_ch2Combined.data();
+    float* ch1Delayed = m_ch1Delayed.data();
 
     // Peak tracking for this buffer
     float ch1PeakLeft = 0.0f, ch1PeakRight = 0.0f;
     float ch2PeakLeft = 0.0f, ch2PeakRight = 0.0f;
     float masterPeakLeft = 0.0f, masterPeakRight = 0.0f;
 
-    // Convert stereo to mono and normalize
-    for (int i = 0; i < frameCount; i++) {
-        // Radio (channel 1)
-        float radioL = radioIn[i * 2] / 32768.0f;
-        float radioR = radioIn[i * 2 + 1] / 32768.0f;
-        ch1Mono[i] = (radioL + radioR) * 0.5f;
-
-        // WebSDR (channel 2)
-        float websdrL = websdrIn[i * 2] / 32768.0f;
-        float websdrR = websdrIn[i * 2 + 1] / 32768.0f;
-        ch2Mono[i] = (websdrL + websdrR) * 0.5f;
-    }
-
     // Feed samples to AudioSync if capturing
+    // (undelayed radio against each receiver before alignment)
     if (m_audioSync && m_audioSync->isCapturing()) {
-        m_audioSync->addSamples(ch1Mono.data(), ch2Mono.data(), frameCount);
+        m_audioSync->addSamples(ch1Mono, m_ch2Mono.data(), frameCount);
     }
+    m_diversity->addSyncSamples(ch1Mono, m_ch2Sources, frameCount);
+
+    // Line the SDR receivers up and combine them into channel 2
+    m_diversity->process(m_ch2Sources, m_ch2Combined.data(), frameCount);
 
     // Apply delay to channel 1
-    m_delayBuffer->process(ch1Mono.data(), ch1Delayed.data(), frameCount);
+    m_delayBuffer->process(ch1Mono, ch1Delayed, frameCount);
 
     // Process each sample
     for (int i = 0; i < frameCount; i++) {
@@ -269,8 +372,8 @@ void MixerCore::process(const int16_t* radioIn, const int16_t* websdrIn,
         mixRight = softClip(mixRight);
 
         // Fade-in for smooth startup
-        if (m_fadeInSamples < FADE_IN_DURATION) {
-            float fadeProgress = static_cast<float>(m_fadeInSamples) / FADE_IN_DURATION;
+        if (m_fadeInSamples < m_fadeInDuration) {
+            float fadeProgress = static_cast<float>(m_fadeInSamples) / m_fadeInDuration;
             float fadeGain = 0.5f * (1.0f - std::cos(fadeProgress * static_cast<float>(M_PI)));
             mixLeft *= fadeGain;
             mixRight *= fadeGain;
@@ -281,21 +384,22 @@ void MixerCore::process(const int16_t* radioIn, const int16_t* websdrIn,
         masterPeakLeft = std::max(masterPeakLeft, std::abs(mixLeft));
         masterPeakRight = std::max(masterPeakRight, std::abs(mixRight));
 
-        // Convert to int16 and clip
-        mixLeft = std::clamp(mixLeft, -1.0f, 1.0f);
-        mixRight = std::clamp(mixRight, -1.0f, 1.0f);
-
-        output[i * 2] = static_cast<int16_t>(mixLeft * 32767.0f);
-        output[i * 2 + 1] = static_cast<int16_t>(mixRight * 32767.0f);
+        // Output stays float; quantisation (if any) happens at the device/file edge
+        output[i * 2] = mixLeft;
+        output[i * 2 + 1] = mixRight;
     }
 
     // Update level meters with peak hold
     // Use a threshold to ensure levels reach zero when there's no signal
     constexpr float SILENCE_THRESHOLD = 0.0001f;  // Below this, treat as silence
 
+    // Decay by elapsed time rather than per call, so meter ballistics do not
+    // depend on the engine rate or the device period
+    float peakDecay = std::exp(-static_cast<float>(frameCount) / (PEAK_DECAY_SECONDS * m_sampleRate));
+
     auto updateLevel = [&](float peak, std::atomic<float>& level) {
         float current = level.load();
-        float decayed = current * PEAK_DECAY;
+        float decayed = current * peakDecay;
         if (decayed < SILENCE_THRESHOLD) decayed = 0.0f;
         level.store(std::max(peak, decayed));
     };
@@ -330,6 +434,8 @@ void MixerCore::getRawLevels(float& ch1, float& ch2) const
 void MixerCore::reset()
 {
     m_delayBuffer->reset();
+    m_diversity->reset();
+    m_probeSync->cancel();
 
     m_ch1LevelLeft.store(0.0f);
     m_ch1LevelRight.store(0.0f);
@@ -351,6 +457,7 @@ void MixerCore::startSyncCapture(AudioSync::SignalMode mode)
     if (m_audioSync) {
         m_audioSync->startCapture(mode);
     }
+    m_diversity->startSyncCapture(mode);
 }
 
 void MixerCore::cancelSyncCapture()
@@ -358,11 +465,12 @@ void MixerCore::cancelSyncCapture()
     if (m_audioSync) {
         m_audioSync->cancel();
     }
+    m_diversity->cancelSyncCapture();
 }
 
 bool MixerCore::isSyncCapturing() const
 {
-    return m_audioSync && m_audioSync->isCapturing();
+    return (m_audioSync && m_audioSync->isCapturing()) || m_diversity->isSyncCapturing();
 }
 
 float MixerCore::getSyncProgress() const
@@ -375,7 +483,8 @@ float MixerCore::getSyncProgress() const
 
 bool MixerCore::hasSyncResult() const
 {
-    return m_audioSync && m_audioSync->hasResult();
+    // Wait for the extra receivers too, so all delays are set together
+    return m_audioSync && m_audioSync->hasResult() && !m_diversity->isSyncPending();
 }
 
 AudioSync::SyncResult MixerCore::getSyncResult()
@@ -385,3 +494,28 @@ AudioSync::SyncResult MixerCore::getSyncResult()
     }
     return AudioSync::SyncResult();
 }
+
+void MixerCore::startProbeSync(AudioSync::SignalMode mode)
+{
+    m_probeSync->startCapture(mode);
+}
+
+void MixerCore::cancelProbeSync()
+{
+    m_probeSync->cancel();
+}
+
+bool MixerCore::isProbeSyncCapturing() const
+{
+    return m_probeSync->isCapturing();
+}
+
+bool MixerCore::hasProbeSyncResult() const
+{
+    return m_probeSync->hasResult();
+}
+
+AudioSync::SyncResult MixerCore::getProbeSyncResult()
+{
+    return m_probeSync->getResult();
+}
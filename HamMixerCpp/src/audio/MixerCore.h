@@ -5,9 +5,12 @@
 #include <mutex>
 #include <memory>
 #include <cstdint>
+#include <vector>
 
 #include "audio/DelayBuffer.h"
+#include "audio/RingBuffer.h"
 #include "audio/AudioSync.h"
+#include "audio/DiversityCombiner.h"
 
 /**
  * @brief Core audio DSP processing engine
@@ -15,6 +18,7 @@
  * Handles mixing of two input channels with:
  * - Independent volume and pan per channel
  * - Delay line on channel 1 (radio)
+ * - Channel 2 fed by up to DiversityCombiner::MAX_SOURCES SDR receivers
  * - Master volume control
  * - Soft clipping to prevent distortion
  * - Level metering for all channels
@@ -28,11 +32,33 @@ public:
     /**
      * @brief Construct MixerCore
      * @param sampleRate Audio sample rate
-     * @param bufferSize Processing buffer size
+     * @param bufferSize Largest block process() is called with (see setMaxBlockFrames())
      */
     MixerCore(int sampleRate = 48000, int bufferSize = 1024);
     ~MixerCore() = default;
 
+    /**
+     * @brief Change the engine sample rate (call while streams are stopped)
+     *
+     * Rebuilds the delay line and sync analyser for the new rate while
+     * keeping all channel, master and delay settings.
+     * @param sampleRate Engine sample rate in Hz
+     */
+    void setSampleRate(int sampleRate);
+
+    /**
+     * @brief Get the engine sample rate
+     */
+    int sampleRate() const { return m_sampleRate; }
+
+    /**
+     * @brief Size the working buffers for blocks of up to maxFrames
+     *
+     * Call while streams are stopped, with the largest block the audio
+     * callback can ask for; process() itself never allocates.
+     */
+    void setMaxBlockFrames(int maxFrames);
+
     // Non-copyable
     MixerCore(const MixerCore&) = delete;
     MixerCore& operator=(const MixerCore&) = delete;
@@ -65,14 +91,23 @@ public:
     bool isMasterMuted() const;
 
     /**
-     * @brief Process and mix audio
-     * @param radioIn Radio input samples (interleaved stereo int16)
-     * @param websdrIn WebSDR input samples (interleaved stereo int16)
-     * @param output Output buffer (interleaved stereo int16)
+     * @brief Pull frameCount frames from the input rings and mix them into output
+     *
+     * Reads the rings in place via peek()/consume() (no intermediate copies);
+     * missing input is treated as silence. output is normally the device
+     * buffer itself, and recorder/meter taps read from the same memory.
+     * @param radioIn Radio ring (engine rate)
+     * @param websdrIn WebSDR ring (engine rate)
+     * @param output Output buffer (interleaved stereo float, soft-clipped to +/-1.0)
      * @param frameCount Number of frames
+     * @param diversityIn Rings of the extra SDR receivers, DiversityCombiner::MAX_SOURCES - 1
+     *                    entries (nullptr = not connected), or nullptr for none
+     * @param probeIn Ring of an SDR being probed (only measured, never mixed), or nullptr
      */
-    void process(const int16_t* radioIn, const int16_t* websdrIn,
-                 int16_t* output, int frameCount);
+    void process(RingBuffer& radioIn, RingBuffer& websdrIn,
+                 float* output, int frameCount,
+                 RingBuffer* const* diversityIn = nullptr,
+                 RingBuffer* probeIn = nullptr);
 
     /**
      * @brief Get current level meters
@@ -108,9 +143,24 @@ public:
     bool hasSyncResult() const;
     AudioSync::SyncResult getSyncResult();
 
+    /**
+     * @brief Channel 2 source combiner (per-receiver delay, SNR and best-of)
+     *
+     * Sync capture also measures every connected extra receiver; read those
+     * results with DiversityCombiner::takeSyncResult() once hasSyncResult().
+     */
+    DiversityCombiner* diversity() { return m_diversity.get(); }
+
+    // Probe sync: delay of an SDR being probed against the radio (probeIn of process())
+    void startProbeSync(AudioSync::SignalMode mode = AudioSync::VOICE);
+    void cancelProbeSync();
+    bool isProbeSyncCapturing() const;
+    bool hasProbeSyncResult() const;
+    AudioSync::SyncResult getProbeSyncResult();
+
 private:
     int m_sampleRate;
-    int m_bufferSize;
+    int m_bufferSize;  // Largest block the working buffers hold
 
     // Channel 1 controls
     std::atomic<float> m_ch1Volume{1.0f};
@@ -126,12 +176,27 @@ private:
     std::atomic<float> m_masterVolume{0.8f};
     std::atomic<bool> m_masterMuted{false};
 
+    // Mono working buffers (sized by setMaxBlockFrames(), reused across calls)
+    std::vector<float> m_ch1Mono;
+    std::vector<float> m_ch2Mono;
+    std::vector<float> m_ch1Delayed;
+    std::vector<float> m_ch2Combined;
+    std::vector<float> m_diversityMono[DiversityCombiner::MAX_SOURCES - 1];
+    const float* m_ch2Sources[DiversityCombiner::MAX_SOURCES] = {};  // Per-block combiner inputs
+    std::vector<float> m_probeMono;
+
     // Delay buffer for channel 1
     std::unique_ptr<DelayBuffer> m_delayBuffer;
 
     // Audio sync for auto-delay detection
     std::unique_ptr<AudioSync> m_audioSync;
 
+    // Channel 2 receivers (extra SDRs, delay per receiver, best-of)
+    std::unique_ptr<DiversityCombiner> m_diversity;
+
+    // Delay measurement of a probed SDR (SdrProber)
+    std::unique_ptr<AudioSync> m_probeSync;
+
     // Level meters (peak values in linear scale)
     std::atomic<float> m_ch1LevelLeft{0.0f};
     std::atomic<float> m_ch1LevelRight{0.0f};
@@ -140,18 +205,21 @@ private:
     std::atomic<float> m_masterLevelLeft{0.0f};
     std::atomic<float> m_masterLevelRight{0.0f};
 
-    // Peak decay
-    static constexpr float PEAK_DECAY = 0.95f;
+    // Peak decay time constant (matches the old 0.95-per-10ms-buffer feel)
+    static constexpr float PEAK_DECAY_SECONDS = 0.2f;
 
     // Fade-in state
     int m_fadeInSamples{0};
-    static constexpr int FADE_IN_DURATION = 2048;
+    int m_fadeInDuration{0};
+    static constexpr float FADE_IN_MS = 42.7f;  // 2048 samples at 48 kHz
 
     // Helper methods
     float linearToDb(float linear) const;
     void applyPan(float mono, float pan, float& left, float& right) const;
     float softClip(float sample) const;
-    void updateLevels(float left, float right, std::atomic<float>& levelLeft, std::atomic<float>& levelRight);
+    void createRateDependents();
+    void downmix(RingBuffer& ring, float* mono, int frameCount);
+    void mixMono(float* output, int frameCount);
 };
 
 #endif // MIXERCORE_H
@@ -25,6 +25,33 @@ void Recorder::setRecordingDirectory(const QString& directory)
     m_recordingDir = directory;
 }
 
+Recorder::Format Recorder::formatFromName(const QString& name)
+{
+    if (name == "pcm24") return Format::Pcm24;
+    if (name == "pcm16") return Format::Pcm16;
+    return Format::Float32;
+}
+
+QString Recorder::formatName(Format format)
+{
+    switch (format) {
+        case Format::Pcm24: return "pcm24";
+        case Format::Pcm16: return "pcm16";
+        case Format::Float32: break;
+    }
+    return "float32";
+}
+
+SampleFormat::Type Recorder::sampleType() const
+{
+    switch (m_activeFormat) {
+        case Format::Pcm24: return SampleFormat::Type::Int24;
+        case Format::Pcm16: return SampleFormat::Type::Int16;
+        case Format::Float32: break;
+    }
+    return SampleFormat::Type::Float32;
+}
+
 QString Recorder::generateFilename() const
 {
     QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
@@ -61,6 +88,9 @@ QString Recorder::startRecording()
         return QString();
     }
 
+    // Lock in the file format for this recording
+    m_activeFormat = m_format;
+
     // Reset counters
     m_sampleCount.store(0);
     m_dataSize = 0;
@@ -100,7 +130,7 @@ void Recorder::stopRecording()
              << "Duration:" << getElapsedTimeFormatted();
 }
 
-void Recorder::writeSamples(const int16_t* samples, int frameCount)
+void Recorder::writeSamples(const float* samples, int frameCount)
 {
     if (!m_recording.load() || !m_file) {
         return;
@@ -112,9 +142,17 @@ void Recorder::writeSamples(const int16_t* samples, int frameCount)
         return;
     }
 
-    // Write samples
-    qint64 bytesToWrite = frameCount * m_channels * sizeof(int16_t);
-    qint64 bytesWritten = m_file->write(reinterpret_cast<const char*>(samples), bytesToWrite);
+    // Convert to file format and write
+    SampleFormat::Type type = sampleType();
+    int sampleCount = frameCount * m_channels;
+    qint64 bytesToWrite = static_cast<qint64>(sampleCount) * SampleFormat::bytesPerSample(type);
+
+    if (static_cast<qint64>(m_convertBuffer.size()) < bytesToWrite) {
+        m_convertBuffer.resize(static_cast<size_t>(bytesToWrite));
+    }
+    SampleFormat::fromFloat(samples, m_convertBuffer.data(), type, sampleCount, m_dither);
+
+    qint64 bytesWritten = m_file->write(m_convertBuffer.data(), bytesToWrite);
 
     if (bytesWritten > 0) {
         m_dataSize += bytesWritten;
@@ -134,7 +172,7 @@ void Recorder::writeWavHeader()
         // fmt chunk
         char fmtId[4] = {'f', 'm', 't', ' '};
         uint32_t fmtSize = 16;
-        uint16_t audioFormat = 1;  // PCM
+        uint16_t audioFormat = 1;  // 1 = PCM, 3 = IEEE float
         uint16_t numChannels = 2;
         uint32_t sampleRate = 48000;
         uint32_t byteRate = 0;
@@ -149,7 +187,8 @@ void Recorder::writeWavHeader()
     WavHeader header;
     header.numChannels = static_cast<uint16_t>(m_channels);
     header.sampleRate = static_cast<uint32_t>(m_sampleRate);
-    header.bitsPerSample = BITS_PER_SAMPLE;
+    header.audioFormat = (m_activeFormat == Format::Float32) ? 3 : 1;
+    header.bitsPerSample = static_cast<uint16_t>(SampleFormat::bytesPerSample(sampleType()) * 8);
     header.blockAlign = header.numChannels * header.bitsPerSample / 8;
     header.byteRate = header.sampleRate * header.blockAlign;
 
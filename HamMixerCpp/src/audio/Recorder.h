@@ -8,18 +8,27 @@
 #include <atomic>
 #include <mutex>
 #include <cstdint>
+#include <vector>
+
+#include "audio/SampleFormat.h"
 
 /**
  * @brief WAV file recorder for mixed audio output
  *
- * Records stereo 16-bit PCM audio to WAV files with
- * auto-timestamped filenames.
+ * Records the float mixer output to stereo WAV files with
+ * auto-timestamped filenames. Files are 32-bit float by default;
+ * 24-bit and dithered 16-bit PCM are available for compatibility.
  */
 class Recorder {
 public:
     static constexpr int SAMPLE_RATE = 48000;
     static constexpr int CHANNELS = 2;
-    static constexpr int BITS_PER_SAMPLE = 16;
+
+    enum class Format {
+        Float32,    // 32-bit IEEE float (WAVE_FORMAT_IEEE_FLOAT)
+        Pcm24,      // 24-bit PCM
+        Pcm16       // 16-bit PCM with TPDF dither
+    };
 
     /**
      * @brief Construct recorder
@@ -50,6 +59,27 @@ public:
      */
     void setSampleRate(int sampleRate) { m_sampleRate = sampleRate; }
 
+    /**
+     * @brief Set file sample format (takes effect on next recording)
+     */
+    void setFormat(Format format) { m_format = format; }
+
+    /**
+     * @brief Get file sample format
+     */
+    Format format() const { return m_format; }
+
+    /**
+     * @brief Parse a format name from settings ("float32", "pcm24", "pcm16")
+     * @return Parsed format, Float32 if unknown
+     */
+    static Format formatFromName(const QString& name);
+
+    /**
+     * @brief Get the settings name for a format
+     */
+    static QString formatName(Format format);
+
     /**
      * @brief Start recording
      * @return Filename of the new recording, or empty on failure
@@ -63,10 +93,10 @@ public:
 
     /**
      * @brief Write audio samples to file
-     * @param samples Interleaved stereo samples (int16_t)
+     * @param samples Interleaved stereo float samples (-1.0 to 1.0)
      * @param frameCount Number of frames
      */
-    void writeSamples(const int16_t* samples, int frameCount);
+    void writeSamples(const float* samples, int frameCount);
 
     /**
      * @brief Check if recording is active
@@ -112,6 +142,8 @@ public:
 private:
     int m_sampleRate;
     int m_channels;
+    Format m_format = Format::Float32;
+    Format m_activeFormat = Format::Float32;  // Format of the file being written
     QString m_recordingDir;
     QString m_currentFilename;
 
@@ -121,6 +153,10 @@ private:
     qint64 m_dataSize = 0;
     std::mutex m_mutex;
 
+    // Conversion scratch for integer formats
+    std::vector<char> m_convertBuffer;
+    SampleFormat::TpdfDither m_dither;
+
     // Real-time elapsed timer for consistent display updates
     QElapsedTimer m_elapsedTimer;
 
@@ -128,6 +164,7 @@ private:
     void writeWavHeader();
     void finalizeWavHeader();
     QString generateFilename() const;
+    SampleFormat::Type sampleType() const;
 };
 
 #endif // RECORDER_H
@@ -0,0 +1,149 @@
+#include "audio/Resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+Resampler::Resampler(int inputRate, int outputRate, int channels)
+    : m_inputRate(std::max(1, inputRate))
+    , m_outputRate(std::max(1, outputRate))
+    , m_channels(std::max(1, channels))
+{
+    m_history.resize(static_cast<size_t>(m_channels) * TAPS * 2, 0.0f);
+
+    if (!isPassthrough()) {
+        buildFilter();
+    }
+}
+
+double Resampler::besselI0(double x)
+{
+    // Power series for the zeroth-order modified Bessel function
+    double sum = 1.0;
+    double term = 1.0;
+    double halfX = x / 2.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+void Resampler::buildFilter()
+{
+    // Cutoff in cycles per input sample; when downsampling the output
+    // Nyquist is the limit, otherwise the input Nyquist
+    double ratio = std::min(1.0, static_cast<double>(m_outputRate) / m_inputRate);
+    double cutoff = 0.5 * PASSBAND * ratio;
+    double halfLength = TAPS / 2.0;
+    double i0Beta = besselI0(KAISER_BETA);
+
+    m_filter.assign(static_cast<size_t>(PHASES + 1) * TAPS, 0.0f);
+
+    for (int p = 0; p <= PHASES; p++) {
+        double frac = static_cast<double>(p) / PHASES;
+        float* row = m_filter.data() + p * TAPS;
+        double sum = 0.0;
+
+        for (int j = 0; j < TAPS; j++) {
+            // Distance (in input samples) from tap j to the output instant
+            double t = halfLength - 1.0 - j + frac;
+
+            double x = 2.0 * cutoff * t;
+            double sinc = (std::abs(x) < 1e-9) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+
+            double r = t / halfLength;
+            double window = (std::abs(r) <= 1.0)
+                ? besselI0(KAISER_BETA * std::sqrt(1.0 - r * r)) / i0Beta
+                : 0.0;
+
+            double h = sinc * window;
+            row[j] = static_cast<float>(h);
+            sum += h;
+        }
+
+        // Unity DC gain for every phase
+        if (sum != 0.0) {
+            for (int j = 0; j < TAPS; j++) {
+                row[j] = static_cast<float>(row[j] / sum);
+            }
+        }
+    }
+}
+
+int Resampler::maxOutputFrames(int inputFrames) const
+{
+    if (isPassthrough()) {
+        return inputFrames;
+    }
+    int64_t frames = (static_cast<int64_t>(inputFrames) * m_outputRate + m_inputRate - 1) / m_inputRate;
+    return static_cast<int>(frames) + 1;
+}
+
+void Resampler::reset()
+{
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+    m_historyPos = 0;
+    m_phaseAcc = 0;
+}
+
+int Resampler::process(const float* input, int inputFrames, float* output, int maxOutputFrames)
+{
+    if (inputFrames <= 0 || input == nullptr || output == nullptr) {
+        return 0;
+    }
+
+    if (isPassthrough()) {
+        int frames = std::min(inputFrames, maxOutputFrames);
+        std::memcpy(output, input, static_cast<size_t>(frames) * m_channels * sizeof(float));
+        return frames;
+    }
+
+    const int historyStride = TAPS * 2;
+    float coef[TAPS];
+    int produced = 0;
+
+    for (int n = 0; n < inputFrames; n++) {
+        // Push one frame into the doubled history
+        for (int ch = 0; ch < m_channels; ch++) {
+            float sample = input[n * m_channels + ch];
+            float* hist = m_history.data() + ch * historyStride;
+            hist[m_historyPos] = sample;
+            hist[m_historyPos + TAPS] = sample;
+        }
+        m_historyPos = (m_historyPos + 1) % TAPS;
+
+        // Emit every output instant that falls inside this input interval
+        while (m_phaseAcc < m_outputRate) {
+            if (produced < maxOutputFrames) {
+                float phase = static_cast<float>(m_phaseAcc) * PHASES / m_outputRate;
+                int p = std::min(static_cast<int>(phase), PHASES - 1);
+                float blend = phase - p;
+
+                const float* row0 = m_filter.data() + p * TAPS;
+                const float* row1 = row0 + TAPS;
+                for (int j = 0; j < TAPS; j++) {
+                    coef[j] = row0[j] + blend * (row1[j] - row0[j]);
+                }
+
+                for (int ch = 0; ch < m_channels; ch++) {
+                    const float* window = m_history.data() + ch * historyStride + m_historyPos;
+                    float acc = 0.0f;
+                    for (int j = 0; j < TAPS; j++) {
+                        acc += window[j] * coef[j];
+                    }
+                    output[produced * m_channels + ch] = acc;
+                }
+                produced++;
+            }
+            m_phaseAcc += m_inputRate;
+        }
+        m_phaseAcc -= m_outputRate;
+    }
+
+    return produced;
+}
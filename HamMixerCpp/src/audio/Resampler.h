@@ -0,0 +1,91 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Streaming polyphase sample rate converter
+ *
+ * Converts interleaved float audio between two arbitrary integer rates
+ * (e.g. 44100 -> 48000) using a Kaiser-windowed sinc filter bank with
+ * linear interpolation between phases. The read position is tracked as
+ * an exact rational (inputRate / outputRate), so long-running streams
+ * never accumulate rounding drift.
+ *
+ * When input and output rates match the resampler is a plain copy.
+ */
+class Resampler {
+public:
+    static constexpr int TAPS = 32;         // Filter length per phase (input samples)
+    static constexpr int PHASES = 128;      // Fractional delay resolution
+    static constexpr float KAISER_BETA = 8.0f;
+    static constexpr float PASSBAND = 0.92f; // Cutoff as fraction of the lower Nyquist
+
+    /**
+     * @brief Construct a resampler
+     * @param inputRate Source sample rate in Hz
+     * @param outputRate Destination sample rate in Hz
+     * @param channels Number of interleaved channels
+     */
+    Resampler(int inputRate, int outputRate, int channels);
+    ~Resampler() = default;
+
+    // Non-copyable
+    Resampler(const Resampler&) = delete;
+    Resampler& operator=(const Resampler&) = delete;
+
+    /**
+     * @brief Convert a block of frames
+     * @param input Interleaved input frames
+     * @param inputFrames Number of input frames
+     * @param output Interleaved output buffer
+     * @param maxOutputFrames Capacity of output in frames
+     * @return Number of output frames produced
+     */
+    int process(const float* input, int inputFrames, float* output, int maxOutputFrames);
+
+    /**
+     * @brief Upper bound on output frames for a given input block
+     */
+    int maxOutputFrames(int inputFrames) const;
+
+    /**
+     * @brief Clear filter history and phase
+     */
+    void reset();
+
+    /**
+     * @brief True when rates match and samples are copied unchanged
+     */
+    bool isPassthrough() const { return m_inputRate == m_outputRate; }
+
+    int inputRate() const { return m_inputRate; }
+    int outputRate() const { return m_outputRate; }
+    int channels() const { return m_channels; }
+
+    /**
+     * @brief Group delay of the filter in input frames
+     */
+    static constexpr int latencyFrames() { return TAPS / 2; }
+
+private:
+    int m_inputRate;
+    int m_outputRate;
+    int m_channels;
+
+    // Filter bank: (PHASES + 1) rows of TAPS coefficients
+    std::vector<float> m_filter;
+
+    // Per-channel history, stored twice so any TAPS window is contiguous
+    std::vector<float> m_history;
+    int m_historyPos = 0;
+
+    // Fractional read position as numerator over m_outputRate
+    int64_t m_phaseAcc = 0;
+
+    void buildFilter();
+    static double besselI0(double x);
+};
+
+#endif // RESAMPLER_H
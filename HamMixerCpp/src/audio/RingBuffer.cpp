@@ -10,10 +10,10 @@ RingBuffer::RingBuffer(int capacityFrames, int channels)
     , m_available(0)
 {
     // Allocate buffer for all samples (frames * channels)
-    m_buffer.resize(capacityFrames * channels, 0);
+    m_buffer.resize(capacityFrames * channels, 0.0f);
 }
 
-int RingBuffer::write(const int16_t* data, int frameCount)
+int RingBuffer::write(const float* data, int frameCount)
 {
     if (frameCount <= 0 || data == nullptr) {
         return 0;
@@ -24,6 +24,11 @@ int RingBuffer::write(const int16_t* data, int frameCount)
     int free = m_capacityFrames - m_available.load();
     int toWrite = std::min(frameCount, free);
 
+    if (toWrite < frameCount) {
+        m_overruns.fetch_add(1, std::memory_order_relaxed);
+        m_overrunFrames.fetch_add(frameCount - std::max(toWrite, 0), std::memory_order_relaxed);
+    }
+
     if (toWrite <= 0) {
         return 0;
     }
@@ -40,7 +45,7 @@ int RingBuffer::write(const int16_t* data, int frameCount)
     std::memcpy(
         m_buffer.data() + writePos * samplesPerFrame,
         data,
-        firstChunk * samplesPerFrame * sizeof(int16_t)
+        firstChunk * samplesPerFrame * sizeof(float)
     );
 
     // Copy second chunk (wrapped around)
@@ -48,18 +53,19 @@ int RingBuffer::write(const int16_t* data, int frameCount)
         std::memcpy(
             m_buffer.data(),
             data + firstChunk * samplesPerFrame,
-            secondChunk * samplesPerFrame * sizeof(int16_t)
+            secondChunk * samplesPerFrame * sizeof(float)
         );
     }
 
     // Update write position
     m_writePos.store((writePos + toWrite) % m_capacityFrames);
-    m_available.fetch_add(toWrite);
+    int fill = m_available.fetch_add(toWrite) + toWrite;
+    Telemetry::updateMax(m_fillMax, fill);
 
     return toWrite;
 }
 
-int RingBuffer::read(int16_t* data, int frameCount)
+int RingBuffer::read(float* data, int frameCount)
 {
     if (frameCount <= 0 || data == nullptr) {
         return 0;
@@ -70,6 +76,7 @@ int RingBuffer::read(int16_t* data, int frameCount)
     int avail = m_available.load();
     int toRead = std::min(frameCount, avail);
     int samplesPerFrame = m_channels;
+    recordUnderrun(avail, frameCount);
 
     if (toRead > 0) {
         int readPos = m_readPos.load();
@@ -83,7 +90,7 @@ int RingBuffer::read(int16_t* data, int frameCount)
         std::memcpy(
             data,
             m_buffer.data() + readPos * samplesPerFrame,
-            firstChunk * samplesPerFrame * sizeof(int16_t)
+            firstChunk * samplesPerFrame * sizeof(float)
         );
 
         // Copy second chunk (wrapped around)
@@ -91,7 +98,7 @@ int RingBuffer::read(int16_t* data, int frameCount)
             std::memcpy(
                 data + firstChunk * samplesPerFrame,
                 m_buffer.data(),
-                secondChunk * samplesPerFrame * sizeof(int16_t)
+                secondChunk * samplesPerFrame * sizeof(float)
             );
         }
 
@@ -106,13 +113,55 @@ int RingBuffer::read(int16_t* data, int frameCount)
         std::memset(
             data + toRead * samplesPerFrame,
             0,
-            remaining * samplesPerFrame * sizeof(int16_t)
+            remaining * samplesPerFrame * sizeof(float)
         );
     }
 
     return toRead;
 }
 
+RingBuffer::ReadRegion RingBuffer::peek(int frameCount) const
+{
+    ReadRegion region;
+    if (frameCount <= 0) {
+        return region;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    int avail = m_available.load();
+    recordUnderrun(avail, frameCount);
+
+    int toRead = std::min(frameCount, avail);
+    if (toRead <= 0) {
+        return region;
+    }
+
+    int readPos = m_readPos.load();
+    int framesBeforeWrap = m_capacityFrames - readPos;
+
+    region.first = m_buffer.data() + readPos * m_channels;
+    region.firstFrames = std::min(toRead, framesBeforeWrap);
+    region.secondFrames = toRead - region.firstFrames;
+    if (region.secondFrames > 0) {
+        region.second = m_buffer.data();
+    }
+    return region;
+}
+
+void RingBuffer::consume(int frameCount)
+{
+    if (frameCount <= 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    int toConsume = std::min(frameCount, m_available.load());
+    m_readPos.store((m_readPos.load() + toConsume) % m_capacityFrames);
+    m_available.fetch_sub(toConsume);
+}
+
 int RingBuffer::available() const
 {
     return m_available.load();
@@ -134,5 +183,38 @@ void RingBuffer::clear()
     m_writePos.store(0);
     m_readPos.store(0);
     m_available.store(0);
-    std::fill(m_buffer.begin(), m_buffer.end(), 0);
+    std::fill(m_buffer.begin(), m_buffer.end(), 0.0f);
+}
+
+void RingBuffer::recordUnderrun(int avail, int requested) const
+{
+    Telemetry::updateMin(m_fillMin, avail);
+    if (avail < requested) {
+        m_underruns.fetch_add(1, std::memory_order_relaxed);
+        m_underrunFrames.fetch_add(requested - avail, std::memory_order_relaxed);
+    }
+}
+
+RingStats RingBuffer::stats() const
+{
+    RingStats stats;
+    stats.underruns = m_underruns.load(std::memory_order_relaxed);
+    stats.underrunFrames = m_underrunFrames.load(std::memory_order_relaxed);
+    stats.overruns = m_overruns.load(std::memory_order_relaxed);
+    stats.overrunFrames = m_overrunFrames.load(std::memory_order_relaxed);
+    int fillMin = m_fillMin.load(std::memory_order_relaxed);
+    stats.fillMin = (fillMin == INT_MAX) ? 0 : fillMin;
+    stats.fillMax = m_fillMax.load(std::memory_order_relaxed);
+    stats.capacity = m_capacityFrames;
+    return stats;
+}
+
+void RingBuffer::resetStats()
+{
+    m_underruns.store(0, std::memory_order_relaxed);
+    m_underrunFrames.store(0, std::memory_order_relaxed);
+    m_overruns.store(0, std::memory_order_relaxed);
+    m_overrunFrames.store(0, std::memory_order_relaxed);
+    m_fillMin.store(INT_MAX, std::memory_order_relaxed);
+    m_fillMax.store(0, std::memory_order_relaxed);
 }
@@ -5,6 +5,7 @@
 #include <atomic>
 #include <cstdint>
 #include <mutex>
+#include "audio/AudioTelemetry.h"
 
 /**
  * @brief Thread-safe circular buffer for audio streaming.
@@ -28,11 +29,11 @@ public:
 
     /**
      * @brief Write frames to the buffer
-     * @param data Pointer to interleaved audio data (int16_t)
+     * @param data Pointer to interleaved float audio data
      * @param frameCount Number of frames to write
      * @return Number of frames actually written
      */
-    int write(const int16_t* data, int frameCount);
+    int write(const float* data, int frameCount);
 
     /**
      * @brief Read frames from the buffer
@@ -40,7 +41,34 @@ public:
      * @param frameCount Number of frames to read
      * @return Number of frames actually read (pads with zeros if underrun)
      */
-    int read(int16_t* data, int frameCount);
+    int read(float* data, int frameCount);
+
+    /**
+     * @brief Readable region of the buffer, split in two at the wrap point
+     *
+     * Points straight into the ring storage. Valid until consume() or clear().
+     */
+    struct ReadRegion {
+        const float* first = nullptr;
+        int firstFrames = 0;
+        const float* second = nullptr;
+        int secondFrames = 0;
+
+        int frames() const { return firstFrames + secondFrames; }
+    };
+
+    /**
+     * @brief Look at up to frameCount readable frames without copying
+     * @param frameCount Maximum number of frames wanted
+     * @return Region covering min(frameCount, available()) frames
+     */
+    ReadRegion peek(int frameCount) const;
+
+    /**
+     * @brief Release frames previously obtained through peek()
+     * @param frameCount Number of frames to drop from the read side
+     */
+    void consume(int frameCount);
 
     /**
      * @brief Get number of frames available for reading
@@ -72,8 +100,18 @@ public:
      */
     int channels() const { return m_channels; }
 
+    /**
+     * @brief Snapshot underrun/overrun counters and fill extremes
+     */
+    RingStats stats() const;
+
+    /**
+     * @brief Clear health counters (buffer contents are untouched)
+     */
+    void resetStats();
+
 private:
-    std::vector<int16_t> m_buffer;
+    std::vector<float> m_buffer;
     int m_capacityFrames;
     int m_channels;
 
@@ -82,6 +120,16 @@ private:
     std::atomic<int> m_available{0};
 
     mutable std::mutex m_mutex;
+
+    // Health counters (see stats())
+    mutable std::atomic<uint64_t> m_underruns{0};
+    mutable std::atomic<uint64_t> m_underrunFrames{0};
+    std::atomic<uint64_t> m_overruns{0};
+    std::atomic<uint64_t> m_overrunFrames{0};
+    mutable std::atomic<int> m_fillMin{INT_MAX};
+    std::atomic<int> m_fillMax{0};
+
+    void recordUnderrun(int avail, int requested) const;
 };
 
 #endif // RINGBUFFER_H
@@ -0,0 +1,168 @@
+#ifndef SAMPLEFORMAT_H
+#define SAMPLEFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+/**
+ * @brief Sample format conversions for the audio edges
+ *
+ * The engine runs on normalized interleaved float32 (-1.0 .. +1.0).
+ * Integer formats only appear at device and file boundaries, where
+ * these helpers convert in and out of the float domain.
+ */
+namespace SampleFormat {
+
+enum class Type {
+    Float32,
+    Int16,
+    Int24,   // Packed 3-byte little-endian
+    Int32
+};
+
+/**
+ * @brief Bytes per sample for a format
+ */
+inline int bytesPerSample(Type type)
+{
+    switch (type) {
+        case Type::Int16: return 2;
+        case Type::Int24: return 3;
+        case Type::Float32:
+        case Type::Int32: return 4;
+    }
+    return 4;
+}
+
+/**
+ * @brief Triangular-PDF dither generator
+ *
+ * Sum of two independent uniform values, giving +/-1 LSB triangular noise
+ * that decorrelates requantisation error from the signal. Uses a small
+ * xorshift generator so it is safe to call from the audio thread.
+ */
+class TpdfDither {
+public:
+    explicit TpdfDither(uint32_t seed = 0x9E3779B9u) : m_state(seed ? seed : 1u) {}
+
+    /**
+     * @brief Next dither value in LSB units (-1.0 .. +1.0, triangular)
+     */
+    float next()
+    {
+        return uniform() + uniform() - 1.0f;
+    }
+
+private:
+    uint32_t m_state;
+
+    float uniform()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return static_cast<float>(m_state >> 8) * (1.0f / 16777216.0f);
+    }
+};
+
+/**
+ * @brief Convert raw device/file samples to float32
+ * @param src Source samples in the given format
+ * @param type Source format
+ * @param dst Destination float buffer
+ * @param sampleCount Number of samples (frames * channels)
+ */
+inline void toFloat(const void* src, Type type, float* dst, int sampleCount)
+{
+    switch (type) {
+        case Type::Float32:
+            std::memcpy(dst, src, sampleCount * sizeof(float));
+            break;
+        case Type::Int16: {
+            const int16_t* in = static_cast<const int16_t*>(src);
+            for (int i = 0; i < sampleCount; i++) {
+                dst[i] = in[i] * (1.0f / 32768.0f);
+            }
+            break;
+        }
+        case Type::Int24: {
+            const uint8_t* in = static_cast<const uint8_t*>(src);
+            for (int i = 0; i < sampleCount; i++) {
+                // Assemble unsigned (a signed << 24 overflows for negative
+                // samples), then sign-extend bit 23 arithmetically
+                uint32_t u = static_cast<uint32_t>(in[i * 3])
+                           | (static_cast<uint32_t>(in[i * 3 + 1]) << 8)
+                           | (static_cast<uint32_t>(in[i * 3 + 2]) << 16);
+                int32_t v = static_cast<int32_t>(u ^ 0x800000u) - 0x800000;
+                dst[i] = static_cast<float>(v) * (1.0f / 8388608.0f);
+            }
+            break;
+        }
+        case Type::Int32: {
+            const int32_t* in = static_cast<const int32_t*>(src);
+            for (int i = 0; i < sampleCount; i++) {
+                dst[i] = static_cast<float>(in[i] * (1.0 / 2147483648.0));
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Convert float32 samples to a device/file format
+ *
+ * Samples are clamped to full scale. Int16 output is TPDF-dithered and
+ * rounded; wider formats are rounded without dither since their noise
+ * floor is already below the analog chain.
+ *
+ * @param src Source float samples
+ * @param dst Destination buffer in the given format
+ * @param type Destination format
+ * @param sampleCount Number of samples (frames * channels)
+ * @param dither Dither generator (used for Int16 only)
+ */
+inline void fromFloat(const float* src, void* dst, Type type, int sampleCount, TpdfDither& dither)
+{
+    switch (type) {
+        case Type::Float32: {
+            float* out = static_cast<float*>(dst);
+            for (int i = 0; i < sampleCount; i++) {
+                out[i] = std::clamp(src[i], -1.0f, 1.0f);
+            }
+            break;
+        }
+        case Type::Int16: {
+            int16_t* out = static_cast<int16_t*>(dst);
+            for (int i = 0; i < sampleCount; i++) {
+                float v = src[i] * 32767.0f + dither.next();
+                v = std::clamp(v, -32768.0f, 32767.0f);
+                out[i] = static_cast<int16_t>(v < 0.0f ? v - 0.5f : v + 0.5f);
+            }
+            break;
+        }
+        case Type::Int24: {
+            uint8_t* out = static_cast<uint8_t*>(dst);
+            for (int i = 0; i < sampleCount; i++) {
+                float v = std::clamp(src[i], -1.0f, 1.0f) * 8388607.0f;
+                int32_t s = static_cast<int32_t>(v < 0.0f ? v - 0.5f : v + 0.5f);
+                out[i * 3] = static_cast<uint8_t>(s & 0xFF);
+                out[i * 3 + 1] = static_cast<uint8_t>((s >> 8) & 0xFF);
+                out[i * 3 + 2] = static_cast<uint8_t>((s >> 16) & 0xFF);
+            }
+            break;
+        }
+        case Type::Int32: {
+            int32_t* out = static_cast<int32_t*>(dst);
+            for (int i = 0; i < sampleCount; i++) {
+                double v = std::clamp(src[i], -1.0f, 1.0f) * 2147483647.0;
+                out[i] = static_cast<int32_t>(v < 0.0 ? v - 0.5 : v + 0.5);
+            }
+            break;
+        }
+    }
+}
+
+} // namespace SampleFormat
+
+#endif // SAMPLEFORMAT_H
@@ -3,6 +3,7 @@
 #include <comdef.h>
 #include <Audioclient.h>
 #include <avrt.h>
+#include <mmreg.h>
 
 #pragma comment(lib, "avrt.lib")
 
@@ -19,6 +20,15 @@ static const GUID IID_IMMDeviceEnumerator_Local = __uuidof(IMMDeviceEnumerator);
 static const GUID IID_IAudioClient_Local = __uuidof(IAudioClient);
 static const GUID IID_IAudioCaptureClient_Local = __uuidof(IAudioCaptureClient);
 static const GUID IID_IAudioRenderClient_Local = __uuidof(IAudioRenderClient);
+static const GUID IID_IAudioClient3_Local = __uuidof(IAudioClient3);
+
+// KSDATAFORMAT subtypes for WAVE_FORMAT_EXTENSIBLE (defined locally for MinGW)
+static const GUID SUBTYPE_IEEE_FLOAT_Local = {
+    0x00000003, 0x0000, 0x0010, { 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 }
+};
+static const GUID SUBTYPE_PCM_Local = {
+    0x00000001, 0x0000, 0x0010, { 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 }
+};
 
 WasapiDevice::WasapiDevice()
 {
@@ -148,13 +158,17 @@ QList<DeviceInfo> WasapiDevice::enumerateDevices(DeviceType type)
 }
 
 bool WasapiDevice::open(const QString& deviceId, DeviceType type,
-                        int sampleRate, int channels, int bufferMs)
+                        int sampleRate, int channels, int bufferMs, ShareMode mode)
 {
     close();
 
     m_deviceType = type;
     m_sampleRate = sampleRate;
     m_channels = channels;
+    m_shareMode = (type == DeviceType::Loopback) ? ShareMode::Shared : mode;
+    if (bufferMs <= 0) {
+        bufferMs = 10;  // Loopback downgraded from a low-latency mode
+    }
 
     // Create device enumerator
     IMMDeviceEnumerator* enumerator = nullptr;
@@ -188,21 +202,31 @@ bool WasapiDevice::open(const QString& deviceId, DeviceType type,
         return false;
     }
 
-    // Set up wave format
-    WAVEFORMATEX format = {};
-    format.wFormatTag = WAVE_FORMAT_PCM;
-    format.nChannels = static_cast<WORD>(channels);
-    format.nSamplesPerSec = static_cast<DWORD>(sampleRate);
-    format.wBitsPerSample = 16;
-    format.nBlockAlign = format.nChannels * format.wBitsPerSample / 8;
-    format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
-    format.cbSize = 0;
+    bool initialized = false;
+    switch (m_shareMode) {
+        case ShareMode::Exclusive:
+            initialized = initializeExclusiveStream();
+            break;
+        case ShareMode::LowLatencyShared:
+            initialized = initializeLowLatencyStream();
+            break;
+        case ShareMode::Shared:
+            initialized = initializeStream(bufferMs);
+            break;
+    }
 
-    if (!initializeStream(&format, bufferMs)) {
+    if (!initialized) {
         releaseResources();
         return false;
     }
 
+    m_audioClient->GetStreamLatency(&m_streamLatency);
+
+    // Scratch buffer for integer device formats (float streams are passed through)
+    if (m_sampleFormat != SampleFormat::Type::Float32) {
+        m_floatBuffer.assign(static_cast<size_t>(m_bufferFrames) * m_channels, 0.0f);
+    }
+
     // Create event for audio buffer notifications
     m_eventHandle = CreateEvent(nullptr, FALSE, FALSE, nullptr);
     if (!m_eventHandle) {
@@ -238,13 +262,42 @@ bool WasapiDevice::open(const QString& deviceId, DeviceType type,
     return true;
 }
 
-bool WasapiDevice::initializeStream(WAVEFORMATEX* format, int bufferMs)
+bool WasapiDevice::formatTypeFromWaveFormat(const WAVEFORMATEX* format, SampleFormat::Type& type)
 {
-    REFERENCE_TIME bufferDuration = static_cast<REFERENCE_TIME>(bufferMs) * 10000;
+    bool isFloat = false;
+    bool isPcm = false;
+
+    if (format->wFormatTag == WAVE_FORMAT_IEEE_FLOAT) {
+        isFloat = true;
+    } else if (format->wFormatTag == WAVE_FORMAT_PCM) {
+        isPcm = true;
+    } else if (format->wFormatTag == WAVE_FORMAT_EXTENSIBLE && format->cbSize >= 22) {
+        const WAVEFORMATEXTENSIBLE* ext = reinterpret_cast<const WAVEFORMATEXTENSIBLE*>(format);
+        isFloat = IsEqualGUID(ext->SubFormat, SUBTYPE_IEEE_FLOAT_Local);
+        isPcm = IsEqualGUID(ext->SubFormat, SUBTYPE_PCM_Local);
+    }
 
-    DWORD streamFlags = AUDCLNT_STREAMFLAGS_EVENTCALLBACK;
-    if (m_deviceType == DeviceType::Loopback) {
-        streamFlags |= AUDCLNT_STREAMFLAGS_LOOPBACK;
+    if (isFloat && format->wBitsPerSample == 32) {
+        type = SampleFormat::Type::Float32;
+        return true;
+    }
+    if (isPcm) {
+        switch (format->wBitsPerSample) {
+            case 16: type = SampleFormat::Type::Int16; return true;
+            case 24: type = SampleFormat::Type::Int24; return true;
+            case 32: type = SampleFormat::Type::Int32; return true;  // Includes 24-in-32 containers
+            default: break;
+        }
+    }
+    return false;
+}
+
+bool WasapiDevice::tryInitialize(const WAVEFORMATEX* format, DWORD streamFlags,
+                                 REFERENCE_TIME bufferDuration)
+{
+    SampleFormat::Type type;
+    if (!formatTypeFromWaveFormat(format, type)) {
+        return false;
     }
 
     HRESULT hr = m_audioClient->Initialize(
@@ -257,44 +310,277 @@ bool WasapiDevice::initializeStream(WAVEFORMATEX* format, int bufferMs)
     );
 
     if (FAILED(hr)) {
-        // Try with mix format
+        m_lastError = QString("Failed to initialize audio client: %1").arg(hr);
+        return false;
+    }
+
+    m_sampleRate = static_cast<int>(format->nSamplesPerSec);
+    m_channels = format->nChannels;
+    m_sampleFormat = type;
+    return true;
+}
+
+bool WasapiDevice::initializeStream(int bufferMs)
+{
+    m_lastError.clear();
+    REFERENCE_TIME bufferDuration = static_cast<REFERENCE_TIME>(bufferMs) * 10000;
+
+    DWORD streamFlags = AUDCLNT_STREAMFLAGS_EVENTCALLBACK;
+    if (m_deviceType == DeviceType::Loopback) {
+        streamFlags |= AUDCLNT_STREAMFLAGS_LOOPBACK;
+    }
+
+    // 1. Float32 at the requested rate and channel count
+    WAVEFORMATEXTENSIBLE floatFormat;
+    makeFormat(floatFormat, m_sampleRate, m_channels, SampleFormat::Type::Float32);
+
+    bool ok = tryInitialize(&floatFormat.Format, streamFlags, bufferDuration);
+
+    // 2. The engine mix format as-is (native rate/channels, normally float32)
+    if (!ok) {
         WAVEFORMATEX* mixFormat = nullptr;
         if (SUCCEEDED(m_audioClient->GetMixFormat(&mixFormat))) {
-            // Update our format to match mix format but keep PCM 16-bit
-            format->nSamplesPerSec = mixFormat->nSamplesPerSec;
-            format->nChannels = mixFormat->nChannels;
-            format->nBlockAlign = format->nChannels * format->wBitsPerSample / 8;
-            format->nAvgBytesPerSec = format->nSamplesPerSec * format->nBlockAlign;
-
-            m_sampleRate = format->nSamplesPerSec;
-            m_channels = format->nChannels;
+            ok = tryInitialize(mixFormat, streamFlags, bufferDuration);
+
+            // 3. Last resort: 16-bit PCM at the mix rate/channels
+            if (!ok) {
+                WAVEFORMATEX pcmFormat = {};
+                pcmFormat.wFormatTag = WAVE_FORMAT_PCM;
+                pcmFormat.nChannels = mixFormat->nChannels;
+                pcmFormat.nSamplesPerSec = mixFormat->nSamplesPerSec;
+                pcmFormat.wBitsPerSample = 16;
+                pcmFormat.nBlockAlign = pcmFormat.nChannels * pcmFormat.wBitsPerSample / 8;
+                pcmFormat.nAvgBytesPerSec = pcmFormat.nSamplesPerSec * pcmFormat.nBlockAlign;
+                pcmFormat.cbSize = 0;
+                ok = tryInitialize(&pcmFormat, streamFlags, bufferDuration);
+            }
 
             CoTaskMemFree(mixFormat);
+        }
+    }
+
+    if (!ok) {
+        if (m_lastError.isEmpty()) {
+            m_lastError = "Failed to initialize audio client: no supported format";
+        }
+        return false;
+    }
+
+    // Get actual buffer size
+    UINT32 bufferFrames = 0;
+    m_audioClient->GetBufferSize(&bufferFrames);
+    m_bufferFrames = static_cast<int>(bufferFrames);
+
+    // Engine period (events arrive at this rate regardless of buffer size)
+    REFERENCE_TIME defaultPeriod = 0;
+    REFERENCE_TIME minimumPeriod = 0;
+    m_audioClient->GetDevicePeriod(&defaultPeriod, &minimumPeriod);
+    m_periodFrames = static_cast<int>(defaultPeriod * m_sampleRate / 10000000);
+
+    return true;
+}
+
+void WasapiDevice::makeFormat(WAVEFORMATEXTENSIBLE& format, int sampleRate, int channels,
+                              SampleFormat::Type type)
+{
+    int containerBits = SampleFormat::bytesPerSample(type) * 8;
+
+    format = {};
+    format.Format.wFormatTag = WAVE_FORMAT_EXTENSIBLE;
+    format.Format.nChannels = static_cast<WORD>(channels);
+    format.Format.nSamplesPerSec = static_cast<DWORD>(sampleRate);
+    format.Format.wBitsPerSample = static_cast<WORD>(containerBits);
+    format.Format.nBlockAlign = format.Format.nChannels * format.Format.wBitsPerSample / 8;
+    format.Format.nAvgBytesPerSec = format.Format.nSamplesPerSec * format.Format.nBlockAlign;
+    format.Format.cbSize = sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX);
+    format.Samples.wValidBitsPerSample = static_cast<WORD>(containerBits);
+    format.dwChannelMask = (channels == 1) ? SPEAKER_FRONT_CENTER
+                                           : (SPEAKER_FRONT_LEFT | SPEAKER_FRONT_RIGHT);
+    format.SubFormat = (type == SampleFormat::Type::Float32) ? SUBTYPE_IEEE_FLOAT_Local
+                                                             : SUBTYPE_PCM_Local;
+}
+
+bool WasapiDevice::reactivateClient()
+{
+    if (m_audioClient) {
+        m_audioClient->Release();
+        m_audioClient = nullptr;
+    }
 
-            hr = m_audioClient->Initialize(
-                AUDCLNT_SHAREMODE_SHARED,
-                streamFlags,
-                bufferDuration,
-                0,
-                format,
-                nullptr
-            );
+    HRESULT hr = m_device->Activate(IID_IAudioClient_Local, CLSCTX_ALL, nullptr, (void**)&m_audioClient);
+    if (FAILED(hr) || !m_audioClient) {
+        m_lastError = QString("Failed to re-activate audio client: %1").arg(hr);
+        m_audioClient = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool WasapiDevice::initializeLowLatencyStream()
+{
+    m_lastError.clear();
+
+    IAudioClient3* client3 = nullptr;
+    HRESULT hr = m_audioClient->QueryInterface(IID_IAudioClient3_Local, (void**)&client3);
+    if (FAILED(hr) || !client3) {
+        m_lastError = "IAudioClient3 not available (requires Windows 10)";
+        return false;
+    }
+
+    // Low-latency shared streams must use the engine mix format
+    WAVEFORMATEX* mixFormat = nullptr;
+    hr = client3->GetMixFormat(&mixFormat);
+    SampleFormat::Type type;
+    if (FAILED(hr) || !mixFormat || !formatTypeFromWaveFormat(mixFormat, type)) {
+        m_lastError = "Unsupported engine mix format for low-latency stream";
+        if (mixFormat) CoTaskMemFree(mixFormat);
+        client3->Release();
+        return false;
+    }
+
+    UINT32 defaultPeriod = 0;
+    UINT32 fundamentalPeriod = 0;
+    UINT32 minPeriod = 0;
+    UINT32 maxPeriod = 0;
+    hr = client3->GetSharedModeEnginePeriod(mixFormat, &defaultPeriod, &fundamentalPeriod,
+                                            &minPeriod, &maxPeriod);
+
+    // Walk up from the minimum period in fundamental steps until the driver accepts one
+    bool ok = false;
+    if (SUCCEEDED(hr) && fundamentalPeriod > 0) {
+        for (UINT32 period = minPeriod; period <= defaultPeriod; period += fundamentalPeriod) {
+            hr = client3->InitializeSharedAudioStream(AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+                                                      period, mixFormat, nullptr);
+            if (SUCCEEDED(hr)) {
+                m_periodFrames = static_cast<int>(period);
+                ok = true;
+                break;
+            }
+        }
+    }
+
+    if (ok) {
+        m_sampleRate = static_cast<int>(mixFormat->nSamplesPerSec);
+        m_channels = mixFormat->nChannels;
+        m_sampleFormat = type;
+
+        UINT32 bufferFrames = 0;
+        m_audioClient->GetBufferSize(&bufferFrames);
+        m_bufferFrames = static_cast<int>(bufferFrames);
+
+        qDebug() << "WasapiDevice: Low-latency shared stream, period" << m_periodFrames
+                 << "frames (min" << minPeriod << ", default" << defaultPeriod << ")";
+    } else {
+        m_lastError = QString("Failed to initialize low-latency stream: %1").arg(hr);
+    }
+
+    CoTaskMemFree(mixFormat);
+    client3->Release();
+    return ok;
+}
+
+bool WasapiDevice::initializeExclusiveStream()
+{
+    m_lastError.clear();
+
+    // Pick the best sample format the device accepts exclusively
+    const SampleFormat::Type candidates[] = {
+        SampleFormat::Type::Float32,
+        SampleFormat::Type::Int32,
+        SampleFormat::Type::Int24,
+        SampleFormat::Type::Int16
+    };
+
+    WAVEFORMATEXTENSIBLE format;
+    bool found = false;
+    for (SampleFormat::Type type : candidates) {
+        makeFormat(format, m_sampleRate, m_channels, type);
+        if (m_audioClient->IsFormatSupported(AUDCLNT_SHAREMODE_EXCLUSIVE, &format.Format, nullptr) == S_OK) {
+            m_sampleFormat = type;
+            found = true;
+            break;
+        }
+    }
+
+    if (!found) {
+        m_lastError = QString("Device does not support %1 Hz / %2 ch in exclusive mode")
+                          .arg(m_sampleRate).arg(m_channels);
+        return false;
+    }
+
+    REFERENCE_TIME defaultPeriod = 0;
+    REFERENCE_TIME minPeriod = 0;
+    m_audioClient->GetDevicePeriod(&defaultPeriod, &minPeriod);
+    if (minPeriod <= 0) {
+        minPeriod = defaultPeriod > 0 ? defaultPeriod : 30000;
+    }
+
+    // Walk up from the minimum device period until the driver accepts one
+    HRESULT hr = E_FAIL;
+    for (REFERENCE_TIME period = minPeriod; period <= defaultPeriod * 2; period += minPeriod) {
+        hr = m_audioClient->Initialize(AUDCLNT_SHAREMODE_EXCLUSIVE, AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+                                       period, period, &format.Format, nullptr);
+
+        if (hr == AUDCLNT_E_BUFFER_SIZE_NOT_ALIGNED) {
+            // Align the period to the buffer size the driver wants, then retry once
+            UINT32 alignedFrames = 0;
+            m_audioClient->GetBufferSize(&alignedFrames);
+            REFERENCE_TIME alignedPeriod = static_cast<REFERENCE_TIME>(
+                10000000.0 * alignedFrames / m_sampleRate + 0.5);
+
+            if (!reactivateClient()) {
+                return false;
+            }
+            hr = m_audioClient->Initialize(AUDCLNT_SHAREMODE_EXCLUSIVE, AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+                                           alignedPeriod, alignedPeriod, &format.Format, nullptr);
+        }
+
+        if (SUCCEEDED(hr)) {
+            break;
+        }
+
+        // A failed Initialize leaves the client unusable for another attempt
+        if (!reactivateClient()) {
+            return false;
         }
     }
 
     if (FAILED(hr)) {
-        m_lastError = QString("Failed to initialize audio client: %1").arg(hr);
+        m_lastError = QString("Failed to initialize exclusive stream: %1").arg(hr);
         return false;
     }
 
-    // Get actual buffer size
     UINT32 bufferFrames = 0;
     m_audioClient->GetBufferSize(&bufferFrames);
     m_bufferFrames = static_cast<int>(bufferFrames);
+    m_periodFrames = m_bufferFrames;  // Exclusive event mode: one period per buffer
 
+    qDebug() << "WasapiDevice: Exclusive stream, period" << m_periodFrames << "frames,"
+             << SampleFormat::bytesPerSample(m_sampleFormat) * 8 << "bit";
     return true;
 }
 
+float WasapiDevice::latencyMs() const
+{
+    if (m_sampleRate <= 0) {
+        return 0.0f;
+    }
+
+    float streamMs = static_cast<float>(m_streamLatency) / 10000.0f;
+    int bufferedFrames = (m_deviceType == DeviceType::Render) ? m_bufferFrames : m_periodFrames;
+    return streamMs + bufferedFrames * 1000.0f / m_sampleRate;
+}
+
+QString WasapiDevice::shareModeName(ShareMode mode)
+{
+    switch (mode) {
+        case ShareMode::LowLatencyShared: return "Low-latency shared";
+        case ShareMode::Exclusive: return "Exclusive";
+        case ShareMode::Shared: break;
+    }
+    return "Shared";
+}
+
 bool WasapiDevice::start(AudioCallback callback)
 {
     if (!m_audioClient) {
@@ -309,6 +595,11 @@ bool WasapiDevice::start(AudioCallback callback)
     m_callback = callback;
     m_running.store(true);
 
+    if (m_telemetry && m_sampleRate > 0) {
+        m_telemetry->setExpectedPeriodUs(
+            static_cast<int>(static_cast<int64_t>(m_periodFrames) * 1000000 / m_sampleRate));
+    }
+
     // Start the audio client
     HRESULT hr = m_audioClient->Start();
     if (FAILED(hr)) {
@@ -397,6 +688,8 @@ void WasapiDevice::captureThread()
         if (!m_running.load()) break;
 
         if (waitResult == WAIT_OBJECT_0) {
+            if (m_telemetry) m_telemetry->onCallback(Telemetry::nowUs());
+
             UINT32 packetLength = 0;
 
             while (SUCCEEDED(m_captureClient->GetNextPacketSize(&packetLength)) && packetLength > 0) {
@@ -406,14 +699,30 @@ void WasapiDevice::captureThread()
 
                 HRESULT hr = m_captureClient->GetBuffer(&data, &framesAvailable, &flags, nullptr, nullptr);
 
+                if (SUCCEEDED(hr) && m_telemetry) {
+                    // Glitch flags: the engine dropped capture data, or the packet timing is unreliable
+                    if (flags & AUDCLNT_BUFFERFLAGS_DATA_DISCONTINUITY) m_telemetry->onDiscontinuity();
+                    if (flags & AUDCLNT_BUFFERFLAGS_TIMESTAMP_ERROR) m_telemetry->onTimestampError();
+                }
+
                 if (SUCCEEDED(hr) && data && framesAvailable > 0) {
                     if (m_callback) {
-                        if (flags & AUDCLNT_BUFFERFLAGS_SILENT) {
-                            // Fill with silence
-                            std::vector<int16_t> silence(framesAvailable * m_channels, 0);
-                            m_callback(silence.data(), framesAvailable, m_channels);
+                        int sampleCount = static_cast<int>(framesAvailable) * m_channels;
+                        bool silent = (flags & AUDCLNT_BUFFERFLAGS_SILENT) != 0;
+
+                        if (m_sampleFormat == SampleFormat::Type::Float32 && !silent) {
+                            // Native float stream, no conversion needed
+                            m_callback(reinterpret_cast<float*>(data), framesAvailable, m_channels);
                         } else {
-                            m_callback(reinterpret_cast<int16_t*>(data), framesAvailable, m_channels);
+                            if (static_cast<int>(m_floatBuffer.size()) < sampleCount) {
+                                m_floatBuffer.resize(sampleCount);
+                            }
+                            if (silent) {
+                                std::fill(m_floatBuffer.begin(), m_floatBuffer.begin() + sampleCount, 0.0f);
+                            } else {
+                                SampleFormat::toFloat(data, m_sampleFormat, m_floatBuffer.data(), sampleCount);
+                            }
+                            m_callback(m_floatBuffer.data(), framesAvailable, m_channels);
                         }
                     }
 
@@ -434,7 +743,7 @@ void WasapiDevice::renderThread()
 
     BYTE* data = nullptr;
     if (SUCCEEDED(m_renderClient->GetBuffer(bufferFrames, &data))) {
-        memset(data, 0, bufferFrames * m_channels * sizeof(int16_t));
+        memset(data, 0, bufferFrames * m_channels * SampleFormat::bytesPerSample(m_sampleFormat));
         m_renderClient->ReleaseBuffer(bufferFrames, 0);
     }
 
@@ -444,8 +753,16 @@ void WasapiDevice::renderThread()
         if (!m_running.load()) break;
 
         if (waitResult == WAIT_OBJECT_0) {
+            if (m_telemetry) m_telemetry->onCallback(Telemetry::nowUs());
+
+            // Exclusive event-driven streams hand over the whole buffer each period
             UINT32 padding = 0;
-            m_audioClient->GetCurrentPadding(&padding);
+            if (m_shareMode != ShareMode::Exclusive) {
+                m_audioClient->GetCurrentPadding(&padding);
+
+                // Nothing left queued: the device ran dry before we woke up
+                if (padding == 0 && m_telemetry) m_telemetry->onStarved();
+            }
 
             UINT32 framesAvailable = bufferFrames - padding;
 
@@ -454,10 +771,20 @@ void WasapiDevice::renderThread()
                 HRESULT hr = m_renderClient->GetBuffer(framesAvailable, &buffer);
 
                 if (SUCCEEDED(hr) && buffer) {
-                    if (m_callback) {
-                        m_callback(reinterpret_cast<int16_t*>(buffer), framesAvailable, m_channels);
+                    int sampleCount = static_cast<int>(framesAvailable) * m_channels;
+
+                    if (!m_callback) {
+                        memset(buffer, 0, sampleCount * SampleFormat::bytesPerSample(m_sampleFormat));
+                    } else if (m_sampleFormat == SampleFormat::Type::Float32) {
+                        // Mixer renders straight into the device buffer
+                        m_callback(reinterpret_cast<float*>(buffer), framesAvailable, m_channels);
                     } else {
-                        memset(buffer, 0, framesAvailable * m_channels * sizeof(int16_t));
+                        if (static_cast<int>(m_floatBuffer.size()) < sampleCount) {
+                            m_floatBuffer.resize(sampleCount);
+                        }
+                        m_callback(m_floatBuffer.data(), framesAvailable, m_channels);
+                        SampleFormat::fromFloat(m_floatBuffer.data(), buffer, m_sampleFormat,
+                                                sampleCount, m_dither);
                     }
 
                     m_renderClient->ReleaseBuffer(framesAvailable, 0);
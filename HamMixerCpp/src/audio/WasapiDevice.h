@@ -12,20 +12,28 @@
 #include <thread>
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #include "audio/DeviceInfo.h"
+#include "audio/SampleFormat.h"
+#include "audio/AudioTelemetry.h"
 
 /**
  * @brief WASAPI audio device wrapper
  *
  * Provides device enumeration and audio streaming for Windows Audio Session API.
  * Supports input, output, and loopback capture modes.
+ *
+ * The callback always sees interleaved float32 samples. The stream is opened
+ * in the shared-mode mix format (float32 on all current Windows versions);
+ * if the device only accepts integer PCM, conversion happens here, with
+ * TPDF dither on 16-bit render.
  */
 class WasapiDevice {
 public:
     // Audio callback function type
-    // Parameters: buffer, frameCount, channels
-    using AudioCallback = std::function<void(int16_t*, int, int)>;
+    // Parameters: buffer (interleaved float32), frameCount, channels
+    using AudioCallback = std::function<void(float*, int, int)>;
 
     enum class DeviceType {
         Capture,    // Input device (microphone, line-in)
@@ -33,6 +41,15 @@ public:
         Loopback    // Loopback capture (system audio)
     };
 
+    /**
+     * @brief How the stream is attached to the audio engine
+     */
+    enum class ShareMode {
+        Shared,             // Classic shared mode, caller-chosen buffer duration
+        LowLatencyShared,   // Shared mode at the engine's minimum period (IAudioClient3)
+        Exclusive           // Exclusive mode at the device's minimum period
+    };
+
     WasapiDevice();
     ~WasapiDevice();
 
@@ -64,11 +81,14 @@ public:
      * @param type Device type
      * @param sampleRate Requested sample rate
      * @param channels Requested channel count
-     * @param bufferMs Buffer size in milliseconds
+     * @param bufferMs Buffer size in milliseconds (Shared mode only)
+     * @param mode Share mode; low-latency modes negotiate the smallest period
+     *             the driver accepts. Loopback always uses Shared.
      * @return true if successful
      */
     bool open(const QString& deviceId, DeviceType type,
-              int sampleRate = 48000, int channels = 2, int bufferMs = 20);
+              int sampleRate = 48000, int channels = 2, int bufferMs = 20,
+              ShareMode mode = ShareMode::Shared);
 
     /**
      * @brief Start audio streaming
@@ -77,6 +97,12 @@ public:
      */
     bool start(AudioCallback callback);
 
+    /**
+     * @brief Attach health counters updated from the stream thread
+     * @param telemetry Counters to update, or nullptr to detach (set before start)
+     */
+    void setTelemetry(DeviceTelemetry* telemetry) { m_telemetry = telemetry; }
+
     /**
      * @brief Stop audio streaming
      */
@@ -107,11 +133,39 @@ public:
      */
     int channels() const { return m_channels; }
 
+    /**
+     * @brief Get the native sample format negotiated with the device
+     */
+    SampleFormat::Type sampleFormat() const { return m_sampleFormat; }
+
     /**
      * @brief Get buffer size in frames
      */
     int bufferFrames() const { return m_bufferFrames; }
 
+    /**
+     * @brief Get the share mode actually in use
+     */
+    ShareMode shareMode() const { return m_shareMode; }
+
+    /**
+     * @brief Get the processing period (frames per event) negotiated with the driver
+     */
+    int periodFrames() const { return m_periodFrames; }
+
+    /**
+     * @brief Get the device-side latency in milliseconds
+     *
+     * Stream latency reported by WASAPI plus the buffering this side adds:
+     * one period for capture, the full buffer for render.
+     */
+    float latencyMs() const;
+
+    /**
+     * @brief Human-readable share mode name for logs and UI
+     */
+    static QString shareModeName(ShareMode mode);
+
     /**
      * @brief Get last error message
      */
@@ -130,11 +184,20 @@ private:
     int m_sampleRate = 48000;
     int m_channels = 2;
     int m_bufferFrames = 0;
+    int m_periodFrames = 0;
+    ShareMode m_shareMode = ShareMode::Shared;
+    REFERENCE_TIME m_streamLatency = 0;
+    SampleFormat::Type m_sampleFormat = SampleFormat::Type::Float32;
+
+    // Float scratch buffer for non-float device formats
+    std::vector<float> m_floatBuffer;
+    SampleFormat::TpdfDither m_dither;
 
     // Threading
     std::atomic<bool> m_running{false};
     std::unique_ptr<std::thread> m_streamThread;
     AudioCallback m_callback;
+    DeviceTelemetry* m_telemetry = nullptr;
 
     QString m_lastError;
 
@@ -142,7 +205,14 @@ private:
     void streamThreadFunc();
     void captureThread();
     void renderThread();
-    bool initializeStream(WAVEFORMATEX* format, int bufferMs);
+    bool initializeStream(int bufferMs);
+    bool initializeLowLatencyStream();
+    bool initializeExclusiveStream();
+    bool reactivateClient();
+    bool tryInitialize(const WAVEFORMATEX* format, DWORD streamFlags, REFERENCE_TIME bufferDuration);
+    static void makeFormat(WAVEFORMATEXTENSIBLE& format, int sampleRate, int channels,
+                           SampleFormat::Type type);
+    static bool formatTypeFromWaveFormat(const WAVEFORMATEX* format, SampleFormat::Type& type);
     void releaseResources();
 };
 
@@ -0,0 +1,56 @@
+/*
+ * BandPlan.h
+ *
+ * Amateur band edges shared by the band buttons and the SDR directory
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef BANDPLAN_H
+#define BANDPLAN_H
+
+#include <cstdint>
+
+/**
+ * @brief The amateur bands HamMixer knows, lowest first
+ *
+ * The index of a band is the index of its button in the main window.
+ */
+namespace BandPlan {
+
+struct Band {
+    uint64_t low;       // Hz
+    uint64_t high;      // Hz
+    const char* label;  // Wavelength, e.g. "40m"
+};
+
+inline constexpr Band BANDS[] = {
+    {1800000,  2000000,  "160m"},
+    {3500000,  4000000,  "80m"},
+    {7000000,  7300000,  "40m"},
+    {10100000, 10150000, "30m"},
+    {14000000, 14350000, "20m"},
+    {18068000, 18168000, "17m"},
+    {21000000, 21450000, "15m"},
+    {24890000, 24990000, "12m"},
+    {28000000, 29700000, "10m"},
+    {50000000, 54000000, "6m"},
+};
+
+inline constexpr int BAND_COUNT = sizeof(BANDS) / sizeof(BANDS[0]);
+
+/**
+ * @brief Index of the band containing a frequency, -1 outside the bands
+ */
+inline int bandIndex(uint64_t frequencyHz)
+{
+    for (int i = 0; i < BAND_COUNT; i++) {
+        if (frequencyHz >= BANDS[i].low && frequencyHz <= BANDS[i].high) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+} // namespace BandPlan
+
+#endif // BANDPLAN_H
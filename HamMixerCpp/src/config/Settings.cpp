@@ -267,6 +267,12 @@ QJsonObject Settings::toJson() const
     devices["output"] = m_devices.output;
     root["devices"] = devices;
 
+    // Audio engine
+    QJsonObject audio;
+    audio["sample_rate"] = m_audio.sampleRate;
+    audio["latency_profile"] = m_audio.latencyProfile;
+    root["audio"] = audio;
+
     // Channel 1
     QJsonObject ch1;
     ch1["volume"] = m_channel1.volume;
@@ -293,6 +299,7 @@ QJsonObject Settings::toJson() const
     QJsonObject recording;
     recording["directory"] = m_recording.directory;
     recording["filename_prefix"] = m_recording.filenamePrefix;
+    recording["format"] = m_recording.format;
     root["recording"] = recording;
 
     // Window
@@ -309,6 +316,18 @@ QJsonObject Settings::toJson() const
     serial["baud_rate"] = m_serial.baudRate;
     serial["auto_connect"] = m_serial.autoConnect;
     serial["dial_step_index"] = m_serial.dialStepIndex;
+    serial["event_driven"] = m_serial.eventDriven;
+
+    QJsonObject detected;
+    for (auto it = m_serial.detectedRadios.cbegin(); it != m_serial.detectedRadios.cend(); ++it) {
+        QJsonObject radio;
+        radio["protocol"] = it.value().protocol;
+        radio["baud_rate"] = it.value().baudRate;
+        radio["civ_address"] = it.value().civAddress;
+        detected[it.key()] = radio;
+    }
+    serial["detected_radios"] = detected;
+    serial["rigctld_address"] = m_serial.rigctldAddress;
     root["serial"] = serial;
 
     // WebSDR
@@ -316,6 +335,11 @@ QJsonObject Settings::toJson() const
     webSdr["selected_site"] = m_webSdr.selectedSiteId;
     webSdr["show_browser"] = m_webSdr.showBrowser;
     webSdr["auto_load"] = m_webSdr.autoLoad;
+    webSdr["kiwi_native_audio"] = m_webSdr.kiwiNativeAudio;
+    webSdr["page_audio_capture"] = m_webSdr.pageAudioCapture;
+    webSdr["http_cache_mb"] = m_webSdr.httpCacheMB;
+    webSdr["block_trackers"] = m_webSdr.blockTrackers;
+    webSdr["diversity_best_of"] = m_webSdr.diversityBestOf;
 
     // WebSDR sites list
     QJsonArray sitesArray;
@@ -349,6 +373,11 @@ void Settings::fromJson(const QJsonObject& json)
     m_devices.systemLoopback = devices["system_loopback"].toString();
     m_devices.output = devices["output"].toString();
 
+    // Audio engine
+    QJsonObject audio = json["audio"].toObject();
+    m_audio.sampleRate = audio["sample_rate"].toInt(48000);
+    m_audio.latencyProfile = audio["latency_profile"].toString("normal");
+
     // Channel 1
     QJsonObject ch1 = json["channel1"].toObject();
     m_channel1.volume = ch1["volume"].toInt(100);
@@ -375,6 +404,7 @@ void Settings::fromJson(const QJsonObject& json)
     // (saved paths become invalid when exe is moved/copied)
     m_recording.directory = getDefaultRecordingDir();
     m_recording.filenamePrefix = recording["filename_prefix"].toString("HamMixer");
+    m_recording.format = recording["format"].toString("float32");
 
     // Window
     QJsonObject window = json["window"].toObject();
@@ -393,12 +423,32 @@ void Settings::fromJson(const QJsonObject& json)
     m_serial.baudRate = serial["baud_rate"].toInt(57600);
     m_serial.autoConnect = serial["auto_connect"].toBool(false);
     m_serial.dialStepIndex = serial["dial_step_index"].toInt(1);  // Default 100Hz (index 1)
+    m_serial.eventDriven = serial["event_driven"].toBool(true);
+
+    m_serial.detectedRadios.clear();
+    QJsonObject detected = serial["detected_radios"].toObject();
+    for (auto it = detected.constBegin(); it != detected.constEnd(); ++it) {
+        QJsonObject radio = it.value().toObject();
+        SerialSettings::DetectedRadio entry;
+        entry.protocol = radio["protocol"].toString();
+        entry.baudRate = radio["baud_rate"].toInt(0);
+        entry.civAddress = radio["civ_address"].toInt(0);
+        if (entry.baudRate > 0) {
+            m_serial.detectedRadios.insert(it.key(), entry);
+        }
+    }
+    m_serial.rigctldAddress = serial["rigctld_address"].toString("localhost:4532");
 
     // WebSDR
     QJsonObject webSdr = json["websdr"].toObject();
     m_webSdr.selectedSiteId = webSdr["selected_site"].toString("maasbree");
     m_webSdr.showBrowser = webSdr["show_browser"].toBool(true);
     m_webSdr.autoLoad = webSdr["auto_load"].toBool(false);
+    m_webSdr.kiwiNativeAudio = webSdr["kiwi_native_audio"].toBool(false);
+    m_webSdr.pageAudioCapture = webSdr["page_audio_capture"].toBool(true);
+    m_webSdr.httpCacheMB = webSdr["http_cache_mb"].toInt(256);
+    m_webSdr.blockTrackers = webSdr["block_trackers"].toBool(true);
+    m_webSdr.diversityBestOf = webSdr["diversity_best_of"].toBool(true);
 
     // WebSDR sites list
     m_webSdrSites.clear();
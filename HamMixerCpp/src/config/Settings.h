@@ -7,6 +7,7 @@
 #include <QPoint>
 #include <QSize>
 #include <QList>
+#include <QMap>
 
 #include "websdr/WebSdrSite.h"
 
@@ -25,6 +26,12 @@ public:
         QString output;
     };
 
+    // Audio engine settings
+    struct AudioSettings {
+        int sampleRate = 48000;  // Engine (mixing) rate; devices at other rates are resampled
+        QString latencyProfile = "normal";  // safe, normal, low, exclusive, auto
+    };
+
     // Channel settings
     struct ChannelSettings {
         int volume = 100;     // 0-150
@@ -44,6 +51,7 @@ public:
     struct RecordingSettings {
         QString directory;
         QString filenamePrefix = "HamMixer";
+        QString format = "float32";  // float32, pcm24 or pcm16
     };
 
     // Window settings
@@ -54,10 +62,20 @@ public:
 
     // Serial/CI-V settings
     struct SerialSettings {
+        // Last successful auto-detection on a port, tried first on reconnect
+        struct DetectedRadio {
+            QString protocol;     // "civ" or "cat"
+            int baudRate = 0;
+            int civAddress = 0;   // CI-V radio address (0 = not CI-V)
+        };
+
         QString portName;
         int baudRate = 57600;
         bool autoConnect = false;
         int dialStepIndex = 1;  // Index into step sizes (0=10Hz, 1=100Hz, 2=1kHz, 3=10kHz, 4=100kHz)
+        bool eventDriven = true;  // Use radio-initiated updates (CI-V transceive) when available
+        QMap<QString, DetectedRadio> detectedRadios;  // Keyed by port name
+        QString rigctldAddress = "localhost:4532";  // Hamlib rigctld, "host:port"
     };
 
     // WebSDR settings
@@ -65,6 +83,11 @@ public:
         QString selectedSiteId = "maasbree";
         bool showBrowser = true;
         bool autoLoad = false;
+        bool kiwiNativeAudio = false;  // Stream KiwiSDR audio without the browser
+        bool pageAudioCapture = true;  // Take SDR page audio inside the browser, not from loopback
+        int httpCacheMB = 256;         // Disk cache of the SDR pages' browser profile
+        bool blockTrackers = true;     // Drop counters/analytics embedded in SDR pages
+        bool diversityBestOf = true;   // Hear only the best diversity receiver (false = average them)
     };
 
     Settings();
@@ -160,6 +183,9 @@ public:
     DeviceSettings& devices() { return m_devices; }
     const DeviceSettings& devices() const { return m_devices; }
 
+    AudioSettings& audio() { return m_audio; }
+    const AudioSettings& audio() const { return m_audio; }
+
     ChannelSettings& channel1() { return m_channel1; }
     const ChannelSettings& channel1() const { return m_channel1; }
 
@@ -193,6 +219,7 @@ public:
 
 private:
     DeviceSettings m_devices;
+    AudioSettings m_audio;
     ChannelSettings m_channel1;
     ChannelSettings m_channel2;
     MasterSettings m_master;
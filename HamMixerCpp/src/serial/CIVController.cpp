@@ -8,6 +8,8 @@
 #include "CIVController.h"
 #include "CIVProtocol.h"
 #include <QDebug>
+#include <algorithm>
+#include <cstdlib>
 
 CIVController::CIVController(QObject* parent)
     : RadioController(parent)
@@ -16,28 +18,35 @@ CIVController::CIVController(QObject* parent)
     , m_state(Disconnected)
     , m_currentFrequencyHz(0)  // Initialize to 0 so first read always triggers update
     , m_currentMode(0xFF)      // Invalid mode so first read always triggers update
-    , m_currentModeName("---")
     , m_currentSMeter(0)
     , m_currentTxStatus(false) // Start assuming RX
-    , m_radioModel()
+    , m_radioAddress(0)
     , m_pollPhase(0)
-    , m_commandTimer(nullptr)
 {
-    // Initialize command queue timer
-    m_commandTimer = new QTimer(this);
-    m_commandTimer->setSingleShot(true);
-    QObject::connect(m_commandTimer, &QTimer::timeout,
-                     this, &CIVController::processCommandQueue);
-    m_lastCommandTime.start();
+    m_scheduler = new CatScheduler([this](const QByteArray& frame) { writeFrame(frame); },
+                                   1, MIN_COMMAND_GAP_MS, RESPONSE_TIMEOUT_MS, this);
+    connect(m_scheduler, &CatScheduler::commandFailed, this, &CIVController::onReadbackLost);
+    m_lastRxTime.start();
+    m_lastVerifyTime.start();
+    m_lastActivityTime.start();
 }
 
 CIVController::~CIVController()
 {
-    disconnect();
+    // Deleted on the I/O thread (deleteLater()) or once it has stopped, so
+    // tear down in place: a blocking call into a stopped thread never returns
+    Q_ASSERT(QThread::currentThread() == thread() || !thread()->isRunning());
+    closePort();
 }
 
 bool CIVController::connect(const QString& portName, int baudRate)
 {
+    // The port must be opened on the I/O thread so its notifiers live there
+    bool opened = false;
+    if (runOnOwnThread([&] { opened = connect(portName, baudRate); })) {
+        return opened;
+    }
+
     // Disconnect if already connected
     if (m_serialPort) {
         disconnect();
@@ -71,7 +80,7 @@ bool CIVController::connect(const QString& portName, int baudRate)
 
     // Clear any stale data
     m_serialPort->clear();
-    m_rxBuffer.clear();
+    m_parser.reset();
 
     qDebug() << "CIVController: Connected to" << portName << "at" << baudRate << "baud";
     setState(Connected);
@@ -85,13 +94,37 @@ bool CIVController::connect(const QString& portName, int baudRate)
 
 void CIVController::disconnect()
 {
-    stopPolling();
+    if (runOnOwnThread([this] { disconnect(); })) {
+        return;
+    }
+
+    if (m_serialPort) {
+        m_scheduler->logStatistics("CIVController");
+    }
+    closePort();
 
-    // Stop command queue timer and clear queue
-    if (m_commandTimer) {
-        m_commandTimer->stop();
+    setState(Disconnected);
+    qDebug() << "CIVController: Disconnected";
+}
+
+void CIVController::closePort()
+{
+    // On the owner thread already: stop polling and drop pending commands
+    m_polling = false;
+    if (m_pollTimer) {
+        m_pollTimer->stop();
+    }
+    m_scheduler->clear();
+
+    // Scope output floods the bus; leave it off for the next program
+    if (m_scopeEnabled && m_serialPort && m_serialPort->isOpen()) {
+        QByteArray data;
+        data.append(static_cast<char>(CIVProtocol::SUBCMD_SCOPE_OUTPUT));
+        data.append(static_cast<char>(0x00));
+        writeFrame(CIVProtocol::buildCommand(CIVProtocol::CMD_SCOPE_DATA, data));
+        m_serialPort->waitForBytesWritten(100);
     }
-    m_commandQueue.clear();
+    m_scopeEnabled = false;
 
     if (m_serialPort) {
         if (m_serialPort->isOpen()) {
@@ -101,9 +134,7 @@ void CIVController::disconnect()
         m_serialPort = nullptr;
     }
 
-    m_rxBuffer.clear();
-    setState(Disconnected);
-    qDebug() << "CIVController: Disconnected";
+    m_parser.reset();
 }
 
 QStringList CIVController::availablePorts()
@@ -123,6 +154,10 @@ QList<QSerialPortInfo> CIVController::availablePortsInfo()
 
 void CIVController::startPolling(int intervalMs)
 {
+    if (postToOwnThread([this, intervalMs] { startPolling(intervalMs); })) {
+        return;
+    }
+
     if (!m_serialPort || !m_serialPort->isOpen()) {
         qWarning() << "CIVController: Cannot start polling - not connected";
         return;
@@ -135,12 +170,23 @@ void CIVController::startPolling(int intervalMs)
     }
 
     m_pollPhase = 0;
+    m_pollIntervalMs = intervalMs;
+    m_lastRxTime.restart();
+    m_lastVerifyTime.restart();
+    m_lastActivityTime.restart();
     m_pollTimer->start(intervalMs);
-    qDebug() << "CIVController: Started polling at" << intervalMs << "ms interval";
+    m_polling = true;
+    qDebug() << "CIVController: Started polling at" << intervalMs << "ms interval"
+             << (m_transceiveEnabled ? "(transceive when available)" : "(polling only)");
 }
 
 void CIVController::stopPolling()
 {
+    if (postToOwnThread([this] { stopPolling(); })) {
+        return;
+    }
+
+    m_polling = false;
     if (m_pollTimer) {
         m_pollTimer->stop();
         qDebug() << "CIVController: Stopped polling";
@@ -149,72 +195,125 @@ void CIVController::stopPolling()
 
 void CIVController::requestFrequency()
 {
-    // Use immediate send for polling (already on timer)
-    sendCommandImmediate(CIVProtocol::buildCommand(CIVProtocol::CMD_READ_FREQ));
+    if (postToOwnThread([this] { requestFrequency(); })) {
+        return;
+    }
+
+    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_READ_FREQ),
+                CatScheduler::Priority::Poll, QStringLiteral("read_freq"));
 }
 
 void CIVController::requestMode()
 {
-    // Use immediate send for polling (already on timer)
-    sendCommandImmediate(CIVProtocol::buildCommand(CIVProtocol::CMD_READ_MODE));
+    if (postToOwnThread([this] { requestMode(); })) {
+        return;
+    }
+
+    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_READ_MODE),
+                CatScheduler::Priority::Poll, QStringLiteral("read_mode"));
 }
 
 void CIVController::requestSMeter()
 {
-    // Use immediate send for polling (already on timer)
-    sendCommandImmediate(CIVProtocol::buildCommand(CIVProtocol::CMD_READ_METER,
-                                          CIVProtocol::SUBCMD_SMETER));
+    if (postToOwnThread([this] { requestSMeter(); })) {
+        return;
+    }
+
+    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_READ_METER, CIVProtocol::SUBCMD_SMETER),
+                CatScheduler::Priority::Meter, QStringLiteral("smeter"));
 }
 
 void CIVController::requestTXStatus()
 {
-    // Use immediate send for polling (already on timer)
-    sendCommandImmediate(CIVProtocol::buildCommand(CIVProtocol::CMD_TX_STATUS,
-                                          CIVProtocol::SUBCMD_TX_STATE));
+    if (postToOwnThread([this] { requestTXStatus(); })) {
+        return;
+    }
+
+    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_TX_STATUS, CIVProtocol::SUBCMD_TX_STATE),
+                CatScheduler::Priority::TxStatus, QStringLiteral("tx_status"));
 }
 
 void CIVController::requestTunerState()
 {
-    // Queue this as it may be called from UI
-    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_TX_STATUS,
-                                          CIVProtocol::SUBCMD_TUNER_STATE));
+    if (postToOwnThread([this] { requestTunerState(); })) {
+        return;
+    }
+
+    // Called from the UI, so it goes ahead of polls
+    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_TX_STATUS, CIVProtocol::SUBCMD_TUNER_STATE),
+                CatScheduler::Priority::User, QStringLiteral("read_tuner"));
 }
 
 void CIVController::setFrequency(uint64_t frequencyHz)
 {
+    if (postToOwnThread([this, frequencyHz] { setFrequency(frequencyHz); })) {
+        return;
+    }
+
     QByteArray bcdData = CIVProtocol::encodeFrequency(frequencyHz);
-    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_WRITE_FREQ, bcdData));
+    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_WRITE_FREQ, bcdData),
+                CatScheduler::Priority::User, QStringLiteral("set_freq"));
+
+    // Radios do not always broadcast changes made over CI-V, so read it back
+    if (m_transceiveActive) {
+        m_writtenFrequencyHz = frequencyHz;
+        sendReadback(CIVProtocol::CMD_READ_FREQ, QStringLiteral("readback_freq"));
+    }
 }
 
 void CIVController::setMode(uint8_t mode)
 {
+    if (postToOwnThread([this, mode] { setMode(mode); })) {
+        return;
+    }
+
     QByteArray modeData;
     modeData.append(static_cast<char>(mode));
-    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_WRITE_MODE, modeData));
+    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_WRITE_MODE, modeData),
+                CatScheduler::Priority::User, QStringLiteral("set_mode"));
+
+    if (m_transceiveActive) {
+        m_writtenMode = mode;
+        sendReadback(CIVProtocol::CMD_READ_MODE, QStringLiteral("readback_mode"));
+    }
 }
 
 void CIVController::setTunerState(bool enabled)
 {
+    if (postToOwnThread([this, enabled] { setTunerState(enabled); })) {
+        return;
+    }
+
     QByteArray data;
     data.append(static_cast<char>(CIVProtocol::SUBCMD_TUNER_STATE));
     data.append(static_cast<char>(enabled ? 0x01 : 0x00));
-    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_TX_STATUS, data));
+    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_TX_STATUS, data),
+                CatScheduler::Priority::User, QStringLiteral("set_tuner"));
 }
 
 void CIVController::startTune()
 {
+    if (postToOwnThread([this] { startTune(); })) {
+        return;
+    }
+
     // IC-7300 tune command: 0x1C 0x01 0x02
     // Sub-command 0x01 = Tuner control
     // Data 0x02 = Start tuning
     QByteArray data;
     data.append(static_cast<char>(CIVProtocol::SUBCMD_TUNER_STATE));  // 0x01
     data.append(static_cast<char>(0x02));  // Start tune
-    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_TX_STATUS, data));
+    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_TX_STATUS, data),
+                CatScheduler::Priority::User, QStringLiteral("tune"), false);
     qDebug() << "CIVController: Sent TUNE command (1C 01 02)";
 }
 
 void CIVController::playVoiceMemory(int memoryNumber)
 {
+    if (postToOwnThread([this, memoryNumber] { playVoiceMemory(memoryNumber); })) {
+        return;
+    }
+
     // Memory numbers are 1-8
     // IC-7300 voice TX keyer: Command 0x28, Sub-cmd 0x00, Data = memory (01-08)
     if (memoryNumber < 1 || memoryNumber > 8) {
@@ -224,18 +323,24 @@ void CIVController::playVoiceMemory(int memoryNumber)
     QByteArray data;
     data.append(static_cast<char>(CIVProtocol::SUBCMD_VOICE_TX_PLAY));  // 0x00
     data.append(static_cast<char>(memoryNumber));
-    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_SPEECH, data));
+    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_SPEECH, data),
+                CatScheduler::Priority::User, QStringLiteral("voice"), false);
     qDebug() << "CIVController: Sent Voice Memory" << memoryNumber << "command (28 00" << QString("%1").arg(memoryNumber, 2, 16, QChar('0')) << ")";
 }
 
 void CIVController::stopVoiceMemory()
 {
+    if (postToOwnThread([this] { stopVoiceMemory(); })) {
+        return;
+    }
+
     // IC-7300 stop voice TX keyer: Command 0x28, Sub-cmd 0x00, Data 0x00
     // Sending memory number 0 cancels the current playback
     QByteArray data;
     data.append(static_cast<char>(CIVProtocol::SUBCMD_VOICE_TX_PLAY));  // 0x00
     data.append(static_cast<char>(0x00));  // Memory 0 = stop/cancel
-    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_SPEECH, data));
+    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_SPEECH, data),
+                CatScheduler::Priority::User, QStringLiteral("voice"), false);
     qDebug() << "CIVController: Sent Stop Voice Memory command (28 00 00)";
 }
 
@@ -243,17 +348,29 @@ void CIVController::onReadyRead()
 {
     if (!m_serialPort) return;
 
-    // Read all available data
-    QByteArray data = m_serialPort->readAll();
+    // Stamp meter samples with the time the bytes arrived, not when the
+    // GUI gets round to them
+    m_rxArrivalMs = monotonicMs();
 
-    // DEBUG: Log raw received data
-    qDebug() << "CIVController: RX RAW (" << data.size() << "bytes):" << data.toHex(' ');
+    // Read straight into the parser's ring and dispatch frames as they complete
+    CIVFrame frame;
+    while (true) {
+        int space = 0;
+        uint8_t* dst = m_parser.writeRegion(space);
+        if (space <= 0) {
+            qWarning() << "CIVController: RX buffer full, resynchronising";
+            m_parser.reset();
+            continue;
+        }
 
-    m_rxBuffer.append(data);
-    qDebug() << "CIVController: Buffer size now:" << m_rxBuffer.size() << "bytes";
+        qint64 bytesRead = m_serialPort->read(reinterpret_cast<char*>(dst), space);
+        if (bytesRead <= 0) break;
+        m_parser.commitWrite(static_cast<int>(bytesRead));
 
-    // Process any complete frames
-    extractFrames();
+        while (m_parser.next(frame)) {
+            dispatchFrame(frame);
+        }
+    }
 }
 
 void CIVController::onPollTimer()
@@ -270,9 +387,35 @@ void CIVController::onPollTimer()
         return;
     }
 
-    // S-Meter and TX status are polled every cycle for real-time display
-    // Frequency and Mode are polled less frequently (every 5th cycle each)
-    // This gives ~10 S-meter/TX updates per second at 100ms interval
+    // Watchdog: meters are always polled, so silence means transceive
+    // reports cannot be trusted either
+    if (m_transceiveActive && m_lastRxTime.elapsed() > WATCHDOG_MS) {
+        setTransceiveActive(false, "no response from radio");
+    }
+
+    // S-Meter and TX status are polled every cycle for real-time display.
+    // The cycle runs at the requested interval while the meter moves or we
+    // transmit, and slows to METER_IDLE_MS once things have been quiet.
+    requestSMeter();
+    requestTXStatus();
+
+    bool busy = m_currentTxStatus || m_lastActivityTime.elapsed() < METER_IDLE_AFTER_MS;
+    int interval = busy ? m_pollIntervalMs : std::max(m_pollIntervalMs, METER_IDLE_MS);
+    if (m_pollTimer->interval() != interval) {
+        m_pollTimer->setInterval(interval);
+    }
+
+    if (m_transceiveActive) {
+        // Frequency and mode arrive unsolicited; just verify now and then
+        if (m_lastVerifyTime.elapsed() >= TRANSCEIVE_VERIFY_MS) {
+            m_lastVerifyTime.restart();
+            requestFrequency();
+            requestMode();
+        }
+        return;
+    }
+
+    // Polling fallback
     //
     // Phase:  0   1   2   3   4   5   6   7   8   9   ...
     // SMeter: X   X   X   X   X   X   X   X   X   X   (every cycle)
@@ -280,10 +423,6 @@ void CIVController::onPollTimer()
     // Freq:   X               X               X       (every 5th, phase 0)
     // Mode:       X               X               X   (every 5th, phase 1)
 
-    // Always request S-meter and TX status for real-time display
-    requestSMeter();
-    requestTXStatus();
-
     // Request frequency every 5 cycles (phase 0, 5, 10, ...)
     if (m_pollPhase % 5 == 0) {
         requestFrequency();
@@ -297,6 +436,59 @@ void CIVController::onPollTimer()
     m_pollPhase = (m_pollPhase + 1) % 10;
 }
 
+void CIVController::setEventDrivenUpdates(bool enabled)
+{
+    if (postToOwnThread([this, enabled] { setEventDrivenUpdates(enabled); })) {
+        return;
+    }
+
+    m_transceiveEnabled = enabled;
+    if (!enabled) {
+        setTransceiveActive(false, "disabled in settings");
+    }
+}
+
+void CIVController::setScopeEnabled(bool enabled)
+{
+    if (postToOwnThread([this, enabled] { setScopeEnabled(enabled); })) {
+        return;
+    }
+
+    m_scopeEnabled = enabled;
+    m_scopeDecoder.reset();
+
+    // Turning the scope display on is required for the radio to produce data
+    QByteArray data;
+    if (enabled) {
+        data.append(static_cast<char>(CIVProtocol::SUBCMD_SCOPE_ON));
+        data.append(static_cast<char>(0x01));
+        sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_SCOPE_DATA, data),
+                    CatScheduler::Priority::User, QStringLiteral("scope_on"));
+        data.clear();
+    }
+    data.append(static_cast<char>(CIVProtocol::SUBCMD_SCOPE_OUTPUT));
+    data.append(static_cast<char>(enabled ? 0x01 : 0x00));
+    sendCommand(CIVProtocol::buildCommand(CIVProtocol::CMD_SCOPE_DATA, data),
+                CatScheduler::Priority::User, QStringLiteral("scope_output"));
+    qDebug() << "CIVController: Scope output" << (enabled ? "on" : "off")
+             << "- dropped sweeps so far:" << m_scopeDecoder.droppedSweeps();
+}
+
+void CIVController::setTransceiveActive(bool active, const char* reason)
+{
+    if (m_transceiveActive == active) {
+        return;
+    }
+
+    m_transceiveActive = active;
+    m_writtenFrequencyHz = 0;
+    m_writtenMode = -1;
+    m_lastVerifyTime.restart();
+    qDebug() << "CIVController:" << (active ? "Transceive detected, frequency/mode polling off"
+                                            : "Transceive off, polling frequency/mode")
+             << "-" << reason;
+}
+
 void CIVController::onSerialError(QSerialPort::SerialPortError error)
 {
     if (error == QSerialPort::NoError) {
@@ -349,286 +541,310 @@ void CIVController::setState(ConnectionState newState)
 
 void CIVController::setError(const QString& error)
 {
-    m_lastError = error;
+    {
+        QMutexLocker lock(&m_errorMutex);
+        m_lastError = error;
+    }
     emit errorOccurred(error);
 }
 
-void CIVController::sendCommand(const QByteArray& data)
+QString CIVController::lastError() const
 {
-    // Queue command to ensure minimum delay between commands
-    queueCommand(data);
+    QMutexLocker lock(&m_errorMutex);
+    return m_lastError;
 }
 
-void CIVController::queueCommand(const QByteArray& data)
+QString CIVController::currentModeName() const
+{
+    uint8_t mode = m_currentMode;
+    return (mode == 0xFF) ? QString("---") : CIVProtocol::modeToString(mode);
+}
+
+QString CIVController::radioModel() const
+{
+    uint8_t address = m_radioAddress;
+    return address ? CIVProtocol::addressToModelName(address) : QString();
+}
+
+void CIVController::sendCommand(const QByteArray& frame, CatScheduler::Priority priority,
+                                const QString& name, bool coalesce)
 {
     if (!m_serialPort || !m_serialPort->isOpen()) {
         qWarning() << "CIVController: Cannot queue command - port not open";
         return;
     }
 
-    m_commandQueue.enqueue(data);
-
-    // If timer not running, start processing
-    if (!m_commandTimer->isActive()) {
-        processCommandQueue();
-    }
+    CatScheduler::Command command;
+    command.data = frame;
+    command.name = name;
+    command.priority = priority;
+    command.responseTag = requestTag(frame);
+    command.coalesce = coalesce;
+    command.retries = (priority == CatScheduler::Priority::User) ? USER_COMMAND_RETRIES : 0;
+    m_scheduler->enqueue(command);
 }
 
-void CIVController::processCommandQueue()
+void CIVController::sendReadback(uint8_t readCommand, const QString& name)
 {
-    if (m_commandQueue.isEmpty()) {
+    if (!m_serialPort || !m_serialPort->isOpen()) {
         return;
     }
 
-    // Check if enough time has passed since last command
-    qint64 elapsed = m_lastCommandTime.elapsed();
-    if (elapsed < MIN_COMMAND_INTERVAL_MS) {
-        // Schedule to run after remaining delay
-        m_commandTimer->start(MIN_COMMAND_INTERVAL_MS - static_cast<int>(elapsed));
-        return;
-    }
+    // Moved behind the write just queued rather than merged into an older
+    // readback that may be ahead of it
+    CatScheduler::Command command;
+    command.data = CIVProtocol::buildCommand(readCommand);
+    command.name = name;
+    command.priority = CatScheduler::Priority::User;
+    command.responseTag = requestTag(command.data);
+    command.requeue = true;
+    command.retries = USER_COMMAND_RETRIES;
+    m_scheduler->enqueue(command);
+}
+
+bool CIVController::isLastReadback(const QString& name) const
+{
+    return m_replyCommand == name && !m_scheduler->isQueued(name);
+}
 
-    // Send next command in queue
-    QByteArray data = m_commandQueue.dequeue();
-    sendCommandImmediate(data);
+void CIVController::onReadbackLost(const QString& name)
+{
+    // A readback that failed settles nothing; stop waiting for it
+    if (m_scheduler->isQueued(name)) return;
+    if (name == QLatin1String("readback_freq")) m_writtenFrequencyHz = 0;
+    if (name == QLatin1String("readback_mode")) m_writtenMode = -1;
+}
 
-    // If more commands in queue, schedule next
-    if (!m_commandQueue.isEmpty()) {
-        m_commandTimer->start(MIN_COMMAND_INTERVAL_MS);
-    }
+void CIVController::setRadioAddress(uint8_t address)
+{
+    m_radioAddress = address;
 }
 
-void CIVController::sendCommandImmediate(const QByteArray& data)
+void CIVController::writeFrame(const QByteArray& frame)
 {
     if (!m_serialPort || !m_serialPort->isOpen()) {
-        qWarning() << "CIVController: Cannot send command - port not open";
         return;
     }
 
-    qDebug() << "CIVController: TX:" << data.toHex(' ');
-    qint64 bytesWritten = m_serialPort->write(data);
-    m_serialPort->flush();
-    m_lastCommandTime.restart();
-    qDebug() << "CIVController: Wrote" << bytesWritten << "bytes";
+    // Frames are built for the IC-7300; address the radio actually found
+    uint8_t address = m_radioAddress;
+    if (address != 0 && frame.size() > 2 && static_cast<uint8_t>(frame[2]) != address) {
+        QByteArray addressed = frame;
+        addressed[2] = static_cast<char>(address);
+        m_serialPort->write(addressed);
+        return;
+    }
+    m_serialPort->write(frame);
 }
 
-bool CIVController::extractFrames()
+uint32_t CIVController::requestTag(const QByteArray& frame)
 {
-    bool foundFrame = false;
+    // Frame: FE FE to from cmd [sub] [data...] FD
+    uint8_t cmd = static_cast<uint8_t>(frame[4]);
+    int payload = frame.size() - 6;  // Bytes after cmd, before FD
 
-    qDebug() << "CIVController: extractFrames() called, buffer:" << m_rxBuffer.toHex(' ');
-
-    while (true) {
-        // Find start of frame (FE FE)
-        int startIdx = -1;
-        for (int i = 0; i < m_rxBuffer.size() - 1; i++) {
-            if (static_cast<uint8_t>(m_rxBuffer[i]) == CIVProtocol::PREAMBLE &&
-                static_cast<uint8_t>(m_rxBuffer[i + 1]) == CIVProtocol::PREAMBLE) {
-                startIdx = i;
-                qDebug() << "CIVController: Found FE FE preamble at index" << i;
-                break;
-            }
-        }
-
-        if (startIdx < 0) {
-            // No frame start found, clear buffer up to last byte
-            qDebug() << "CIVController: No FE FE preamble found in buffer";
-            if (m_rxBuffer.size() > 1) {
-                qDebug() << "CIVController: Trimming buffer, discarding" << (m_rxBuffer.size() - 1) << "bytes";
-                m_rxBuffer = m_rxBuffer.right(1);
-            }
-            break;
-        }
+    // Reads are answered with the same command (and sub-command); writes with OK/NG
+    if ((cmd == CIVProtocol::CMD_READ_FREQ || cmd == CIVProtocol::CMD_READ_MODE) && payload == 0) {
+        return 0x100u | cmd;
+    }
+    if ((cmd == CIVProtocol::CMD_READ_METER || cmd == CIVProtocol::CMD_TX_STATUS) && payload == 1) {
+        return 0x10000u | (cmd << 8) | static_cast<uint8_t>(frame[5]);
+    }
+    return TAG_ACK;
+}
 
-        // Discard any garbage before frame start
-        if (startIdx > 0) {
-            qDebug() << "CIVController: Discarding" << startIdx << "bytes of garbage before frame";
-            m_rxBuffer = m_rxBuffer.mid(startIdx);
-        }
+uint32_t CIVController::responseTag(const CIVFrame& frame)
+{
+    switch (frame.command) {
+        case CIVProtocol::CMD_READ_FREQ:
+        case CIVProtocol::CMD_READ_MODE:
+            return 0x100u | frame.command;
+        case CIVProtocol::CMD_READ_METER:
+        case CIVProtocol::CMD_TX_STATUS:
+            return frame.dataSize >= 1 ? (0x10000u | (frame.command << 8) | frame.at(0)) : 0;
+        case CIVProtocol::CMD_OK:
+            return TAG_ACK;
+        default:
+            return 0;  // Unsolicited (transceive, scope); NG, see dispatchFrame()
+    }
+}
 
-        // Find end of frame (FD)
-        int endIdx = -1;
-        for (int i = 2; i < m_rxBuffer.size(); i++) {
-            if (static_cast<uint8_t>(m_rxBuffer[i]) == CIVProtocol::EOM) {
-                endIdx = i;
-                qDebug() << "CIVController: Found FD (end of message) at index" << i;
-                break;
-            }
-        }
+const std::array<CIVController::FrameHandler, 256>& CIVController::frameHandlers()
+{
+    static const std::array<FrameHandler, 256> table = [] {
+        std::array<FrameHandler, 256> t{};
+        t[CIVProtocol::CMD_TRANSCEIVE_FREQ] = &CIVController::handleFrequency;
+        t[CIVProtocol::CMD_READ_FREQ] = &CIVController::handleFrequency;
+        t[CIVProtocol::CMD_TRANSCEIVE_MODE] = &CIVController::handleMode;
+        t[CIVProtocol::CMD_READ_MODE] = &CIVController::handleMode;
+        t[CIVProtocol::CMD_READ_METER] = &CIVController::handleMeter;
+        t[CIVProtocol::CMD_TX_STATUS] = &CIVController::handleTxStatus;
+        t[CIVProtocol::CMD_NG] = &CIVController::handleNg;
+        t[CIVProtocol::CMD_SCOPE_DATA] = &CIVController::handleScope;
+        // CMD_OK acknowledgments are deliberately unhandled
+        return t;
+    }();
+    return table;
+}
 
-        if (endIdx < 0) {
-            // Frame not complete yet
-            qDebug() << "CIVController: No FD found - frame incomplete, waiting for more data";
-            break;
-        }
+void CIVController::dispatchFrame(const CIVFrame& frame)
+{
+    // Only accept frames from known Icom radios (drops our own echo on the bus)
+    if (!CIVProtocol::isKnownAddress(frame.source)) {
+        return;
+    }
 
-        // Extract the frame
-        QByteArray frame = m_rxBuffer.left(endIdx + 1);
-        m_rxBuffer = m_rxBuffer.mid(endIdx + 1);
+    // Report the model from the source address (once; the address itself
+    // may already be known from detection)
+    if (!m_modelReported) {
+        m_modelReported = true;
+        m_radioAddress = frame.source;
+        QString model = CIVProtocol::addressToModelName(frame.source);
+        qDebug() << "CIVController: Detected radio model:" << model;
+        emit radioModelDetected(model);
+    }
 
-        qDebug() << "CIVController: Extracted frame:" << frame.toHex(' ');
+    m_lastRxTime.restart();
+    m_replyCommand.clear();
+    if (frame.command == CIVProtocol::CMD_NG) {
+        // NG does not say what it rejects; with one command on the bus it
+        // is the one in flight, a read as much as a write
+        m_scheduler->onUntaggedError(&m_replyCommand);
+    } else {
+        m_scheduler->onResponse(responseTag(frame), true, &m_replyCommand);
+    }
 
-        // Process the frame
-        if (CIVProtocol::isValidFrame(frame)) {
-            qDebug() << "CIVController: Frame is valid, processing...";
-            processFrame(frame);
-            foundFrame = true;
-        } else {
-            qWarning() << "CIVController: Frame failed validation:" << frame.toHex(' ');
-        }
+    // Unsolicited frequency/mode reports mean CI-V transceive is on
+    if (m_transceiveEnabled && !m_transceiveActive &&
+        (frame.command == CIVProtocol::CMD_TRANSCEIVE_FREQ ||
+         frame.command == CIVProtocol::CMD_TRANSCEIVE_MODE)) {
+        setTransceiveActive(true, "unsolicited report received");
     }
 
-    return foundFrame;
+    FrameHandler handler = frameHandlers()[frame.command];
+    if (handler) {
+        (this->*handler)(frame);
+    }
 }
 
-void CIVController::processFrame(const QByteArray& frame)
+void CIVController::handleFrequency(const CIVFrame& frame)
 {
-    uint8_t srcAddr = CIVProtocol::getSourceAddress(frame);
-    uint8_t dstAddr = CIVProtocol::getDestAddress(frame);
+    // Frequency response: 5 BCD bytes
+    if (frame.dataSize < 5) {
+        qWarning() << "CIVController: Frequency data too short:" << frame.dataSize << "bytes";
+        return;
+    }
 
-    qDebug() << "CIVController: processFrame - src:" << QString("0x%1").arg(srcAddr, 2, 16, QChar('0'))
-             << "dst:" << QString("0x%1").arg(dstAddr, 2, 16, QChar('0'));
+    uint64_t freq = CIVProtocol::parseFrequency(frame.data, frame.dataSize);
 
-    // Detect radio model from source address (only once)
-    if (m_radioModel.isEmpty()) {
-        QString detectedModel = CIVProtocol::addressToModelName(srcAddr);
-        if (!detectedModel.isEmpty()) {
-            m_radioModel = detectedModel;
-            qDebug() << "CIVController: Detected radio model:" << m_radioModel;
-            emit radioModelDetected(m_radioModel);
+    if (frame.command == CIVProtocol::CMD_READ_FREQ) {
+        if (m_writtenFrequencyHz != 0) {
+            // Our own write is settled by a read that shows it, or by the
+            // last readback (the radio may have rounded or refused it).
+            // Anything else was read before the write took effect.
+            bool settled = freq == m_writtenFrequencyHz || isLastReadback(QStringLiteral("readback_freq"));
+            if (!settled) {
+                return;
+            }
+            m_writtenFrequencyHz = 0;
+        } else if (m_transceiveActive && freq != m_currentFrequencyHz) {
+            // A read that disagrees with the cache means a transceive report was lost
+            setTransceiveActive(false, "missed a frequency change");
         }
     }
 
-    // Process frames from known Icom radios - accept any valid CI-V source
-    // Check if source is a known Icom address
-    QString modelCheck = CIVProtocol::addressToModelName(srcAddr);
-    if (modelCheck.isEmpty()) {
-        qDebug() << "CIVController: Ignoring frame from unknown source";
-        return;
+    if (freq != m_currentFrequencyHz) {
+        m_currentFrequencyHz = freq;
+        emit frequencyChanged(freq);
     }
+}
 
-    // Skip scope/waveform data (command 0x27) - it's high-frequency noise
-    uint8_t cmdCheck = CIVProtocol::getCommand(frame);
-    if (cmdCheck == 0x27) {
-        // Scope data, ignore silently
+void CIVController::handleMode(const CIVFrame& frame)
+{
+    // Mode response: 1-2 bytes (mode, optional filter)
+    if (frame.dataSize < 1) {
+        qWarning() << "CIVController: Mode data is empty";
         return;
     }
 
-    uint8_t cmd = CIVProtocol::getCommand(frame);
-    QByteArray data = CIVProtocol::getData(frame);
-
-    qDebug() << "CIVController: Command:" << QString("0x%1").arg(cmd, 2, 16, QChar('0'))
-             << "Data:" << data.toHex(' ') << "(" << data.size() << "bytes)";
+    uint8_t mode = frame.at(0);
 
-    switch (cmd) {
-        case CIVProtocol::CMD_READ_FREQ:
-        case CIVProtocol::CMD_TRANSCEIVE_FREQ:
-        {
-            qDebug() << "CIVController: Processing FREQUENCY command";
-            // Frequency response: 5 BCD bytes
-            if (data.size() >= 5) {
-                uint64_t freq = CIVProtocol::parseFrequency(data);
-                qDebug() << "CIVController: Parsed frequency:" << freq << "Hz"
-                         << "(current:" << m_currentFrequencyHz << "Hz)";
-                if (freq != m_currentFrequencyHz) {
-                    m_currentFrequencyHz = freq;
-                    qDebug() << "CIVController: EMITTING frequencyChanged signal:" << freq;
-                    emit frequencyChanged(freq);
-                } else {
-                    qDebug() << "CIVController: Frequency unchanged, not emitting signal";
-                }
-            } else {
-                qWarning() << "CIVController: Frequency data too short:" << data.size() << "bytes";
+    if (frame.command == CIVProtocol::CMD_READ_MODE) {
+        if (m_writtenMode >= 0) {
+            bool settled = mode == m_writtenMode || isLastReadback(QStringLiteral("readback_mode"));
+            if (!settled) {
+                return;
             }
-            break;
+            m_writtenMode = -1;
+        } else if (m_transceiveActive && mode != m_currentMode) {
+            setTransceiveActive(false, "missed a mode change");
         }
+    }
 
-        case CIVProtocol::CMD_READ_MODE:
-        case CIVProtocol::CMD_TRANSCEIVE_MODE:
-        {
-            qDebug() << "CIVController: Processing MODE command";
-            // Mode response: 1-2 bytes (mode, optional filter)
-            if (!data.isEmpty()) {
-                uint8_t mode = CIVProtocol::parseMode(data);
-                qDebug() << "CIVController: Parsed mode:" << QString("0x%1").arg(mode, 2, 16, QChar('0'))
-                         << "(current:" << QString("0x%1").arg(m_currentMode, 2, 16, QChar('0')) << ")";
-                if (mode != m_currentMode) {
-                    m_currentMode = mode;
-                    m_currentModeName = CIVProtocol::modeToString(mode);
-                    qDebug() << "CIVController: EMITTING modeChanged signal:" << m_currentModeName;
-                    emit modeChanged(mode, m_currentModeName);
-                } else {
-                    qDebug() << "CIVController: Mode unchanged, not emitting signal";
-                }
-            } else {
-                qWarning() << "CIVController: Mode data is empty";
-            }
-            break;
-        }
+    if (mode != m_currentMode) {
+        m_currentMode = mode;
+        emit modeChanged(mode, CIVProtocol::modeToString(mode));
+    }
+}
 
-        case CIVProtocol::CMD_READ_METER:
-        {
-            // S-meter response: subcommand + 2 BCD bytes
-            // Frame data format: [subcmd] [BCD high] [BCD low]
-            qDebug() << "CIVController: Processing METER command, data size:" << data.size()
-                     << "data:" << data.toHex(' ');
-
-            if (data.size() >= 3) {
-                uint8_t subcmd = static_cast<uint8_t>(data[0]);
-                if (subcmd == CIVProtocol::SUBCMD_SMETER) {
-                    int smeter = CIVProtocol::parseSMeter(data.mid(1));
-                    qDebug() << "CIVController: S-meter raw value:" << smeter
-                             << "dB:" << CIVProtocol::smeterToDb(smeter);
-                    m_currentSMeter = smeter;
-                    emit smeterChanged(smeter);
-                } else {
-                    qDebug() << "CIVController: Meter subcmd is" << QString("0x%1").arg(subcmd, 2, 16, QChar('0'))
-                             << "(not S-meter 0x02)";
-                }
-            } else {
-                qWarning() << "CIVController: Meter data too short:" << data.size() << "bytes (need 3)";
-            }
-            break;
-        }
+void CIVController::handleMeter(const CIVFrame& frame)
+{
+    // Meter response: [subcmd] [BCD high] [BCD low]
+    if (frame.dataSize < 3 || frame.at(0) != CIVProtocol::SUBCMD_SMETER) {
+        return;
+    }
 
-        case CIVProtocol::CMD_TX_STATUS:
-        {
-            // TX status response: subcommand + state byte
-            qDebug() << "CIVController: Processing TX_STATUS command, data size:" << data.size()
-                     << "data:" << data.toHex(' ');
-
-            if (data.size() >= 2) {
-                uint8_t subcmd = static_cast<uint8_t>(data[0]);
-                uint8_t state = static_cast<uint8_t>(data[1]);
-
-                if (subcmd == CIVProtocol::SUBCMD_TX_STATE) {
-                    // TX/RX state: 0x00=RX, 0x01=TX
-                    bool txActive = (state == 0x01);
-                    if (txActive != m_currentTxStatus) {
-                        m_currentTxStatus = txActive;
-                        qDebug() << "CIVController: TX status changed to:" << (txActive ? "TX" : "RX");
-                        emit txStatusChanged(txActive);
-                    }
-                } else if (subcmd == CIVProtocol::SUBCMD_TUNER_STATE) {
-                    // Tuner state: 0x00=OFF, 0x01=ON
-                    bool tunerOn = (state == 0x01);
-                    qDebug() << "CIVController: Tuner state:" << (tunerOn ? "ON" : "OFF");
-                    emit tunerStateChanged(tunerOn);
-                }
-            }
-            break;
-        }
+    int smeter = CIVProtocol::parseSMeter(frame.data + 1, frame.dataSize - 1);
+    if (std::abs(smeter - m_currentSMeter) >= SMETER_CHANGE_THRESHOLD) {
+        m_lastActivityTime.restart();
+    }
+    m_currentSMeter = smeter;
+    emit smeterChanged(smeter, m_rxArrivalMs);
+}
 
-        case CIVProtocol::CMD_OK:
-            qDebug() << "CIVController: Received OK (FB) acknowledgment";
-            break;
+void CIVController::handleTxStatus(const CIVFrame& frame)
+{
+    // TX status response: subcommand + state byte
+    if (frame.dataSize < 2) {
+        return;
+    }
 
-        case CIVProtocol::CMD_NG:
-            qWarning() << "CIVController: Command rejected by radio (NG)";
-            break;
+    uint8_t subcmd = frame.at(0);
+    uint8_t state = frame.at(1);
+
+    if (subcmd == CIVProtocol::SUBCMD_TX_STATE) {
+        // TX/RX state: 0x00=RX, 0x01=TX
+        bool txActive = (state == 0x01);
+        if (txActive != m_currentTxStatus) {
+            m_currentTxStatus = txActive;
+            m_lastActivityTime.restart();
+            qDebug() << "CIVController: TX status changed to:" << (txActive ? "TX" : "RX");
+            emit txStatusChanged(txActive);
+        }
+    } else if (subcmd == CIVProtocol::SUBCMD_TUNER_STATE) {
+        // Tuner state: 0x00=OFF, 0x01=ON
+        emit tunerStateChanged(state == 0x01);
+    }
+}
 
-        default:
-            qDebug() << "CIVController: Unknown/unhandled command:" << QString("0x%1").arg(cmd, 2, 16, QChar('0'));
-            break;
+void CIVController::handleScope(const CIVFrame& frame)
+{
+    // Scope frames stream unsolicited while output is on; ignore strays after turning it off
+    if (!m_scopeEnabled) {
+        return;
+    }
+    if (m_scopeDecoder.feed(frame, m_scopeLine)) {
+        emit scopeLineReady(m_scopeLine.amplitudes, m_scopeLine.lowHz, m_scopeLine.highHz);
+    }
+}
+
+void CIVController::handleNg(const CIVFrame& frame)
+{
+    Q_UNUSED(frame);
+    if (m_replyCommand.isEmpty()) {
+        qWarning() << "CIVController: Command rejected by radio (NG)";
+        return;
     }
+    qWarning() << "CIVController: Radio rejected" << m_replyCommand << "(NG)";
+    onReadbackLost(m_replyCommand);
 }
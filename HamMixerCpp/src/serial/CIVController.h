@@ -9,6 +9,9 @@
 #define CIVCONTROLLER_H
 
 #include "RadioController.h"
+#include "CIVParser.h"
+#include "CIVScope.h"
+#include "CatScheduler.h"
 #include <QSerialPort>
 #include <QSerialPortInfo>
 #include <QTimer>
@@ -16,7 +19,9 @@
 #include <QByteArray>
 #include <QString>
 #include <QStringList>
-#include <QQueue>
+#include <QMutex>
+#include <array>
+#include <atomic>
 
 class CIVController : public RadioController
 {
@@ -30,7 +35,7 @@ public:
     bool connect(const QString& portName, int baudRate = 57600) override;
     void disconnect() override;
     ConnectionState state() const override { return m_state; }
-    QString lastError() const override { return m_lastError; }
+    QString lastError() const override;
     bool isConnected() const override { return m_state == Connected; }
     Protocol protocol() const override { return IcomCIV; }
 
@@ -41,7 +46,15 @@ public:
     // Polling control
     void startPolling(int intervalMs = 100) override;
     void stopPolling() override;
-    bool isPolling() const override { return m_pollTimer && m_pollTimer->isActive(); }
+    bool isPolling() const override { return m_polling; }
+
+    // Transceive (hybrid) mode: see onPollTimer()
+    void setEventDrivenUpdates(bool enabled) override;
+    bool eventDrivenActive() const override { return m_transceiveActive; }
+
+    // Spectrum scope: asks the radio to stream 0x27 waveform frames
+    bool supportsScope() const override { return true; }
+    void setScopeEnabled(bool enabled) override;
 
     // Manual queries (results come via signals)
     void requestFrequency() override;
@@ -61,47 +74,95 @@ public:
     // Current values (cached from last poll)
     uint64_t currentFrequency() const override { return m_currentFrequencyHz; }
     uint8_t currentMode() const override { return m_currentMode; }
-    QString currentModeName() const override { return m_currentModeName; }
+    QString currentModeName() const override;
     int currentSMeter() const override { return m_currentSMeter; }
-    QString radioModel() const override { return m_radioModel; }
+    QString radioModel() const override;
+
+    /**
+     * @brief Radio address found by RadioDetector; commands are sent to it
+     */
+    void setRadioAddress(uint8_t address);
 
 private slots:
     void onReadyRead();
     void onPollTimer();
     void onSerialError(QSerialPort::SerialPortError error);
-    void processCommandQueue();
 
 private:
+    void closePort();  // Teardown shared by disconnect() and the destructor
     void setState(ConnectionState newState);
     void setError(const QString& error);
-    void processFrame(const QByteArray& frame);
-    void sendCommand(const QByteArray& data);
-    void queueCommand(const QByteArray& data);  // Queue command with delay
-    void sendCommandImmediate(const QByteArray& data);  // Send without queueing (for polling)
-    bool extractFrames();  // Extract complete frames from buffer
+    void dispatchFrame(const CIVFrame& frame);
+    void sendCommand(const QByteArray& frame, CatScheduler::Priority priority,
+                     const QString& name, bool coalesce = true);
+    void sendReadback(uint8_t readCommand, const QString& name);
+    bool isLastReadback(const QString& name) const;
+    void onReadbackLost(const QString& name);
+    void writeFrame(const QByteArray& frame);  // Called by the scheduler
+    static uint32_t requestTag(const QByteArray& frame);
+    static uint32_t responseTag(const CIVFrame& frame);
+
+    // Per-command frame handlers, looked up through a 256-entry table
+    using FrameHandler = void (CIVController::*)(const CIVFrame&);
+    static const std::array<FrameHandler, 256>& frameHandlers();
+    void handleFrequency(const CIVFrame& frame);
+    void handleMode(const CIVFrame& frame);
+    void handleMeter(const CIVFrame& frame);
+    void handleTxStatus(const CIVFrame& frame);
+    void handleNg(const CIVFrame& frame);
+    void handleScope(const CIVFrame& frame);
+
+    void setTransceiveActive(bool active, const char* reason);
 
     QSerialPort* m_serialPort;
     QTimer* m_pollTimer;
-    QByteArray m_rxBuffer;
-    ConnectionState m_state;
+    CIVParser m_parser;
+    std::atomic<ConnectionState> m_state;
+    mutable QMutex m_errorMutex;  // Guards m_lastError (read from the GUI thread)
     QString m_lastError;
 
-    // Cached current state
-    uint64_t m_currentFrequencyHz;
-    uint8_t m_currentMode;
-    QString m_currentModeName;
-    int m_currentSMeter;
-    bool m_currentTxStatus;  // true = transmitting
-    QString m_radioModel;
+    // Cached current state, written on the I/O thread and read from any thread
+    std::atomic<uint64_t> m_currentFrequencyHz;
+    std::atomic<uint8_t> m_currentMode;
+    std::atomic<int> m_currentSMeter;
+    std::atomic<bool> m_currentTxStatus;  // true = transmitting
+    std::atomic<uint8_t> m_radioAddress;  // CI-V address of the radio, 0 until known
+    bool m_modelReported = false;         // radioModelDetected emitted for the first frame
+    std::atomic<bool> m_polling{false};
+    qint64 m_rxArrivalMs = 0;             // monotonicMs() of the read being parsed
 
     // Polling state machine
     int m_pollPhase;  // 0=freq, 1=mode, 2=smeter
-
-    // Command queue for reliable timing
-    QQueue<QByteArray> m_commandQueue;
-    QTimer* m_commandTimer;
-    QElapsedTimer m_lastCommandTime;
-    static constexpr int MIN_COMMAND_INTERVAL_MS = 50;  // Minimum ms between commands
+    int m_pollIntervalMs = 100;  // Fast meter interval requested by startPolling()
+
+    // Transceive: radio broadcasts 0x00/0x01 on VFO/mode changes, so those
+    // are not polled. A periodic read verifies nothing was missed and a
+    // watchdog falls back to full polling when the radio goes quiet.
+    bool m_transceiveEnabled = true;   // User setting
+    std::atomic<bool> m_transceiveActive{false};  // Unsolicited frames seen and trusted
+    uint64_t m_writtenFrequencyHz = 0; // Our write awaiting its readback (0 = none)
+    int m_writtenMode = -1;            // Likewise (-1 = none)
+    QString m_replyCommand;            // Command the frame being dispatched answers
+    QElapsedTimer m_lastRxTime;        // Last frame from the radio
+    QElapsedTimer m_lastVerifyTime;    // Last freq/mode verification read
+    QElapsedTimer m_lastActivityTime;  // Last meter/TX change (adaptive rate)
+    static constexpr int TRANSCEIVE_VERIFY_MS = 5000;  // Verify freq/mode this often
+    static constexpr int WATCHDOG_MS = 2000;           // Radio silence before falling back
+    static constexpr int METER_IDLE_MS = 300;          // Meter interval when nothing changes
+    static constexpr int METER_IDLE_AFTER_MS = 3000;   // Quiet time before slowing down
+    static constexpr int SMETER_CHANGE_THRESHOLD = 3;  // Raw units counted as activity
+
+    // Spectrum scope reassembly
+    CIVScopeDecoder m_scopeDecoder;
+    CIVScopeLine m_scopeLine;
+    bool m_scopeEnabled = false;
+
+    // Command scheduling: one command on the bus at a time, replies matched by tag
+    CatScheduler* m_scheduler;
+    static constexpr int MIN_COMMAND_GAP_MS = 10;     // Between sends
+    static constexpr int RESPONSE_TIMEOUT_MS = 300;   // Per attempt
+    static constexpr int USER_COMMAND_RETRIES = 2;
+    static constexpr uint32_t TAG_ACK = 0xFB;         // OK reply to a write
 };
 
 #endif // CIVCONTROLLER_H
@@ -0,0 +1,150 @@
+/*
+ * CIVParser.cpp
+ *
+ * Incremental, allocation-free CI-V frame parser
+ * Part of HamMixer CT7BAC
+ */
+
+#include "CIVParser.h"
+#include "CIVProtocol.h"
+#include <algorithm>
+#include <cstring>
+
+uint8_t* CIVParser::writeRegion(int& space)
+{
+    // Release everything that is neither unparsed nor part of a pending frame.
+    // This is what invalidates the last frame view.
+    m_tail = (m_state == State::Body) ? m_frameStart : m_scan;
+
+    int used = static_cast<int>(m_head - m_tail);
+    int free = BUFFER_SIZE - used;
+    int beforeWrap = BUFFER_SIZE - static_cast<int>(m_head & MASK);
+    space = std::min(free, beforeWrap);
+    return m_buffer + (m_head & MASK);
+}
+
+void CIVParser::commitWrite(int bytes)
+{
+    if (bytes > 0) {
+        m_head += static_cast<uint32_t>(bytes);
+    }
+}
+
+int CIVParser::feed(const uint8_t* data, int size)
+{
+    int accepted = 0;
+    while (accepted < size) {
+        int space = 0;
+        uint8_t* dst = writeRegion(space);
+        if (space <= 0) break;
+
+        int chunk = std::min(space, size - accepted);
+        std::memcpy(dst, data + accepted, chunk);
+        commitWrite(chunk);
+        accepted += chunk;
+    }
+    return accepted;
+}
+
+void CIVParser::reset()
+{
+    m_head = m_tail = m_scan = m_frameStart = 0;
+    m_state = State::Idle;
+}
+
+void CIVParser::dropFrame()
+{
+    m_droppedBytes += m_scan - m_frameStart + 2;  // Body so far plus preamble
+    m_state = State::Idle;
+}
+
+bool CIVParser::next(CIVFrame& frame)
+{
+    while (m_scan != m_head) {
+        uint8_t byte = m_buffer[m_scan & MASK];
+
+        switch (m_state) {
+            case State::Idle:
+                if (byte == CIVProtocol::PREAMBLE) {
+                    m_state = State::Preamble;
+                } else {
+                    m_droppedBytes++;
+                }
+                m_scan++;
+                break;
+
+            case State::Preamble:
+                m_scan++;
+                if (byte == CIVProtocol::PREAMBLE) {
+                    m_state = State::Body;
+                    m_frameStart = m_scan;
+                } else {
+                    m_droppedBytes += 2;
+                    m_state = State::Idle;
+                }
+                break;
+
+            case State::Body: {
+                int length = static_cast<int>(m_scan - m_frameStart);
+
+                if (byte == CIVProtocol::PREAMBLE) {
+                    if (length > 0) {
+                        // EOM was lost; this byte starts the next frame
+                        dropFrame();
+                        m_state = State::Preamble;
+                    }
+                    m_scan++;
+                    if (length == 0) {
+                        // Extra preamble byte, frame has not started yet
+                        m_frameStart = m_scan;
+                    }
+                    break;
+                }
+
+                if (byte == CIVProtocol::JAMMER) {
+                    // Bus collision: whatever was being sent is lost
+                    m_scan++;
+                    dropFrame();
+                    break;
+                }
+
+                if (byte != CIVProtocol::EOM) {
+                    m_scan++;
+                    if (length + 1 > MAX_FRAME_BYTES) {
+                        dropFrame();
+                    }
+                    break;
+                }
+
+                // EOM: frame complete
+                m_scan++;
+                m_state = State::Idle;
+
+                if (length < 3) {
+                    m_droppedBytes += length + 3;  // Needs at least to, from, command
+                    break;
+                }
+
+                const uint8_t* body;
+                uint32_t offset = m_frameStart & MASK;
+                if (offset + length <= static_cast<uint32_t>(BUFFER_SIZE)) {
+                    body = m_buffer + offset;
+                } else {
+                    // Frame straddles the wrap point
+                    int firstPart = BUFFER_SIZE - static_cast<int>(offset);
+                    std::memcpy(m_linear, m_buffer + offset, firstPart);
+                    std::memcpy(m_linear + firstPart, m_buffer, length - firstPart);
+                    body = m_linear;
+                }
+
+                frame.dest = body[0];
+                frame.source = body[1];
+                frame.command = body[2];
+                frame.data = body + 3;
+                frame.dataSize = length - 3;
+                return true;
+            }
+        }
+    }
+    return false;
+}
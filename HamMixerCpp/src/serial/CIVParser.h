@@ -0,0 +1,107 @@
+/*
+ * CIVParser.h
+ *
+ * Incremental, allocation-free CI-V frame parser
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef CIVPARSER_H
+#define CIVPARSER_H
+
+#include <cstdint>
+
+/**
+ * @brief View of one received CI-V frame
+ *
+ * Points into the parser's storage; valid until the next call to
+ * CIVParser::next() or CIVParser::writeRegion().
+ */
+struct CIVFrame {
+    uint8_t dest = 0;
+    uint8_t source = 0;
+    uint8_t command = 0;
+    const uint8_t* data = nullptr;  // Bytes after the command, before EOM
+    int dataSize = 0;
+
+    uint8_t at(int index) const { return data[index]; }
+};
+
+/**
+ * @brief State-machine CI-V parser over a fixed circular byte buffer
+ *
+ * Serial data is read straight into the ring (writeRegion/commitWrite),
+ * then next() walks the new bytes once: idle -> preamble -> body -> EOM.
+ * Complete frames are returned as views into the ring; only a frame that
+ * straddles the wrap point is linearised into a small fixed scratch
+ * buffer. Garbage, bus collisions (0xFC) and oversized frames are dropped.
+ */
+class CIVParser
+{
+public:
+    static constexpr int BUFFER_SIZE = 2048;     // Ring capacity (power of two)
+    static constexpr int MAX_FRAME_BYTES = 512;  // Address + command + data (scope frames are long)
+
+    CIVParser() = default;
+
+    /**
+     * @brief Get contiguous free space for incoming bytes
+     * @param space Receives the number of writable bytes
+     * @return Write pointer (valid for 'space' bytes)
+     */
+    uint8_t* writeRegion(int& space);
+
+    /**
+     * @brief Commit bytes written into the region from writeRegion()
+     */
+    void commitWrite(int bytes);
+
+    /**
+     * @brief Copy bytes in (for callers that already have a buffer)
+     * @return Number of bytes accepted
+     */
+    int feed(const uint8_t* data, int size);
+
+    /**
+     * @brief Parse up to the next complete frame
+     * @param frame Receives the frame view
+     * @return true if a frame was produced
+     */
+    bool next(CIVFrame& frame);
+
+    /**
+     * @brief Drop all buffered bytes and restart in the idle state
+     */
+    void reset();
+
+    /**
+     * @brief Bytes discarded as garbage, collisions or oversized frames
+     */
+    uint64_t droppedBytes() const { return m_droppedBytes; }
+
+private:
+    enum class State {
+        Idle,       // Waiting for first 0xFE
+        Preamble,   // Saw one 0xFE
+        Body        // Collecting address/command/data until 0xFD
+    };
+
+    static constexpr uint32_t MASK = BUFFER_SIZE - 1;
+    static_assert((BUFFER_SIZE & (BUFFER_SIZE - 1)) == 0, "BUFFER_SIZE must be a power of two");
+    static_assert(MAX_FRAME_BYTES < BUFFER_SIZE, "A frame must fit in the ring");
+
+    void dropFrame();
+
+    uint8_t m_buffer[BUFFER_SIZE];
+    uint8_t m_linear[MAX_FRAME_BYTES];
+
+    // Free-running positions (wrap via MASK)
+    uint32_t m_head = 0;        // Next byte to write
+    uint32_t m_tail = 0;        // Oldest byte still needed
+    uint32_t m_scan = 0;        // Next byte to parse
+    uint32_t m_frameStart = 0;  // First body byte of the frame being collected
+
+    State m_state = State::Idle;
+    uint64_t m_droppedBytes = 0;
+};
+
+#endif // CIVPARSER_H
@@ -47,7 +47,12 @@ QByteArray buildCommand(uint8_t command, const QByteArray& payload)
 
 uint64_t parseFrequency(const QByteArray& bcdData)
 {
-    if (bcdData.size() < 5) {
+    return parseFrequency(reinterpret_cast<const uint8_t*>(bcdData.constData()), bcdData.size());
+}
+
+uint64_t parseFrequency(const uint8_t* bcd, int size)
+{
+    if (size < 5) {
         return 0;
     }
 
@@ -64,7 +69,7 @@ uint64_t parseFrequency(const QByteArray& bcdData)
     uint64_t multiplier = 1;
 
     for (int i = 0; i < 5; i++) {
-        uint8_t byte = static_cast<uint8_t>(bcdData[i]);
+        uint8_t byte = bcd[i];
         uint8_t lowNibble = byte & 0x0F;
         uint8_t highNibble = (byte >> 4) & 0x0F;
 
@@ -102,14 +107,19 @@ uint8_t parseMode(const QByteArray& data)
 
 int parseSMeter(const QByteArray& data)
 {
-    if (data.size() < 2) {
+    return parseSMeter(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+}
+
+int parseSMeter(const uint8_t* bcd, int size)
+{
+    if (size < 2) {
         return 0;
     }
 
     // S-meter data is 2 BCD digits (0x00 to 0xFF)
     // Format: high byte and low byte, each containing BCD
-    uint8_t highByte = static_cast<uint8_t>(data[0]);
-    uint8_t lowByte = static_cast<uint8_t>(data[1]);
+    uint8_t highByte = bcd[0];
+    uint8_t lowByte = bcd[1];
 
     // Convert from BCD to integer
     int highDigit = ((highByte >> 4) & 0x0F) * 10 + (highByte & 0x0F);
@@ -244,4 +254,19 @@ QString addressToModelName(uint8_t civAddress)
     }
 }
 
+bool isKnownAddress(uint8_t civAddress)
+{
+    switch (civAddress) {
+        case ADDR_IC705:
+        case ADDR_IC7100:
+        case ADDR_IC7300:
+        case ADDR_IC7610:
+        case ADDR_IC7851:
+        case ADDR_IC9700:
+            return true;
+        default:
+            return false;
+    }
+}
+
 } // namespace CIVProtocol
@@ -17,6 +17,7 @@ namespace CIVProtocol {
 // Frame structure bytes
 constexpr uint8_t PREAMBLE = 0xFE;
 constexpr uint8_t EOM = 0xFD;           // End of message
+constexpr uint8_t JAMMER = 0xFC;        // Bus collision jam code
 
 // Default addresses
 constexpr uint8_t ADDR_CONTROLLER = 0xE0; // Controller (PC) address
@@ -38,6 +39,7 @@ constexpr uint8_t CMD_WRITE_FREQ = 0x05;       // Set operating frequency
 constexpr uint8_t CMD_WRITE_MODE = 0x06;       // Set operating mode
 constexpr uint8_t CMD_READ_METER = 0x15;       // Read meter levels
 constexpr uint8_t CMD_TX_STATUS = 0x1C;        // Read/set transmit status
+constexpr uint8_t CMD_SCOPE_DATA = 0x27;       // Spectrum scope waveform data
 constexpr uint8_t CMD_OK = 0xFB;               // OK response
 constexpr uint8_t CMD_NG = 0xFA;               // NG (error) response
 
@@ -52,6 +54,11 @@ constexpr uint8_t SUBCMD_TUNER_TUNE = 0x02;    // Start tuning
 constexpr uint8_t CMD_SPEECH = 0x28;
 constexpr uint8_t SUBCMD_VOICE_TX_PLAY = 0x00;  // Sub-command for voice TX (memory 1-8 to play, 0 to stop)
 
+// Sub-commands for CMD_SCOPE_DATA (0x27)
+constexpr uint8_t SUBCMD_SCOPE_WAVE = 0x00;     // Waveform data (radio -> PC)
+constexpr uint8_t SUBCMD_SCOPE_ON = 0x10;       // Scope display on/off
+constexpr uint8_t SUBCMD_SCOPE_OUTPUT = 0x11;   // Waveform output to CI-V on/off
+
 // Sub-commands for CMD_READ_METER (0x15)
 constexpr uint8_t SUBCMD_SMETER = 0x02;        // S-meter level
 constexpr uint8_t SUBCMD_SQUELCH = 0x01;       // Squelch status
@@ -124,6 +131,14 @@ QByteArray buildCommand(uint8_t command, const QByteArray& data);
  */
 uint64_t parseFrequency(const QByteArray& bcdData);
 
+/**
+ * Parse frequency from BCD-encoded bytes in place (no copy)
+ * @param bcd Pointer to BCD bytes
+ * @param size Number of bytes available (at least 5 needed)
+ * @return Frequency in Hz, 0 if too short
+ */
+uint64_t parseFrequency(const uint8_t* bcd, int size);
+
 /**
  * Encode frequency to BCD format
  * @param freqHz Frequency in Hz
@@ -145,6 +160,14 @@ uint8_t parseMode(const QByteArray& data);
  */
 int parseSMeter(const QByteArray& data);
 
+/**
+ * Parse S-meter value from BCD bytes in place (no copy)
+ * @param bcd Pointer to 2 BCD bytes
+ * @param size Number of bytes available
+ * @return S-meter value 0-255, 0 if too short
+ */
+int parseSMeter(const uint8_t* bcd, int size);
+
 /**
  * Convert CI-V mode code to human-readable string
  * @param civMode CI-V mode code
@@ -213,6 +236,13 @@ uint8_t getDestAddress(const QByteArray& frame);
  */
 QString addressToModelName(uint8_t civAddress);
 
+/**
+ * Check whether a CI-V address belongs to a known Icom radio
+ * @param civAddress CI-V address byte
+ * @return true if addressToModelName() would return a model
+ */
+bool isKnownAddress(uint8_t civAddress);
+
 } // namespace CIVProtocol
 
 #endif // CIVPROTOCOL_H
@@ -0,0 +1,127 @@
+/*
+ * CIVScope.cpp
+ *
+ * Reassembles Icom spectrum scope (0x27) frames into spectrum lines
+ * Part of HamMixer CT7BAC
+ */
+
+#include "CIVScope.h"
+#include "CIVProtocol.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Two-digit BCD byte (sequence numbers)
+int bcdByte(uint8_t value)
+{
+    return ((value >> 4) & 0x0F) * 10 + (value & 0x0F);
+}
+
+constexpr int HEADER_SIZE = 4;       // 00, main/sub, seq, seq max
+constexpr int SWEEP_INFO_SIZE = 12;  // Mode, 2 x 5-byte frequency, out-of-range
+constexpr uint8_t MODE_CENTER = 0x00;
+constexpr uint8_t MODE_SCROLL_CENTER = 0x02;
+
+} // namespace
+
+CIVScopeDecoder::CIVScopeDecoder()
+{
+    m_buffer.resize(MAX_POINTS);
+}
+
+void CIVScopeDecoder::reset()
+{
+    m_points = 0;
+    m_expectedSeq = 1;
+    m_haveHeader = false;
+}
+
+void CIVScopeDecoder::append(const uint8_t* data, int size)
+{
+    int count = std::min(size, MAX_POINTS - m_points);
+    if (count <= 0) {
+        return;
+    }
+
+    // Clamp here so the waterfall can index its palette without checks
+    char* dst = m_buffer.data() + m_points;
+    for (int i = 0; i < count; i++) {
+        dst[i] = static_cast<char>(std::min(data[i], MAX_LEVEL));
+    }
+    m_points += count;
+}
+
+bool CIVScopeDecoder::feed(const CIVFrame& frame, CIVScopeLine& line)
+{
+    if (frame.dataSize < HEADER_SIZE || frame.at(0) != CIVProtocol::SUBCMD_SCOPE_WAVE) {
+        return false;  // Scope settings replies (27 10, 27 11, ...) are not waveform
+    }
+
+    int receiver = frame.at(1);
+    int seq = bcdByte(frame.at(2));
+    int seqMax = bcdByte(frame.at(3));
+    const uint8_t* payload = frame.data + HEADER_SIZE;
+    int payloadSize = frame.dataSize - HEADER_SIZE;
+
+    if (seq == 1) {
+        // Start of a sweep; anything half-assembled is lost
+        if (m_points > 0 || m_expectedSeq != 1) {
+            m_droppedSweeps++;
+        }
+        reset();
+
+        if (payloadSize < SWEEP_INFO_SIZE) {
+            return false;
+        }
+
+        uint8_t mode = payload[0];
+        uint64_t first = CIVProtocol::parseFrequency(payload + 1, 5);
+        uint64_t second = CIVProtocol::parseFrequency(payload + 6, 5);
+        if (mode == MODE_CENTER || mode == MODE_SCROLL_CENTER) {
+            // Center frequency and half span
+            m_lowHz = first > second ? first - second : 0;
+            m_highHz = first + second;
+        } else {
+            m_lowHz = first;
+            m_highHz = second;
+        }
+        m_outOfRange = payload[11] != 0;
+        m_haveHeader = true;
+
+        // Single-frame sweeps carry the waveform straight after the header
+        append(payload + SWEEP_INFO_SIZE, payloadSize - SWEEP_INFO_SIZE);
+    } else {
+        if (!m_haveHeader || seq != m_expectedSeq) {
+            if (m_haveHeader) {
+                m_droppedSweeps++;
+            }
+            reset();
+            return false;
+        }
+        append(payload, payloadSize);
+    }
+
+    m_expectedSeq = seq + 1;
+    if (seq < seqMax) {
+        return false;
+    }
+
+    // Last division: hand out the sweep
+    bool complete = m_points > 0;
+    if (complete) {
+        // Reuse the line's buffer: no allocation once receivers have let go
+        // of the previous sweep (they copy it, see WaterfallWidget::addLine())
+        if (line.amplitudes.capacity() < MAX_POINTS) {
+            line.amplitudes.reserve(MAX_POINTS);
+        }
+        line.amplitudes.resize(m_points);
+        std::memcpy(line.amplitudes.data(), m_buffer.constData(), m_points);
+        line.lowHz = m_lowHz;
+        line.highHz = m_highHz;
+        line.outOfRange = m_outOfRange;
+        line.receiver = receiver;
+    }
+    reset();
+    return complete;
+}
@@ -0,0 +1,77 @@
+/*
+ * CIVScope.h
+ *
+ * Reassembles Icom spectrum scope (0x27) frames into spectrum lines
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef CIVSCOPE_H
+#define CIVSCOPE_H
+
+#include "CIVParser.h"
+#include <QByteArray>
+#include <cstdint>
+
+/**
+ * @brief One complete scope sweep
+ *
+ * Amplitudes are the radio's raw levels (0 to CIVScopeDecoder::MAX_LEVEL),
+ * lowest frequency first.
+ */
+struct CIVScopeLine {
+    QByteArray amplitudes;
+    uint64_t lowHz = 0;
+    uint64_t highHz = 0;
+    bool outOfRange = false;  // Radio flags the scope edges as outside the band
+    int receiver = 0;         // 0 = main, 1 = sub
+};
+
+/**
+ * @brief Decoder for "27 00" scope waveform frames
+ *
+ * Frame data (after the 0x27 command byte):
+ *   00 <main/sub> <seq BCD> <seq max BCD> <payload...>
+ *
+ * Sequence 1 carries the header: mode (00 center, 01 fixed, 02/03 scroll),
+ * two 5-byte BCD frequencies (center and half span, or lower and upper
+ * edge) and the out-of-range flag. Over USB the radio splits a sweep into
+ * up to 11 divisions with the waveform in sequences 2..max; over LAN or at
+ * high CI-V speeds it sends one frame with the waveform after the header.
+ *
+ * Divisions are appended into a preallocated buffer; a line is produced
+ * when the last one arrives. A gap in the sequence drops the sweep.
+ */
+class CIVScopeDecoder
+{
+public:
+    static constexpr int MAX_POINTS = 1024;   // IC-7300: 475, IC-7610: 689
+    static constexpr uint8_t MAX_LEVEL = 160; // Full-scale amplitude
+
+    CIVScopeDecoder();
+
+    /**
+     * @brief Feed one 0x27 frame
+     * @param frame Frame with command CMD_SCOPE_DATA
+     * @param line Receives the sweep when the last division completes it
+     * @return true if line was filled
+     */
+    bool feed(const CIVFrame& frame, CIVScopeLine& line);
+
+    void reset();
+
+    uint64_t droppedSweeps() const { return m_droppedSweeps; }
+
+private:
+    void append(const uint8_t* data, int size);
+
+    QByteArray m_buffer;      // Reserved once; reused for every sweep
+    int m_points = 0;
+    int m_expectedSeq = 1;
+    bool m_haveHeader = false;
+    uint64_t m_lowHz = 0;
+    uint64_t m_highHz = 0;
+    bool m_outOfRange = false;
+    uint64_t m_droppedSweeps = 0;
+};
+
+#endif // CIVSCOPE_H
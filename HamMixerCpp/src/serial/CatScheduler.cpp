@@ -0,0 +1,265 @@
+/*
+ * CatScheduler.cpp
+ *
+ * Priority command scheduler shared by the CAT controllers
+ * Part of HamMixer CT7BAC
+ */
+
+#include "CatScheduler.h"
+#include <QDebug>
+#include <algorithm>
+
+CatScheduler::CatScheduler(Writer writer, int maxInFlight, int minGapMs, int timeoutMs,
+                           QObject* parent)
+    : QObject(parent)
+    , m_writer(std::move(writer))
+    , m_maxInFlight(std::max(1, maxInFlight))
+    , m_minGapMs(std::max(0, minGapMs))
+    , m_timeoutMs(std::max(1, timeoutMs))
+    , m_timer(this)  // Child, so it follows the controller onto the I/O thread
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &CatScheduler::pump);
+    m_clock.start();
+}
+
+void CatScheduler::enqueue(const Command& command)
+{
+    QList<Command>& queue = m_queues[static_cast<size_t>(command.priority)];
+
+    if (command.coalesce && !command.name.isEmpty()) {
+        // A queued command with the same name is superseded, in place or
+        // by appending the new one behind what was queued since
+        for (int i = 0; i < queue.size(); i++) {
+            if (queue[i].name == command.name) {
+                stats(command.name).coalesced++;
+                if (command.requeue) {
+                    queue.removeAt(i);
+                    break;
+                }
+                queue[i] = command;
+                return;
+            }
+        }
+
+        // A read already on the wire will answer this one too
+        if (command.priority != Priority::User) {
+            for (const InFlight& flight : m_inFlight) {
+                if (flight.command.name == command.name) {
+                    stats(command.name).coalesced++;
+                    return;
+                }
+            }
+        }
+    }
+
+    queue.append(command);
+    pump();
+}
+
+bool CatScheduler::onResponse(uint32_t tag, bool ok, QString* command)
+{
+    if (tag == 0) {
+        return false;
+    }
+
+    // Oldest matching command first: replies come back in order
+    for (int i = 0; i < m_inFlight.size(); i++) {
+        if (m_inFlight[i].command.responseTag == tag) {
+            if (command) *command = m_inFlight[i].command.name;
+            m_untrackedSinceReply = 0;
+            complete(i, ok);
+            pump();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CatScheduler::onUntaggedError(QString* command)
+{
+    if (m_inFlight.size() != 1 || m_untrackedSinceReply > 0) {
+        return false;
+    }
+
+    if (command) *command = m_inFlight[0].command.name;
+    complete(0, false);
+    pump();
+    return true;
+}
+
+void CatScheduler::clear()
+{
+    for (QList<Command>& queue : m_queues) {
+        queue.clear();
+    }
+    m_inFlight.clear();
+    m_untrackedSinceReply = 0;
+    m_timer.stop();
+}
+
+int CatScheduler::queuedCount() const
+{
+    int count = 0;
+    for (const QList<Command>& queue : m_queues) {
+        count += queue.size();
+    }
+    return count;
+}
+
+bool CatScheduler::isQueued(const QString& name) const
+{
+    for (const QList<Command>& queue : m_queues) {
+        for (const Command& command : queue) {
+            if (command.name == name) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+QList<CatScheduler::Stats> CatScheduler::statistics() const
+{
+    QList<Stats> list = m_stats.values();
+    std::sort(list.begin(), list.end(), [](const Stats& a, const Stats& b) {
+        return a.name < b.name;
+    });
+    return list;
+}
+
+void CatScheduler::logStatistics(const char* owner) const
+{
+    for (const Stats& s : statistics()) {
+        qDebug().nospace() << owner << ": " << s.name << " sent " << s.sent
+                           << ", ok " << s.completed << ", rejected " << s.rejected
+                           << ", timeouts " << s.timeouts << ", retries " << s.retries
+                           << ", coalesced " << s.coalesced
+                           << ", latency mean " << s.meanLatencyMs << " ms, max "
+                           << s.maxLatencyMs << " ms";
+    }
+}
+
+void CatScheduler::pump()
+{
+    checkTimeouts();
+
+    while (m_inFlight.size() < m_maxInFlight) {
+        qint64 now = m_clock.elapsed();
+        if (m_lastSendMs >= 0 && now - m_lastSendMs < m_minGapMs) {
+            break;  // Timer below picks this up once the gap has passed
+        }
+
+        // Highest priority class first, FIFO within a class
+        QList<Command>* queue = nullptr;
+        for (QList<Command>& candidate : m_queues) {
+            if (!candidate.isEmpty()) {
+                queue = &candidate;
+                break;
+            }
+        }
+        if (!queue) {
+            break;
+        }
+
+        Command command = queue->takeFirst();
+        stats(command.name).sent++;
+        send(command, now);
+    }
+
+    scheduleTimer();
+}
+
+void CatScheduler::send(Command command, qint64 firstSentAtMs)
+{
+    qint64 now = m_clock.elapsed();
+    m_writer(command.data);
+    m_lastSendMs = now;
+
+    if (command.responseTag == 0) {
+        stats(command.name).completed++;
+        m_untrackedSinceReply++;
+        return;
+    }
+
+    InFlight flight;
+    flight.command = std::move(command);
+    flight.sentAtMs = now;
+    flight.firstSentAtMs = firstSentAtMs;
+    m_inFlight.append(flight);
+}
+
+void CatScheduler::checkTimeouts()
+{
+    qint64 now = m_clock.elapsed();
+
+    for (int i = 0; i < m_inFlight.size(); ) {
+        if (now - m_inFlight[i].sentAtMs < m_timeoutMs) {
+            i++;
+            continue;
+        }
+
+        InFlight flight = m_inFlight.takeAt(i);
+        Stats& s = stats(flight.command.name);
+        s.timeouts++;
+
+        if (flight.command.retries > 0) {
+            // Resend right away, ahead of anything queued
+            flight.command.retries--;
+            s.retries++;
+            send(flight.command, flight.firstSentAtMs);
+        } else {
+            qWarning() << "CatScheduler: No reply to" << flight.command.name;
+            emit commandFailed(flight.command.name);
+        }
+    }
+}
+
+void CatScheduler::scheduleTimer()
+{
+    qint64 now = m_clock.elapsed();
+    qint64 next = -1;
+
+    // Next in-flight deadline
+    for (const InFlight& flight : m_inFlight) {
+        qint64 due = flight.sentAtMs + m_timeoutMs;
+        if (next < 0 || due < next) next = due;
+    }
+
+    // End of the send gap, if something is waiting and there is room
+    if (queuedCount() > 0 && m_inFlight.size() < m_maxInFlight) {
+        qint64 due = m_lastSendMs + m_minGapMs;
+        if (next < 0 || due < next) next = due;
+    }
+
+    if (next < 0) {
+        m_timer.stop();
+        return;
+    }
+    m_timer.start(static_cast<int>(std::max<qint64>(0, next - now)));
+}
+
+void CatScheduler::complete(int index, bool ok)
+{
+    InFlight flight = m_inFlight.takeAt(index);
+    Stats& s = stats(flight.command.name);
+
+    if (!ok) {
+        s.rejected++;
+        return;
+    }
+
+    double latency = static_cast<double>(m_clock.elapsed() - flight.firstSentAtMs);
+    s.completed++;
+    s.meanLatencyMs += (latency - s.meanLatencyMs) / s.completed;
+    s.maxLatencyMs = std::max(s.maxLatencyMs, latency);
+}
+
+CatScheduler::Stats& CatScheduler::stats(const QString& name)
+{
+    Stats& s = m_stats[name];
+    if (s.name.isEmpty()) {
+        s.name = name;
+    }
+    return s;
+}
@@ -0,0 +1,172 @@
+/*
+ * CatScheduler.h
+ *
+ * Priority command scheduler shared by the CAT controllers
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef CATSCHEDULER_H
+#define CATSCHEDULER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <array>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief Schedules radio commands by priority and matches replies to them
+ *
+ * Commands wait in one FIFO per priority class; the highest non-empty
+ * class is always served first, so a user action never sits behind meter
+ * polls. A queued command with the same coalescing key is replaced in
+ * place (only the last setFrequency matters), or for a requeue command
+ * moved behind what was queued since (a readback must follow the newest
+ * write), and a read that is already queued or in flight is not asked for
+ * twice.
+ *
+ * Sent commands that expect a reply stay in flight until the controller
+ * reports a reply with the matching tag, or until they time out and are
+ * retried or dropped. Per-command latency, timeout and retry counts are
+ * kept for diagnostics.
+ *
+ * The scheduler knows nothing about the wire format: the controller
+ * supplies the bytes, the reply tag and a writer function.
+ */
+class CatScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Priority {
+        User = 0,   // User writes and user-initiated reads
+        TxStatus,   // TX/RX state (drives audio muting)
+        Meter,      // S-meter
+        Poll,       // Frequency/mode polls
+        Count
+    };
+
+    struct Command {
+        QByteArray data;
+        QString name;                    // Stats and coalescing key
+        Priority priority = Priority::Poll;
+        uint32_t responseTag = 0;        // 0 = fire and forget
+        bool coalesce = true;            // Replace a queued command with the same name
+        bool requeue = false;            // ...by moving it to the back rather than in place
+        int retries = 0;                 // Resends after a timeout
+    };
+
+    struct Stats {
+        QString name;
+        int sent = 0;
+        int completed = 0;
+        int rejected = 0;     // Radio answered with an error
+        int timeouts = 0;
+        int retries = 0;
+        int coalesced = 0;    // Superseded before being sent
+        double meanLatencyMs = 0.0;
+        double maxLatencyMs = 0.0;
+    };
+
+    using Writer = std::function<void(const QByteArray&)>;
+
+    /**
+     * @param writer Sends raw bytes to the radio
+     * @param maxInFlight Commands awaiting a reply at once (1 for a shared bus)
+     * @param minGapMs Minimum time between two sends
+     * @param timeoutMs Reply timeout per attempt
+     */
+    CatScheduler(Writer writer, int maxInFlight, int minGapMs, int timeoutMs,
+                 QObject* parent = nullptr);
+
+    /**
+     * @brief Queue a command (coalesced with an identical queued one)
+     */
+    void enqueue(const Command& command);
+
+    /**
+     * @brief Report a reply from the radio
+     * @param tag Reply tag as computed by the controller
+     * @param ok false if the radio rejected the command
+     * @param command If given, set to the name of the matched command
+     * @return true if it matched an in-flight command
+     */
+    bool onResponse(uint32_t tag, bool ok = true, QString* command = nullptr);
+
+    /**
+     * @brief Report an error reply that carries no tag
+     *
+     * Failed to the in-flight command only when it can be the only source:
+     * exactly one command in flight and no fire-and-forget command sent
+     * since the last matched reply (replies come back in order, so an
+     * error for an earlier one would have arrived before it). Otherwise the
+     * error is ambiguous and the command is left to its timeout.
+     * @param command If given, set to the name of the failed command
+     * @return true if it was attributed to a command
+     */
+    bool onUntaggedError(QString* command = nullptr);
+
+    /**
+     * @brief Drop all queued and in-flight commands
+     */
+    void clear();
+
+    int queuedCount() const;
+
+    /**
+     * @brief Whether a command with this name is waiting to be sent
+     */
+    bool isQueued(const QString& name) const;
+    int inFlightCount() const { return m_inFlight.size(); }
+
+    QList<Stats> statistics() const;
+    void resetStatistics() { m_stats.clear(); }
+
+    /**
+     * @brief Write a one-line-per-command latency summary to the debug log
+     */
+    void logStatistics(const char* owner) const;
+
+signals:
+    /**
+     * @brief A command got no reply after all retries
+     */
+    void commandFailed(const QString& name);
+
+private slots:
+    void pump();
+
+private:
+    struct InFlight {
+        Command command;
+        qint64 sentAtMs = 0;
+        qint64 firstSentAtMs = 0;
+    };
+
+    void send(Command command, qint64 firstSentAtMs);
+    void checkTimeouts();
+    void scheduleTimer();
+    void complete(int index, bool ok);
+    Stats& stats(const QString& name);
+
+    Writer m_writer;
+    int m_maxInFlight;
+    int m_minGapMs;
+    int m_timeoutMs;
+
+    std::array<QList<Command>, static_cast<size_t>(Priority::Count)> m_queues;
+    QList<InFlight> m_inFlight;
+    QHash<QString, Stats> m_stats;
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastSendMs = -1;
+    int m_untrackedSinceReply = 0;  // Fire-and-forget sends since the last matched reply
+};
+
+#endif // CATSCHEDULER_H
@@ -16,19 +16,36 @@ KenwoodController::KenwoodController(QObject* parent)
     , m_state(Disconnected)
     , m_currentFrequencyHz(0)
     , m_currentMode(0xFF)
-    , m_currentModeName("---")
     , m_currentSMeter(0)
     , m_pollPhase(0)
 {
+    m_scheduler = new CatScheduler([this](const QByteArray& data) { writeCommand(data); },
+                                   MAX_IN_FLIGHT, MIN_COMMAND_GAP_MS, RESPONSE_TIMEOUT_MS, this);
+    // A rig without AI may never answer the read-back (its "?;" can be ambiguous)
+    QObject::connect(m_scheduler, &CatScheduler::commandFailed, this, [this](const QString& name) {
+        if (name == QLatin1String("AI") && m_aiLevelTried) {
+            onAiUnsupported();
+        }
+    });
+    m_lastRxTime.start();
 }
 
 KenwoodController::~KenwoodController()
 {
-    disconnect();
+    // Deleted on the I/O thread (deleteLater()) or once it has stopped, so
+    // tear down in place: a blocking call into a stopped thread never returns
+    Q_ASSERT(QThread::currentThread() == thread() || !thread()->isRunning());
+    closePort();
 }
 
 bool KenwoodController::connect(const QString& portName, int baudRate)
 {
+    // The port must be opened on the I/O thread so its notifiers live there
+    bool opened = false;
+    if (runOnOwnThread([&] { opened = connect(portName, baudRate); })) {
+        return opened;
+    }
+
     // Disconnect if already connected
     if (m_serialPort) {
         disconnect();
@@ -62,7 +79,7 @@ bool KenwoodController::connect(const QString& portName, int baudRate)
 
     // Clear any stale data
     m_serialPort->clear();
-    m_rxBuffer.clear();
+    m_parser.reset();
 
     qDebug() << "KenwoodController: Connected to" << portName << "at" << baudRate << "baud";
     setState(Connected);
@@ -72,7 +89,35 @@ bool KenwoodController::connect(const QString& portName, int baudRate)
 
 void KenwoodController::disconnect()
 {
-    stopPolling();
+    if (runOnOwnThread([this] { disconnect(); })) {
+        return;
+    }
+
+    if (m_serialPort) {
+        m_scheduler->logStatistics("KenwoodController");
+    }
+    closePort();
+
+    setState(Disconnected);
+    qDebug() << "KenwoodController: Disconnected";
+}
+
+void KenwoodController::closePort()
+{
+    // On the owner thread already: stop polling and drop pending commands
+    m_polling = false;
+    if (m_pollTimer) {
+        m_pollTimer->stop();
+    }
+    m_scheduler->clear();
+
+    // Leave the rig as we found it for other CAT software on the port
+    if (m_aiActive && m_serialPort && m_serialPort->isOpen()) {
+        m_serialPort->write("AI0;");
+        m_serialPort->waitForBytesWritten(100);
+    }
+    setAiActive(false, "disconnected");
+    m_aiLevelTried = 0;
 
     if (m_serialPort) {
         if (m_serialPort->isOpen()) {
@@ -82,13 +127,15 @@ void KenwoodController::disconnect()
         m_serialPort = nullptr;
     }
 
-    m_rxBuffer.clear();
-    setState(Disconnected);
-    qDebug() << "KenwoodController: Disconnected";
+    m_parser.reset();
 }
 
 void KenwoodController::startPolling(int intervalMs)
 {
+    if (postToOwnThread([this, intervalMs] { startPolling(intervalMs); })) {
+        return;
+    }
+
     if (!m_serialPort || !m_serialPort->isOpen()) {
         qWarning() << "KenwoodController: Cannot start polling - not connected";
         return;
@@ -101,12 +148,65 @@ void KenwoodController::startPolling(int intervalMs)
     }
 
     m_pollPhase = 0;
+    m_lastRxTime.restart();
     m_pollTimer->start(intervalMs);
+    m_polling = true;
     qDebug() << "KenwoodController: Started polling at" << intervalMs << "ms interval";
+
+    if (m_aiEnabled && !m_aiActive) {
+        enableAutoInformation();
+    }
+}
+
+void KenwoodController::setEventDrivenUpdates(bool enabled)
+{
+    if (postToOwnThread([this, enabled] { setEventDrivenUpdates(enabled); })) {
+        return;
+    }
+
+    m_aiEnabled = enabled;
+    if (!enabled && m_aiActive) {
+        sendCommand("AI0;", CatScheduler::Priority::User);
+        setAiActive(false, "disabled in settings");
+    } else if (enabled && !m_aiActive && isPolling()) {
+        enableAutoInformation();
+    }
+}
+
+void KenwoodController::enableAutoInformation()
+{
+    // Ask for AI2, then read it back; the level read back (or the read
+    // failing) decides
+    m_aiLevelTried = '2';
+    sendCommand("AI2;", CatScheduler::Priority::User, false);
+    sendCommand("AI;", CatScheduler::Priority::User);
+}
+
+void KenwoodController::onAiUnsupported()
+{
+    m_aiLevelTried = 0;
+    setAiActive(false, "Auto-Information not supported");
+    qDebug() << "KenwoodController: Auto-Information not supported, polling";
+}
+
+void KenwoodController::setAiActive(bool active, const char* reason)
+{
+    if (m_aiActive == active) {
+        return;
+    }
+    m_aiActive = active;
+    qDebug() << "KenwoodController:" << (active ? "Auto-Information on, polling S-meter only"
+                                                : "Auto-Information off, polling frequency/mode")
+             << "-" << reason;
 }
 
 void KenwoodController::stopPolling()
 {
+    if (postToOwnThread([this] { stopPolling(); })) {
+        return;
+    }
+
+    m_polling = false;
     if (m_pollTimer) {
         m_pollTimer->stop();
         qDebug() << "KenwoodController: Stopped polling";
@@ -115,86 +215,129 @@ void KenwoodController::stopPolling()
 
 void KenwoodController::requestFrequency()
 {
-    sendCommand("FA;");
+    if (postToOwnThread([this] { requestFrequency(); })) {
+        return;
+    }
+
+    sendCommand("FA;", CatScheduler::Priority::Poll);
 }
 
 void KenwoodController::requestMode()
 {
-    sendCommand("MD;");
+    if (postToOwnThread([this] { requestMode(); })) {
+        return;
+    }
+
+    sendCommand("MD;", CatScheduler::Priority::Poll);
 }
 
 void KenwoodController::requestSMeter()
 {
-    sendCommand("SM;");
+    if (postToOwnThread([this] { requestSMeter(); })) {
+        return;
+    }
+
+    sendCommand("SM;", CatScheduler::Priority::Meter);
 }
 
 void KenwoodController::requestTunerState()
 {
-    // AC; command reads tuner state
-    sendCommand("AC;");
+    if (postToOwnThread([this] { requestTunerState(); })) {
+        return;
+    }
+
+    // AC; command reads tuner state (called from the UI)
+    sendCommand("AC;", CatScheduler::Priority::User);
 }
 
 void KenwoodController::setFrequency(uint64_t frequencyHz)
 {
+    if (postToOwnThread([this, frequencyHz] { setFrequency(frequencyHz); })) {
+        return;
+    }
+
     // Format: FAnnnnnnnnnnn; (11 digits, leading zeros)
     QString cmd = QString("FA%1;").arg(frequencyHz, 11, 10, QChar('0'));
-    sendCommand(cmd);
+    sendCommand(cmd, CatScheduler::Priority::User);
 }
 
 void KenwoodController::setMode(uint8_t mode)
 {
+    if (postToOwnThread([this, mode] { setMode(mode); })) {
+        return;
+    }
+
     // Kenwood mode mapping: 1=LSB, 2=USB, 3=CW, 4=FM, 5=AM, 6=FSK, 7=CW-R, 9=FSK-R
     QString cmd = QString("MD%1;").arg(mode);
-    sendCommand(cmd);
+    sendCommand(cmd, CatScheduler::Priority::User);
 }
 
 void KenwoodController::setTunerState(bool enabled)
 {
+    if (postToOwnThread([this, enabled] { setTunerState(enabled); })) {
+        return;
+    }
+
     // AC command: AC P1 P2 P3;
     // P1=0/1 (RX antenna tuner on/off), P2=0/1 (TX tuner on/off), P3=0/1 (tuning)
     QString cmd = QString("AC%1%1%1;").arg(enabled ? "1" : "0");
-    sendCommand(cmd);
+    sendCommand(cmd, CatScheduler::Priority::User);
 }
 
 void KenwoodController::startTune()
 {
+    if (postToOwnThread([this] { startTune(); })) {
+        return;
+    }
+
     // Start tuning: AC111;
-    sendCommand("AC111;");
+    sendCommand("AC111;", CatScheduler::Priority::User, false);
 }
 
 void KenwoodController::playVoiceMemory(int memoryNumber)
 {
+    if (postToOwnThread([this, memoryNumber] { playVoiceMemory(memoryNumber); })) {
+        return;
+    }
+
     // PB command: PBnn; (voice memory playback, 01-04 for most Kenwoods)
     if (memoryNumber < 1 || memoryNumber > 8) {
         qWarning() << "KenwoodController: Invalid voice memory number:" << memoryNumber;
         return;
     }
     QString cmd = QString("PB%1;").arg(memoryNumber, 2, 10, QChar('0'));
-    sendCommand(cmd);
+    sendCommand(cmd, CatScheduler::Priority::User, false);
 }
 
 void KenwoodController::stopVoiceMemory()
 {
+    if (postToOwnThread([this] { stopVoiceMemory(); })) {
+        return;
+    }
+
     // PB00 command: Stop voice memory playback
-    sendCommand("PB00;");
+    sendCommand("PB00;", CatScheduler::Priority::User, false);
 }
 
 void KenwoodController::onReadyRead()
 {
     if (!m_serialPort) return;
 
-    // Read all available data
-    QByteArray data = m_serialPort->readAll();
-    m_rxBuffer += QString::fromLatin1(data);
+    // Stamp meter samples with the time the bytes arrived
+    m_rxArrivalMs = monotonicMs();
 
-    // Process complete responses (terminated by ';')
-    int idx;
-    while ((idx = m_rxBuffer.indexOf(';')) != -1) {
-        QString response = m_rxBuffer.left(idx + 1);
-        m_rxBuffer = m_rxBuffer.mid(idx + 1);
+    // Read straight into the parser buffer and handle complete responses
+    KenwoodResponse response;
+    while (true) {
+        int space = 0;
+        char* dst = m_parser.writeRegion(space);
+        qint64 bytesRead = m_serialPort->read(dst, space);
+        if (bytesRead <= 0) break;
+        m_parser.commitWrite(static_cast<int>(bytesRead));
 
-        qDebug() << "KenwoodController: RX:" << response;
-        processResponse(response);
+        while (m_parser.next(response)) {
+            processResponse(response);
+        }
     }
 }
 
@@ -206,6 +349,17 @@ void KenwoodController::onPollTimer()
         return;
     }
 
+    // Watchdog: S-meter replies keep arriving while the rig is alive
+    if (m_aiActive && m_lastRxTime.elapsed() > WATCHDOG_MS) {
+        setAiActive(false, "no response from radio");
+    }
+
+    // In AI mode the rig reports frequency and mode itself
+    if (m_aiActive) {
+        requestSMeter();
+        return;
+    }
+
     // Polling pattern:
     // Phase 0: S-meter + Frequency
     // Phase 1: S-meter
@@ -282,97 +436,166 @@ void KenwoodController::setState(ConnectionState newState)
 
 void KenwoodController::setError(const QString& error)
 {
-    m_lastError = error;
+    {
+        QMutexLocker lock(&m_errorMutex);
+        m_lastError = error;
+    }
     emit errorOccurred(error);
 }
 
-void KenwoodController::sendCommand(const QString& cmd)
+QString KenwoodController::lastError() const
+{
+    QMutexLocker lock(&m_errorMutex);
+    return m_lastError;
+}
+
+QString KenwoodController::currentModeName() const
+{
+    uint8_t mode = m_currentMode;
+    return (mode == 0xFF) ? QString("---") : modeToString(mode);
+}
+
+void KenwoodController::sendCommand(const QString& cmd, CatScheduler::Priority priority, bool coalesce)
 {
     if (!m_serialPort || !m_serialPort->isOpen()) {
         qWarning() << "KenwoodController: Cannot send command - port not open";
         return;
     }
 
-    QByteArray data = cmd.toLatin1();
-    qDebug() << "KenwoodController: TX:" << cmd;
+    // "FA;" is a read and answers "FA...;"; "FA00014200000;" is a silent set
+    bool isRead = cmd.length() == 3;
+
+    CatScheduler::Command command;
+    command.data = cmd.toLatin1();
+    command.name = isRead ? cmd.left(2) : cmd.left(2) + "=";
+    command.priority = priority;
+    command.responseTag = isRead ? commandTag(cmd) : 0;
+    command.coalesce = coalesce;
+    command.retries = (priority == CatScheduler::Priority::User) ? USER_COMMAND_RETRIES : 0;
+    m_scheduler->enqueue(command);
+}
+
+void KenwoodController::writeCommand(const QByteArray& data)
+{
+    if (!m_serialPort || !m_serialPort->isOpen()) {
+        return;
+    }
     m_serialPort->write(data);
-    m_serialPort->flush();
 }
 
-void KenwoodController::processResponse(const QString& response)
+uint32_t KenwoodController::commandTag(const QString& text)
+{
+    if (text.length() < 2) {
+        return 0;
+    }
+    return commandTag(text.at(0).toLatin1(), text.at(1).toLatin1());
+}
+
+uint32_t KenwoodController::commandTag(char a, char b)
 {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(a)) << 8) | static_cast<uint8_t>(b);
+}
+
+void KenwoodController::processResponse(const KenwoodResponse& response)
+{
+    m_lastRxTime.restart();
+
     // Check for error response (command followed by ?;)
-    if (response.endsWith("?;")) {
-        qWarning() << "KenwoodController: Command error:" << response;
+    if (response.isError()) {
+        // "?;" names no command: only trust it when the scheduler can pin
+        // it on one, and leave the AI negotiation alone otherwise
+        QString failed;
+        if (!m_scheduler->onUntaggedError(&failed)) {
+            qWarning() << "KenwoodController: Command error:" << QLatin1String(response.text, response.size)
+                       << "(command unknown)";
+        } else if (failed == QLatin1String("AI") && m_aiLevelTried) {
+            onAiUnsupported();
+        } else {
+            qWarning() << "KenwoodController: Command error:" << failed;
+        }
+        return;
+    }
+
+    // Every reply starts with its two-letter command (see hasPrefix()); a
+    // bare ";" has none, and text[1] would be past it
+    if (response.size < 3) {
         return;
     }
 
+    m_scheduler->onResponse(commandTag(response.text[0], response.text[1]));
+    bool ok = false;
+
     // FA - Frequency response (FAnnnnnnnnnnn;)
     // Format: FA followed by up to 11 digits (frequency in Hz), then ;
-    if (response.startsWith("FA") && response.length() >= 4) {
-        QString freqStr = response.mid(2, response.length() - 3);  // Remove "FA" and ";"
-        bool ok;
-        uint64_t freq = freqStr.toULongLong(&ok);
-        if (ok && freq > 0) {
-            if (freq != m_currentFrequencyHz) {
-                m_currentFrequencyHz = freq;
-                qDebug() << "KenwoodController: Frequency:" << freq << "Hz";
-                emit frequencyChanged(freq);
-            }
+    if (response.hasPrefix('F', 'A') && response.size >= 4) {
+        uint64_t freq = response.number(2, -1, &ok);
+        if (ok && freq > 0 && freq != m_currentFrequencyHz) {
+            m_currentFrequencyHz = freq;
+            emit frequencyChanged(freq);
         }
     }
     // MD - Mode response (MDn;)
     // Format: MD followed by mode digit (1-9), then ;
-    else if (response.startsWith("MD") && response.length() >= 4) {
-        QString modeStr = response.mid(2, 1);
-        bool ok;
-        int mode = modeStr.toInt(&ok);
-        if (ok) {
-            if (mode != m_currentMode) {
-                m_currentMode = static_cast<uint8_t>(mode);
-                m_currentModeName = modeToString(mode);
-                qDebug() << "KenwoodController: Mode:" << mode << "=" << m_currentModeName;
-                emit modeChanged(m_currentMode, m_currentModeName);
-            }
+    else if (response.hasPrefix('M', 'D') && response.size >= 4) {
+        int mode = static_cast<int>(response.number(2, 1, &ok));
+        if (ok && mode != m_currentMode) {
+            m_currentMode = static_cast<uint8_t>(mode);
+            emit modeChanged(static_cast<uint8_t>(mode), modeToString(mode));
         }
     }
     // SM - S-Meter response (SMnnnn;)
     // Format: SM followed by 4 digits (0000-0030 for Kenwood, 0000-0042 for Elecraft K4)
-    else if (response.startsWith("SM") && response.length() >= 6) {
-        QString smStr = response.mid(2, response.length() - 3);  // Remove "SM" and ";"
-        bool ok;
-        int rawSm = smStr.toInt(&ok);
+    else if (response.hasPrefix('S', 'M') && response.size >= 6) {
+        int rawSm = static_cast<int>(response.number(2, -1, &ok));
         if (ok) {
             // Scale to 0-255 for compatibility with Icom S-meter
             // Kenwood uses 0-30, Elecraft K4 uses 0-42
             // Use 30 as baseline (most common)
             int scaled = qBound(0, rawSm * 255 / 30, 255);
             m_currentSMeter = scaled;
-            emit smeterChanged(scaled);
+            emit smeterChanged(scaled, m_rxArrivalMs);
         }
     }
     // IF - Information response (contains frequency, mode, etc.)
-    else if (response.startsWith("IF") && response.length() >= 38) {
+    // Sent unsolicited by AI1 rigs on every change
+    else if (response.hasPrefix('I', 'F') && response.size >= 38) {
         // IF response format varies by radio, but frequency is typically at positions 2-12
-        QString freqStr = response.mid(2, 11);
-        bool ok;
-        uint64_t freq = freqStr.toULongLong(&ok);
+        uint64_t freq = response.number(2, 11, &ok);
         if (ok && freq > 0 && freq != m_currentFrequencyHz) {
             m_currentFrequencyHz = freq;
-            qDebug() << "KenwoodController: IF Frequency:" << freq << "Hz";
             emit frequencyChanged(freq);
         }
+
+        // Kenwood/Elecraft layout (38 bytes): mode digit at 29
+        if (response.size == 38) {
+            int mode = static_cast<int>(response.number(29, 1, &ok));
+            if (ok && mode != m_currentMode) {
+                m_currentMode = static_cast<uint8_t>(mode);
+                emit modeChanged(static_cast<uint8_t>(mode), modeToString(mode));
+            }
+        }
+    }
+    // AI - Auto-Information state (AIn;)
+    else if (response.hasPrefix('A', 'I')) {
+        int level = static_cast<int>(response.number(2, 1, &ok));
+        if (m_aiLevelTried == '2' && (!ok || level != 2)) {
+            // Rig did not take AI2: try the Yaesu flavour once
+            m_aiLevelTried = '1';
+            sendCommand("AI1;", CatScheduler::Priority::User, false);
+            sendCommand("AI;", CatScheduler::Priority::User);
+        } else if (m_aiLevelTried == '1' && (!ok || level != 1)) {
+            onAiUnsupported();
+        } else {
+            m_aiLevelTried = 0;
+            setAiActive(ok && level > 0 && m_aiEnabled, "rig confirmed AI state");
+        }
     }
     // AC - Antenna tuner response (ACxxx;)
     // Format: AC P1 P2 P3; where P1=RX, P2=TX, P3=tuning
-    else if (response.startsWith("AC") && response.length() >= 5) {
+    else if (response.hasPrefix('A', 'C') && response.size >= 5) {
         // P2 (TX tuner) is the relevant one for "tuner on/off"
-        if (response.length() >= 4) {
-            QChar p2 = response.at(3);  // TX tuner state
-            bool tunerOn = (p2 == '1');
-            qDebug() << "KenwoodController: Tuner state:" << (tunerOn ? "ON" : "OFF");
-            emit tunerStateChanged(tunerOn);
-        }
+        bool tunerOn = (response.text[3] == '1');
+        emit tunerStateChanged(tunerOn);
     }
 }
 
@@ -9,10 +9,15 @@
 #define KENWOODCONTROLLER_H
 
 #include "RadioController.h"
+#include "CatScheduler.h"
+#include "KenwoodParser.h"
 #include <QSerialPort>
 #include <QSerialPortInfo>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QByteArray>
+#include <QMutex>
+#include <atomic>
 
 class KenwoodController : public RadioController
 {
@@ -27,12 +32,16 @@ public:
     void disconnect() override;
     bool isConnected() const override { return m_state == Connected; }
     ConnectionState state() const override { return m_state; }
-    QString lastError() const override { return m_lastError; }
+    QString lastError() const override;
     Protocol protocol() const override { return KenwoodCAT; }
 
     void startPolling(int intervalMs) override;
     void stopPolling() override;
-    bool isPolling() const override { return m_pollTimer && m_pollTimer->isActive(); }
+    bool isPolling() const override { return m_polling; }
+
+    // Auto-Information mode: rig pushes FA/MD/IF changes, only SM is polled
+    void setEventDrivenUpdates(bool enabled) override;
+    bool eventDrivenActive() const override { return m_aiActive; }
 
     void requestFrequency() override;
     void requestMode() override;
@@ -49,7 +58,7 @@ public:
 
     uint64_t currentFrequency() const override { return m_currentFrequencyHz; }
     uint8_t currentMode() const override { return m_currentMode; }
-    QString currentModeName() const override { return m_currentModeName; }
+    QString currentModeName() const override;
     int currentSMeter() const override { return m_currentSMeter; }
     QString radioModel() const override { return QString(); }  // Not supported for Kenwood CAT
 
@@ -59,26 +68,49 @@ private slots:
     void onSerialError(QSerialPort::SerialPortError error);
 
 private:
+    void closePort();  // Teardown shared by disconnect() and the destructor
     void setState(ConnectionState newState);
     void setError(const QString& error);
-    void sendCommand(const QString& cmd);
-    void processResponse(const QString& response);
-    QString modeToString(int mode);
+    void sendCommand(const QString& cmd, CatScheduler::Priority priority, bool coalesce = true);
+    void writeCommand(const QByteArray& data);  // Called by the scheduler
+    static uint32_t commandTag(const QString& text);
+    static uint32_t commandTag(char a, char b);
+    void processResponse(const KenwoodResponse& response);
+    void enableAutoInformation();
+    void setAiActive(bool active, const char* reason);
+    void onAiUnsupported();  // Neither AI2 nor AI1 took: stay on polling
+    static QString modeToString(int mode);
 
     QSerialPort* m_serialPort;
     QTimer* m_pollTimer;
-    QString m_rxBuffer;
-    ConnectionState m_state;
+    KenwoodParser m_parser;
+    std::atomic<ConnectionState> m_state;
+    mutable QMutex m_errorMutex;  // Guards m_lastError (read from the GUI thread)
     QString m_lastError;
 
-    // Cached current state
-    uint64_t m_currentFrequencyHz;
-    uint8_t m_currentMode;
-    QString m_currentModeName;
-    int m_currentSMeter;
+    // Cached current state, written on the I/O thread and read from any thread
+    std::atomic<uint64_t> m_currentFrequencyHz;
+    std::atomic<uint8_t> m_currentMode;
+    std::atomic<int> m_currentSMeter;
+    std::atomic<bool> m_polling{false};
+    qint64 m_rxArrivalMs = 0;     // monotonicMs() of the read being parsed
 
     // Polling state machine
     int m_pollPhase;
+
+    // Auto-Information: AI2 (Kenwood/Elecraft) is tried first, AI1 (Yaesu) if rejected
+    bool m_aiEnabled = true;      // User setting
+    std::atomic<bool> m_aiActive{false};  // Rig confirmed AI on
+    char m_aiLevelTried = 0;      // '2' or '1' while negotiating
+    QElapsedTimer m_lastRxTime;
+    static constexpr int WATCHDOG_MS = 2000;  // Silence before falling back to polling
+
+    // Command scheduling: set commands are silent, reads answer with their own prefix
+    CatScheduler* m_scheduler;
+    static constexpr int MAX_IN_FLIGHT = 2;           // Radio buffers a couple of reads
+    static constexpr int MIN_COMMAND_GAP_MS = 10;
+    static constexpr int RESPONSE_TIMEOUT_MS = 300;
+    static constexpr int USER_COMMAND_RETRIES = 2;
 };
 
 #endif // KENWOODCONTROLLER_H
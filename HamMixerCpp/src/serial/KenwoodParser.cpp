@@ -0,0 +1,116 @@
+/*
+ * KenwoodParser.cpp
+ *
+ * Allocation-free splitter for ASCII CAT responses
+ * Part of HamMixer CT7BAC
+ */
+
+#include "KenwoodParser.h"
+#include <algorithm>
+#include <cstring>
+
+uint64_t KenwoodResponse::number(int offset, int count, bool* ok) const
+{
+    int end = (count < 0) ? size - 1 : std::min(offset + count, size - 1);
+    uint64_t value = 0;
+    bool valid = offset < end;
+
+    for (int i = offset; i < end; i++) {
+        char c = text[i];
+        if (c < '0' || c > '9') {
+            valid = false;
+            break;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+
+    if (ok) *ok = valid;
+    return valid ? value : 0;
+}
+
+char* KenwoodParser::writeRegion(int& space)
+{
+    // Slide the unfinished response to the front; this invalidates views
+    if (m_start > 0) {
+        int remaining = m_end - m_start;
+        if (remaining > 0) {
+            std::memmove(m_buffer, m_buffer + m_start, remaining);
+        }
+        m_scan -= m_start;
+        m_end = remaining;
+        m_start = 0;
+    }
+
+    // A partial response that fills the buffer can never complete
+    if (m_end >= BUFFER_SIZE) {
+        m_droppedBytes += m_end;
+        m_start = m_scan = m_end = 0;
+    }
+
+    space = BUFFER_SIZE - m_end;
+    return m_buffer + m_end;
+}
+
+void KenwoodParser::commitWrite(int bytes)
+{
+    if (bytes > 0) {
+        m_end = std::min(BUFFER_SIZE, m_end + bytes);
+    }
+}
+
+int KenwoodParser::feed(const char* data, int size)
+{
+    int space = 0;
+    char* dst = writeRegion(space);
+    int chunk = std::min(space, size);
+    if (chunk > 0) {
+        std::memcpy(dst, data, chunk);
+        commitWrite(chunk);
+    }
+    return chunk;
+}
+
+void KenwoodParser::reset()
+{
+    m_start = m_scan = m_end = 0;
+    m_discarding = false;
+}
+
+bool KenwoodParser::next(KenwoodResponse& response)
+{
+    while (m_scan < m_end) {
+        char c = m_buffer[m_scan++];
+
+        // Tail of a runaway response: nothing is valid until its ';'
+        if (m_discarding) {
+            m_start = m_scan;
+            m_droppedBytes++;
+            if (c == ';') {
+                m_discarding = false;
+            }
+            continue;
+        }
+
+        // Line noise and stray CR/LF between responses
+        if (m_scan - 1 == m_start && (c == '\r' || c == '\n' || c == ' ')) {
+            m_start = m_scan;
+            m_droppedBytes++;
+            continue;
+        }
+
+        if (c == ';') {
+            response.text = m_buffer + m_start;
+            response.size = m_scan - m_start;
+            m_start = m_scan;
+            return true;
+        }
+
+        if (m_scan - m_start > MAX_RESPONSE) {
+            // Runaway response, resynchronise after the next ';'
+            m_droppedBytes += m_scan - m_start;
+            m_start = m_scan;
+            m_discarding = true;
+        }
+    }
+    return false;
+}
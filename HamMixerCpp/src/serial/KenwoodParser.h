@@ -0,0 +1,74 @@
+/*
+ * KenwoodParser.h
+ *
+ * Allocation-free splitter for ASCII CAT responses
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef KENWOODPARSER_H
+#define KENWOODPARSER_H
+
+#include <cstdint>
+
+/**
+ * @brief View of one ';'-terminated CAT response
+ *
+ * Points into the parser's buffer (terminator included); valid until the
+ * next call to KenwoodParser::writeRegion().
+ */
+struct KenwoodResponse {
+    const char* text = nullptr;
+    int size = 0;
+
+    bool hasPrefix(char a, char b) const { return size >= 3 && text[0] == a && text[1] == b; }
+    bool isError() const { return size >= 2 && text[size - 2] == '?'; }
+
+    /**
+     * @brief Parse decimal digits in place
+     * @param offset First character
+     * @param count Number of characters (-1 = up to the terminator)
+     * @param ok Set false if a non-digit is found or the field is empty
+     */
+    uint64_t number(int offset, int count, bool* ok = nullptr) const;
+};
+
+/**
+ * @brief Splits the serial byte stream into CAT responses without QString
+ *
+ * Bytes are read straight into a fixed linear buffer (writeRegion /
+ * commitWrite). next() scans only the new bytes for ';' and returns a
+ * view; consumed bytes are reclaimed by sliding the partial tail to the
+ * front on the next write.
+ */
+class KenwoodParser
+{
+public:
+    static constexpr int BUFFER_SIZE = 1024;
+    static constexpr int MAX_RESPONSE = 128;  // Longest legal response (IF is 38)
+
+    KenwoodParser() = default;
+
+    char* writeRegion(int& space);
+    void commitWrite(int bytes);
+
+    /**
+     * @brief Copy bytes in (for callers that already have a buffer)
+     * @return Number of bytes accepted; parse with next() before feeding the rest
+     */
+    int feed(const char* data, int size);
+
+    bool next(KenwoodResponse& response);
+    void reset();
+
+    uint64_t droppedBytes() const { return m_droppedBytes; }
+
+private:
+    char m_buffer[BUFFER_SIZE];
+    int m_start = 0;  // First byte of the response being collected
+    int m_scan = 0;   // Next byte to look at
+    int m_end = 0;    // One past the last byte written
+    bool m_discarding = false;  // Dropping a runaway response up to its ';'
+    uint64_t m_droppedBytes = 0;
+};
+
+#endif // KENWOODPARSER_H
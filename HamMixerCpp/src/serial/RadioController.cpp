@@ -1,101 +1,26 @@
 /*
  * RadioController.cpp
  *
- * Auto-detection factory for radio control protocols
+ * Factory for radio control protocols
  * Part of HamMixer CT7BAC
  */
 
 #include "RadioController.h"
 #include "CIVController.h"
 #include "KenwoodController.h"
-#include <QEventLoop>
-#include <QTimer>
-#include <QDebug>
+#include "RigctldController.h"
 
-RadioController* RadioController::detectAndConnect(const QString& port, QObject* parent)
+RadioController* RadioController::create(Protocol protocol, QObject* parent)
 {
-    qDebug() << "RadioController: Auto-detecting radio on port" << port;
-
-    // === Try Icom CI-V first ===
-    QList<int> icomBauds = {57600, 115200};
-    for (int baud : icomBauds) {
-        qDebug() << "RadioController: Trying Icom CI-V at" << baud << "baud...";
-
-        CIVController* icom = new CIVController(parent);
-        if (icom->connect(port, baud)) {
-            // Send frequency request and wait for response
-            icom->requestFrequency();
-
-            QEventLoop loop;
-            QTimer timeout;
-            timeout.setSingleShot(true);
-
-            bool gotResponse = false;
-
-            // Store connection so we can disconnect it before returning
-            QMetaObject::Connection freqConn = QObject::connect(icom, &RadioController::frequencyChanged,
-                [&](uint64_t) { gotResponse = true; loop.quit(); });
-            QObject::connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
-
-            timeout.start(800);  // 800ms timeout
-            loop.exec();
-
-            // CRITICAL: Disconnect the temporary lambda before returning
-            // Otherwise it will crash when frequency changes (dangling reference)
-            QObject::disconnect(freqConn);
-
-            if (gotResponse && icom->currentFrequency() > 0) {
-                qDebug() << "RadioController: Detected Icom CI-V radio at" << baud << "baud";
-                qDebug() << "RadioController: Frequency:" << icom->currentFrequency() << "Hz";
-                return icom;
-            }
-
-            qDebug() << "RadioController: No CI-V response at" << baud << "baud";
-            icom->disconnect();
-        }
-        delete icom;
-    }
-
-    // === Try Kenwood/Elecraft/Yaesu CAT ===
-    QList<int> kenwoodBauds = {38400, 9600, 4800};
-    for (int baud : kenwoodBauds) {
-        qDebug() << "RadioController: Trying Kenwood CAT at" << baud << "baud...";
-
-        KenwoodController* kenwood = new KenwoodController(parent);
-        if (kenwood->connect(port, baud)) {
-            // Send frequency request and wait for response
-            kenwood->requestFrequency();
-
-            QEventLoop loop;
-            QTimer timeout;
-            timeout.setSingleShot(true);
-
-            bool gotResponse = false;
-
-            // Store connection so we can disconnect it before returning
-            QMetaObject::Connection freqConn = QObject::connect(kenwood, &RadioController::frequencyChanged,
-                [&](uint64_t) { gotResponse = true; loop.quit(); });
-            QObject::connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
-
-            timeout.start(800);  // 800ms timeout
-            loop.exec();
-
-            // CRITICAL: Disconnect the temporary lambda before returning
-            // Otherwise it will crash when frequency changes (dangling reference)
-            QObject::disconnect(freqConn);
-
-            if (gotResponse && kenwood->currentFrequency() > 0) {
-                qDebug() << "RadioController: Detected Kenwood/Elecraft/Yaesu CAT radio at" << baud << "baud";
-                qDebug() << "RadioController: Frequency:" << kenwood->currentFrequency() << "Hz";
-                return kenwood;
-            }
-
-            qDebug() << "RadioController: No CAT response at" << baud << "baud";
-            kenwood->disconnect();
-        }
-        delete kenwood;
+    switch (protocol) {
+        case IcomCIV:
+            return new CIVController(parent);
+        case KenwoodCAT:
+            return new KenwoodController(parent);
+        case HamlibRigctld:
+            return new RigctldController(parent);
+        case Unknown:
+            break;
     }
-
-    qDebug() << "RadioController: No compatible radio detected on port" << port;
     return nullptr;
 }
@@ -2,7 +2,7 @@
  * RadioController.h
  *
  * Abstract interface for radio control protocols
- * Supports Icom CI-V and Kenwood/Elecraft/Yaesu CAT
+ * Supports Icom CI-V, Kenwood/Elecraft/Yaesu CAT and Hamlib rigctld
  * Part of HamMixer CT7BAC
  */
 
@@ -11,8 +11,20 @@
 
 #include <QObject>
 #include <QString>
+#include <QByteArray>
+#include <QThread>
+#include <QMetaObject>
+#include <QElapsedTimer>
 #include <cstdint>
+#include <utility>
 
+/*
+ * Controllers normally live on a dedicated serial I/O thread (see
+ * RadioDetector::setIoThread), away from GUI repaints. Public commands may
+ * be called from any thread and are re-posted to the controller's thread;
+ * connect()/disconnect() block until done. Cached values are atomics, and
+ * signals reach GUI receivers as queued connections.
+ */
 class RadioController : public QObject
 {
     Q_OBJECT
@@ -29,7 +41,8 @@ public:
     enum Protocol {
         Unknown,
         IcomCIV,
-        KenwoodCAT
+        KenwoodCAT,
+        HamlibRigctld   // Network client; not probed by RadioDetector
     };
     Q_ENUM(Protocol)
 
@@ -49,6 +62,17 @@ public:
     virtual void stopPolling() = 0;
     virtual bool isPolling() const = 0;
 
+    // Event-driven updates (CI-V transceive, CAT auto-information).
+    // When enabled and the radio reports changes on its own, frequency and
+    // mode are taken from those reports and only the meters are polled.
+    virtual void setEventDrivenUpdates(bool enabled) { Q_UNUSED(enabled); }
+    virtual bool eventDrivenActive() const { return false; }
+
+    // Spectrum scope streamed by the radio (Icom CI-V 0x27); sweeps arrive
+    // through scopeLineReady() while enabled
+    virtual bool supportsScope() const { return false; }
+    virtual void setScopeEnabled(bool enabled) { Q_UNUSED(enabled); }
+
     // Manual queries (results come via signals)
     virtual void requestFrequency() = 0;
     virtual void requestMode() = 0;
@@ -70,18 +94,51 @@ public:
     virtual int currentSMeter() const = 0;
     virtual QString radioModel() const = 0;
 
-    // Static factory with auto-detection
-    static RadioController* detectAndConnect(const QString& port, QObject* parent);
+    // Static factory (see RadioDetector for auto-detection)
+    static RadioController* create(Protocol protocol, QObject* parent);
+
+    // Timestamp on the QElapsedTimer reference clock, comparable across threads
+    // (subtract another timer's msecsSinceReference() to rebase it)
+    static qint64 monotonicMs()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        return timer.msecsSinceReference();
+    }
 
 signals:
     void connectionStateChanged(RadioController::ConnectionState state);
     void frequencyChanged(uint64_t frequencyHz);
     void modeChanged(uint8_t mode, const QString& modeName);
-    void smeterChanged(int value);  // 0-255 scale
+    void smeterChanged(int value, qint64 arrivalMs);  // 0-255 scale; arrivalMs from monotonicMs() at byte arrival
     void txStatusChanged(bool transmitting);  // TX/RX state
     void tunerStateChanged(bool enabled);  // Tuner on/off state
     void errorOccurred(const QString& error);
     void radioModelDetected(const QString& modelName);
+    void scopeLineReady(const QByteArray& amplitudes, uint64_t lowHz, uint64_t highHz);  // 0-160 levels
+
+protected:
+    // Called off the controller's thread: queue fn there and return true
+    template <typename Fn>
+    bool postToOwnThread(Fn&& fn)
+    {
+        if (QThread::currentThread() == thread()) {
+            return false;
+        }
+        QMetaObject::invokeMethod(this, std::forward<Fn>(fn), Qt::QueuedConnection);
+        return true;
+    }
+
+    // Same, but wait for fn to finish (for calls that return a result)
+    template <typename Fn>
+    bool runOnOwnThread(Fn&& fn)
+    {
+        if (QThread::currentThread() == thread()) {
+            return false;
+        }
+        QMetaObject::invokeMethod(this, std::forward<Fn>(fn), Qt::BlockingQueuedConnection);
+        return true;
+    }
 };
 
 #endif // RADIOCONTROLLER_H
@@ -0,0 +1,220 @@
+/*
+ * RadioDetector.cpp
+ *
+ * Asynchronous radio protocol/baud rate auto-detection
+ * Part of HamMixer CT7BAC
+ */
+
+#include "RadioDetector.h"
+#include "CIVProtocol.h"
+#include "CIVController.h"
+#include <QDebug>
+
+RadioDetector::RadioDetector(QObject* parent)
+    : QObject(parent)
+{
+    m_timeout.setSingleShot(true);
+    connect(&m_timeout, &QTimer::timeout, this, &RadioDetector::onProbeTimeout);
+}
+
+RadioDetector::~RadioDetector()
+{
+    closeProbePort();
+}
+
+void RadioDetector::start(const QString& port, const Result& hint)
+{
+    cancel();
+
+    m_port = port;
+    m_hint = hint;
+
+    // Icom rates first (most common USB defaults), then Kenwood/Elecraft/Yaesu
+    m_baudRates = {57600, 115200, 38400, 19200, 9600, 4800};
+    if (hint.isValid()) {
+        m_baudRates.removeAll(hint.baudRate);
+        m_baudRates.prepend(hint.baudRate);
+    }
+
+    m_attempt = 0;
+    m_total = m_baudRates.size();
+    m_running = true;
+
+    qDebug() << "RadioDetector: Auto-detecting radio on port" << port
+             << (hint.isValid() ? QString("(last seen at %1 baud)").arg(hint.baudRate) : QString());
+    probeNext();
+}
+
+void RadioDetector::cancel()
+{
+    m_timeout.stop();
+    closeProbePort();
+    m_baudRates.clear();
+    m_running = false;
+}
+
+void RadioDetector::probeNext()
+{
+    closeProbePort();
+
+    if (m_baudRates.isEmpty()) {
+        m_running = false;
+        qDebug() << "RadioDetector: No compatible radio detected on port" << m_port;
+        emit failed(QString("No compatible radio detected on %1").arg(m_port));
+        return;
+    }
+
+    m_probeBaud = m_baudRates.takeFirst();
+    m_attempt++;
+    emit progress(QString("Probing %1 at %2 baud...").arg(m_port).arg(m_probeBaud),
+                  m_attempt, m_total);
+
+    m_probePort = new QSerialPort(this);
+    m_probePort->setPortName(m_port);
+    m_probePort->setBaudRate(m_probeBaud);
+    m_probePort->setDataBits(QSerialPort::Data8);
+    m_probePort->setParity(QSerialPort::NoParity);
+    m_probePort->setStopBits(QSerialPort::OneStop);
+    m_probePort->setFlowControl(QSerialPort::NoFlowControl);
+
+    if (!m_probePort->open(QIODevice::ReadWrite)) {
+        QString error = m_probePort->errorString();
+        delete m_probePort;
+        m_probePort = nullptr;
+        m_baudRates.clear();
+        m_running = false;
+        qWarning() << "RadioDetector: Failed to open port" << m_port << ":" << error;
+        emit failed(QString("Failed to open port %1: %2").arg(m_port, error));
+        return;
+    }
+
+    connect(m_probePort, &QSerialPort::readyRead, this, &RadioDetector::onReadyRead);
+
+    m_probePort->clear();
+    m_civParser.reset();
+    m_catParser.reset();
+
+    // One write carries both probes; each protocol ignores the other's. At
+    // the last known rate the radio last seen here is asked by its address
+    // first (the default-addressed frame still finds a different radio)
+    QByteArray probe;
+    if (m_hint.protocol == RadioController::IcomCIV && m_hint.civAddress != 0
+        && m_probeBaud == m_hint.baudRate) {
+        probe = CIVProtocol::buildFrame(m_hint.civAddress, CIVProtocol::ADDR_CONTROLLER,
+                                        QByteArray(1, static_cast<char>(CIVProtocol::CMD_READ_FREQ)));
+    }
+    QByteArray civProbe = CIVProtocol::buildCommand(CIVProtocol::CMD_READ_FREQ);
+    if (probe != civProbe) {
+        probe.append(civProbe);
+    }
+    probe.append("FA;");
+    m_probePort->write(probe);
+
+    m_timeout.start(PROBE_TIMEOUT_MS);
+}
+
+void RadioDetector::closeProbePort()
+{
+    if (!m_probePort) {
+        return;
+    }
+    // Close now so the controller can open the port; delete later because
+    // this may run inside the port's own readyRead
+    m_probePort->disconnect(this);
+    if (m_probePort->isOpen()) {
+        m_probePort->close();
+    }
+    m_probePort->deleteLater();
+    m_probePort = nullptr;
+}
+
+void RadioDetector::onReadyRead()
+{
+    if (!m_probePort) return;
+
+    // Probe replies are a few dozen bytes; anything beyond the parser
+    // buffers is noise at the wrong baud rate and can be dropped
+    QByteArray data = m_probePort->readAll();
+    m_civParser.feed(reinterpret_cast<const uint8_t*>(data.constData()), static_cast<int>(data.size()));
+    m_catParser.feed(data.constData(), static_cast<int>(data.size()));
+
+    Result result;
+    if (classify(result)) {
+        finish(result);
+    }
+}
+
+void RadioDetector::onProbeTimeout()
+{
+    qDebug() << "RadioDetector: No response at" << m_probeBaud << "baud";
+    probeNext();
+}
+
+bool RadioDetector::classify(Result& result)
+{
+    // Icom: a frequency reply addressed to us (our own echo is addressed to the radio)
+    CIVFrame frame;
+    while (m_civParser.next(frame)) {
+        if (frame.dest == CIVProtocol::ADDR_CONTROLLER &&
+            frame.command == CIVProtocol::CMD_READ_FREQ &&
+            CIVProtocol::isKnownAddress(frame.source)) {
+            result.protocol = RadioController::IcomCIV;
+            result.baudRate = m_probeBaud;
+            result.civAddress = frame.source;
+            result.frequencyHz = CIVProtocol::parseFrequency(frame.data, frame.dataSize);
+            return result.frequencyHz > 0;
+        }
+    }
+
+    // Kenwood/Elecraft/Yaesu: "FAnnnnnnnnnnn;"
+    KenwoodResponse response;
+    while (m_catParser.next(response)) {
+        if (response.hasPrefix('F', 'A')) {
+            bool ok = false;
+            uint64_t freq = response.number(2, -1, &ok);
+            if (ok && freq > 0) {
+                result.protocol = RadioController::KenwoodCAT;
+                result.baudRate = m_probeBaud;
+                result.frequencyHz = freq;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void RadioDetector::finish(const Result& result)
+{
+    m_timeout.stop();
+    closeProbePort();
+    m_baudRates.clear();
+    m_running = false;
+
+    qDebug() << "RadioDetector: Detected"
+             << (result.protocol == RadioController::IcomCIV ? "Icom CI-V" : "Kenwood/Elecraft/Yaesu CAT")
+             << "radio at" << result.baudRate << "baud, frequency" << result.frequencyHz << "Hz";
+
+    // Objects with a parent cannot change threads
+    RadioController* controller = RadioController::create(result.protocol, m_ioThread ? nullptr : parent());
+    if (!controller) {
+        emit failed("Unsupported protocol");
+        return;
+    }
+    if (m_ioThread) {
+        controller->moveToThread(m_ioThread);
+    }
+    if (auto* civ = qobject_cast<CIVController*>(controller)) {
+        civ->setRadioAddress(result.civAddress);
+    }
+
+    // Opens the port on the controller's thread and waits for the result
+    if (!controller->connect(m_port, result.baudRate)) {
+        QString error = controller->lastError();
+        controller->deleteLater();
+        emit failed(error);
+        return;
+    }
+
+    emit detected(controller, result);
+}
@@ -0,0 +1,124 @@
+/*
+ * RadioDetector.h
+ *
+ * Asynchronous radio protocol/baud rate auto-detection
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef RADIODETECTOR_H
+#define RADIODETECTOR_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QTimer>
+#include <QSerialPort>
+#include <QThread>
+#include <cstdint>
+
+#include "RadioController.h"
+#include "CIVParser.h"
+#include "KenwoodParser.h"
+
+/**
+ * @brief Finds the radio protocol and baud rate on a serial port without blocking
+ *
+ * Each baud rate is probed once with a CI-V "read frequency" frame and a
+ * Kenwood "FA;" sent back to back: an Icom radio ignores the ASCII and a
+ * CAT radio answers the binary frame with "?;" at worst, so the reply
+ * tells both protocols apart in a single round trip. A known-good result
+ * for the port (from a previous session) is probed first, addressed to
+ * the radio it found, so a reconnect normally completes in one probe. The
+ * CI-V address found is handed to the controller.
+ *
+ * Progress is reported through signals; the event loop keeps running
+ * while probes are outstanding.
+ */
+class RadioDetector : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Result {
+        RadioController::Protocol protocol = RadioController::Unknown;
+        int baudRate = 0;
+        uint8_t civAddress = 0;     // Source address of the CI-V reply
+        uint64_t frequencyHz = 0;   // Frequency from the probe reply
+
+        bool isValid() const { return protocol != RadioController::Unknown && baudRate > 0; }
+    };
+
+    explicit RadioDetector(QObject* parent = nullptr);
+    ~RadioDetector() override;
+
+    /**
+     * @brief Start probing a port
+     * @param port Serial port name
+     * @param hint Previous result for this port (probed first if valid)
+     */
+    void start(const QString& port, const Result& hint = Result());
+
+    /**
+     * @brief Abort detection and release the port
+     */
+    void cancel();
+
+    /**
+     * @brief Thread the detected controller is moved to (nullptr = caller's thread)
+     */
+    void setIoThread(QThread* thread) { m_ioThread = thread; }
+
+    bool isRunning() const { return m_running; }
+    QString port() const { return m_port; }
+
+signals:
+    /**
+     * @brief A probe is starting
+     * @param message Human-readable description ("Probing 57600 baud...")
+     * @param attempt 1-based probe number
+     * @param total Number of probes planned
+     */
+    void progress(const QString& message, int attempt, int total);
+
+    /**
+     * @brief A radio answered; the controller is connected and owned by the receiver
+     *
+     * With an I/O thread set the controller has no parent and lives on that
+     * thread: release it with disconnect() and deleteLater().
+     */
+    void detected(RadioController* controller, const RadioDetector::Result& result);
+
+    /**
+     * @brief No radio answered on any baud rate
+     */
+    void failed(const QString& reason);
+
+private slots:
+    void onReadyRead();
+    void onProbeTimeout();
+
+private:
+    void probeNext();
+    void closeProbePort();
+    bool classify(Result& result);
+    void finish(const Result& result);
+
+    static constexpr int PROBE_TIMEOUT_MS = 500;   // Slowest radios answer in ~100 ms at 4800 baud
+
+    QString m_port;
+    QList<int> m_baudRates;       // Remaining probes, in order
+    int m_attempt = 0;
+    int m_total = 0;
+    bool m_running = false;
+    QThread* m_ioThread = nullptr;
+
+    QSerialPort* m_probePort = nullptr;
+    int m_probeBaud = 0;
+    Result m_hint;
+    QTimer m_timeout;
+
+    CIVParser m_civParser;
+    KenwoodParser m_catParser;
+};
+
+#endif // RADIODETECTOR_H
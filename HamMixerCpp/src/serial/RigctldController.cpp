@@ -0,0 +1,630 @@
+/*
+ * RigctldController.cpp
+ *
+ * Hamlib rigctld (NET rigctl) client implementation
+ * Part of HamMixer CT7BAC
+ */
+
+#include "RigctldController.h"
+#include "CIVProtocol.h"
+#include <QDebug>
+#include <cmath>
+
+RigctldController::RigctldController(QObject* parent)
+    : RadioController(parent)
+    , m_socket(nullptr)
+    , m_pollTimer(nullptr)
+    , m_reconnectTimer(nullptr)
+    , m_port(DEFAULT_TCP_PORT)
+    , m_state(Disconnected)
+    , m_currentFrequencyHz(0)
+    , m_currentMode(0xFF)
+    , m_currentSMeter(0)
+    , m_pollPhase(0)
+{
+    m_scheduler = new CatScheduler([this](const QByteArray& data) { writeCommand(data); },
+                                   MAX_IN_FLIGHT, MIN_COMMAND_GAP_MS, RESPONSE_TIMEOUT_MS, this);
+}
+
+RigctldController::~RigctldController()
+{
+    // Deleted on the I/O thread (deleteLater()) or once it has stopped, so
+    // tear down in place: a blocking call into a stopped thread never returns
+    Q_ASSERT(QThread::currentThread() == thread() || !thread()->isRunning());
+    closeSocket();
+}
+
+bool RigctldController::parseAddress(const QString& address, QString& host, quint16& port)
+{
+    QString text = address.trimmed();
+    port = DEFAULT_TCP_PORT;
+
+    // "[::1]:4532" for IPv6 literals, "host:4532" or plain "host" otherwise
+    int colon = text.lastIndexOf(':');
+    bool hasPort = colon > 0 && (text.startsWith('[') ? text.at(colon - 1) == ']'
+                                                       : text.indexOf(':') == colon);
+    if (hasPort) {
+        bool ok = false;
+        int value = text.mid(colon + 1).toInt(&ok);
+        if (!ok || value <= 0 || value > 65535) {
+            return false;
+        }
+        port = static_cast<quint16>(value);
+        text = text.left(colon);
+    }
+    if (text.startsWith('[') && text.endsWith(']')) {
+        text = text.mid(1, text.length() - 2);
+    }
+
+    host = text;
+    return !host.isEmpty();
+}
+
+bool RigctldController::connect(const QString& address, int baudRate)
+{
+    Q_UNUSED(baudRate);  // rigctld owns the serial line
+
+    // The socket must be created on the I/O thread so its notifiers live there
+    bool opened = false;
+    if (runOnOwnThread([&] { opened = connect(address, baudRate); })) {
+        return opened;
+    }
+
+    if (m_socket) {
+        disconnect();
+    }
+
+    if (!parseAddress(address, m_host, m_port)) {
+        setError(QString("Invalid rigctld address \"%1\" (expected host:port)").arg(address));
+        setState(Error);
+        return false;
+    }
+
+    setState(Connecting);
+
+    m_socket = new QTcpSocket(this);
+    m_socket->connectToHost(m_host, m_port);
+    if (!m_socket->waitForConnected(CONNECT_TIMEOUT_MS)) {
+        setError(QString("Failed to connect to rigctld at %1:%2: %3")
+                 .arg(m_host)
+                 .arg(m_port)
+                 .arg(m_socket->errorString()));
+        delete m_socket;
+        m_socket = nullptr;
+        setState(Error);
+        return false;
+    }
+
+    // Small requests must not wait for Nagle: replies gate the pipeline
+    m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_socket->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
+
+    QObject::connect(m_socket, &QTcpSocket::readyRead,
+                     this, &RigctldController::onReadyRead);
+    QObject::connect(m_socket, &QTcpSocket::connected,
+                     this, &RigctldController::onSocketConnected);
+    QObject::connect(m_socket, &QTcpSocket::disconnected,
+                     this, &RigctldController::onSocketDisconnected);
+    QObject::connect(m_socket, &QTcpSocket::errorOccurred,
+                     this, &RigctldController::onSocketError);
+
+    if (!m_reconnectTimer) {
+        m_reconnectTimer = new QTimer(this);
+        m_reconnectTimer->setSingleShot(true);
+        QObject::connect(m_reconnectTimer, &QTimer::timeout,
+                         this, &RigctldController::onReconnectTimer);
+    }
+
+    m_keepConnected = true;
+    m_rxBuffer.clear();
+    resetReply();
+
+    qDebug() << "RigctldController: Connected to" << m_host << "port" << m_port;
+    setState(Connected);
+
+    return true;
+}
+
+void RigctldController::disconnect()
+{
+    if (runOnOwnThread([this] { disconnect(); })) {
+        return;
+    }
+
+    if (m_socket) {
+        m_scheduler->logStatistics("RigctldController");
+    }
+    closeSocket();
+
+    setState(Disconnected);
+    qDebug() << "RigctldController: Disconnected";
+}
+
+void RigctldController::closeSocket()
+{
+    // On the owner thread already: no reconnect, no polling, no pending commands
+    m_keepConnected = false;
+    m_polling = false;
+    if (m_pollTimer) {
+        m_pollTimer->stop();
+    }
+    if (m_reconnectTimer) {
+        m_reconnectTimer->stop();
+    }
+    m_scheduler->clear();
+
+    if (m_socket) {
+        QObject::disconnect(m_socket, nullptr, this, nullptr);
+        m_socket->abort();
+        delete m_socket;
+        m_socket = nullptr;
+    }
+
+    m_rxBuffer.clear();
+    resetReply();
+}
+
+void RigctldController::startPolling(int intervalMs)
+{
+    if (postToOwnThread([this, intervalMs] { startPolling(intervalMs); })) {
+        return;
+    }
+
+    if (!m_socket) {
+        qWarning() << "RigctldController: Cannot start polling - not connected";
+        return;
+    }
+
+    if (!m_pollTimer) {
+        m_pollTimer = new QTimer(this);
+        QObject::connect(m_pollTimer, &QTimer::timeout,
+                         this, &RigctldController::onPollTimer);
+    }
+
+    m_pollPhase = 0;
+    m_pollTimer->start(intervalMs);
+    m_polling = true;
+    qDebug() << "RigctldController: Started polling at" << intervalMs << "ms interval";
+}
+
+void RigctldController::stopPolling()
+{
+    if (postToOwnThread([this] { stopPolling(); })) {
+        return;
+    }
+
+    m_polling = false;
+    if (m_pollTimer) {
+        m_pollTimer->stop();
+        qDebug() << "RigctldController: Stopped polling";
+    }
+}
+
+void RigctldController::requestFrequency()
+{
+    if (postToOwnThread([this] { requestFrequency(); })) {
+        return;
+    }
+
+    sendCommand("get_freq", CatScheduler::Priority::Poll);
+}
+
+void RigctldController::requestMode()
+{
+    if (postToOwnThread([this] { requestMode(); })) {
+        return;
+    }
+
+    sendCommand("get_mode", CatScheduler::Priority::Poll);
+}
+
+void RigctldController::requestSMeter()
+{
+    if (postToOwnThread([this] { requestSMeter(); })) {
+        return;
+    }
+
+    sendCommand("get_level STRENGTH", CatScheduler::Priority::Meter);
+}
+
+void RigctldController::requestTunerState()
+{
+    if (postToOwnThread([this] { requestTunerState(); })) {
+        return;
+    }
+
+    sendCommand("get_func TUNER", CatScheduler::Priority::User);
+}
+
+void RigctldController::setFrequency(uint64_t frequencyHz)
+{
+    if (postToOwnThread([this, frequencyHz] { setFrequency(frequencyHz); })) {
+        return;
+    }
+
+    sendCommand("set_freq " + QByteArray::number(static_cast<qulonglong>(frequencyHz)),
+                CatScheduler::Priority::User);
+}
+
+void RigctldController::setMode(uint8_t mode)
+{
+    if (postToOwnThread([this, mode] { setMode(mode); })) {
+        return;
+    }
+
+    QByteArray name = modeToHamlib(mode);
+    if (name.isEmpty()) {
+        qWarning() << "RigctldController: No Hamlib mode for CI-V mode" << static_cast<int>(mode);
+        return;
+    }
+
+    // Passband 0 = the rig's default filter for the mode
+    sendCommand("set_mode " + name + " 0", CatScheduler::Priority::User);
+}
+
+void RigctldController::setTunerState(bool enabled)
+{
+    if (postToOwnThread([this, enabled] { setTunerState(enabled); })) {
+        return;
+    }
+
+    sendCommand(enabled ? "set_func TUNER 1" : "set_func TUNER 0", CatScheduler::Priority::User);
+}
+
+void RigctldController::startTune()
+{
+    if (postToOwnThread([this] { startTune(); })) {
+        return;
+    }
+
+    sendCommand("vfo_op TUNE", CatScheduler::Priority::User, false);
+}
+
+void RigctldController::playVoiceMemory(int memoryNumber)
+{
+    if (postToOwnThread([this, memoryNumber] { playVoiceMemory(memoryNumber); })) {
+        return;
+    }
+
+    if (memoryNumber < 1 || memoryNumber > 8) {
+        qWarning() << "RigctldController: Invalid voice memory number:" << memoryNumber;
+        return;
+    }
+
+    // Hamlib 4.5+; older daemons answer RPRT -4 (not implemented)
+    sendCommand("send_voice_mem " + QByteArray::number(memoryNumber),
+                CatScheduler::Priority::User, false);
+}
+
+void RigctldController::stopVoiceMemory()
+{
+    if (postToOwnThread([this] { stopVoiceMemory(); })) {
+        return;
+    }
+
+    sendCommand("stop_voice_mem", CatScheduler::Priority::User, false);
+}
+
+void RigctldController::onReadyRead()
+{
+    if (!m_socket) return;
+
+    // Stamp meter samples with the time the bytes arrived
+    m_rxArrivalMs = monotonicMs();
+    m_rxBuffer.append(m_socket->readAll());
+
+    // Handle complete lines; a partial line waits for the next read
+    int start = 0;
+    while (true) {
+        int end = m_rxBuffer.indexOf('\n', start);
+        if (end < 0) break;
+        int length = end - start;
+        if (length > 0 && m_rxBuffer.at(end - 1) == '\r') {
+            length--;
+        }
+        processLine(m_rxBuffer.mid(start, length));
+        start = end + 1;
+    }
+    m_rxBuffer.remove(0, start);
+
+    if (m_rxBuffer.size() > MAX_LINE_LENGTH) {
+        qWarning() << "RigctldController: Discarding overlong line - is this really rigctld?";
+        m_rxBuffer.clear();
+        resetReply();
+    }
+}
+
+void RigctldController::processLine(const QByteArray& line)
+{
+    if (line.isEmpty()) {
+        return;
+    }
+
+    // "RPRT n" closes every extended reply (n = 0 or a negative Hamlib error)
+    if (line.startsWith("RPRT ")) {
+        processReply(line.mid(5).trimmed().toInt());
+        return;
+    }
+
+    int colon = line.indexOf(':');
+    if (!m_inReply) {
+        // Header: "get_freq:", "set_freq: 14074000", "get_level: STRENGTH"
+        m_replyCommand = (colon > 0) ? line.left(colon) : line;
+        m_inReply = true;
+    } else if (colon > 0) {
+        // Value: "Frequency: 14074000", "Mode: USB", "Level Value: -54"
+        m_replyValues.append(line.mid(colon + 1).trimmed());
+    }
+}
+
+void RigctldController::processReply(int result)
+{
+    bool ok = (result == 0);
+    uint32_t tag = m_inReply ? replyTag(m_replyCommand) : TagNone;
+
+    // A bare "RPRT n" (unknown command, protocol error) names nothing
+    if (tag == TagNone) {
+        if (!ok) {
+            m_scheduler->onUntaggedError();
+            qWarning() << "RigctldController: Command error: RPRT" << result;
+        }
+        resetReply();
+        return;
+    }
+
+    m_scheduler->onResponse(tag, ok);
+
+    if (!ok) {
+        qWarning().noquote() << "RigctldController:" << QString::fromLatin1(m_replyCommand)
+                             << "failed: RPRT" << result;
+        resetReply();
+        return;
+    }
+
+    const QByteArray value = m_replyValues.value(0);
+
+    switch (tag) {
+        case TagGetFreq: {
+            // Printed as "%.0f" by rigctld; tolerate a fractional part
+            bool parsed = false;
+            double hz = value.toDouble(&parsed);
+            if (parsed && hz > 0) {
+                uint64_t freq = static_cast<uint64_t>(std::llround(hz));
+                if (freq != m_currentFrequencyHz) {
+                    m_currentFrequencyHz = freq;
+                    emit frequencyChanged(freq);
+                }
+            }
+            break;
+        }
+        case TagGetMode: {
+            uint8_t mode = modeFromHamlib(value);
+            if (mode != 0xFF && mode != m_currentMode) {
+                m_currentMode = mode;
+                emit modeChanged(mode, CIVProtocol::modeToString(mode));
+            }
+            break;
+        }
+        case TagGetLevel: {
+            bool parsed = false;
+            double db = value.toDouble(&parsed);
+            if (parsed) {
+                int scaled = strengthToSMeter(static_cast<int>(std::lround(db)));
+                m_currentSMeter = scaled;
+                emit smeterChanged(scaled, m_rxArrivalMs);
+            }
+            break;
+        }
+        case TagGetFunc:
+            emit tunerStateChanged(value.trimmed() == "1");
+            break;
+        default:
+            break;
+    }
+
+    resetReply();
+}
+
+void RigctldController::resetReply()
+{
+    m_replyCommand.clear();
+    m_replyValues.clear();
+    m_inReply = false;
+}
+
+void RigctldController::onPollTimer()
+{
+    if (!m_socket || m_state != Connected) {
+        // Reconnecting: polling resumes by itself once the link is back
+        return;
+    }
+
+    // Polling pattern (same cadence as the serial controllers):
+    // every tick S-meter, frequency on phase 0, mode on phase 2
+    requestSMeter();
+
+    if (m_pollPhase % 5 == 0) {
+        requestFrequency();
+    }
+
+    if (m_pollPhase % 5 == 2) {
+        requestMode();
+    }
+
+    m_pollPhase = (m_pollPhase + 1) % 10;
+}
+
+void RigctldController::onSocketConnected()
+{
+    qDebug() << "RigctldController: Reconnected to" << m_host << "port" << m_port;
+    m_rxBuffer.clear();
+    resetReply();
+    setState(Connected);
+
+    // Whatever changed while we were away
+    requestFrequency();
+    requestMode();
+}
+
+void RigctldController::onSocketDisconnected()
+{
+    if (!m_keepConnected) {
+        return;
+    }
+
+    qWarning() << "RigctldController: Connection to rigctld lost";
+    scheduleReconnect();
+}
+
+void RigctldController::onSocketError(QAbstractSocket::SocketError error)
+{
+    // RemoteHostClosedError is followed by disconnected(); reconnect from there
+    if (error == QAbstractSocket::RemoteHostClosedError || !m_socket) {
+        return;
+    }
+
+    setError(QString("rigctld: %1").arg(m_socket->errorString()));
+    qWarning() << "RigctldController: Socket error -" << m_socket->errorString();
+
+    // A failed reconnect attempt never reaches disconnected()
+    if (m_keepConnected && m_socket->state() == QAbstractSocket::UnconnectedState) {
+        scheduleReconnect();
+    }
+}
+
+void RigctldController::scheduleReconnect()
+{
+    // In-flight requests died with the connection
+    m_scheduler->clear();
+    m_rxBuffer.clear();
+    resetReply();
+    setState(Connecting);
+
+    if (m_reconnectTimer && !m_reconnectTimer->isActive()) {
+        m_reconnectTimer->start(RECONNECT_INTERVAL_MS);
+    }
+}
+
+void RigctldController::onReconnectTimer()
+{
+    if (!m_keepConnected || !m_socket) {
+        return;
+    }
+
+    if (m_socket->state() == QAbstractSocket::UnconnectedState) {
+        m_socket->connectToHost(m_host, m_port);
+    }
+}
+
+void RigctldController::setState(ConnectionState newState)
+{
+    if (m_state != newState) {
+        m_state = newState;
+        emit connectionStateChanged(newState);
+    }
+}
+
+void RigctldController::setError(const QString& error)
+{
+    {
+        QMutexLocker lock(&m_errorMutex);
+        m_lastError = error;
+    }
+    emit errorOccurred(error);
+}
+
+QString RigctldController::lastError() const
+{
+    QMutexLocker lock(&m_errorMutex);
+    return m_lastError;
+}
+
+QString RigctldController::currentModeName() const
+{
+    uint8_t mode = m_currentMode;
+    return (mode == 0xFF) ? QString("---") : CIVProtocol::modeToString(mode);
+}
+
+void RigctldController::sendCommand(const QByteArray& command, CatScheduler::Priority priority, bool coalesce)
+{
+    if (!m_socket || m_state != Connected) {
+        return;
+    }
+
+    // Every extended reply starts with the command name, reads and sets alike
+    QByteArray name = command.left(command.indexOf(' '));
+
+    CatScheduler::Command cmd;
+    cmd.data = "+\\" + command + "\n";
+    cmd.name = QString::fromLatin1(name);
+    cmd.priority = priority;
+    cmd.responseTag = replyTag(name);
+    cmd.coalesce = coalesce;
+    cmd.retries = (priority == CatScheduler::Priority::User) ? USER_COMMAND_RETRIES : 0;
+    m_scheduler->enqueue(cmd);
+}
+
+void RigctldController::writeCommand(const QByteArray& data)
+{
+    if (!m_socket || m_socket->state() != QAbstractSocket::ConnectedState) {
+        return;
+    }
+    m_socket->write(data);
+}
+
+uint32_t RigctldController::replyTag(const QByteArray& commandName)
+{
+    if (commandName == "get_freq") return TagGetFreq;
+    if (commandName == "get_mode") return TagGetMode;
+    if (commandName == "get_level") return TagGetLevel;
+    if (commandName == "get_func") return TagGetFunc;
+    if (commandName == "set_freq") return TagSetFreq;
+    if (commandName == "set_mode") return TagSetMode;
+    if (commandName == "set_func") return TagSetFunc;
+    if (commandName == "vfo_op") return TagVfoOp;
+    if (commandName == "send_voice_mem") return TagSendVoiceMem;
+    if (commandName == "stop_voice_mem") return TagStopVoiceMem;
+    return TagNone;
+}
+
+uint8_t RigctldController::modeFromHamlib(const QByteArray& name)
+{
+    using namespace CIVProtocol;
+
+    if (name == "USB" || name == "PKTUSB" || name == "ECSSUSB") return MODE_USB;
+    if (name == "LSB" || name == "PKTLSB" || name == "ECSSLSB") return MODE_LSB;
+    if (name == "CW") return MODE_CW;
+    if (name == "CWR") return MODE_CW_R;
+    if (name == "RTTY") return MODE_RTTY;
+    if (name == "RTTYR") return MODE_RTTY_R;
+    if (name == "AM" || name == "AMS" || name == "SAM") return MODE_AM;
+    if (name == "FM" || name == "FMN" || name == "PKTFM") return MODE_FM;
+    if (name == "WFM") return MODE_WFM;
+    return 0xFF;
+}
+
+QByteArray RigctldController::modeToHamlib(uint8_t civMode)
+{
+    using namespace CIVProtocol;
+
+    switch (civMode) {
+        case MODE_LSB:    return "LSB";
+        case MODE_USB:    return "USB";
+        case MODE_AM:     return "AM";
+        case MODE_CW:     return "CW";
+        case MODE_RTTY:   return "RTTY";
+        case MODE_FM:     return "FM";
+        case MODE_WFM:    return "WFM";
+        case MODE_CW_R:   return "CWR";
+        case MODE_RTTY_R: return "RTTYR";
+        default:          return QByteArray();
+    }
+}
+
+int RigctldController::strengthToSMeter(int dbOverS9)
+{
+    // Icom scale (see CIVProtocol::smeterToDb): 0 = S0 (S9-54 dB), 120 = S9, 241 = S9+60 dB
+    int raw = (dbOverS9 <= 0) ? (dbOverS9 + 54) * 120 / 54
+                              : 120 + dbOverS9 * 121 / 60;
+    return qBound(0, raw, 255);
+}
@@ -0,0 +1,171 @@
+/*
+ * RigctldController.h
+ *
+ * Hamlib rigctld (NET rigctl) client, for radios shared with other software
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef RIGCTLDCONTROLLER_H
+#define RIGCTLDCONTROLLER_H
+
+#include "RadioController.h"
+#include "CatScheduler.h"
+#include <QTcpSocket>
+#include <QTimer>
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <atomic>
+
+/**
+ * @brief Radio control through a rigctld daemon over TCP
+ *
+ * rigctld owns the serial port and multiplexes it between clients (loggers,
+ * digital-mode software), so HamMixer no longer needs the port to itself.
+ * Commands use the extended response protocol ("+\get_freq"): every reply
+ * names the command it answers and ends with "RPRT n", which lets several
+ * requests be pipelined on the connection. The connection is kept open and
+ * re-established in the background if rigctld goes away.
+ *
+ * connect() takes "host[:port]" (port 4532 by default); the baud rate is
+ * rigctld's business and is ignored. Modes are exposed as CI-V mode codes
+ * like the other controllers.
+ */
+class RigctldController : public RadioController
+{
+    Q_OBJECT
+
+public:
+    // Port-list entry that selects this controller instead of a serial port
+    static constexpr const char* PORT_NAME = "rigctld";
+    static constexpr quint16 DEFAULT_TCP_PORT = 4532;
+
+    explicit RigctldController(QObject* parent = nullptr);
+    ~RigctldController();
+
+    // RadioController interface implementation
+    bool connect(const QString& address, int baudRate) override;
+    void disconnect() override;
+    bool isConnected() const override { return m_state == Connected; }
+    ConnectionState state() const override { return m_state; }
+    QString lastError() const override;
+    Protocol protocol() const override { return HamlibRigctld; }
+
+    void startPolling(int intervalMs) override;
+    void stopPolling() override;
+    bool isPolling() const override { return m_polling; }
+
+    void requestFrequency() override;
+    void requestMode() override;
+    void requestSMeter() override;
+    void requestTunerState() override;
+
+    // Write commands (control the radio)
+    void setFrequency(uint64_t frequencyHz) override;
+    void setMode(uint8_t mode) override;
+    void setTunerState(bool enabled) override;
+    void startTune() override;
+    void playVoiceMemory(int memoryNumber) override;
+    void stopVoiceMemory() override;
+
+    uint64_t currentFrequency() const override { return m_currentFrequencyHz; }
+    uint8_t currentMode() const override { return m_currentMode; }
+    QString currentModeName() const override;
+    int currentSMeter() const override { return m_currentSMeter; }
+    QString radioModel() const override { return QStringLiteral("rigctld"); }
+
+    /**
+     * @brief Split "host[:port]" into its parts
+     * @return false if the address is empty or the port is not a number
+     */
+    static bool parseAddress(const QString& address, QString& host, quint16& port);
+
+    /**
+     * @brief Hamlib mode name (USB, PKTUSB, CWR...) to CI-V mode code
+     * @return CI-V code, or 0xFF if HamMixer has no equivalent
+     */
+    static uint8_t modeFromHamlib(const QByteArray& name);
+
+    /**
+     * @brief CI-V mode code to Hamlib mode name, empty if unknown
+     */
+    static QByteArray modeToHamlib(uint8_t civMode);
+
+    /**
+     * @brief Hamlib STRENGTH level (dB relative to S9) to the 0-255 Icom scale
+     */
+    static int strengthToSMeter(int dbOverS9);
+
+private slots:
+    void onReadyRead();
+    void onPollTimer();
+    void onSocketConnected();
+    void onSocketDisconnected();
+    void onSocketError(QAbstractSocket::SocketError error);
+    void onReconnectTimer();
+
+private:
+    // Reply tags for the scheduler: one per command name
+    enum ReplyTag : uint32_t {
+        TagNone = 0,
+        TagGetFreq,
+        TagGetMode,
+        TagGetLevel,
+        TagGetFunc,
+        TagSetFreq,
+        TagSetMode,
+        TagSetFunc,
+        TagVfoOp,
+        TagSendVoiceMem,
+        TagStopVoiceMem
+    };
+
+    void closeSocket();  // Teardown shared by disconnect() and the destructor
+    void setState(ConnectionState newState);
+    void setError(const QString& error);
+    void sendCommand(const QByteArray& command, CatScheduler::Priority priority, bool coalesce = true);
+    void writeCommand(const QByteArray& data);  // Called by the scheduler
+    static uint32_t replyTag(const QByteArray& commandName);
+    void processLine(const QByteArray& line);
+    void processReply(int result);
+    void resetReply();
+    void scheduleReconnect();
+
+    QTcpSocket* m_socket;
+    QTimer* m_pollTimer;
+    QTimer* m_reconnectTimer;
+    QString m_host;
+    quint16 m_port;
+    bool m_keepConnected = false;  // Set by connect(), cleared by disconnect()
+    std::atomic<ConnectionState> m_state;
+    mutable QMutex m_errorMutex;  // Guards m_lastError (read from the GUI thread)
+    QString m_lastError;
+
+    // Cached current state, written on the I/O thread and read from any thread
+    std::atomic<uint64_t> m_currentFrequencyHz;
+    std::atomic<uint8_t> m_currentMode;
+    std::atomic<int> m_currentSMeter;
+    std::atomic<bool> m_polling{false};
+    qint64 m_rxArrivalMs = 0;     // monotonicMs() of the read being parsed
+
+    // Reply being assembled: "cmd: args" header, "Key: value" lines, "RPRT n"
+    QByteArray m_rxBuffer;
+    QByteArray m_replyCommand;
+    QList<QByteArray> m_replyValues;
+    bool m_inReply = false;
+
+    // Polling state machine
+    int m_pollPhase;
+
+    // Command scheduling: rigctld queues requests per client and answers in order
+    CatScheduler* m_scheduler;
+    static constexpr int MAX_IN_FLIGHT = 4;           // Pipelined on the socket
+    static constexpr int MIN_COMMAND_GAP_MS = 0;      // rigctld paces the radio itself
+    static constexpr int RESPONSE_TIMEOUT_MS = 1000;  // rigctld may retry the radio first
+    static constexpr int USER_COMMAND_RETRIES = 1;
+    static constexpr int CONNECT_TIMEOUT_MS = 2000;
+    static constexpr int RECONNECT_INTERVAL_MS = 2000;
+    static constexpr int MAX_LINE_LENGTH = 1024;      // Guard against a non-rigctld peer
+};
+
+#endif // RIGCTLDCONTROLLER_H
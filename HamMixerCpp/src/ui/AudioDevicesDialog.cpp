@@ -7,6 +7,8 @@
 
 #include "AudioDevicesDialog.h"
 #include <QVBoxLayout>
+#include <QFormLayout>
+#include <QGroupBox>
 
 AudioDevicesDialog::AudioDevicesDialog(QWidget* parent)
     : QDialog(parent)
@@ -17,8 +19,8 @@ AudioDevicesDialog::AudioDevicesDialog(QWidget* parent)
 void AudioDevicesDialog::setupUI()
 {
     setWindowTitle("Audio Devices");
-    setMinimumSize(450, 240);
-    resize(500, 240);
+    setMinimumSize(450, 340);
+    resize(500, 340);
 
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
     mainLayout->setContentsMargins(15, 15, 15, 15);
@@ -28,6 +30,26 @@ void AudioDevicesDialog::setupUI()
     m_devicePanel = new DevicePanel(this);
     mainLayout->addWidget(m_devicePanel);
 
+    // Latency profile
+    QGroupBox* latencyGroup = new QGroupBox("Latency", this);
+    QFormLayout* latencyLayout = new QFormLayout(latencyGroup);
+
+    m_latencyCombo = new QComboBox(this);
+    m_latencyCombo->addItem("Safe (shared, 20 ms)", "safe");
+    m_latencyCombo->addItem("Normal (shared, 10 ms)", "normal");
+    m_latencyCombo->addItem("Low (shared, minimum engine period)", "low");
+    m_latencyCombo->addItem("Exclusive (minimum device period)", "exclusive");
+    m_latencyCombo->addItem("Auto (smallest period that opens)", "auto");
+    m_latencyCombo->setToolTip("Applied the next time audio is started.\n"
+                               "Exclusive mode locks the device for other applications.");
+    latencyLayout->addRow("Profile:", m_latencyCombo);
+
+    m_latencyInfoLabel = new QLabel("Audio not running", this);
+    m_latencyInfoLabel->setStyleSheet("QLabel { font-family: 'Consolas'; color: #aaa; }");
+    latencyLayout->addRow("Measured:", m_latencyInfoLabel);
+
+    mainLayout->addWidget(latencyGroup);
+
     // Spacer
     mainLayout->addStretch();
 
@@ -37,3 +59,19 @@ void AudioDevicesDialog::setupUI()
     connect(m_buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
     mainLayout->addWidget(m_buttonBox);
 }
+
+QString AudioDevicesDialog::latencyProfile() const
+{
+    return m_latencyCombo->currentData().toString();
+}
+
+void AudioDevicesDialog::setLatencyProfile(const QString& name)
+{
+    int index = m_latencyCombo->findData(name);
+    m_latencyCombo->setCurrentIndex(index >= 0 ? index : 1);
+}
+
+void AudioDevicesDialog::setLatencyInfo(const QString& text)
+{
+    m_latencyInfoLabel->setText(text);
+}
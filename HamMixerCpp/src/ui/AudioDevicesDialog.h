@@ -10,13 +10,16 @@
 
 #include <QDialog>
 #include <QDialogButtonBox>
+#include <QComboBox>
+#include <QLabel>
 #include "DevicePanel.h"
 
 /**
  * @brief Dialog for managing audio device selection
  *
  * Provides a modal dialog containing the DevicePanel widget
- * for selecting radio input, WebSDR loopback, and audio output devices.
+ * for selecting radio input, WebSDR loopback, and audio output devices,
+ * plus the latency profile and the latency measured on the running streams.
  */
 class AudioDevicesDialog : public QDialog
 {
@@ -29,10 +32,19 @@ public:
     // Access the device panel for configuration
     DevicePanel* devicePanel() { return m_devicePanel; }
 
+    // Latency profile (settings name: safe, normal, low, exclusive, auto)
+    QString latencyProfile() const;
+    void setLatencyProfile(const QString& name);
+
+    // Measured latency text shown under the profile selector
+    void setLatencyInfo(const QString& text);
+
 private:
     void setupUI();
 
     DevicePanel* m_devicePanel;
+    QComboBox* m_latencyCombo;
+    QLabel* m_latencyInfoLabel;
     QDialogButtonBox* m_buttonBox;
 };
 
@@ -101,6 +101,7 @@ void DevicePanel::populateInputDevices(const QList<DeviceInfo>& devices)
 
 void DevicePanel::populateLoopbackDevices(const QList<DeviceInfo>& devices)
 {
+    bool hadSelection = m_loopbackCombo->currentIndex() >= 0;
     QString currentId = m_loopbackCombo->currentData().toString();
     m_loopbackCombo->blockSignals(true);
     m_loopbackCombo->clear();
@@ -109,8 +110,12 @@ void DevicePanel::populateLoopbackDevices(const QList<DeviceInfo>& devices)
         m_loopbackCombo->addItem(device.name, device.id);
     }
 
-    // Restore selection
-    int index = m_loopbackCombo->findData(currentId);
+    // No loopback at all: channel 2 then only comes from the SDR itself
+    // (page audio capture or native streams), so no virtual cable is needed
+    m_loopbackCombo->addItem(NO_LOOPBACK_NAME, QString());
+
+    // Restore selection (an empty id is the None entry, not "nothing yet")
+    int index = hadSelection ? m_loopbackCombo->findData(currentId) : -1;
     if (index >= 0) {
         m_loopbackCombo->setCurrentIndex(index);
     }
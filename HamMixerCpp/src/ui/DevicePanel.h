@@ -24,9 +24,14 @@ public:
 
     /**
      * @brief Populate loopback device combo box
+     *
+     * Ends with a NO_LOOPBACK_NAME entry (empty ID) for running channel 2
+     * from the SDR alone.
      */
     void populateLoopbackDevices(const QList<DeviceInfo>& devices);
 
+    static constexpr const char* NO_LOOPBACK_NAME = "None (SDR page capture)";
+
     /**
      * @brief Populate output device combo box
      */
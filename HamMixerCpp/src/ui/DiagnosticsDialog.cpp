@@ -0,0 +1,298 @@
+/*
+ * DiagnosticsDialog.cpp
+ *
+ * Live audio engine health view with JSON/CSV export
+ * Part of HamMixer CT7BAC
+ */
+
+#include "DiagnosticsDialog.h"
+#include "websdr/WebSdrManager.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <QDateTime>
+#include <QScrollBar>
+#include <QSignalBlocker>
+
+namespace {
+
+QString deviceSection(const QString& name, const DeviceTelemetry::Snapshot& d)
+{
+    if (d.callbacks == 0) {
+        return QString("%1\n  inactive\n").arg(name);
+    }
+
+    QString text;
+    QTextStream out(&text);
+    out << name << "\n";
+    out << QString("  callbacks %1   period %2 us   max jitter %3 us\n")
+               .arg(d.callbacks).arg(d.expectedPeriodUs).arg(d.maxJitterUs);
+    out << QString("  interval  mean %1 us   min %2 us   max %3 us\n")
+               .arg(d.intervals.meanUs, 0, 'f', 0).arg(d.intervals.minUs).arg(d.intervals.maxUs);
+    out << QString("  discontinuities %1   timestamp errors %2   starved %3\n")
+               .arg(d.discontinuities).arg(d.timestampErrors).arg(d.starved);
+    return text;
+}
+
+QString ringSection(const QString& name, const RingStats& r, int sampleRate)
+{
+    auto ms = [sampleRate](int frames) {
+        return sampleRate > 0 ? frames * 1000.0 / sampleRate : 0.0;
+    };
+
+    return QString("%1\n  underruns %2 (%3 frames)   overruns %4 (%5 frames)\n"
+                   "  fill min %6 / max %7 of %8 frames (%9 - %10 ms)\n")
+        .arg(name)
+        .arg(r.underruns).arg(r.underrunFrames)
+        .arg(r.overruns).arg(r.overrunFrames)
+        .arg(r.fillMin).arg(r.fillMax).arg(r.capacity)
+        .arg(ms(r.fillMin), 0, 'f', 1).arg(ms(r.fillMax), 0, 'f', 1);
+}
+
+QString histogramSection(const QString& name, const TimingHistogram::Snapshot& h)
+{
+    QString text;
+    QTextStream out(&text);
+    out << QString("%1\n  blocks %2   mean %3 us   max %4 us\n")
+               .arg(name).arg(h.count).arg(h.meanUs, 0, 'f', 1).arg(h.maxUs);
+
+    for (int i = 0; i < TimingHistogram::BUCKETS; i++) {
+        if (h.counts[i] == 0) continue;
+        double pct = h.count > 0 ? 100.0 * h.counts[i] / h.count : 0.0;
+        out << QString("  %1 %2 %3%\n")
+                   .arg(TimingHistogram::bucketLabel(i), -8)
+                   .arg(h.counts[i], 10)
+                   .arg(pct, 6, 'f', 2);
+    }
+    return text;
+}
+
+QString tuneSection(const TuneScheduler::Stats& t)
+{
+    QString text;
+    QTextStream out(&text);
+    out << "SDR tuning\n";
+    out << QString("  requests %1   sent %2   coalesced %3   skipped %4   timeouts %5\n")
+               .arg(t.requests).arg(t.sent).arg(t.coalesced).arg(t.skipped).arg(t.timeouts);
+    out << QString("  radio to SDR  last %1 ms   mean %2 ms   max %3 ms\n")
+               .arg(t.lastLatencyMs).arg(t.meanLatencyMs, 0, 'f', 1).arg(t.maxLatencyMs);
+    return text;
+}
+
+QString pageLoadSection(const WebSdrManager* webSdrManager)
+{
+    QString text;
+    QTextStream out(&text);
+    out << QString("SDR page loads (blocked requests %1)\n").arg(webSdrManager->blockedRequestCount());
+    for (const WebSdrManager::PageLoadStats& p : webSdrManager->pageLoadStatistics()) {
+        out << QString("  %1 loads %2   last %3 ms   best %4 ms   mean %5 ms   max %6 ms\n")
+                   .arg(p.siteName, -16)
+                   .arg(p.loads)
+                   .arg(p.lastMs).arg(p.bestMs).arg(p.averageMs()).arg(p.worstMs);
+    }
+    return text;
+}
+
+QString diversitySection(DiversityCombiner* d, const WebSdrManager* webSdrManager)
+{
+    QString text;
+    QTextStream out(&text);
+    out << QString("SDR diversity (%1)\n")
+               .arg(d->mode() == DiversityCombiner::Mode::BestOf ? "best-of" : "average");
+    for (int s = 0; s < DiversityCombiner::MAX_SOURCES; s++) {
+        if (!d->isSourcePresent(s)) continue;
+        QString name = s == 0 ? QString("channel 2") : webSdrManager->diversitySiteId(s);
+        out << QString("  %1 %2   SNR %3 dB   delay %4 ms\n")
+                   .arg(s == d->selectedSource() ? '>' : ' ')
+                   .arg(name, -16)
+                   .arg(d->sourceSnrDb(s), 5, 'f', 1)
+                   .arg(d->sourceDelayMs(s), 0, 'f', 0);
+    }
+    return text;
+}
+
+} // namespace
+
+DiagnosticsDialog::DiagnosticsDialog(AudioManager* audioManager, WebSdrManager* webSdrManager,
+                                     QWidget* parent)
+    : QDialog(parent)
+    , m_audioManager(audioManager)
+    , m_webSdrManager(webSdrManager)
+{
+    setupUI();
+
+    m_refreshTimer = new QTimer(this);
+    connect(m_refreshTimer, &QTimer::timeout, this, &DiagnosticsDialog::refresh);
+    m_refreshTimer->start(REFRESH_INTERVAL_MS);
+    refresh();
+}
+
+DiagnosticsDialog::~DiagnosticsDialog()
+{
+    if (m_logFile.isOpen()) {
+        m_logFile.close();
+    }
+}
+
+void DiagnosticsDialog::setupUI()
+{
+    setWindowTitle("Audio Diagnostics");
+    setMinimumSize(520, 560);
+    resize(560, 640);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setContentsMargins(15, 15, 15, 15);
+    mainLayout->setSpacing(10);
+
+    m_reportView = new QPlainTextEdit(this);
+    m_reportView->setReadOnly(true);
+    m_reportView->setStyleSheet("QPlainTextEdit { font-family: 'Consolas'; font-size: 9pt; }");
+    mainLayout->addWidget(m_reportView, 1);
+
+    m_logCheck = new QCheckBox("Append a CSV row to a log file on every refresh", this);
+    connect(m_logCheck, &QCheckBox::toggled, this, &DiagnosticsDialog::onLogToggled);
+    mainLayout->addWidget(m_logCheck);
+
+    QHBoxLayout* buttonRowLayout = new QHBoxLayout();
+
+    QPushButton* resetButton = new QPushButton("Reset", this);
+    connect(resetButton, &QPushButton::clicked, this, &DiagnosticsDialog::onReset);
+    buttonRowLayout->addWidget(resetButton);
+
+    QPushButton* jsonButton = new QPushButton("Export JSON...", this);
+    connect(jsonButton, &QPushButton::clicked, this, &DiagnosticsDialog::onExportJson);
+    buttonRowLayout->addWidget(jsonButton);
+
+    QPushButton* csvButton = new QPushButton("Export CSV...", this);
+    connect(csvButton, &QPushButton::clicked, this, &DiagnosticsDialog::onExportCsv);
+    buttonRowLayout->addWidget(csvButton);
+
+    buttonRowLayout->addStretch();
+
+    m_buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(m_buttonBox, &QDialogButtonBox::rejected, this, &QDialog::close);
+    buttonRowLayout->addWidget(m_buttonBox);
+
+    mainLayout->addLayout(buttonRowLayout);
+}
+
+QString DiagnosticsDialog::formatReport(const AudioTelemetry::Snapshot& snap) const
+{
+    QString text;
+    QTextStream out(&text);
+
+    out << QString("Engine %1 Hz   window %2 s   %3\n\n")
+               .arg(snap.sampleRate)
+               .arg(snap.windowMs / 1000.0, 0, 'f', 1)
+               .arg(m_audioManager->isRunning() ? "running" : "stopped");
+
+    out << deviceSection("Radio input", snap.input) << "\n";
+    out << deviceSection("WebSDR loopback", snap.loopback) << "\n";
+    out << deviceSection("Output", snap.output) << "\n";
+    out << ringSection("Radio ring", snap.radioRing, snap.sampleRate) << "\n";
+    out << ringSection("Loopback ring", snap.loopbackRing, snap.sampleRate) << "\n";
+    out << histogramSection("Mixer process", snap.mixerProcess);
+    out << "\n";
+    out << histogramSection("Output callback interval", snap.output.intervals);
+
+    if (m_webSdrManager) {
+        out << "\n" << tuneSection(m_webSdrManager->tuneStatistics());
+        out << "\n" << pageLoadSection(m_webSdrManager);
+
+        if (!m_webSdrManager->diversitySiteIds().isEmpty() && m_audioManager->mixer()) {
+            out << "\n" << diversitySection(m_audioManager->mixer()->diversity(), m_webSdrManager);
+        }
+    }
+    return text;
+}
+
+void DiagnosticsDialog::refresh()
+{
+    AudioTelemetry::Snapshot snap = m_audioManager->telemetrySnapshot();
+
+    // Keep the scroll position while the text is replaced
+    int scroll = m_reportView->verticalScrollBar()->value();
+    m_reportView->setPlainText(formatReport(snap));
+    m_reportView->verticalScrollBar()->setValue(scroll);
+
+    if (m_logFile.isOpen() && m_audioManager->isRunning()) {
+        QTextStream out(&m_logFile);
+        out << snap.toCsvRow() << "\n";
+        out.flush();
+    }
+}
+
+void DiagnosticsDialog::onReset()
+{
+    m_audioManager->resetTelemetry();
+    if (m_webSdrManager) {
+        m_webSdrManager->resetTuneStatistics();
+        m_webSdrManager->resetPageLoadStatistics();
+    }
+    refresh();
+}
+
+void DiagnosticsDialog::onExportJson()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Export Diagnostics",
+        QString("hammixer_audio_%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss")),
+        "JSON Files (*.json)");
+    if (path.isEmpty()) return;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QMessageBox::warning(this, "Export Failed", "Could not write " + path);
+        return;
+    }
+    file.write(QJsonDocument(m_audioManager->telemetrySnapshot().toJson()).toJson());
+}
+
+void DiagnosticsDialog::onExportCsv()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Export Diagnostics",
+        QString("hammixer_audio_%1.csv").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss")),
+        "CSV Files (*.csv)");
+    if (path.isEmpty()) return;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        QMessageBox::warning(this, "Export Failed", "Could not write " + path);
+        return;
+    }
+    QTextStream out(&file);
+    out << AudioTelemetry::Snapshot::csvHeader() << "\n";
+    out << m_audioManager->telemetrySnapshot().toCsvRow() << "\n";
+}
+
+void DiagnosticsDialog::onLogToggled(bool enabled)
+{
+    if (!enabled) {
+        m_logFile.close();
+        return;
+    }
+
+    QString path = QFileDialog::getSaveFileName(this, "Diagnostics Log",
+        QString("hammixer_audio_log_%1.csv").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss")),
+        "CSV Files (*.csv)");
+
+    m_logFile.setFileName(path);
+    if (path.isEmpty() || !m_logFile.open(QIODevice::Append | QIODevice::Text)) {
+        if (!path.isEmpty()) {
+            QMessageBox::warning(this, "Log Failed", "Could not open " + path);
+        }
+        QSignalBlocker blocker(m_logCheck);
+        m_logCheck->setChecked(false);
+        return;
+    }
+
+    // Header only for a fresh file so repeated runs append cleanly
+    if (m_logFile.size() == 0) {
+        QTextStream out(&m_logFile);
+        out << AudioTelemetry::Snapshot::csvHeader() << "\n";
+    }
+}
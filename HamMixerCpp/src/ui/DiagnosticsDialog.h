@@ -0,0 +1,66 @@
+/*
+ * DiagnosticsDialog.h
+ *
+ * Live audio engine health view with JSON/CSV export
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QPlainTextEdit>
+#include <QCheckBox>
+#include <QTimer>
+#include <QFile>
+#include "audio/AudioManager.h"
+
+class WebSdrManager;
+
+/**
+ * @brief Non-modal dialog showing audio telemetry
+ *
+ * Refreshes twice a second from AudioManager::telemetrySnapshot():
+ * per-device callback intervals and glitch flags, ring underruns and
+ * overruns with fill extremes, and mixer processing time, plus the
+ * radio-to-SDR tune pipeline and the diversity receivers (SNR, delay and
+ * which one is heard). Counters can be reset; the audio ones can
+ * be exported as JSON or CSV, or appended to a CSV log file on every
+ * refresh for unattended runs.
+ */
+class DiagnosticsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    DiagnosticsDialog(AudioManager* audioManager, WebSdrManager* webSdrManager,
+                      QWidget* parent = nullptr);
+    ~DiagnosticsDialog() override;
+
+private slots:
+    void refresh();
+    void onReset();
+    void onExportJson();
+    void onExportCsv();
+    void onLogToggled(bool enabled);
+
+private:
+    void setupUI();
+    QString formatReport(const AudioTelemetry::Snapshot& snap) const;
+
+    AudioManager* m_audioManager;
+    WebSdrManager* m_webSdrManager;
+
+    QPlainTextEdit* m_reportView;
+    QCheckBox* m_logCheck;
+    QDialogButtonBox* m_buttonBox;
+    QTimer* m_refreshTimer;
+
+    // Periodic CSV log
+    QFile m_logFile;
+
+    static constexpr int REFRESH_INTERVAL_MS = 500;
+};
+
+#endif // DIAGNOSTICSDIALOG_H
@@ -3,9 +3,16 @@
 #include "ui/WebSdrManagerDialog.h"
 #include "ui/AudioDevicesDialog.h"
 #include "ui/VoiceMemoryDialog.h"
+#include "ui/DiagnosticsDialog.h"
+#include "ui/WaterfallWidget.h"
+#include "ui/SignalHistoryGraph.h"
+#include "ui/SdrDirectoryDialog.h"
 #include "audio/MixerCore.h"
 #include "audio/AudioSync.h"
+#include "audio/DiversityCombiner.h"
 #include "serial/CIVProtocol.h"
+#include "serial/RigctldController.h"
+#include "config/BandPlan.h"
 #include "HamMixer/Version.h"
 #include <algorithm>
 #include <cmath>
@@ -23,9 +30,11 @@
 #include <QDebug>
 #include <QWebEngineView>
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QDir>
 #include <QGridLayout>
 #include <QScreen>
+#include <QSignalBlocker>
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
@@ -49,6 +58,13 @@ MainWindow::MainWindow(QWidget* parent)
 
     // Radio controller initialized on connect (auto-detects protocol)
     m_radioController = nullptr;
+    m_radioDetector = new RadioDetector(this);
+
+    // Serial reads, polls and frame parsing run here, away from repaints
+    m_radioThread = new QThread(this);
+    m_radioThread->setObjectName("RadioIO");
+    m_radioThread->start();
+    m_radioDetector->setIoThread(m_radioThread);
 
     setupWindow();
     setupUI();
@@ -98,9 +114,15 @@ MainWindow::~MainWindow()
     m_marqueeTimer->stop();
 
     // Disconnect radio if connected
-    if (m_radioController && m_radioController->isConnected()) {
-        m_radioController->disconnect();
-    }
+    m_radioDetector->cancel();
+    releaseRadioController();
+
+    // Pending deleteLater() calls run as the thread finishes
+    m_radioThread->quit();
+    m_radioThread->wait();
+
+    // Stop probing before the audio engine goes
+    m_sdrProber->cancel();
 
     // Unload WebSDR site
     if (m_webSdrManager) {
@@ -318,10 +340,47 @@ void MainWindow::setupUI()
     // Create WebSDR manager with the browser container for embedded mode
     m_webSdrManager = new WebSdrManager(browserContainer, this);
 
+    // Natively streamed KiwiSDR audio goes straight into the mixer's channel 2
+    m_webSdrManager->setAudioSink([this](const float* samples, int frames, double sampleRate) {
+        m_audioManager->writeSdrStream(samples, frames, sampleRate);
+    });
+
+    // Diversity receivers each feed their own source of channel 2
+    m_webSdrManager->setDiversitySink([this](int source, const float* samples, int frames, double sampleRate) {
+        m_audioManager->writeDiversitySource(source, samples, frames, sampleRate);
+    });
+
     // Set site list in manager and populate dropdown (no sites loaded yet)
     m_webSdrManager->setSiteList(m_settings.webSdrSites());
     m_radioControlPanel->setSiteList(m_settings.webSdrSites());
 
+    // SDR directory, probed on the radio's band in the background
+    m_sdrDirectory = new SdrDirectory(Settings::getConfigDir() + "/sdr_directory.json", this);
+    m_sdrDirectory->load();
+    m_sdrProber = new SdrProber(m_sdrDirectory, this);
+
+    // Probe streams are measured against the radio, never mixed
+    m_sdrProber->setAudioSink([this](const float* samples, int frames, double sampleRate) {
+        m_audioManager->writeProbe(samples, frames, sampleRate);
+    });
+    SdrProber::DelayMeter meter;
+    meter.start = [this]() {
+        MixerCore* mixer = m_audioManager->mixer();
+        if (!m_civConnected || !m_audioManager->isRunning() || !mixer) return false;
+        mixer->startProbeSync(radioSyncMode());
+        return true;
+    };
+    meter.poll = [this](AudioSync::SyncResult& result) {
+        MixerCore* mixer = m_audioManager->mixer();
+        if (!mixer || !mixer->hasProbeSyncResult()) return false;
+        result = mixer->getProbeSyncResult();
+        return true;
+    };
+    meter.stop = [this]() {
+        m_audioManager->stopProbe();
+    };
+    m_sdrProber->setDelayMeter(std::move(meter));
+
     // Pre-initialize Chromium engine at startup to avoid visual blink on first connect
     m_webSdrManager->preInitialize();
 }
@@ -345,7 +404,26 @@ void MainWindow::setupMenuBar()
 
     toolsMenu->addAction("&Audio Devices...", this, &MainWindow::onAudioDevicesClicked);
     toolsMenu->addAction("Manage &SDR Sites...", this, &MainWindow::onManageWebSdr);
+    toolsMenu->addAction("SDR &Directory...", this, &MainWindow::onSdrDirectory);
     toolsMenu->addAction("&Voice Memory...", this, &MainWindow::onVoiceMemoryConfig);
+    toolsMenu->addAction("&rigctld Address...", this, &MainWindow::onRigctldAddress);
+    m_kiwiNativeAudioAction = toolsMenu->addAction("&KiwiSDR Native Audio");
+    m_kiwiNativeAudioAction->setCheckable(true);
+    m_kiwiNativeAudioAction->setToolTip("Stream KiwiSDR audio directly instead of through the browser and loopback");
+    connect(m_kiwiNativeAudioAction, &QAction::toggled, this, &MainWindow::onKiwiNativeAudioToggled);
+    m_pageAudioCaptureAction = toolsMenu->addAction("SDR &Page Audio Capture");
+    m_pageAudioCaptureAction->setCheckable(true);
+    m_pageAudioCaptureAction->setToolTip("Take the SDR page's audio inside the browser instead of from the loopback device");
+    connect(m_pageAudioCaptureAction, &QAction::toggled, this, &MainWindow::onPageAudioCaptureToggled);
+    m_diversityBestOfAction = toolsMenu->addAction("SDR Diversity &Best-of");
+    m_diversityBestOfAction->setCheckable(true);
+    m_diversityBestOfAction->setToolTip("With diversity receivers streaming, hear only the one with the best SNR "
+                                        "(off: average them)");
+    connect(m_diversityBestOfAction, &QAction::toggled, this, &MainWindow::onDiversityBestOfToggled);
+    toolsMenu->addSeparator();
+    toolsMenu->addAction("Audio &Diagnostics...", this, &MainWindow::onAudioDiagnostics);
+    toolsMenu->addAction("Radio S&cope...", this, &MainWindow::onRadioScope);
+    toolsMenu->addAction("Signal &History...", this, &MainWindow::onSignalHistory);
 
     // ===== Help Menu =====
     QMenu* helpMenu = menuBar()->addMenu("&Help");
@@ -386,7 +464,7 @@ QWidget* MainWindow::createRadioControlsSection()
     m_bandGroup->setExclusive(true);
 
     // Two-line labels: wavelength on top, frequency below
-    const char* bandWavelengths[] = {"160m", "80m", "40m", "30m", "20m", "17m", "15m", "12m", "10m", "6m"};
+    static_assert(BandPlan::BAND_COUNT == BAND_COUNT, "One button per BandPlan band");
     const char* bandFreqs[] = {"1.8", "3.5", "7", "10", "14", "18", "21", "24", "28", "50"};
 
     QString bandButtonStyle =
@@ -414,7 +492,7 @@ QWidget* MainWindow::createRadioControlsSection()
     // Row 0: 160m, 80m, 40m, 30m, 20m (indices 0-4)
     // Row 1: 17m, 15m, 12m, 10m, 6m (indices 5-9)
     for (int i = 0; i < BAND_COUNT; i++) {
-        QString label = QString("%1\n%2").arg(bandWavelengths[i]).arg(bandFreqs[i]);
+        QString label = QString("%1\n%2").arg(BandPlan::BANDS[i].label).arg(bandFreqs[i]);
         QPushButton* btn = new QPushButton(label, bandGroup);
         btn->setCheckable(true);
         btn->setAutoDefault(false);
@@ -651,7 +729,13 @@ void MainWindow::connectSignals()
             this, &MainWindow::onSerialConnectClicked);
     connect(m_radioControlPanel, &RadioControlPanel::serialDisconnectClicked,
             this, &MainWindow::onSerialDisconnectClicked);
-    // Note: Radio controller signals are connected after auto-detection in onSerialConnectClicked()
+    // Note: Radio controller signals are connected after auto-detection in onRadioDetected()
+    connect(m_radioDetector, &RadioDetector::progress,
+            m_radioControlPanel, &RadioControlPanel::setDetectionProgress);
+    connect(m_radioDetector, &RadioDetector::detected,
+            this, &MainWindow::onRadioDetected);
+    connect(m_radioDetector, &RadioDetector::failed,
+            this, &MainWindow::onRadioDetectionFailed);
 
     // ========== WebSDR Manager signals ==========
     connect(m_radioControlPanel, &RadioControlPanel::webSdrSiteChanged,
@@ -665,6 +749,12 @@ void MainWindow::connectSignals()
             this, &MainWindow::onWebSdrStateChanged);
     connect(m_webSdrManager, &WebSdrManager::smeterChanged,
             this, &MainWindow::onWebSdrSmeterChanged);
+    connect(m_webSdrManager, &WebSdrManager::nativeAudioChanged,
+            m_audioManager.get(), &AudioManager::setSdrStreamActive);
+    connect(m_webSdrManager, &WebSdrManager::diversitySourceChanged,
+            this, &MainWindow::onDiversitySourceChanged);
+    connect(m_sdrProber, &SdrProber::bandProbed,
+            this, &MainWindow::onSdrBandProbed);
     connect(m_webSdrManager, &WebSdrManager::siteReady,
             this, [this](const QString& siteId) {
                 qDebug() << "WebSDR site ready:" << siteId;
@@ -710,9 +800,15 @@ void MainWindow::applySettingsToUI()
     m_radioStrip->setVolume(m_settings.channel1().volume);
     m_websdrStrip->setVolume(m_settings.channel2().volume);
 
+    // Engine sample rate and latency profile (applied on next stream start)
+    m_audioManager->setEngineSampleRate(m_settings.audio().sampleRate);
+    m_audioManager->setLatencyProfile(
+        AudioManager::latencyProfileFromName(m_settings.audio().latencyProfile));
+
     // Set recording directory
     if (m_audioManager->recorder()) {
         m_audioManager->recorder()->setRecordingDirectory(m_settings.recording().directory);
+        m_audioManager->recorder()->setFormat(Recorder::formatFromName(m_settings.recording().format));
     }
 
     // Apply serial settings
@@ -730,11 +826,33 @@ void MainWindow::applySettingsToUI()
     m_webSdrManager->setSiteList(m_settings.webSdrSites());
     m_radioControlPanel->setSiteList(m_settings.webSdrSites());
     m_radioControlPanel->setSelectedSite(m_settings.webSdr().selectedSiteId);
+    m_webSdrManager->setKiwiNativeAudio(m_settings.webSdr().kiwiNativeAudio);
+    if (m_kiwiNativeAudioAction) {
+        QSignalBlocker blocker(m_kiwiNativeAudioAction);
+        m_kiwiNativeAudioAction->setChecked(m_settings.webSdr().kiwiNativeAudio);
+    }
+    m_webSdrManager->setPageAudioCapture(m_settings.webSdr().pageAudioCapture);
+    m_webSdrManager->setHttpCacheSizeMB(m_settings.webSdr().httpCacheMB);
+    m_webSdrManager->setBlockTrackers(m_settings.webSdr().blockTrackers);
+    if (m_pageAudioCaptureAction) {
+        QSignalBlocker blocker(m_pageAudioCaptureAction);
+        m_pageAudioCaptureAction->setChecked(m_settings.webSdr().pageAudioCapture);
+    }
+    if (m_diversityBestOfAction) {
+        QSignalBlocker blocker(m_diversityBestOfAction);
+        m_diversityBestOfAction->setChecked(m_settings.webSdr().diversityBestOf);
+    }
+    if (MixerCore* mixer = m_audioManager->mixer()) {
+        mixer->diversity()->setMode(m_settings.webSdr().diversityBestOf
+                                        ? DiversityCombiner::Mode::BestOf
+                                        : DiversityCombiner::Mode::Sum);
+    }
 
     // Apply WebSDR browser view state (compact/full mode)
     if (m_browserGroup) {
         bool showBrowser = m_settings.webSdr().showBrowser;
         m_radioControlPanel->setWebSdrViewVisible(showBrowser);
+        m_webSdrManager->setBrowserVisible(showBrowser);
 
         if (!showBrowser) {
             // Start in compact mode - same height as toggle function
@@ -1099,7 +1217,9 @@ void MainWindow::checkSyncResult()
         if (result.success) {
             // Apply the detected delay (can be positive or negative)
             int newDelayMs = static_cast<int>(result.delayMs);
-            int currentDelayMs = m_delaySlider->value();
+            // Channel 2's own source may be delayed to line up with diversity receivers
+            int currentDelayMs = m_delaySlider->value()
+                               - static_cast<int>(mixer->diversity()->sourceDelayMs(0));
 
             // For auto-triggered syncs, check if delta is within threshold
             if (wasAutoTriggered) {
@@ -1114,6 +1234,7 @@ void MainWindow::checkSyncResult()
                 }
 
                 // Apply silently (no message box for auto sync)
+                newDelayMs = alignDiversitySources(newDelayMs);
                 if (newDelayMs >= 0) {
                     m_delaySlider->setValue(newDelayMs);
                     setDelayLabelSyncStatus(true);  // Green - sync successful
@@ -1128,6 +1249,7 @@ void MainWindow::checkSyncResult()
             }
 
             // Manual sync - show message boxes
+            newDelayMs = alignDiversitySources(newDelayMs);
             if (newDelayMs >= 0) {
                 // Normal case: WebSDR is behind Radio, add delay to Radio channel
                 m_delaySlider->setValue(newDelayMs);
@@ -1390,44 +1512,106 @@ void MainWindow::onSerialConnectClicked()
         return;
     }
 
-    // Clean up existing controller if any
-    if (m_radioController) {
-        m_radioController->disconnect();
-        delete m_radioController;
-        m_radioController = nullptr;
+    // A second click while probing cancels detection
+    if (m_radioDetector->isRunning()) {
+        m_radioDetector->cancel();
+        m_radioControlPanel->setSerialConnectionState(RadioController::Disconnected);
+        return;
     }
 
+    // Clean up existing controller if any
+    releaseRadioController();
+
     // Update UI state to show "Connecting..." while we detect
     m_radioControlPanel->setSerialConnectionState(RadioController::Connecting);
 
-    qDebug() << "MainWindow: Auto-detecting radio on port" << port;
+    // rigctld already knows its radio: nothing to probe
+    if (port == RigctldController::PORT_NAME) {
+        connectRigctld();
+        return;
+    }
 
-    // Step 2: Auto-detect radio protocol (tries Icom CI-V, then Kenwood CAT)
-    m_radioController = RadioController::detectAndConnect(port, this);
+    // Step 2: Auto-detect radio protocol without blocking the UI; the last
+    // result for this port is tried first (continues in onRadioDetected)
+    RadioDetector::Result hint;
+    auto cached = m_settings.serial().detectedRadios.constFind(port);
+    if (cached != m_settings.serial().detectedRadios.constEnd()) {
+        hint.protocol = (cached->protocol == "civ") ? RadioController::IcomCIV : RadioController::KenwoodCAT;
+        hint.baudRate = cached->baudRate;
+        hint.civAddress = static_cast<uint8_t>(cached->civAddress);
+    }
+    m_radioDetector->start(port, hint);
+}
 
-    if (!m_radioController) {
-        // No radio detected
-        QMessageBox::critical(this, "No Radio Detected",
-            "No compatible radio detected on this port.\n\n"
-            "Supported radios:\n"
-            "• Icom (IC-7300, IC-7600, IC-7610, etc.)\n"
-            "• Kenwood (TS-590, TS-890, TS-990, etc.)\n"
-            "• Elecraft (K3, K4, KX2, KX3, etc.)\n"
-            "• Yaesu (FT-991, FTDX101, FT-710, etc.)\n\n"
-            "Please check:\n"
-            "• Radio is powered on\n"
-            "• USB cable is connected\n"
-            "• Correct COM port selected");
+void MainWindow::connectRigctld()
+{
+    QString address = m_settings.serial().rigctldAddress;
+    RadioController* controller = RadioController::create(RadioController::HamlibRigctld, nullptr);
+    controller->moveToThread(m_radioThread);
 
+    // Blocks for at most the connect timeout; a local daemon answers at once
+    if (!controller->connect(address, 0)) {
+        QString error = controller->lastError();
+        controller->deleteLater();
+        QMessageBox::critical(this, "rigctld Not Reachable",
+            QString("Could not connect to rigctld at %1.\n\n%2\n\n"
+                    "Start rigctld for your radio (for example \"rigctld -m <model> -r <port>\") "
+                    "or set its address under Tools > rigctld Address.")
+                .arg(address, error));
         m_radioControlPanel->setSerialConnectionState(RadioController::Disconnected);
         return;
     }
 
+    RadioDetector::Result result;
+    result.protocol = RadioController::HamlibRigctld;
+    onRadioDetected(controller, result);
+}
+
+void MainWindow::onRadioDetectionFailed(const QString& reason)
+{
+    qDebug() << "MainWindow: Radio detection failed:" << reason;
+
+    QMessageBox::critical(this, "No Radio Detected",
+        "No compatible radio detected on this port.\n\n"
+        "Supported radios:\n"
+        "• Icom (IC-7300, IC-7600, IC-7610, etc.)\n"
+        "• Kenwood (TS-590, TS-890, TS-990, etc.)\n"
+        "• Elecraft (K3, K4, KX2, KX3, etc.)\n"
+        "• Yaesu (FT-991, FTDX101, FT-710, etc.)\n\n"
+        "Please check:\n"
+        "• Radio is powered on\n"
+        "• USB cable is connected\n"
+        "• Correct COM port selected");
+
+    m_radioControlPanel->setSerialConnectionState(RadioController::Disconnected);
+}
+
+void MainWindow::onRadioDetected(RadioController* controller, const RadioDetector::Result& result)
+{
+    m_radioController = controller;
+
+    // Remember what worked so the next connect on this port takes one probe
+    if (result.protocol != RadioController::HamlibRigctld) {
+        QString port = m_radioDetector->port();
+        Settings::SerialSettings::DetectedRadio detected;
+        detected.protocol = (result.protocol == RadioController::IcomCIV) ? "civ" : "cat";
+        detected.baudRate = result.baudRate;
+        detected.civAddress = result.civAddress;
+        m_settings.serial().detectedRadios.insert(port, detected);
+        m_settings.serial().baudRate = result.baudRate;
+        m_settings.markDirty();
+    }
+
     // Log detected protocol
-    QString protoName = (m_radioController->protocol() == RadioController::IcomCIV)
-        ? "Icom CI-V" : "Kenwood/Elecraft CAT";
-    qDebug() << "MainWindow: Detected" << protoName << "protocol";
-    qDebug() << "MainWindow: Frequency:" << m_radioController->currentFrequency() << "Hz";
+    QString protoName;
+    switch (m_radioController->protocol()) {
+        case RadioController::IcomCIV:       protoName = "Icom CI-V"; break;
+        case RadioController::HamlibRigctld: protoName = "Hamlib rigctld"; break;
+        default:                             protoName = "Kenwood/Elecraft CAT"; break;
+    }
+    qDebug() << "MainWindow: Detected" << protoName << "protocol at" << result.baudRate << "baud";
+    m_radioController->setEventDrivenUpdates(m_settings.serial().eventDriven);
+    qDebug() << "MainWindow: Frequency:" << result.frequencyHz << "Hz";
 
     m_civConnected = true;
 
@@ -1455,10 +1639,10 @@ void MainWindow::onSerialConnectClicked()
     // Request current tuner state from radio (so ATU button shows correct state)
     m_radioController->requestTunerState();
 
-    // Update display with initial values from detection
-    // (The signals were consumed by detection lambda, so we need to manually update)
-    if (m_radioController->currentFrequency() > 0) {
-        m_localFrequency = m_radioController->currentFrequency();
+    // Update display with the frequency from the detection probe; mode and
+    // the controller's own first reads arrive through the signals above
+    if (result.frequencyHz > 0) {
+        m_localFrequency = result.frequencyHz;
         m_radioControlPanel->setFrequencyDisplay(m_localFrequency);
         // Update band button selection
         updateBandSelection(m_localFrequency);
@@ -1543,11 +1727,17 @@ void MainWindow::onSerialConnectClicked()
 
 void MainWindow::onSerialDisconnectClicked()
 {
+    m_radioDetector->cancel();
+
     // Step 1: Stop radio polling
     if (m_radioController && m_radioController->isPolling()) {
         m_radioController->stopPolling();
     }
 
+    // Stop directory probing; the band is probed again on the next connect
+    m_sdrProber->cancel();
+    m_radioBand.clear();
+
     // Step 2: Stop audio engine
     if (m_audioManager->isRunning()) {
         m_audioManager->stopStreams();
@@ -1568,11 +1758,7 @@ void MainWindow::onSerialDisconnectClicked()
     }
 
     // Step 5: Disconnect radio and clean up controller
-    if (m_radioController) {
-        m_radioController->disconnect();
-        delete m_radioController;
-        m_radioController = nullptr;
-    }
+    releaseRadioController();
     m_civConnected = false;
     m_civSMeterDb = -80.0f;
 
@@ -1650,6 +1836,10 @@ void MainWindow::onCIVFrequencyChanged(uint64_t frequencyHz)
         m_webSdrManager->setFrequency(frequencyHz);
     }
 
+    // Keep probes on the radio's frequency; a new band gets probed and ranked
+    m_sdrProber->setTuning(frequencyHz, QString());
+    updateRadioBand(frequencyHz);
+
     qDebug() << "CI-V: Frequency changed to" << frequencyHz << "Hz";
 }
 
@@ -1662,29 +1852,23 @@ void MainWindow::onCIVModeChanged(uint8_t mode, const QString& modeName)
     updateModeSelection(mode);
 
     // Broadcast to ALL WebSDR sites
+    QString webSdrMode = CIVProtocol::modeToWebSdr(mode);
     if (m_webSdrManager) {
-        QString webSdrMode = CIVProtocol::modeToWebSdr(mode);
         m_webSdrManager->setMode(webSdrMode);
     }
+    m_sdrProber->setTuning(m_localFrequency, webSdrMode);
 
     qDebug() << "CI-V: Mode changed to" << modeName;
 }
 
-void MainWindow::onCIVSMeterChanged(int value)
+void MainWindow::onCIVSMeterChanged(int value, qint64 arrivalMs)
 {
     // Convert CI-V S-meter value (0-255) to dB scale (-80 to 0)
     float valueDb = CIVProtocol::smeterToDb(value);
 
-    // Store in delay buffer with timestamp
-    SMeterSample sample;
-    sample.timestamp = m_smeterTimer.elapsed();
-    sample.valueDb = valueDb;
-    m_smeterBuffer.push_back(sample);
-
-    // Keep buffer size bounded (remove old samples)
-    while (m_smeterBuffer.size() > SMETER_BUFFER_MAX) {
-        m_smeterBuffer.pop_front();
-    }
+    // Record in the history, timestamped when the reply reached the serial
+    // thread (rebased onto m_smeterTimer) so GUI load does not skew it
+    m_radioSMeterHistory.append(arrivalMs - m_smeterTimer.msecsSinceReference(), valueDb);
 
     // Also update immediate value for fallback
     m_civSMeterDb = valueDb;
@@ -1703,6 +1887,7 @@ void MainWindow::onTxStatusChanged(bool transmitting)
 
     // Update TX indicator in UI
     m_radioControlPanel->setTransmitting(transmitting);
+    m_txHistory.append(m_smeterTimer.elapsed(), transmitting ? 1.0f : 0.0f);
 
     // Update voice button states (shows red when transmitting)
     if (!transmitting && m_activeVoiceMemory > 0) {
@@ -1760,23 +1945,23 @@ void MainWindow::onWebSdrSiteChanged(const WebSdrSite& site)
     m_settings.webSdr().selectedSiteId = site.id;
 }
 
-void MainWindow::onWebSdrStateChanged(WebSdrController::State state)
+void MainWindow::onWebSdrStateChanged(SdrController::State state)
 {
     m_radioControlPanel->setWebSdrState(state);
 
     switch (state) {
-        case WebSdrController::Unloaded:
+        case SdrController::Unloaded:
             qDebug() << "WebSDR: Unloaded";
             m_websdrSmeterValid = false;  // Reset S-meter when unloaded
             break;
-        case WebSdrController::Loading:
+        case SdrController::Loading:
             qDebug() << "WebSDR: Loading...";
             m_websdrSmeterValid = false;  // Reset S-meter during loading
             break;
-        case WebSdrController::Ready:
+        case SdrController::Ready:
             qDebug() << "WebSDR: Ready";
             break;
-        case WebSdrController::Error:
+        case SdrController::Error:
             qDebug() << "WebSDR: Error";
             m_websdrSmeterValid = false;  // Reset S-meter on error
             break;
@@ -1847,6 +2032,18 @@ void MainWindow::onAudioDevicesClicked()
     dialog.devicePanel()->setSelectedLoopbackByName(m_devicePanel->getSelectedLoopbackName());
     dialog.devicePanel()->setSelectedOutputByName(m_devicePanel->getSelectedOutputName());
 
+    // Latency profile and the estimated latency of the running streams
+    dialog.setLatencyProfile(m_settings.audio().latencyProfile);
+    AudioManager::LatencyReport latency = m_audioManager->estimateLatency();
+    if (latency.valid) {
+        dialog.setLatencyInfo(QString("%1 ms (in %2 + buffer %3 + out %4)\n%5 / %6")
+            .arg(latency.totalMs, 0, 'f', 1)
+            .arg(latency.inputMs, 0, 'f', 1)
+            .arg(latency.bufferMs + latency.resamplerMs, 0, 'f', 1)
+            .arg(latency.outputMs, 0, 'f', 1)
+            .arg(latency.inputMode.isEmpty() ? "-" : latency.inputMode, latency.outputMode));
+    }
+
     if (dialog.exec() == QDialog::Accepted) {
         // Copy selections from dialog to main device panel
         QString inputName = dialog.devicePanel()->getSelectedInputName();
@@ -1861,8 +2058,12 @@ void MainWindow::onAudioDevicesClicked()
         m_settings.devices().radioInput = inputName;
         m_settings.devices().systemLoopback = loopbackName;
         m_settings.devices().output = outputName;
+        m_settings.audio().latencyProfile = dialog.latencyProfile();
         m_settings.save();
 
+        m_audioManager->setLatencyProfile(
+            AudioManager::latencyProfileFromName(m_settings.audio().latencyProfile));
+
         qDebug() << "Audio devices updated - Input:" << inputName
                  << "Loopback:" << loopbackName << "Output:" << outputName;
     }
@@ -1926,6 +2127,9 @@ void MainWindow::onToggleWebSdrView(bool checked)
         qDebug() << "WebSDR view collapsed to compact mode";
     }
 
+    // Audio-only sites stop rendering while the browser is hidden
+    m_webSdrManager->setBrowserVisible(checked);
+
     // Mark settings as dirty so the view preference is saved
     m_settings.markDirty();
 }
@@ -1938,59 +2142,26 @@ float MainWindow::getDelayedSMeterValue() const
     // Compensation for CI-V polling latency (~100ms) + physics smoothing (~50ms)
     static constexpr int SMETER_LATENCY_COMPENSATION_MS = 150;
 
-    if (delayMs == 0 || m_smeterBuffer.empty()) {
+    if (delayMs == 0 || m_radioSMeterHistory.isEmpty()) {
         // No delay or no samples - return latest value
         return m_civSMeterDb;
     }
 
-    // Calculate target timestamp (now - delay + compensation)
-    // We look further back to compensate for display latency
+    // Value at (now - delay + compensation), interpolated between the two
+    // samples around it. We look further back to compensate for display latency
     qint64 now = m_smeterTimer.elapsed();
     int adjustedDelay = std::max(0, delayMs - SMETER_LATENCY_COMPENSATION_MS);
-    qint64 targetTime = now - adjustedDelay;
-
-    // Find the sample closest to the target time
-    // Buffer is ordered oldest to newest
-    float result = m_civSMeterDb;  // Default to latest
-
-    for (auto it = m_smeterBuffer.rbegin(); it != m_smeterBuffer.rend(); ++it) {
-        if (it->timestamp <= targetTime) {
-            result = it->valueDb;
-            break;
-        }
-        // Keep updating result with older samples
-        result = it->valueDb;
-    }
-
-    return result;
+    return m_radioSMeterHistory.valueAt(now - adjustedDelay, m_civSMeterDb);
 }
 
 float MainWindow::getDelayedWebSdrSMeterValue() const
 {
     // Fixed 200ms delay to compensate for browser audio buffering
-    if (m_websdrSmeterBuffer.empty()) {
-        return m_websdrSMeterDb;
-    }
-
-    // Calculate target timestamp (now - 200ms)
     qint64 now = m_smeterTimer.elapsed();
-    qint64 targetTime = now - WEBSDR_SMETER_DELAY_MS;
-
-    // Find the sample closest to the target time
-    float result = m_websdrSMeterDb;  // Default to latest
-
-    for (auto it = m_websdrSmeterBuffer.rbegin(); it != m_websdrSmeterBuffer.rend(); ++it) {
-        if (it->timestamp <= targetTime) {
-            result = it->valueDb;
-            break;
-        }
-        result = it->valueDb;
-    }
-
-    return result;
+    return m_sdrSMeterHistory.valueAt(now - WEBSDR_SMETER_DELAY_MS, m_websdrSMeterDb);
 }
 
-void MainWindow::onWebSdrSmeterChanged(int value)
+void MainWindow::onWebSdrSmeterChanged(int value, qint64 sampledMs)
 {
     // Convert WebSDR smeter value to dB scale for display
     // WebSDR uses soundapplet.smeter() which returns:
@@ -2013,14 +2184,10 @@ void MainWindow::onWebSdrSmeterChanged(int value)
 
     float dbValue = DB_MIN + normalized * (DB_MAX - DB_MIN);
 
-    // Store in delay buffer to compensate for browser audio latency
-    qint64 now = m_smeterTimer.elapsed();
-    m_websdrSmeterBuffer.push_back({now, dbValue});
-
-    // Limit buffer size
-    while (m_websdrSmeterBuffer.size() > WEBSDR_SMETER_BUFFER_MAX) {
-        m_websdrSmeterBuffer.pop_front();
-    }
+    // Record in the history at the time the SDR page measured it (rebased
+    // onto m_smeterTimer), so IPC and GUI load do not skew it; the display
+    // reads it back delayed to compensate for browser audio latency
+    m_sdrSMeterHistory.append(sampledMs - m_smeterTimer.msecsSinceReference(), dbValue);
 
     m_websdrSmeterValid = true;
 }
@@ -2170,33 +2337,7 @@ void MainWindow::updateModeSelection(uint8_t mode)
 
 int MainWindow::frequencyToBandIndex(uint64_t freqHz) const
 {
-    // Band ranges in Hz (approximate)
-    struct BandRange {
-        uint64_t low;
-        uint64_t high;
-        int index;
-    };
-
-    static const BandRange ranges[] = {
-        {1800000,  2000000,  0},  // 160m
-        {3500000,  4000000,  1},  // 80m
-        {7000000,  7300000,  2},  // 40m
-        {10100000, 10150000, 3},  // 30m
-        {14000000, 14350000, 4},  // 20m
-        {18068000, 18168000, 5},  // 17m
-        {21000000, 21450000, 6},  // 15m
-        {24890000, 24990000, 7},  // 12m
-        {28000000, 29700000, 8},  // 10m
-        {50000000, 54000000, 9},  // 6m
-    };
-
-    for (const auto& range : ranges) {
-        if (freqHz >= range.low && freqHz <= range.high) {
-            return range.index;
-        }
-    }
-
-    return -1;  // Not in any amateur band
+    return BandPlan::bandIndex(freqHz);  // -1 if not in any amateur band
 }
 
 int MainWindow::modeToIndex(uint8_t mode) const
@@ -2209,6 +2350,25 @@ int MainWindow::modeToIndex(uint8_t mode) const
     return -1;
 }
 
+void MainWindow::releaseRadioController()
+{
+    if (!m_radioController) {
+        return;
+    }
+
+    // The scope window belongs to this controller (turns scope output off)
+    if (m_scopeDialog) {
+        m_scopeDialog->close();
+    }
+
+    // The controller lives on the I/O thread: close the port there (blocking),
+    // stop listening to it, then let its own thread delete it
+    m_radioController->disconnect();
+    QObject::disconnect(m_radioController, nullptr, this, nullptr);
+    m_radioController->deleteLater();
+    m_radioController = nullptr;
+}
+
 void MainWindow::setRadioControlsEnabled(bool enabled)
 {
     m_tuneButton->setEnabled(enabled);
@@ -2406,6 +2566,308 @@ void MainWindow::onDialInactive()
 
 // ========== Voice Memory Configuration ==========
 
+void MainWindow::onSdrDirectory()
+{
+    // Non-modal so the ranking can be watched while probes run
+    if (!m_sdrDirectoryDialog) {
+        SdrDirectoryDialog* dialog = new SdrDirectoryDialog(m_sdrDirectory, m_sdrProber, this);
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
+        dialog->setRadioBand(m_radioBand);
+        connect(dialog, &SdrDirectoryDialog::probeRequested, this, [this]() {
+            m_sdrProber->probeBand(m_radioBand, true);
+        });
+        connect(dialog, &SdrDirectoryDialog::addSiteRequested, this, [this](const WebSdrSite& site) {
+            addDirectorySite(site, false);
+        });
+        m_sdrDirectoryDialog = dialog;
+    }
+    m_sdrDirectoryDialog->show();
+    m_sdrDirectoryDialog->raise();
+    m_sdrDirectoryDialog->activateWindow();
+}
+
+void MainWindow::updateRadioBand(uint64_t frequencyHz)
+{
+    QString band = SdrDirectory::bandForFrequency(frequencyHz);
+    if (band == m_radioBand) return;
+
+    m_radioBand = band;
+    if (auto* dialog = qobject_cast<SdrDirectoryDialog*>(m_sdrDirectoryDialog.data())) {
+        dialog->setRadioBand(band);
+    }
+
+    // Out of band: finish nothing half-measured on the wrong frequency
+    if (band.isEmpty()) {
+        m_sdrProber->cancel();
+        return;
+    }
+    m_sdrProber->probeBand(band);
+}
+
+void MainWindow::onSdrBandProbed(const QString& band)
+{
+    if (band == m_radioBand) {
+        offerBestSite(band);
+    }
+}
+
+void MainWindow::offerBestSite(const QString& band)
+{
+    // Once per band per session, and only while an SDR is in use
+    if (!m_civConnected || m_offeredBands.contains(band) || m_siteOfferBox) return;
+
+    WebSdrSite best = m_sdrDirectory->best(band);
+    WebSdrSite current = WebSdrSite::findById(m_settings.webSdrSites(), m_settings.webSdr().selectedSiteId);
+    if (!best.isValid() || best.isSameServer(current)) return;
+    m_offeredBands.insert(band);
+
+    const SdrDirectory::ProbeResult result = m_sdrDirectory->find(best.id)->results.value(band);
+    QString detail = result.delayValid
+        ? QString("%1 ms behind the radio").arg(result.delayMs)
+        : QString("connects in %1 ms").arg(result.connectMs);
+
+    // Non-modal: the question must not hold up operating
+    QMessageBox* box = new QMessageBox(QMessageBox::Question, "Best SDR Site",
+        QString("%1 ranks best on %2 (%3).\n\nSwitch to it?").arg(best.name, band, detail),
+        QMessageBox::Yes | QMessageBox::No, this);
+    box->setAttribute(Qt::WA_DeleteOnClose);
+    box->setModal(false);
+    connect(box, &QMessageBox::finished, this, [this, best, box]() {
+        if (box->clickedButton() == box->button(QMessageBox::Yes)) {
+            addDirectorySite(best, true);
+        }
+    });
+    m_siteOfferBox = box;
+    box->show();
+}
+
+void MainWindow::addDirectorySite(const WebSdrSite& site, bool select)
+{
+    // A server already in the list keeps the user's entry (name, password, flags)
+    QList<WebSdrSite> sites = m_settings.webSdrSites();
+    auto known = std::find_if(sites.begin(), sites.end(),
+                              [&site](const WebSdrSite& s) { return s.isSameServer(site); });
+    WebSdrSite target = (known != sites.end()) ? *known : site;
+
+    if (known == sites.end()) {
+        sites.append(site);
+        m_settings.setWebSdrSites(sites);
+        m_settings.markDirty();
+        m_webSdrManager->setSiteList(sites);
+        m_radioControlPanel->setSiteList(sites);
+        m_radioControlPanel->setSelectedSite(m_settings.webSdr().selectedSiteId);
+        qDebug() << "MainWindow: Added directory site" << site.name;
+    }
+
+    if (select) {
+        m_radioControlPanel->setSelectedSite(target.id);
+        onWebSdrSiteChanged(target);
+    }
+}
+
+AudioSync::SignalMode MainWindow::radioSyncMode() const
+{
+    if (!m_radioController) return AudioSync::VOICE;
+
+    uint8_t radioMode = m_radioController->currentMode();
+    if (radioMode == CIVProtocol::MODE_CW ||
+        radioMode == CIVProtocol::MODE_CW_R ||
+        radioMode == CIVProtocol::MODE_RTTY ||
+        radioMode == CIVProtocol::MODE_RTTY_R) {
+        return AudioSync::CW;
+    }
+    return AudioSync::VOICE;
+}
+
+void MainWindow::onAudioDiagnostics()
+{
+    // Non-modal so it can stay open while operating
+    if (!m_diagnosticsDialog) {
+        m_diagnosticsDialog = new DiagnosticsDialog(m_audioManager.get(), m_webSdrManager, this);
+        m_diagnosticsDialog->setAttribute(Qt::WA_DeleteOnClose);
+    }
+    m_diagnosticsDialog->show();
+    m_diagnosticsDialog->raise();
+    m_diagnosticsDialog->activateWindow();
+}
+
+void MainWindow::onRadioScope()
+{
+    if (!m_radioController || !m_radioController->supportsScope()) {
+        QMessageBox::information(this, "Radio Scope",
+            "The spectrum scope needs a connected Icom radio that streams\n"
+            "its scope over CI-V (IC-7300, IC-705, IC-7610, IC-9700).");
+        return;
+    }
+
+    if (!m_scopeDialog) {
+        QDialog* dialog = new QDialog(this);
+        dialog->setWindowTitle("Radio Scope");
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
+
+        WaterfallWidget* waterfall = new WaterfallWidget(dialog);
+        QVBoxLayout* layout = new QVBoxLayout(dialog);
+        layout->setContentsMargins(4, 4, 4, 4);
+        layout->addWidget(waterfall);
+
+        // Sweeps come from the serial thread; the connection is queued
+        connect(m_radioController, &RadioController::scopeLineReady,
+                waterfall, &WaterfallWidget::addLine);
+        connect(dialog, &QDialog::finished, this, [this]() {
+            if (m_radioController) {
+                m_radioController->setScopeEnabled(false);
+            }
+        });
+
+        m_radioController->setScopeEnabled(true);
+        m_scopeDialog = dialog;
+    }
+    m_scopeDialog->show();
+    m_scopeDialog->raise();
+    m_scopeDialog->activateWindow();
+}
+
+void MainWindow::onSignalHistory()
+{
+    if (!m_historyDialog) {
+        QDialog* dialog = new QDialog(this);
+        dialog->setWindowTitle("Signal History");
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
+
+        // Reads the history series directly; repaints on its own timer
+        SignalHistoryGraph* graph = new SignalHistoryGraph(&m_smeterTimer, &m_radioSMeterHistory,
+                                                           &m_sdrSMeterHistory, &m_txHistory, dialog);
+        QVBoxLayout* layout = new QVBoxLayout(dialog);
+        layout->setContentsMargins(4, 4, 4, 4);
+        layout->addWidget(graph);
+
+        m_historyDialog = dialog;
+    }
+    m_historyDialog->show();
+    m_historyDialog->raise();
+    m_historyDialog->activateWindow();
+}
+
+void MainWindow::onRigctldAddress()
+{
+    bool ok = false;
+    QString address = QInputDialog::getText(this, "rigctld Address",
+        "Host and port of the Hamlib rigctld daemon sharing the radio:",
+        QLineEdit::Normal, m_settings.serial().rigctldAddress, &ok).trimmed();
+    if (!ok || address.isEmpty()) {
+        return;
+    }
+
+    QString host;
+    quint16 tcpPort = 0;
+    if (!RigctldController::parseAddress(address, host, tcpPort)) {
+        QMessageBox::warning(this, "rigctld Address",
+            QString("\"%1\" is not a valid address. Use host:port, e.g. localhost:4532.").arg(address));
+        return;
+    }
+
+    m_settings.serial().rigctldAddress = address;
+    m_settings.markDirty();
+    m_settings.save();
+    qDebug() << "rigctld address set to" << address << "(used on the next connect)";
+}
+
+void MainWindow::onKiwiNativeAudioToggled(bool checked)
+{
+    m_settings.webSdr().kiwiNativeAudio = checked;
+    m_settings.markDirty();
+    m_settings.save();
+    m_webSdrManager->setKiwiNativeAudio(checked);
+    qDebug() << "KiwiSDR native audio" << (checked ? "enabled" : "disabled") << "(used on the next site load)";
+}
+
+void MainWindow::onPageAudioCaptureToggled(bool checked)
+{
+    m_settings.webSdr().pageAudioCapture = checked;
+    m_settings.markDirty();
+    m_settings.save();
+    m_webSdrManager->setPageAudioCapture(checked);
+    qDebug() << "SDR page audio capture" << (checked ? "enabled" : "disabled");
+}
+
+void MainWindow::onDiversityBestOfToggled(bool checked)
+{
+    m_settings.webSdr().diversityBestOf = checked;
+    m_settings.markDirty();
+    m_settings.save();
+    if (MixerCore* mixer = m_audioManager->mixer()) {
+        mixer->diversity()->setMode(checked ? DiversityCombiner::Mode::BestOf
+                                            : DiversityCombiner::Mode::Sum);
+    }
+    qDebug() << "SDR diversity:" << (checked ? "best-of" : "average");
+}
+
+void MainWindow::onDiversitySourceChanged(int source, const QString& siteId)
+{
+    m_audioManager->setDiversitySourceActive(source, !siteId.isEmpty());
+
+    MixerCore* mixer = m_audioManager->mixer();
+    if (!mixer) return;
+    DiversityCombiner* diversity = mixer->diversity();
+
+    if (!siteId.isEmpty()) {
+        // Not lined up until the next sync
+        diversity->setSourceDelayMs(source, 0.0f);
+        qDebug() << "SDR diversity: Receiver" << source << "is" << siteId << "- sync to line it up";
+        return;
+    }
+
+    // Last receiver gone: take channel 2's alignment delay back out of the radio delay
+    diversity->setSourceDelayMs(source, 0.0f);
+    for (int s = 1; s < DiversityCombiner::MAX_SOURCES; s++) {
+        if (m_audioManager->isDiversitySourceActive(s)) return;
+    }
+    int channel2DelayMs = static_cast<int>(diversity->sourceDelayMs(0));
+    if (channel2DelayMs > 0) {
+        diversity->setSourceDelayMs(0, 0.0f);
+        m_delaySlider->setValue(std::max(0, m_delaySlider->value() - channel2DelayMs));
+    }
+}
+
+int MainWindow::alignDiversitySources(int mainLatencyMs)
+{
+    // Each connected source's radio-to-receiver latency: measured by this sync,
+    // or implied by its current alignment. The radio is delayed by the largest
+    // and every source by the difference, so all of them line up.
+    MixerCore* mixer = m_audioManager->mixer();
+    DiversityCombiner* diversity = mixer->diversity();
+    int radioDelayMs = m_delaySlider->value();
+
+    float latencyMs[DiversityCombiner::MAX_SOURCES];
+    bool connected[DiversityCombiner::MAX_SOURCES] = {};
+    latencyMs[0] = static_cast<float>(mainLatencyMs);
+    connected[0] = true;
+    float maxLatencyMs = latencyMs[0];
+
+    for (int s = 1; s < DiversityCombiner::MAX_SOURCES; s++) {
+        if (!m_audioManager->isDiversitySourceActive(s)) continue;
+        connected[s] = true;
+
+        AudioSync::SyncResult result;
+        if (diversity->takeSyncResult(s, result) && result.success) {
+            latencyMs[s] = result.delayMs;
+            qDebug() << "SDR diversity: Receiver" << s << "latency" << result.delayMs
+                     << "ms (confidence:" << result.confidence * 100 << "%)";
+        } else {
+            latencyMs[s] = radioDelayMs - diversity->sourceDelayMs(s);
+        }
+        maxLatencyMs = std::max(maxLatencyMs, latencyMs[s]);
+    }
+    maxLatencyMs = std::min(maxLatencyMs, static_cast<float>(DelayBuffer::MAX_DELAY_MS));
+
+    for (int s = 0; s < DiversityCombiner::MAX_SOURCES; s++) {
+        if (connected[s]) {
+            diversity->setSourceDelayMs(s, maxLatencyMs - latencyMs[s]);
+        }
+    }
+    return static_cast<int>(maxLatencyMs);
+}
+
 void MainWindow::onVoiceMemoryConfig()
 {
     VoiceMemoryDialog dialog(m_voiceMemoryLabels, this);
@@ -10,7 +10,6 @@
 #include <QMenu>
 #include <QGroupBox>
 #include <memory>
-#include <deque>
 
 #include "audio/AudioManager.h"
 #include "config/Settings.h"
@@ -20,10 +19,16 @@
 #include "ui/Crossfader.h"
 #include "ui/SMeter.h"
 #include "ui/RadioControlPanel.h"
+#include "ui/TelemetrySeries.h"
 #include "serial/RadioController.h"
+#include "serial/RadioDetector.h"
 #include "websdr/WebSdrManager.h"
+#include "websdr/SdrDirectory.h"
+#include "websdr/SdrProber.h"
 
 #include <QButtonGroup>
+#include <QPointer>
+#include <QSet>
 
 /**
  * @brief Main application window
@@ -54,22 +59,34 @@ private slots:
     // CI-V serial connection slots
     void onSerialConnectClicked();
     void onSerialDisconnectClicked();
+    void onRadioDetected(RadioController* controller, const RadioDetector::Result& result);
+    void onRadioDetectionFailed(const QString& reason);
     void onRadioConnectionStateChanged(RadioController::ConnectionState state);
     void onCIVFrequencyChanged(uint64_t frequencyHz);
     void onCIVModeChanged(uint8_t mode, const QString& modeName);
-    void onCIVSMeterChanged(int value);
+    void onCIVSMeterChanged(int value, qint64 arrivalMs);
     void onCIVError(const QString& error);
     void onTxStatusChanged(bool transmitting);
 
     // WebSDR slots
     void onWebSdrSiteChanged(const WebSdrSite& site);
-    void onWebSdrStateChanged(WebSdrController::State state);
-    void onWebSdrSmeterChanged(int value);
+    void onWebSdrStateChanged(SdrController::State state);
+    void onWebSdrSmeterChanged(int value, qint64 sampledMs);
     void onManageWebSdr();
+    void onSdrDirectory();
+    void onSdrBandProbed(const QString& band);
 
     // Settings dialogs
     void onAudioDevicesClicked();
     void onVoiceMemoryConfig();
+    void onRigctldAddress();
+    void onKiwiNativeAudioToggled(bool checked);
+    void onPageAudioCaptureToggled(bool checked);
+    void onDiversityBestOfToggled(bool checked);
+    void onDiversitySourceChanged(int source, const QString& siteId);
+    void onAudioDiagnostics();
+    void onRadioScope();
+    void onSignalHistory();
 
     // View toggle
     void onToggleWebSdrView(bool checked);
@@ -95,6 +112,9 @@ private:
 
     // UI components
     RadioControlPanel* m_radioControlPanel;
+    QPointer<QDialog> m_diagnosticsDialog;  // Non-modal, created on first use
+    QPointer<QDialog> m_scopeDialog;        // Radio spectrum scope waterfall
+    QPointer<QDialog> m_historyDialog;      // Radio vs SDR S-meter history graph
     DevicePanel* m_devicePanel;
     SMeter* m_radioSMeter;
     SMeter* m_websdrSMeter;
@@ -105,10 +125,20 @@ private:
 
     // Radio Controller (Icom CI-V or Kenwood/Elecraft CAT)
     RadioController* m_radioController;
+    RadioDetector* m_radioDetector;  // Probes the port asynchronously on connect
+    QThread* m_radioThread;          // Serial I/O thread the controller runs on
 
     // WebSDR Manager (manages multiple WebSDR sites)
     WebSdrManager* m_webSdrManager;
 
+    // SDR directory: public sites probed in the background, ranked per band
+    SdrDirectory* m_sdrDirectory;
+    SdrProber* m_sdrProber;
+    QPointer<QDialog> m_sdrDirectoryDialog;  // Non-modal, created on first use
+    QPointer<QDialog> m_siteOfferBox;        // Pending "switch to the best site" question
+    QString m_radioBand;                     // Band of the radio frequency ("40m", empty outside)
+    QSet<QString> m_offeredBands;            // Best site already offered this session
+
     // CI-V S-meter data with delay buffer for sync with audio
     float m_civSMeterDb;
     bool m_civConnected;
@@ -121,24 +151,23 @@ private:
     float m_websdrSMeterDb;
     bool m_websdrSmeterValid;
 
-    // S-Meter sample structure for delay buffers
-    struct SMeterSample {
-        qint64 timestamp;  // ms since app start
-        float valueDb;
-    };
+    // S-meter history, timestamped on m_smeterTimer. The delayed S-meter
+    // displays and the history graph both read from these.
     QElapsedTimer m_smeterTimer;
+    static constexpr int SMETER_HISTORY_SAMPLES = 8192;  // >10 min at 10Hz
 
-    // Radio S-Meter delay buffer (syncs S-meter display with delayed audio)
-    std::deque<SMeterSample> m_smeterBuffer;
-    static constexpr size_t SMETER_BUFFER_MAX = 64;  // ~6.4 sec at 10Hz
+    // Radio S-Meter history (syncs S-meter display with delayed audio)
+    TelemetrySeries m_radioSMeterHistory{SMETER_HISTORY_SAMPLES};
     float getDelayedSMeterValue() const;
 
-    // WebSDR S-Meter delay buffer (compensates for browser audio buffering)
-    std::deque<SMeterSample> m_websdrSmeterBuffer;
+    // WebSDR S-Meter history (compensates for browser audio buffering)
+    TelemetrySeries m_sdrSMeterHistory{SMETER_HISTORY_SAMPLES};
     static constexpr int WEBSDR_SMETER_DELAY_MS = 200;  // Browser audio latency compensation
-    static constexpr size_t WEBSDR_SMETER_BUFFER_MAX = 32;  // ~3.2 sec at 10Hz
     float getDelayedWebSdrSMeterValue() const;
 
+    // TX on/off history (shaded on the history graph)
+    TelemetrySeries m_txHistory{1024, TelemetrySeries::Interpolation::Step};
+
     // Delay controls
     QSlider* m_delaySlider;
     QLabel* m_delayLabel;
@@ -160,6 +189,9 @@ private:
 
     // Config menu
     QMenu* m_recentConfigsMenu;
+    QAction* m_kiwiNativeAudioAction = nullptr;
+    QAction* m_pageAudioCaptureAction = nullptr;
+    QAction* m_diversityBestOfAction = nullptr;
 
     // WebSDR browser view
     QGroupBox* m_browserGroup;
@@ -230,7 +262,14 @@ private:
     int frequencyToBandIndex(uint64_t freqHz) const;
     int modeToIndex(uint8_t mode) const;
     void setRadioControlsEnabled(bool enabled);
+    void releaseRadioController();
+    void connectRigctld();  // Network radio: skips RadioDetector
     void setDelayLabelSyncStatus(bool synced);  // Green if synced, orange if not
+    int alignDiversitySources(int mainLatencyMs);  // Returns the radio delay
+    AudioSync::SignalMode radioSyncMode() const;   // CW/RTTY envelope or voice, from the radio mode
+    void updateRadioBand(uint64_t frequencyHz);
+    void offerBestSite(const QString& band);
+    void addDirectorySite(const WebSdrSite& site, bool select);
     void updateVoiceButtonStates();
 
     void setupWindow();
@@ -7,6 +7,7 @@
 
 #include "RadioControlPanel.h"
 #include "serial/CIVController.h"  // For static availablePorts()
+#include "serial/RigctldController.h"
 #include "Styles.h"
 #include <QHBoxLayout>
 #include <QVBoxLayout>
@@ -53,7 +54,8 @@ void RadioControlPanel::setupUI()
     m_portCombo->setStyleSheet("QComboBox { min-width: 75px; max-width: 75px; }");
     m_portCombo->setFixedWidth(75);
     m_portCombo->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
-    m_portCombo->setToolTip("Select the COM port connected to the transceiver");
+    m_portCombo->setToolTip("Select the COM port connected to the transceiver,\n"
+                            "or \"rigctld\" to share it through Hamlib rigctld");
 
     m_connectButton = new QPushButton("Connect", serialGroup);
     m_connectButton->setFixedWidth(65);
@@ -434,10 +436,18 @@ void RadioControlPanel::setSerialConnectionState(RadioController::ConnectionStat
             break;
     }
 
+    m_connectButton->setToolTip("Connect to or disconnect from the radio");
     updateConnectButtonStyle();
 }
 
-void RadioControlPanel::setWebSdrState(WebSdrController::State state)
+void RadioControlPanel::setDetectionProgress(const QString& message, int attempt, int total)
+{
+    // Shown on the button while auto-detection probes baud rates
+    m_connectButton->setText(QString("%1/%2").arg(attempt).arg(total));
+    m_connectButton->setToolTip(message + "\nClick to cancel");
+}
+
+void RadioControlPanel::setWebSdrState(SdrController::State state)
 {
     // No longer showing status label, but we can change combo box style if needed
     Q_UNUSED(state)
@@ -478,8 +488,11 @@ void RadioControlPanel::setRadioModel(const QString& modelName)
 void RadioControlPanel::refreshPorts()
 {
     QStringList ports = CIVController::availablePorts();
-    setPortList(ports);
     qDebug() << "RadioControlPanel: Found" << ports.size() << "serial ports";
+
+    // A radio shared through rigctld is reached over the network instead
+    ports.append(RigctldController::PORT_NAME);
+    setPortList(ports);
 }
 
 void RadioControlPanel::setDialStepIndex(int index)
@@ -17,7 +17,7 @@
 
 #include "serial/RadioController.h"
 #include "websdr/WebSdrSite.h"
-#include "websdr/WebSdrController.h"
+#include "websdr/SdrController.h"
 #include "ui/FrequencyLCD.h"
 
 /**
@@ -46,7 +46,8 @@ public:
 
     // Status updates
     void setSerialConnectionState(RadioController::ConnectionState state);
-    void setWebSdrState(WebSdrController::State state);
+    void setDetectionProgress(const QString& message, int attempt, int total);
+    void setWebSdrState(SdrController::State state);
 
     // Frequency display
     void setFrequencyDisplay(uint64_t frequencyHz);
@@ -0,0 +1,226 @@
+/*
+ * SdrDirectoryDialog.cpp
+ *
+ * Browse, import and probe the SDR site directory
+ * Part of HamMixer CT7BAC
+ */
+
+#include "SdrDirectoryDialog.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QDebug>
+
+namespace {
+
+enum Column {
+    ColName,
+    ColType,
+    ColConnect,
+    ColAudioStart,
+    ColDelay,
+    ColProbed,
+    ColumnCount
+};
+
+QString msText(int ms)
+{
+    return ms >= 0 ? QString("%1 ms").arg(ms) : QString("-");
+}
+
+} // namespace
+
+SdrDirectoryDialog::SdrDirectoryDialog(SdrDirectory* directory, SdrProber* prober, QWidget* parent)
+    : QDialog(parent)
+    , m_directory(directory)
+    , m_prober(prober)
+{
+    setupUI();
+
+    connect(m_directory, &SdrDirectory::changed, this, &SdrDirectoryDialog::refresh);
+    connect(m_prober, &SdrProber::probeStarted, this, &SdrDirectoryDialog::updateStatus);
+    connect(m_prober, &SdrProber::bandProbed, this, &SdrDirectoryDialog::updateStatus);
+
+    refresh();
+    updateStatus();
+}
+
+void SdrDirectoryDialog::setupUI()
+{
+    setWindowTitle("SDR Directory");
+    setMinimumSize(640, 420);
+    resize(720, 480);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setContentsMargins(15, 15, 15, 15);
+    mainLayout->setSpacing(10);
+
+    QHBoxLayout* bandLayout = new QHBoxLayout();
+    bandLayout->addWidget(new QLabel("Band:", this));
+    m_bandCombo = new QComboBox(this);
+    m_bandCombo->addItems(SdrDirectory::bands());
+    bandLayout->addWidget(m_bandCombo);
+    bandLayout->addStretch();
+    mainLayout->addLayout(bandLayout);
+
+    m_table = new QTableWidget(0, ColumnCount, this);
+    m_table->setHorizontalHeaderLabels({"Site", "Type", "Connect", "Audio start", "Delay", "Probed"});
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(ColName, QHeaderView::Stretch);
+    m_table->setStyleSheet(
+        "QTableWidget { background-color: #2D2D30; border: 1px solid #3F3F46; }"
+        "QTableWidget::item:selected { background-color: #0078D4; }"
+    );
+    mainLayout->addWidget(m_table, 1);
+
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setStyleSheet("QLabel { color: #808080; font-size: 10pt; }");
+    mainLayout->addWidget(m_statusLabel);
+
+    QHBoxLayout* buttonRowLayout = new QHBoxLayout();
+
+    m_importButton = new QPushButton("Import...", this);
+    m_importButton->setToolTip("Add sites from a saved KiwiSDR/WebSDR list (JSON, HTML or text)");
+    buttonRowLayout->addWidget(m_importButton);
+
+    m_probeButton = new QPushButton("Probe now", this);
+    m_probeButton->setToolTip("Measure the sites again on the radio's band");
+    buttonRowLayout->addWidget(m_probeButton);
+
+    m_addButton = new QPushButton("Add to my sites", this);
+    m_addButton->setEnabled(false);
+    buttonRowLayout->addWidget(m_addButton);
+
+    buttonRowLayout->addStretch();
+
+    m_buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(m_buttonBox, &QDialogButtonBox::rejected, this, &QDialog::close);
+    buttonRowLayout->addWidget(m_buttonBox);
+
+    mainLayout->addLayout(buttonRowLayout);
+
+    connect(m_bandCombo, &QComboBox::currentTextChanged, this, &SdrDirectoryDialog::refresh);
+    connect(m_importButton, &QPushButton::clicked, this, &SdrDirectoryDialog::onImport);
+    connect(m_probeButton, &QPushButton::clicked, this, &SdrDirectoryDialog::probeRequested);
+    connect(m_addButton, &QPushButton::clicked, this, &SdrDirectoryDialog::onAddSite);
+    connect(m_table, &QTableWidget::itemSelectionChanged,
+            this, &SdrDirectoryDialog::onSelectionChanged);
+}
+
+void SdrDirectoryDialog::setRadioBand(const QString& band)
+{
+    bool follow = m_radioBand.isEmpty() || m_bandCombo->currentText() == m_radioBand;
+    m_radioBand = band;
+
+    // Follow the radio unless another band is being looked at
+    if (follow && !band.isEmpty()) {
+        m_bandCombo->setCurrentText(band);
+    }
+    updateStatus();
+}
+
+void SdrDirectoryDialog::refresh()
+{
+    QString band = m_bandCombo->currentText();
+    QString selectedId;
+    if (QTableWidgetItem* item = m_table->item(m_table->currentRow(), ColName)) {
+        selectedId = item->data(Qt::UserRole).toString();
+    }
+
+    // Ranked sites first, then the ones without a usable result
+    QList<const SdrDirectory::Entry*> rows = m_directory->ranked(band);
+    for (const SdrDirectory::Entry& entry : m_directory->entries()) {
+        if (!rows.contains(&entry)) rows.append(&entry);
+    }
+
+    m_table->setRowCount(0);
+    m_table->setRowCount(rows.size());
+    for (int row = 0; row < rows.size(); row++) {
+        const SdrDirectory::Entry* entry = rows[row];
+        auto result = entry->results.constFind(band);
+        bool probed = result != entry->results.constEnd();
+
+        QTableWidgetItem* nameItem = new QTableWidgetItem(entry->site.name);
+        nameItem->setData(Qt::UserRole, entry->site.id);
+        nameItem->setToolTip(entry->site.effectiveUrl());
+        m_table->setItem(row, ColName, nameItem);
+        m_table->setItem(row, ColType, new QTableWidgetItem(entry->site.isKiwiSDR() ? "KiwiSDR" : "WebSDR"));
+
+        if (!probed) {
+            m_table->setItem(row, ColConnect, new QTableWidgetItem("not probed"));
+        } else if (!result->reachable) {
+            m_table->setItem(row, ColConnect, new QTableWidgetItem("unreachable"));
+        } else {
+            m_table->setItem(row, ColConnect, new QTableWidgetItem(msText(result->connectMs)));
+            m_table->setItem(row, ColAudioStart, new QTableWidgetItem(msText(result->audioStartMs)));
+            m_table->setItem(row, ColDelay, new QTableWidgetItem(
+                result->delayValid ? msText(result->delayMs) : QString("-")));
+        }
+        if (probed) {
+            QString when = result->probedAt.toLocalTime().toString("dd MMM HH:mm");
+            if (result->isStale()) when += " (stale)";
+            m_table->setItem(row, ColProbed, new QTableWidgetItem(when));
+        }
+
+        if (entry->site.id == selectedId) {
+            m_table->selectRow(row);
+        }
+    }
+    onSelectionChanged();
+}
+
+void SdrDirectoryDialog::updateStatus()
+{
+    QString text;
+    if (m_prober->isBusy()) {
+        text = QString("Probing %1 (%2 more queued)...")
+                   .arg(m_prober->band())
+                   .arg(m_prober->pendingCount());
+    } else if (m_radioBand.isEmpty()) {
+        text = "Radio is outside the amateur bands; sites are probed on the radio's band.";
+    } else {
+        text = QString("Radio on %1. %2 sites in the directory.")
+                   .arg(m_radioBand)
+                   .arg(m_directory->entries().size());
+    }
+    m_statusLabel->setText(text);
+    m_probeButton->setEnabled(!m_radioBand.isEmpty() && !m_directory->entries().isEmpty());
+}
+
+void SdrDirectoryDialog::onImport()
+{
+    QString path = QFileDialog::getOpenFileName(
+        this, "Import SDR List", QString(),
+        "SDR lists (*.json *.html *.htm *.txt);;All files (*)");
+    if (path.isEmpty()) return;
+
+    int added = m_directory->importFile(path);
+    if (added < 0) {
+        QMessageBox::warning(this, "Import Failed", "Could not read " + path);
+        return;
+    }
+    QMessageBox::information(this, "Import",
+                             QString("%1 new sites added to the directory.").arg(added));
+    updateStatus();
+}
+
+void SdrDirectoryDialog::onAddSite()
+{
+    QTableWidgetItem* item = m_table->item(m_table->currentRow(), ColName);
+    if (!item) return;
+
+    if (const SdrDirectory::Entry* entry = m_directory->find(item->data(Qt::UserRole).toString())) {
+        emit addSiteRequested(entry->site);
+    }
+}
+
+void SdrDirectoryDialog::onSelectionChanged()
+{
+    m_addButton->setEnabled(m_table->currentRow() >= 0 && !m_table->selectedItems().isEmpty());
+}
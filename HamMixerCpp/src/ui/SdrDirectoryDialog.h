@@ -0,0 +1,69 @@
+/*
+ * SdrDirectoryDialog.h
+ *
+ * Browse, import and probe the SDR site directory
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef SDRDIRECTORYDIALOG_H
+#define SDRDIRECTORYDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QLabel>
+#include <QDialogButtonBox>
+
+#include "websdr/SdrDirectory.h"
+#include "websdr/SdrProber.h"
+
+/**
+ * @brief Non-modal view of the SDR directory, ranked per band
+ *
+ * Shows every directory site with its probe result on the chosen band,
+ * best first; sites without a fresh result follow. Lists are imported from
+ * a local file. Probing always uses the radio's band (the probes are tuned
+ * to the radio), so "Probe now" asks for that band to be measured again.
+ */
+class SdrDirectoryDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    SdrDirectoryDialog(SdrDirectory* directory, SdrProber* prober, QWidget* parent = nullptr);
+    ~SdrDirectoryDialog() override = default;
+
+    /**
+     * @brief Band the radio is on (empty outside the amateur bands)
+     */
+    void setRadioBand(const QString& band);
+
+signals:
+    void probeRequested();
+    void addSiteRequested(const WebSdrSite& site);
+
+private slots:
+    void refresh();
+    void onImport();
+    void onAddSite();
+    void onSelectionChanged();
+    void updateStatus();
+
+private:
+    void setupUI();
+
+    SdrDirectory* m_directory;
+    SdrProber* m_prober;
+    QString m_radioBand;
+
+    QComboBox* m_bandCombo;
+    QTableWidget* m_table;
+    QLabel* m_statusLabel;
+    QPushButton* m_importButton;
+    QPushButton* m_probeButton;
+    QPushButton* m_addButton;
+    QDialogButtonBox* m_buttonBox;
+};
+
+#endif // SDRDIRECTORYDIALOG_H
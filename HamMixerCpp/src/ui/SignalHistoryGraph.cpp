@@ -0,0 +1,131 @@
+/*
+ * SignalHistoryGraph.cpp
+ *
+ * Scrolling radio vs SDR signal strength history
+ * Part of HamMixer CT7BAC
+ */
+
+#include "ui/SignalHistoryGraph.h"
+#include "ui/TelemetrySeries.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <algorithm>
+
+SignalHistoryGraph::SignalHistoryGraph(const QElapsedTimer* clock, const TelemetrySeries* radio,
+                                       const TelemetrySeries* sdr, const TelemetrySeries* tx,
+                                       QWidget* parent)
+    : QWidget(parent)
+    , m_clock(clock)
+    , m_radio(radio)
+    , m_sdr(sdr)
+    , m_tx(tx)
+{
+    setMinimumSize(400, 160);
+
+    m_refreshTimer = new QTimer(this);
+    connect(m_refreshTimer, &QTimer::timeout, this, QOverload<>::of(&QWidget::update));
+    m_refreshTimer->start(REFRESH_MS);
+}
+
+QSize SignalHistoryGraph::sizeHint() const
+{
+    return QSize(720, 240);
+}
+
+void SignalHistoryGraph::setWindowSeconds(int seconds)
+{
+    m_windowSeconds = std::max(10, seconds);
+    update();
+}
+
+void SignalHistoryGraph::drawSeries(QPainter& painter, const QRect& plot, const TelemetrySeries* series,
+                                    qint64 startMs, qint64 endMs, const QColor& color)
+{
+    if (!series || series->isEmpty()) {
+        return;
+    }
+
+    // Nothing recorded before the first sample: start the trace there
+    qint64 firstMs = std::max(startMs, series->oldest().timeMs);
+    double msPerPixel = static_cast<double>(endMs - startMs) / plot.width();
+
+    QPainterPath path;
+    bool started = false;
+    for (int x = 0; x < plot.width(); x++) {
+        qint64 t = startMs + static_cast<qint64>(x * msPerPixel);
+        if (t < firstMs) {
+            continue;
+        }
+        float db = std::clamp(series->valueAt(t), DB_MIN, DB_MAX);
+        double y = plot.bottom() - (db - DB_MIN) / (DB_MAX - DB_MIN) * plot.height();
+        if (!started) {
+            path.moveTo(plot.left() + x, y);
+            started = true;
+        } else {
+            path.lineTo(plot.left() + x, y);
+        }
+    }
+
+    painter.setPen(QPen(color, 1.5));
+    painter.drawPath(path);
+}
+
+void SignalHistoryGraph::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), QColor(0x1E, 0x1E, 0x1E));
+
+    QRect plot = rect().adjusted(40, 20, -10, -20);
+    if (plot.width() <= 0 || plot.height() <= 0) {
+        return;
+    }
+
+    qint64 endMs = m_clock->elapsed();
+    qint64 startMs = endMs - static_cast<qint64>(m_windowSeconds) * 1000;
+
+    // TX periods as shaded bands
+    if (m_tx && !m_tx->isEmpty()) {
+        double msPerPixel = static_cast<double>(endMs - startMs) / plot.width();
+        int bandStart = -1;
+        for (int x = 0; x <= plot.width(); x++) {
+            bool tx = x < plot.width() &&
+                      m_tx->valueAt(startMs + static_cast<qint64>(x * msPerPixel)) > 0.5f;
+            if (tx && bandStart < 0) {
+                bandStart = x;
+            } else if (!tx && bandStart >= 0) {
+                painter.fillRect(QRect(plot.left() + bandStart, plot.top(), x - bandStart, plot.height()),
+                                 QColor(0xF4, 0x43, 0x36, 50));
+                bandStart = -1;
+            }
+        }
+    }
+
+    // Grid: every 20 dB and every minute
+    painter.setPen(QColor(0x42, 0x42, 0x42));
+    for (float db = DB_MIN; db <= DB_MAX; db += 20.0f) {
+        int y = plot.bottom() - static_cast<int>((db - DB_MIN) / (DB_MAX - DB_MIN) * plot.height());
+        painter.drawLine(plot.left(), y, plot.right(), y);
+        painter.drawText(QRect(0, y - 8, plot.left() - 4, 16), Qt::AlignRight | Qt::AlignVCenter,
+                         QString::number(static_cast<int>(db)));
+    }
+    for (int s = 60; s < m_windowSeconds; s += 60) {
+        int x = plot.right() - static_cast<int>(static_cast<double>(s) / m_windowSeconds * plot.width());
+        painter.drawLine(x, plot.top(), x, plot.bottom());
+        painter.drawText(QRect(x - 30, plot.bottom() + 2, 60, 16), Qt::AlignCenter,
+                         QString("-%1 min").arg(s / 60));
+    }
+
+    drawSeries(painter, plot, m_sdr, startMs, endMs, QColor(0x21, 0x96, 0xF3));
+    drawSeries(painter, plot, m_radio, startMs, endMs, QColor(0x4C, 0xAF, 0x50));
+
+    // Legend
+    painter.setPen(QColor(0x4C, 0xAF, 0x50));
+    painter.drawText(QRect(plot.left(), 2, 100, 16), Qt::AlignLeft | Qt::AlignVCenter, "Radio");
+    painter.setPen(QColor(0x21, 0x96, 0xF3));
+    painter.drawText(QRect(plot.left() + 60, 2, 100, 16), Qt::AlignLeft | Qt::AlignVCenter, "SDR");
+    painter.setPen(QColor(0xF4, 0x43, 0x36));
+    painter.drawText(QRect(plot.left() + 110, 2, 100, 16), Qt::AlignLeft | Qt::AlignVCenter, "TX");
+}
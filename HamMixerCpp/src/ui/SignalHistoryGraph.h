@@ -0,0 +1,62 @@
+/*
+ * SignalHistoryGraph.h
+ *
+ * Scrolling radio vs SDR signal strength history
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef SIGNALHISTORYGRAPH_H
+#define SIGNALHISTORYGRAPH_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class TelemetrySeries;
+
+/**
+ * @brief Plots two S-meter series (and TX periods) over the last few minutes
+ *
+ * Reads the series owned by MainWindow; every refresh samples each series
+ * once per pixel column with TelemetrySeries::valueAt(), so the cost
+ * depends on the widget width, not on how many samples were recorded.
+ */
+class SignalHistoryGraph : public QWidget {
+    Q_OBJECT
+
+public:
+    /**
+     * @param clock Timer the series timestamps are relative to
+     * @param radio Radio S-meter in dB (-80..0)
+     * @param sdr SDR S-meter in dB (-80..0)
+     * @param tx TX state (0/1), shaded behind the traces; may be nullptr
+     */
+    SignalHistoryGraph(const QElapsedTimer* clock, const TelemetrySeries* radio,
+                       const TelemetrySeries* sdr, const TelemetrySeries* tx,
+                       QWidget* parent = nullptr);
+
+    void setWindowSeconds(int seconds);
+    int windowSeconds() const { return m_windowSeconds; }
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    void drawSeries(QPainter& painter, const QRect& plot, const TelemetrySeries* series,
+                    qint64 startMs, qint64 endMs, const QColor& color);
+
+    const QElapsedTimer* m_clock;
+    const TelemetrySeries* m_radio;
+    const TelemetrySeries* m_sdr;
+    const TelemetrySeries* m_tx;
+    int m_windowSeconds = 300;
+    QTimer* m_refreshTimer;
+
+    static constexpr float DB_MIN = -80.0f;
+    static constexpr float DB_MAX = 0.0f;
+    static constexpr int REFRESH_MS = 250;
+};
+
+#endif // SIGNALHISTORYGRAPH_H
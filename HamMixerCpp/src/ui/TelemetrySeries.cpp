@@ -0,0 +1,86 @@
+/*
+ * TelemetrySeries.cpp
+ *
+ * Fixed-capacity, time-indexed ring of telemetry samples
+ * Part of HamMixer CT7BAC
+ */
+
+#include "ui/TelemetrySeries.h"
+#include <algorithm>
+
+TelemetrySeries::TelemetrySeries(int capacity, Interpolation mode)
+    : m_mode(mode)
+{
+    int size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    m_samples.resize(static_cast<size_t>(size));
+    m_mask = size - 1;
+}
+
+void TelemetrySeries::append(qint64 timeMs, float value)
+{
+    if (m_count > 0) {
+        timeMs = std::max(timeMs, latest().timeMs);
+    }
+
+    if (m_count == capacity()) {
+        // Full: overwrite the oldest
+        m_samples[m_head] = {timeMs, value};
+        m_head = (m_head + 1) & m_mask;
+    } else {
+        m_samples[(m_head + m_count) & m_mask] = {timeMs, value};
+        m_count++;
+    }
+}
+
+void TelemetrySeries::clear()
+{
+    m_head = 0;
+    m_count = 0;
+}
+
+int TelemetrySeries::indexAtOrBefore(qint64 timeMs) const
+{
+    if (m_count == 0 || timeMs < oldest().timeMs) {
+        return -1;
+    }
+
+    // Binary search in age order over the ring
+    int lo = 0;
+    int hi = m_count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (at(mid).timeMs <= timeMs) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+float TelemetrySeries::valueAt(qint64 timeMs, float fallback) const
+{
+    if (m_count == 0) {
+        return fallback;
+    }
+
+    int index = indexAtOrBefore(timeMs);
+    if (index < 0) {
+        return oldest().value;
+    }
+    if (index == m_count - 1 || m_mode == Interpolation::Step) {
+        return at(index).value;
+    }
+
+    const Sample& a = at(index);
+    const Sample& b = at(index + 1);
+    qint64 span = b.timeMs - a.timeMs;
+    if (span <= 0) {
+        return b.value;
+    }
+    float t = static_cast<float>(timeMs - a.timeMs) / static_cast<float>(span);
+    return a.value + t * (b.value - a.value);
+}
@@ -0,0 +1,79 @@
+/*
+ * TelemetrySeries.h
+ *
+ * Fixed-capacity, time-indexed ring of telemetry samples
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef TELEMETRYSERIES_H
+#define TELEMETRYSERIES_H
+
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @brief Timestamped sample history with lookup by time
+ *
+ * Samples are appended in time order into a preallocated ring (capacity
+ * rounded up to a power of two); the oldest sample is overwritten when
+ * full, so nothing is allocated after construction. valueAt() finds the
+ * pair of samples around a time by binary search over the ring and
+ * interpolates between them (linearly, or holding the earlier value for
+ * on/off series such as TX state).
+ *
+ * Timestamps are milliseconds on any monotonic clock the caller uses
+ * consistently. A sample older than the newest one is clamped to the
+ * newest timestamp to keep the series sorted. Not thread-safe: append and
+ * read from the same thread.
+ */
+class TelemetrySeries
+{
+public:
+    enum class Interpolation {
+        Linear,  // Continuous values (S-meter)
+        Step     // Value holds until the next sample (TX on/off)
+    };
+
+    struct Sample {
+        qint64 timeMs = 0;
+        float value = 0.0f;
+    };
+
+    explicit TelemetrySeries(int capacity, Interpolation mode = Interpolation::Linear);
+
+    void append(qint64 timeMs, float value);
+    void clear();
+
+    /**
+     * @brief Value at a point in time
+     * @param fallback Returned when the series is empty
+     * Before the oldest sample the oldest value is returned, after the
+     * newest the newest.
+     */
+    float valueAt(qint64 timeMs, float fallback = 0.0f) const;
+
+    bool isEmpty() const { return m_count == 0; }
+    int size() const { return m_count; }
+    int capacity() const { return static_cast<int>(m_samples.size()); }
+
+    /**
+     * @brief Sample by age order (0 = oldest)
+     */
+    const Sample& at(int index) const { return m_samples[(m_head + index) & m_mask]; }
+    const Sample& latest() const { return at(m_count - 1); }
+    const Sample& oldest() const { return at(0); }
+
+    /**
+     * @brief Index of the last sample at or before timeMs (-1 if none)
+     */
+    int indexAtOrBefore(qint64 timeMs) const;
+
+private:
+    std::vector<Sample> m_samples;
+    int m_mask;
+    int m_head = 0;    // Oldest sample
+    int m_count = 0;
+    Interpolation m_mode;
+};
+
+#endif // TELEMETRYSERIES_H
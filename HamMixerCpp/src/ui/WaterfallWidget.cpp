@@ -0,0 +1,247 @@
+/*
+ * WaterfallWidget.cpp
+ *
+ * Scrolling waterfall for the radio's spectrum scope
+ * Part of HamMixer CT7BAC Radio Control Module
+ */
+
+#include "ui/WaterfallWidget.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <algorithm>
+#include <cstring>
+
+WaterfallWidget::WaterfallWidget(QWidget* parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumHeight(TRACE_HEIGHT + LABEL_HEIGHT + 60);
+}
+
+QSize WaterfallWidget::sizeHint() const
+{
+    return QSize(700, TRACE_HEIGHT + LABEL_HEIGHT + HISTORY_ROWS);
+}
+
+QSize WaterfallWidget::minimumSizeHint() const
+{
+    return QSize(300, TRACE_HEIGHT + LABEL_HEIGHT + 60);
+}
+
+const std::array<QRgb, WaterfallWidget::MAX_LEVEL + 1>& WaterfallWidget::palette()
+{
+    // Black -> blue -> cyan -> yellow -> red, built once
+    static const std::array<QRgb, MAX_LEVEL + 1> lut = [] {
+        struct Stop { float pos; int r, g, b; };
+        const Stop stops[] = {
+            {0.00f, 0, 0, 0},
+            {0.25f, 0, 0, 160},
+            {0.50f, 0, 200, 220},
+            {0.75f, 240, 240, 0},
+            {1.00f, 255, 40, 0},
+        };
+        std::array<QRgb, MAX_LEVEL + 1> table{};
+        for (int i = 0; i <= MAX_LEVEL; i++) {
+            float t = static_cast<float>(i) / MAX_LEVEL;
+            int s = 0;
+            while (s < 3 && t > stops[s + 1].pos) s++;
+            float f = (t - stops[s].pos) / (stops[s + 1].pos - stops[s].pos);
+            int r = static_cast<int>(stops[s].r + f * (stops[s + 1].r - stops[s].r));
+            int g = static_cast<int>(stops[s].g + f * (stops[s + 1].g - stops[s].g));
+            int b = static_cast<int>(stops[s].b + f * (stops[s + 1].b - stops[s].b));
+            table[i] = qRgb(r, g, b);
+        }
+        return table;
+    }();
+    return lut;
+}
+
+QRect WaterfallWidget::traceRect() const
+{
+    return QRect(0, 0, width(), TRACE_HEIGHT);
+}
+
+QRect WaterfallWidget::fallRect() const
+{
+    return QRect(0, TRACE_HEIGHT, width(), std::max(0, height() - TRACE_HEIGHT - LABEL_HEIGHT));
+}
+
+QRect WaterfallWidget::labelRect() const
+{
+    return QRect(0, height() - LABEL_HEIGHT, width(), LABEL_HEIGHT);
+}
+
+void WaterfallWidget::addLine(const QByteArray& amplitudes, uint64_t lowHz, uint64_t highHz)
+{
+    int points = amplitudes.size();
+    if (points <= 0) {
+        return;
+    }
+    bool repaintAll = m_rowsFilled == 0;  // Replaces the placeholder text
+
+    // New sweep width (scope span mode or radio changed): start over
+    if (points != m_points) {
+        m_points = points;
+        m_levels.assign(static_cast<size_t>(points) * HISTORY_ROWS, 0);
+        m_newestRow = 0;
+        m_rowsFilled = 0;
+        rebuildFall();
+        repaintAll = true;
+    }
+
+    // Advance the ring upwards and keep the new sweep's levels
+    m_newestRow = (m_newestRow + HISTORY_ROWS - 1) % HISTORY_ROWS;
+    m_rowsFilled = std::min(m_rowsFilled + 1, HISTORY_ROWS);
+    uint8_t* levels = m_levels.data() + static_cast<size_t>(m_newestRow) * m_points;
+    std::memcpy(levels, amplitudes.constData(), points);
+
+    // Move the shown waterfall down one row and colour the new top row
+    if (!m_fall.isNull()) {
+        int rows = m_fall.height();
+        if (rows > 1) {
+            uchar* top = m_fall.scanLine(0);
+            std::memmove(top + m_fall.bytesPerLine(), top,
+                         static_cast<size_t>(rows - 1) * m_fall.bytesPerLine());
+        }
+        renderRow(0, levels);
+    }
+
+    // Copy the trace rather than keeping a reference, so the sender can
+    // refill its buffer without reallocating
+    bool spanChanged = lowHz != m_lowHz || highHz != m_highHz;
+    m_lastLine.resize(points);
+    std::memcpy(m_lastLine.data(), amplitudes.constData(), points);
+    m_lowHz = lowHz;
+    m_highHz = highHz;
+
+    if (repaintAll) {
+        update();
+        return;
+    }
+
+    // Scroll what is on screen; only the exposed top row gets painted
+    scroll(0, 1, fallRect());
+    update(traceRect());
+    if (spanChanged) {
+        update(labelRect());
+    }
+}
+
+void WaterfallWidget::clear()
+{
+    m_levels.clear();
+    m_points = 0;
+    m_newestRow = 0;
+    m_rowsFilled = 0;
+    m_lastLine.resize(0);
+    m_lowHz = 0;
+    m_highHz = 0;
+    rebuildFall();
+    update();
+}
+
+void WaterfallWidget::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
+    rebuildFall();
+}
+
+void WaterfallWidget::rebuildFall()
+{
+    QRect area = fallRect();
+    if (area.width() <= 0 || area.height() <= 0) {
+        m_fall = QImage();
+        return;
+    }
+    if (m_fall.size() != area.size()) {
+        m_fall = QImage(area.size(), QImage::Format_RGB32);
+    }
+    m_fall.fill(palette()[0]);
+
+    // Sweep points covered by each screen column
+    int columns = area.width();
+    m_columnStart.resize(columns + 1);
+    for (int x = 0; x <= columns; x++) {
+        m_columnStart[x] = static_cast<int>(static_cast<int64_t>(x) * m_points / columns);
+    }
+
+    // Newest sweep on top, as many as fit
+    if (m_points > 0) {
+        int rows = std::min(area.height(), m_rowsFilled);
+        for (int y = 0; y < rows; y++) {
+            int ringRow = (m_newestRow + y) % HISTORY_ROWS;
+            renderRow(y, m_levels.data() + static_cast<size_t>(ringRow) * m_points);
+        }
+    }
+}
+
+void WaterfallWidget::renderRow(int y, const uint8_t* levels)
+{
+    const std::array<QRgb, MAX_LEVEL + 1>& lut = palette();
+    QRgb* dst = reinterpret_cast<QRgb*>(m_fall.scanLine(y));
+    int columns = m_fall.width();
+
+    for (int x = 0; x < columns; x++) {
+        // Strongest point of the column, so narrow signals survive narrowing
+        int begin = m_columnStart[x];
+        int end = std::max(m_columnStart[x + 1], begin + 1);
+        uint8_t level = 0;
+        for (int i = begin; i < end; i++) {
+            level = std::max(level, levels[i]);
+        }
+        dst[x] = lut[std::min<int>(level, MAX_LEVEL)];
+    }
+}
+
+void WaterfallWidget::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(this);
+    QRect dirty = event->rect();
+
+    if (m_rowsFilled == 0 || m_fall.isNull()) {
+        painter.fillRect(rect(), Qt::black);
+        painter.setPen(QColor(0x9E, 0x9E, 0x9E));
+        painter.drawText(rect(), Qt::AlignCenter, "Waiting for scope data...");
+        return;
+    }
+
+    // Waterfall: an unscaled copy of the part of the backing image that is dirty
+    QRect fall = fallRect() & dirty;
+    if (!fall.isEmpty()) {
+        painter.drawImage(fall.topLeft(), m_fall, fall.translated(0, -TRACE_HEIGHT));
+    }
+
+    // Spectrum trace of the latest sweep
+    QRect trace = traceRect();
+    int points = m_lastLine.size();
+    if (dirty.intersects(trace)) {
+        painter.fillRect(trace, Qt::black);
+        if (points > 1) {
+            const uint8_t* src = reinterpret_cast<const uint8_t*>(m_lastLine.constData());
+            double xScale = static_cast<double>(trace.width()) / (points - 1);
+            double yScale = static_cast<double>(trace.height() - 2) / MAX_LEVEL;
+            QPainterPath path;
+            path.moveTo(0, trace.bottom() - std::min<int>(src[0], MAX_LEVEL) * yScale);
+            for (int i = 1; i < points; i++) {
+                path.lineTo(i * xScale, trace.bottom() - std::min<int>(src[i], MAX_LEVEL) * yScale);
+            }
+            painter.setPen(QColor(0x4C, 0xAF, 0x50));
+            painter.drawPath(path);
+        }
+    }
+
+    // Edge and centre frequencies
+    QRect label = labelRect();
+    if (dirty.intersects(label)) {
+        painter.fillRect(label, Qt::black);
+        if (m_highHz > m_lowHz) {
+            painter.setPen(QColor(0xE0, 0xE0, 0xE0));
+            auto mhz = [](uint64_t hz) { return QString::number(hz / 1e6, 'f', 3); };
+            painter.drawText(label.adjusted(4, 0, 0, 0), Qt::AlignLeft | Qt::AlignVCenter, mhz(m_lowHz));
+            painter.drawText(label, Qt::AlignCenter, mhz((m_lowHz + m_highHz) / 2) + " MHz");
+            painter.drawText(label.adjusted(0, 0, -4, 0), Qt::AlignRight | Qt::AlignVCenter, mhz(m_highHz));
+        }
+    }
+}
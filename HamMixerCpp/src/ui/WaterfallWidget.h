@@ -0,0 +1,81 @@
+/*
+ * WaterfallWidget.h
+ *
+ * Scrolling waterfall for the radio's spectrum scope
+ * Part of HamMixer CT7BAC Radio Control Module
+ */
+
+#ifndef WATERFALLWIDGET_H
+#define WATERFALLWIDGET_H
+
+#include <QWidget>
+#include <QImage>
+#include <QByteArray>
+#include <array>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief CPU-only waterfall with a live spectrum trace on top
+ *
+ * The waterfall is kept in a backing image the size of its area on
+ * screen, one row per sweep. A new sweep moves that image down by one row,
+ * is converted through a palette lookup table into the freed top row, and
+ * the widget is scrolled by one row, so a paint only has to draw that row
+ * and the trace. Nothing is scaled while painting.
+ *
+ * Sweep levels are also kept in a ring of HISTORY_ROWS rows so the
+ * backing image can be rebuilt when the widget is resized. All buffers
+ * are preallocated and only reallocated when the widget size or the
+ * number of points per sweep changes.
+ */
+class WaterfallWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    static constexpr int HISTORY_ROWS = 300;
+    static constexpr int MAX_LEVEL = 160;   // Icom scope full scale
+
+    explicit WaterfallWidget(QWidget* parent = nullptr);
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+public slots:
+    /**
+     * @brief Append one sweep (copied, the caller's buffer is not kept)
+     * @param amplitudes Levels 0..MAX_LEVEL, lowest frequency first
+     */
+    void addLine(const QByteArray& amplitudes, uint64_t lowHz, uint64_t highHz);
+
+    void clear();
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    static const std::array<QRgb, MAX_LEVEL + 1>& palette();
+
+    QRect traceRect() const;
+    QRect fallRect() const;
+    QRect labelRect() const;
+
+    void rebuildFall();
+    void renderRow(int y, const uint8_t* levels);
+
+    std::vector<uint8_t> m_levels;   // HISTORY_ROWS x m_points ring of sweeps
+    int m_points = 0;
+    int m_newestRow = 0;
+    int m_rowsFilled = 0;
+    QImage m_fall;                   // Waterfall as shown, newest row on top
+    std::vector<int> m_columnStart;  // First sweep point of each screen column (+ end)
+    QByteArray m_lastLine;           // For the spectrum trace, reused
+    uint64_t m_lowHz = 0;
+    uint64_t m_highHz = 0;
+
+    static constexpr int TRACE_HEIGHT = 60;
+    static constexpr int LABEL_HEIGHT = 16;
+};
+
+#endif // WATERFALLWIDGET_H
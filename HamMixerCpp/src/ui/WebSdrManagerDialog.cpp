@@ -14,6 +14,7 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QComboBox>
+#include <QCheckBox>
 #include <QMessageBox>
 #include <QUuid>
 #include <QDebug>
@@ -274,12 +275,36 @@ bool WebSdrManagerDialog::showSiteDialog(WebSdrSite& site, bool isEdit)
     layout->addRow("URL:", urlEdit);
     layout->addRow("Password:", passwordEdit);
 
+    // Audio-only: no waterfall/spectrum rendering while the browser is hidden
+    QCheckBox* audioOnlyCheck = new QCheckBox("Audio only when the browser is hidden", &dialog);
+    audioOnlyCheck->setChecked(site.audioOnly);
+    audioOnlyCheck->setToolTip("Stop drawing the waterfall and spectrum in compact view to save CPU");
+    layout->addRow("", audioOnlyCheck);
+
+    // Warm standby: preloaded, muted and tuned along while another site is live
+    QCheckBox* standbyCheck = new QCheckBox("Keep ready in the background", &dialog);
+    standbyCheck->setChecked(site.standby);
+    standbyCheck->setToolTip("Preload this site muted so switching to it is instant.\n"
+                             "The first two ticked sites are kept; each costs a page's memory\n"
+                             "and, on a KiwiSDR, one of its receiver channels.");
+    layout->addRow("", standbyCheck);
+
+    // Diversity: streamed natively next to the live site, into its own mixer source
+    QCheckBox* diversityCheck = new QCheckBox("Diversity receiver", &dialog);
+    diversityCheck->setChecked(site.diversity);
+    diversityCheck->setToolTip("Stream this KiwiSDR alongside the live site for best-of listening.\n"
+                               "The first two ticked sites are used; each takes one of the\n"
+                               "KiwiSDR's receiver channels. Sync lines them up.");
+    layout->addRow("", diversityCheck);
+
     // Enable/disable KiwiSDR-specific fields based on type
-    auto updateKiwiFields = [passwordEdit](int index) {
+    auto updateKiwiFields = [passwordEdit, diversityCheck](int index) {
         bool isKiwi = (index == 1);
         passwordEdit->setEnabled(isKiwi);
+        diversityCheck->setEnabled(isKiwi);
         if (!isKiwi) {
             passwordEdit->clear();
+            diversityCheck->setChecked(false);
         }
     };
 
@@ -329,6 +354,9 @@ bool WebSdrManagerDialog::showSiteDialog(WebSdrSite& site, bool isEdit)
         site.type = static_cast<SdrSiteType>(typeCombo->currentData().toInt());
         site.port = 0;  // Port is now included in the URL directly
         site.password = passwordEdit->text();
+        site.audioOnly = audioOnlyCheck->isChecked();
+        site.standby = standbyCheck->isChecked();
+        site.diversity = diversityCheck->isChecked();
         return true;
     }
 
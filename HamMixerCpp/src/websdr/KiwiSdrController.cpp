@@ -6,6 +6,8 @@
  */
 
 #include "KiwiSdrController.h"
+#include "SmeterBridge.h"
+#include "PageThrottle.h"
 #include "HamMixer/Version.h"
 #include <QDebug>
 #include <QUrl>
@@ -17,8 +19,54 @@
 #include <QIcon>
 #include <cmath>
 
-KiwiSdrController::KiwiSdrController(QWidget* parentWidget, QObject* parent)
-    : QObject(parent)
+namespace {
+
+// Page-side S-meter hook (runs with push() in scope, see SmeterBridge).
+// The page rewrites its dBm readout whenever an audio packet brings a new
+// value; observing that element pushes in step with the page. The in-page
+// sampler reads the globals for layouts without the readout.
+const char* kSmeterHook = R"(
+    var observed = null;
+    function readout(el) {
+        var match = (el.textContent || '').match(/-?\d+(\.\d+)?/);
+        if (match) push(parseFloat(match[0]));
+    }
+    function hook() {
+        var el = document.getElementById('id-smeter-dbm');
+        if (el && el !== observed) {
+            observed = el;
+            new MutationObserver(function() { readout(el); })
+                .observe(el, { childList: true, characterData: true, subtree: true });
+        }
+    }
+    setInterval(function() {
+        try {
+            hook();
+            if (typeof smeter_dBm !== 'undefined') {
+                push(smeter_dBm);
+            } else if (typeof get_smeter === 'function') {
+                push(get_smeter());
+            }
+        } catch (e) {}
+    }, 50);
+)";
+
+// Audio-only hooks: turn the waterfall stream off at the server (speed 0),
+// then back to the page's own speed setting (fast if it has none)
+const char* kSuspendHook = R"(
+    if (typeof wf_send === 'function') wf_send('SET wf_speed=0');
+)";
+const char* kResumeHook = R"(
+    if (typeof wf_send === 'function') {
+        var speed = (typeof wf !== 'undefined' && wf.speed) ? wf.speed : 4;
+        wf_send('SET wf_speed=' + speed);
+    }
+)";
+
+} // namespace
+
+KiwiSdrController::KiwiSdrController(QWebEngineProfile* profile, QWidget* parentWidget, QObject* parent)
+    : SdrController(parent)
     , m_browserWindow(nullptr)
     , m_webView(nullptr)
     , m_state(Unloaded)
@@ -26,8 +74,16 @@ KiwiSdrController::KiwiSdrController(QWidget* parentWidget, QObject* parent)
     , m_embedded(parentWidget != nullptr)
     , m_pendingFrequencyHz(0)
     , m_hasPendingTune(false)
-    , m_smeterTimer(nullptr)
+    , m_smeterBridge(nullptr)
+    , m_smeterActive(false)
     , m_lastSmeterValue(-1)
+    , m_pageThrottle(nullptr)
+    , m_audioTap(nullptr)
+    , m_pageAudioRequested(false)
+    , m_audioOnlyRequested(false)
+    , m_standby(false)
+    , m_pageReady(false)
+    , m_pageLoadMs(-1)
     , m_initialized(false)
 {
     if (m_embedded) {
@@ -65,6 +121,11 @@ KiwiSdrController::KiwiSdrController(QWidget* parentWidget, QObject* parent)
         qDebug() << "KiwiSdrController: Created with separate window";
     }
 
+    // Shared profile: disk cache and cookies survive site switches
+    if (profile) {
+        m_webView->setPage(new QWebEnginePage(profile, m_webView));
+    }
+
     // Configure web engine settings to allow autoplay without user gesture
     QWebEngineSettings* settings = m_webView->page()->settings();
     settings->setAttribute(QWebEngineSettings::PlaybackRequiresUserGesture, false);
@@ -75,6 +136,19 @@ KiwiSdrController::KiwiSdrController(QWidget* parentWidget, QObject* parent)
     settings->setAttribute(QWebEngineSettings::AutoLoadImages, true);
     qDebug() << "KiwiSdrController: Configured WebEngine for KiwiSDR";
 
+    // S-meter readings are pushed by a script in the page
+    m_smeterBridge = new SmeterBridge(m_webView->page(), kSmeterHook, this);
+    QObject::connect(m_smeterBridge, &SmeterBridge::sampled,
+                     this, &KiwiSdrController::onSmeterSampled);
+
+    // Rendering can be suspended while the browser is hidden
+    m_pageThrottle = new PageThrottle(m_webView->page(), kSuspendHook, kResumeHook, this);
+
+    // Page audio can be taken before the sound card, over the S-meter's channel
+    m_audioTap = new PageAudioTap(m_webView->page(), m_smeterBridge->channel(), this);
+    QObject::connect(m_audioTap, &PageAudioTap::deliveringChanged,
+                     this, &SdrController::sinkAudioChanged);
+
     // Connect signals
     QObject::connect(m_webView, &QWebEngineView::loadStarted,
                      this, &KiwiSdrController::onLoadStarted);
@@ -98,7 +172,7 @@ bool KiwiSdrController::eventFilter(QObject* obj, QEvent* event)
 
 KiwiSdrController::~KiwiSdrController()
 {
-    stopSmeterPolling();
+    stopSmeterUpdates();
     unload();
 
     if (m_embedded) {
@@ -117,6 +191,11 @@ KiwiSdrController::~KiwiSdrController()
     }
 }
 
+SdrController::Capabilities KiwiSdrController::capabilities() const
+{
+    return SmeterPush | Passband | BrowserPage | PageAudio;
+}
+
 void KiwiSdrController::showWindow()
 {
     if (m_embedded) {
@@ -214,15 +293,17 @@ void KiwiSdrController::loadSite(const WebSdrSite& site)
     qDebug() << "KiwiSdrController: Loading site" << site.name << "from" << loadUrl;
     setState(Loading);
 
-    // Show the window/view and load the site
-    showWindow();
+    // Show the window/view (unless kept in standby) and load the site
+    if (!m_standby) {
+        showWindow();
+    }
     m_webView->load(QUrl(loadUrl));
 }
 
 void KiwiSdrController::unload()
 {
     if (m_state != Unloaded) {
-        stopSmeterPolling();
+        stopSmeterUpdates();
 
         // Stop audio before unloading
         if (m_webView && m_webView->page()) {
@@ -247,6 +328,7 @@ void KiwiSdrController::unload()
         }
 
         m_currentSite = WebSdrSite();
+        m_pageReady = false;
         m_audioStarted = false;
         m_hasPendingTune = false;
         m_initialized = false;
@@ -256,12 +338,13 @@ void KiwiSdrController::unload()
     }
 }
 
-void KiwiSdrController::setFrequency(uint64_t frequencyHz)
+void KiwiSdrController::setFrequency(uint64_t frequencyHz, std::function<void()> applied)
 {
     m_pendingFrequencyHz = frequencyHz;
 
     if (m_state != Ready || !m_initialized) {
         m_hasPendingTune = true;
+        if (applied) applied();
         return;
     }
 
@@ -325,16 +408,19 @@ void KiwiSdrController::setFrequency(uint64_t frequencyHz)
         })()
     )").arg(freqKHz, 0, 'f', 3);
 
-    runJavaScript(script);
+    runJavaScript(script, [applied](const QVariant&) {
+        if (applied) applied();
+    });
     qDebug() << "KiwiSdrController: Set frequency to" << frequencyHz << "Hz (" << freqKHz << "kHz)";
 }
 
-void KiwiSdrController::setMode(const QString& mode)
+void KiwiSdrController::setMode(const QString& mode, std::function<void()> applied)
 {
     m_pendingMode = mode.toLower();
 
     if (m_state != Ready || !m_initialized) {
         m_hasPendingTune = true;
+        if (applied) applied();
         return;
     }
 
@@ -396,7 +482,9 @@ void KiwiSdrController::setMode(const QString& mode)
         })()
     )").arg(kiwiMode);
 
-    runJavaScript(script);
+    runJavaScript(script, [applied](const QVariant&) {
+        if (applied) applied();
+    });
     qDebug() << "KiwiSdrController: Set mode to" << kiwiMode;
 }
 
@@ -498,21 +586,41 @@ void KiwiSdrController::setVolume(int percent)
     qDebug() << "KiwiSdrController: Set volume to" << vol << "%";
 }
 
-void KiwiSdrController::tune(uint64_t frequencyHz, const QString& mode)
+void KiwiSdrController::tune(uint64_t frequencyHz, const QString& mode, std::function<void()> applied)
 {
     if (m_state != Ready || !m_initialized) {
         m_pendingFrequencyHz = frequencyHz;
         m_pendingMode = mode;
         m_hasPendingTune = true;
+        if (applied) applied();
         return;
     }
 
     setMode(mode);
-    setFrequency(frequencyHz);
+    setFrequency(frequencyHz, std::move(applied));
+}
+
+void KiwiSdrController::setPassband(int lowCutHz, int highCutHz)
+{
+    if (m_state != Ready || !m_initialized) {
+        return;
+    }
+
+    runJavaScript(QString("(function() {"
+                          "  try {"
+                          "    if (typeof ext_set_passband === 'function') {"
+                          "      ext_set_passband(%1, %2);"
+                          "    }"
+                          "  } catch(e) {}"
+                          "})();").arg(lowCutHz).arg(highCutHz));
+    qDebug() << "KiwiSdrController: Set passband to" << lowCutHz << "-" << highCutHz << "Hz";
 }
 
 void KiwiSdrController::onLoadStarted()
 {
+    m_pageReady = false;
+    m_pageLoadMs = -1;
+    m_loadClock.start();
     setState(Loading);
     emit loadProgress(0);
 }
@@ -592,11 +700,21 @@ void KiwiSdrController::initializeKiwiSdr()
             if (m_state != Ready) return;
             startAudio();
 
-            // Start S-meter polling
-            startSmeterPolling(100);
+            // Forward S-meter readings from the page
+            startSmeterUpdates();
+
+            // Re-run the audio-only hook against the fresh page
+            m_pageThrottle->reapply();
+
+            // A page that finished loading in standby has no meaningful time
+            if (!m_standby) {
+                m_pageLoadMs = m_loadClock.elapsed();
+                qDebug() << "KiwiSdrController: Page ready in" << m_pageLoadMs << "ms" << m_currentSite.name;
+            }
 
             // Emit ready
-            emit pageReady();
+            m_pageReady = true;
+            emit ready();
             qDebug() << "KiwiSdrController: Initialization complete - page ready";
         });
     });
@@ -644,77 +762,88 @@ void KiwiSdrController::runJavaScript(const QString& script,
     m_webView->page()->runJavaScript(script, callback);
 }
 
-void KiwiSdrController::startSmeterPolling(int intervalMs)
+void KiwiSdrController::startSmeterUpdates()
 {
-    if (!m_smeterTimer) {
-        m_smeterTimer = new QTimer(this);
-        connect(m_smeterTimer, &QTimer::timeout, this, &KiwiSdrController::pollSmeter);
-    }
-
-    m_smeterTimer->start(intervalMs);
-    qDebug() << "KiwiSdrController: Started S-meter polling at" << intervalMs << "ms";
+    m_smeterActive = true;
+    qDebug() << "KiwiSdrController: S-meter updates started";
 }
 
-void KiwiSdrController::stopSmeterPolling()
+void KiwiSdrController::stopSmeterUpdates()
 {
-    if (m_smeterTimer) {
-        m_smeterTimer->stop();
-        qDebug() << "KiwiSdrController: Stopped S-meter polling";
+    if (m_smeterActive) {
+        m_smeterActive = false;
+        m_lastSmeterValue = -1;
+        qDebug() << "KiwiSdrController: S-meter updates stopped";
     }
 }
 
-void KiwiSdrController::pollSmeter()
+void KiwiSdrController::setAudioOnly(bool enabled)
 {
-    if (m_state != Ready) {
+    m_audioOnlyRequested = enabled;
+    m_pageThrottle->setAudioOnly(m_audioOnlyRequested || m_standby);
+}
+
+void KiwiSdrController::setStandby(bool standby)
+{
+    if (m_standby == standby) {
         return;
     }
+    m_standby = standby;
+    m_pageLoadMs = -1;
 
-    // JavaScript to read KiwiSDR S-meter value
-    // KiwiSDR provides S-meter in dBm
-    QString script = R"(
-        (function() {
-            try {
-                // Method 1: smeter_dBm global variable
-                if (typeof smeter_dBm !== 'undefined') {
-                    return smeter_dBm;
-                }
+    // Show before lifting the throttle so the page knows it is visible again
+    if (standby) {
+        hideWindow();
+    } else {
+        showWindow();
+    }
 
-                // Method 2: get_smeter function
-                if (typeof get_smeter === 'function') {
-                    return get_smeter();
-                }
+    // Muted in Chromium, so the page's own volume setup stays untouched
+    m_webView->page()->setAudioMuted(standby);
+    m_pageThrottle->setAudioOnly(m_audioOnlyRequested || standby);
+    m_audioTap->setEnabled(m_pageAudioRequested && !standby);
 
-                // Method 3: Read from smeter element
-                var smeterEl = document.getElementById('id-smeter-dbm');
-                if (smeterEl) {
-                    var text = smeterEl.innerText || smeterEl.textContent;
-                    var match = text.match(/-?\d+/);
-                    if (match) {
-                        return parseInt(match[0]);
-                    }
-                }
+    qDebug() << "KiwiSdrController:" << (standby ? "In standby" : "Live") << m_currentSite.name;
+}
 
-                return -127;  // No signal
-            } catch(e) {
-                return -127;
-            }
-        })()
-    )";
+bool KiwiSdrController::isAudioOnly() const
+{
+    return m_pageThrottle->isAudioOnly();
+}
 
-    runJavaScript(script, [this](const QVariant& result) {
-        if (result.isValid()) {
-            int dBm = result.toInt();
-            if (dBm > -127) {
-                // Convert dBm to 0-255 scale similar to Icom S-meter
-                // Typical range: -127 dBm (noise floor) to -60 dBm (S9+30)
-                // Map -127..-60 to 0..255
-                int scaled = qBound(0, static_cast<int>((dBm + 127) * 255.0 / 67.0), 255);
-
-                if (scaled != m_lastSmeterValue) {
-                    m_lastSmeterValue = scaled;
-                    emit smeterChanged(scaled);
-                }
-            }
+void KiwiSdrController::setAudioSink(AudioSink sink)
+{
+    m_audioTap->setAudioSink(std::move(sink));
+}
+
+void KiwiSdrController::setPageAudioCapture(bool enabled)
+{
+    m_pageAudioRequested = enabled;
+    m_audioTap->setEnabled(m_pageAudioRequested && !m_standby);
+}
+
+bool KiwiSdrController::isPageAudioDelivering() const
+{
+    return m_audioTap->isDelivering();
+}
+
+void KiwiSdrController::onSmeterSampled(double value, qint64 sampledMs)
+{
+    if (m_state != Ready || !m_smeterActive) {
+        return;
+    }
+
+    // KiwiSDR reports dBm
+    int dBm = static_cast<int>(value);
+    if (dBm > -127) {
+        // Convert dBm to 0-255 scale similar to Icom S-meter
+        // Typical range: -127 dBm (noise floor) to -60 dBm (S9+30)
+        // Map -127..-60 to 0..255
+        int scaled = qBound(0, static_cast<int>((dBm + 127) * 255.0 / 67.0), 255);
+
+        if (scaled != m_lastSmeterValue) {
+            m_lastSmeterValue = scaled;
+            emit smeterChanged(scaled, sampledMs);
         }
-    });
+    }
 }
@@ -0,0 +1,374 @@
+/*
+ * KiwiSdrStream.cpp
+ *
+ * Native KiwiSDR audio client (WebSocket SND stream, no browser)
+ * Part of HamMixer CT7BAC
+ */
+
+#include "KiwiSdrStream.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// IMA ADPCM tables (same as the KiwiSDR server's encoder)
+const int kStepSizes[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+const int kIndexAdjust[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+inline float decodeNibble(int code, KiwiSdrStream::AdpcmState& state)
+{
+    int step = kStepSizes[state.index];
+    state.index = std::clamp(state.index + kIndexAdjust[code & 7], 0, 88);
+
+    int difference = step >> 3;
+    if (code & 1) difference += step >> 2;
+    if (code & 2) difference += step >> 1;
+    if (code & 4) difference += step;
+    if (code & 8) difference = -difference;
+
+    state.previous = std::clamp(state.previous + difference, -32768, 32767);
+    return state.previous / 32768.0f;
+}
+
+} // namespace
+
+KiwiSdrStream::KiwiSdrStream(QObject* parent)
+    : QObject(parent)
+    , m_socket(new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this))
+    , m_keepaliveTimer(new QTimer(this))
+    , m_state(Unloaded)
+    , m_frequencyHz(0)
+    , m_mode("usb")
+    , m_lowCut(0)
+    , m_highCut(0)
+    , m_configured(false)
+    , m_sampleRate(0.0)
+    , m_nextSequence(0)
+    , m_packetsReceived(0)
+    , m_packetsLost(0)
+    , m_lastSmeterValue(-1)
+{
+    connect(m_socket, &QWebSocket::connected, this, &KiwiSdrStream::onConnected);
+    connect(m_socket, &QWebSocket::disconnected, this, &KiwiSdrStream::onDisconnected);
+    connect(m_socket, &QWebSocket::binaryMessageReceived, this, &KiwiSdrStream::onBinaryMessage);
+    connect(m_socket, &QWebSocket::textMessageReceived, this, &KiwiSdrStream::onTextMessage);
+    connect(m_socket, &QWebSocket::errorOccurred, this, [this](QAbstractSocket::SocketError) {
+        if (m_state == Connecting || m_state == Ready) {
+            fail(m_socket->errorString());
+        }
+    });
+
+    m_keepaliveTimer->setInterval(KEEPALIVE_INTERVAL_MS);
+    connect(m_keepaliveTimer, &QTimer::timeout, this, &KiwiSdrStream::onKeepalive);
+}
+
+KiwiSdrStream::~KiwiSdrStream()
+{
+    close();
+}
+
+QUrl KiwiSdrStream::streamUrl(const WebSdrSite& site)
+{
+    QUrl url(site.effectiveUrl());
+    url.setScheme(url.scheme() == "https" ? "wss" : "ws");
+    url.setPath(QString("/kiwi/%1/SND").arg(QDateTime::currentMSecsSinceEpoch()));
+    url.setQuery(QString());
+    url.setFragment(QString());
+    return url;
+}
+
+void KiwiSdrStream::open(const WebSdrSite& site)
+{
+    close();
+
+    m_currentSite = site;
+    m_configured = false;
+    m_sampleRate = 0.0;
+    m_nextSequence = 0;
+    m_packetsReceived = 0;
+    m_packetsLost = 0;
+    m_lastSmeterValue = -1;
+
+    QUrl url = streamUrl(site);
+    qDebug() << "KiwiSdrStream: Connecting to" << url.toString();
+
+    setState(Connecting);
+    m_socket->open(url);
+}
+
+void KiwiSdrStream::close()
+{
+    m_keepaliveTimer->stop();
+    if (m_state == Unloaded) return;
+
+    setState(Unloaded);  // Before abort() so onDisconnected() knows it was intended
+    m_socket->abort();
+    qDebug() << "KiwiSdrStream: Closed" << m_currentSite.name
+             << "(" << m_packetsReceived << "packets," << m_packetsLost << "lost)";
+}
+
+void KiwiSdrStream::setState(State newState)
+{
+    if (m_state != newState) {
+        m_state = newState;
+        emit stateChanged(newState);
+    }
+}
+
+void KiwiSdrStream::fail(const QString& error)
+{
+    qWarning() << "KiwiSdrStream:" << error;
+    m_keepaliveTimer->stop();
+    setState(Error);
+    m_socket->abort();
+    emit errorOccurred(error);
+}
+
+void KiwiSdrStream::send(const QByteArray& command)
+{
+    if (m_socket->state() == QAbstractSocket::ConnectedState) {
+        m_socket->sendTextMessage(QString::fromLatin1(command));
+    }
+}
+
+void KiwiSdrStream::onConnected()
+{
+    qDebug() << "KiwiSdrStream: Connected, authenticating";
+
+    // Password goes in clear, as the web page sends it
+    QByteArray password = QUrl::toPercentEncoding(m_currentSite.password);
+    send("SET auth t=kiwi p=" + password);
+    m_keepaliveTimer->start();
+}
+
+void KiwiSdrStream::onDisconnected()
+{
+    if (m_state == Connecting || m_state == Ready) {
+        fail(m_packetsReceived > 0 ? QStringLiteral("KiwiSDR closed the connection")
+                                   : QStringLiteral("KiwiSDR refused the audio connection"));
+    }
+}
+
+void KiwiSdrStream::onKeepalive()
+{
+    send("SET keepalive");
+}
+
+void KiwiSdrStream::onTextMessage(const QString& message)
+{
+    onBinaryMessage(message.toLatin1());
+}
+
+void KiwiSdrStream::onBinaryMessage(const QByteArray& message)
+{
+    if (message.size() < 3) return;
+
+    if (message.startsWith("SND")) {
+        processSound(message);
+    } else if (message.startsWith("MSG")) {
+        processMessage(message.mid(4));
+    }
+}
+
+void KiwiSdrStream::processMessage(const QByteArray& body)
+{
+    for (const QByteArray& pair : body.split(' ')) {
+        int eq = pair.indexOf('=');
+        QByteArray key = eq < 0 ? pair : pair.left(eq);
+        QByteArray value = eq < 0 ? QByteArray() : QByteArray::fromPercentEncoding(pair.mid(eq + 1));
+
+        if (key == "audio_rate") {
+            // Nominal rate, used until the exact one follows as sample_rate.
+            // "out" is only informational, HamMixer resamples on its side.
+            int nominal = value.toInt();
+            m_sampleRate = nominal;
+            send("SET AR OK in=" + QByteArray::number(nominal) + " out=48000");
+        } else if (key == "sample_rate") {
+            // Exact rate (e.g. 12001.135): the resampler runs from it, as
+            // the nominal one would over- or underrun the audio ring
+            double exact = value.toDouble();
+            if (exact > 0) {
+                m_sampleRate = exact;
+            }
+            if (!m_configured) {
+                m_configured = true;
+                send("SET compression=1");
+                send("SET agc=1 hang=0 thresh=-100 slope=6 decay=1000 manGain=50");
+                send("SET squelch=0 max=0");
+                send("SET genattn=0");
+                send("SET gen=0 mix=-1");
+                send("SET ident_user=HamMixer");
+                sendTune();
+                qDebug() << "KiwiSdrStream: Audio at" << m_sampleRate << "Hz";
+            }
+        } else if (key == "badp" && value == "1") {
+            fail("KiwiSDR rejected the password");
+            return;
+        } else if (key == "too_busy") {
+            fail(QString("KiwiSDR is busy (all %1 channels in use)").arg(QString::fromLatin1(value)));
+            return;
+        } else if (key == "down") {
+            fail("KiwiSDR is down for maintenance");
+            return;
+        } else if (key == "redirect") {
+            fail("KiwiSDR redirected to " + QString::fromLatin1(value));
+            return;
+        }
+    }
+}
+
+void KiwiSdrStream::processSound(const QByteArray& packet)
+{
+    if (packet.size() < SND_HEADER_BYTES) return;
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(packet.constData());
+    uint8_t flags = bytes[3];
+    uint32_t sequence = uint32_t(bytes[4]) | (uint32_t(bytes[5]) << 8)
+                        | (uint32_t(bytes[6]) << 16) | (uint32_t(bytes[7]) << 24);
+    int smeter = (bytes[8] << 8) | bytes[9];
+
+    // Sequence gaps are packets the server dropped for a slow client
+    if (m_packetsReceived > 0 && !(flags & FLAG_RESTART) && sequence != m_nextSequence) {
+        m_packetsLost += static_cast<uint32_t>(sequence - m_nextSequence);
+    }
+    m_nextSequence = sequence + 1;
+    m_packetsReceived++;
+
+    // RSSI travels as tenths of a dB above -127 dBm
+    int value = dbmToSmeter(0.1 * smeter - 127.0);
+    if (value != m_lastSmeterValue) {
+        m_lastSmeterValue = value;
+        QElapsedTimer now;
+        now.start();
+        emit smeterChanged(value, now.msecsSinceReference());
+    }
+
+    if (flags & FLAG_MODE_IQ) return;  // Only requested modes are mono
+
+    const uint8_t* data = bytes + SND_HEADER_BYTES;
+    int dataBytes = packet.size() - SND_HEADER_BYTES;
+    int frames = 0;
+
+    if (flags & FLAG_COMPRESSED) {
+        m_samples.resize(static_cast<size_t>(dataBytes) * 2);
+        AdpcmState state;
+        frames = decodeAdpcm(data, dataBytes, m_samples.data(), state);
+    } else {
+        frames = dataBytes / 2;
+        m_samples.resize(static_cast<size_t>(frames));
+        bool little = flags & FLAG_LITTLE_ENDIAN;
+        for (int i = 0; i < frames; i++) {
+            uint8_t hi = little ? data[i * 2 + 1] : data[i * 2];
+            uint8_t lo = little ? data[i * 2] : data[i * 2 + 1];
+            m_samples[i] = static_cast<int16_t>((hi << 8) | lo) / 32768.0f;
+        }
+    }
+
+    if (m_sink && frames > 0 && m_sampleRate > 0) {
+        m_sink(m_samples.data(), frames, m_sampleRate);
+    }
+
+    if (m_state == Connecting) {
+        qDebug() << "KiwiSdrStream: Streaming from" << m_currentSite.name;
+        setState(Ready);
+        emit streamReady();
+    }
+}
+
+int KiwiSdrStream::decodeAdpcm(const uint8_t* data, int bytes, float* out, AdpcmState& state)
+{
+    for (int i = 0; i < bytes; i++) {
+        out[i * 2] = decodeNibble(data[i] & 0x0F, state);
+        out[i * 2 + 1] = decodeNibble(data[i] >> 4, state);
+    }
+    return bytes * 2;
+}
+
+int KiwiSdrStream::dbmToSmeter(double dBm)
+{
+    // S0 at -127 dBm, S9 at -73 dBm, 6 dB per S-unit
+    return std::clamp(static_cast<int>(std::lround((dBm + 127.0) * 100.0)), 0, 11400);
+}
+
+QString KiwiSdrStream::kiwiMode(const QString& mode)
+{
+    QString m = mode.toLower();
+    if (m == "fm") return "nbfm";
+    if (m == "cw-r" || m == "cwr") return "cwn";
+    if (m == "lsb" || m == "usb" || m == "cw" || m == "am") return m;
+    return "usb";
+}
+
+void KiwiSdrStream::passband(const QString& kiwiMode, int& lowCut, int& highCut)
+{
+    if (kiwiMode == "lsb") {
+        lowCut = -2700; highCut = -300;
+    } else if (kiwiMode == "cw" || kiwiMode == "cwn") {
+        lowCut = 300; highCut = 700;
+    } else if (kiwiMode == "am") {
+        lowCut = -4900; highCut = 4900;
+    } else if (kiwiMode == "nbfm") {
+        lowCut = -6000; highCut = 6000;
+    } else {
+        lowCut = 300; highCut = 2700;
+    }
+}
+
+void KiwiSdrStream::sendTune()
+{
+    if (!m_configured || m_frequencyHz == 0) return;
+
+    QString mode = kiwiMode(m_mode);
+    int lowCut = m_lowCut;
+    int highCut = m_highCut;
+    if (lowCut == 0 && highCut == 0) {
+        passband(mode, lowCut, highCut);
+    }
+
+    send(QString("SET mod=%1 low_cut=%2 high_cut=%3 freq=%4")
+             .arg(mode).arg(lowCut).arg(highCut)
+             .arg(m_frequencyHz / 1000.0, 0, 'f', 3).toLatin1());
+}
+
+void KiwiSdrStream::setFrequency(uint64_t frequencyHz)
+{
+    if (m_frequencyHz == frequencyHz) return;
+    m_frequencyHz = frequencyHz;
+    sendTune();
+}
+
+void KiwiSdrStream::setMode(const QString& mode)
+{
+    if (mode.isEmpty() || m_mode == mode.toLower()) return;
+    m_mode = mode.toLower();
+    sendTune();
+}
+
+void KiwiSdrStream::setPassband(int lowCut, int highCut)
+{
+    if (m_lowCut == lowCut && m_highCut == highCut) return;
+    m_lowCut = lowCut;
+    m_highCut = highCut;
+    sendTune();
+}
+
+void KiwiSdrStream::tune(uint64_t frequencyHz, const QString& mode)
+{
+    m_frequencyHz = frequencyHz;
+    if (!mode.isEmpty()) {
+        m_mode = mode.toLower();
+    }
+    sendTune();
+}
@@ -0,0 +1,168 @@
+/*
+ * KiwiSdrStream.h
+ *
+ * Native KiwiSDR audio client (WebSocket SND stream, no browser)
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef KIWISDRSTREAM_H
+#define KIWISDRSTREAM_H
+
+#include <QObject>
+#include <QWebSocket>
+#include <QTimer>
+#include <QString>
+#include <QUrl>
+#include <QByteArray>
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+#include "WebSdrSite.h"
+
+/**
+ * @brief Receives KiwiSDR audio directly over its WebSocket protocol
+ *
+ * Connects to ws://host:port/kiwi/<timestamp>/SND, the same endpoint the
+ * KiwiSDR web page uses for sound, and decodes the audio packets itself.
+ * Samples go straight to an AudioSink instead of through the browser and
+ * the loopback device, which saves the WASAPI loopback hop, Chromium's
+ * audio buffering and the CPU of a full page. The S-meter is read from
+ * the packet headers, so it is in step with the audio.
+ *
+ * Packets are "SND" + flags(1) + sequence(4, LE) + S-meter(2, BE) + data;
+ * data is IMA ADPCM when compressed, 16-bit PCM otherwise. Control
+ * messages ("MSG key=value ...") announce the audio rate and errors.
+ */
+class KiwiSdrStream : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State {
+        Unloaded,
+        Connecting,   // Socket open, waiting for the first audio packet
+        Ready,
+        Error
+    };
+    Q_ENUM(State)
+
+    /**
+     * @brief Receives decoded audio (mono, -1..1) on the GUI thread
+     */
+    using AudioSink = std::function<void(const float* samples, int frames, double sampleRate)>;
+
+    /**
+     * @brief IMA ADPCM decoder state (the server restarts it every packet)
+     */
+    struct AdpcmState {
+        int index = 0;
+        int previous = 0;
+    };
+
+    explicit KiwiSdrStream(QObject* parent = nullptr);
+    ~KiwiSdrStream();
+
+    void setAudioSink(AudioSink sink) { m_sink = std::move(sink); }
+
+    // Open/close the stream for a KiwiSDR site
+    void open(const WebSdrSite& site);
+    void close();
+
+    // State
+    State state() const { return m_state; }
+    bool isReady() const { return m_state == Ready; }
+    const WebSdrSite& currentSite() const { return m_currentSite; }
+    double sampleRate() const { return m_sampleRate; }
+
+    // Control: frequency in Hz, mode "lsb", "usb", "cw", "am", "fm"
+    void setFrequency(uint64_t frequencyHz);
+    void setMode(const QString& mode);
+    void tune(uint64_t frequencyHz, const QString& mode);
+
+    // Passband in Hz from the carrier; 0, 0 restores the mode's default
+    void setPassband(int lowCut, int highCut);
+
+    // Stream health
+    uint64_t packetsReceived() const { return m_packetsReceived; }
+    uint64_t packetsLost() const { return m_packetsLost; }
+
+    /**
+     * @brief SND endpoint for a site (ws:// or wss:// to match the site URL)
+     */
+    static QUrl streamUrl(const WebSdrSite& site);
+
+    /**
+     * @brief HamMixer mode name to KiwiSDR demodulator name
+     */
+    static QString kiwiMode(const QString& mode);
+
+    /**
+     * @brief Default passband for a KiwiSDR demodulator, in Hz from the carrier
+     */
+    static void passband(const QString& kiwiMode, int& lowCut, int& highCut);
+
+    /**
+     * @brief KiwiSDR RSSI (dBm) to the WebSDR S-meter scale (S9 = 5400, 600 per S-unit)
+     */
+    static int dbmToSmeter(double dBm);
+
+    /**
+     * @brief Decode IMA ADPCM (low nibble first) to samples in -1..1
+     * @return Number of samples written (two per input byte)
+     */
+    static int decodeAdpcm(const uint8_t* data, int bytes, float* out, AdpcmState& state);
+
+    // Packet flags
+    static constexpr uint8_t FLAG_MODE_IQ = 0x08;
+    static constexpr uint8_t FLAG_COMPRESSED = 0x10;
+    static constexpr uint8_t FLAG_RESTART = 0x20;
+    static constexpr uint8_t FLAG_LITTLE_ENDIAN = 0x80;
+    static constexpr int SND_HEADER_BYTES = 3 + 1 + 4 + 2;
+
+signals:
+    void stateChanged(KiwiSdrStream::State state);
+    void streamReady();
+    void errorOccurred(const QString& error);
+    void smeterChanged(int value, qint64 sampledMs);  // WebSDR scale, see dbmToSmeter(); packet arrival
+
+private slots:
+    void onConnected();
+    void onDisconnected();
+    void onBinaryMessage(const QByteArray& message);
+    void onTextMessage(const QString& message);
+    void onKeepalive();
+
+private:
+    void setState(State newState);
+    void fail(const QString& error);
+    void send(const QByteArray& command);
+    void sendTune();
+    void processMessage(const QByteArray& body);
+    void processSound(const QByteArray& packet);
+
+    QWebSocket* m_socket;
+    QTimer* m_keepaliveTimer;
+    WebSdrSite m_currentSite;
+    State m_state;
+    AudioSink m_sink;
+
+    // Tuning, applied once the server has announced its audio rate
+    uint64_t m_frequencyHz;
+    QString m_mode;
+    int m_lowCut;       // Both 0: passband() default for the mode
+    int m_highCut;
+    bool m_configured;
+
+    // Stream
+    double m_sampleRate;  // Exact once sample_rate has arrived
+    uint32_t m_nextSequence;
+    uint64_t m_packetsReceived;
+    uint64_t m_packetsLost;
+    int m_lastSmeterValue;
+    std::vector<float> m_samples;   // Decode scratch
+
+    static constexpr int KEEPALIVE_INTERVAL_MS = 5000;
+};
+
+#endif // KIWISDRSTREAM_H
@@ -0,0 +1,104 @@
+/*
+ * KiwiStreamController.cpp
+ *
+ * SdrController backend for the native KiwiSDR audio stream
+ * Part of HamMixer CT7BAC
+ */
+
+#include "KiwiStreamController.h"
+#include <QDebug>
+
+KiwiStreamController::KiwiStreamController(QObject* parent)
+    : SdrController(parent)
+    , m_stream(new KiwiSdrStream(this))
+{
+    connect(m_stream, &KiwiSdrStream::stateChanged,
+            this, &KiwiStreamController::onStreamStateChanged);
+    connect(m_stream, &KiwiSdrStream::streamReady,
+            this, &SdrController::ready);
+    connect(m_stream, &KiwiSdrStream::errorOccurred,
+            this, &SdrController::errorOccurred);
+    connect(m_stream, &KiwiSdrStream::smeterChanged,
+            this, &SdrController::smeterChanged);
+}
+
+KiwiStreamController::~KiwiStreamController()
+{
+    m_stream->close();
+}
+
+SdrController::Capabilities KiwiStreamController::capabilities() const
+{
+    return NativeAudio | SmeterPush | Passband;
+}
+
+void KiwiStreamController::loadSite(const WebSdrSite& site)
+{
+    qDebug() << "KiwiStreamController: Streaming" << site.name;
+
+    // open() closes a stream already running
+    m_stream->open(site);
+    emit sinkAudioChanged(true);
+}
+
+void KiwiStreamController::unload()
+{
+    bool wasOpen = m_stream->state() != KiwiSdrStream::Unloaded;
+    m_stream->close();
+    if (wasOpen) {
+        emit sinkAudioChanged(false);
+    }
+}
+
+SdrController::State KiwiStreamController::state() const
+{
+    return mapState(m_stream->state());
+}
+
+SdrController::State KiwiStreamController::mapState(KiwiSdrStream::State state)
+{
+    switch (state) {
+        case KiwiSdrStream::Unloaded:
+            return Unloaded;
+        case KiwiSdrStream::Connecting:
+            return Loading;
+        case KiwiSdrStream::Ready:
+            return Ready;
+        case KiwiSdrStream::Error:
+        default:
+            return Error;
+    }
+}
+
+void KiwiStreamController::onStreamStateChanged(KiwiSdrStream::State state)
+{
+    emit stateChanged(mapState(state));
+}
+
+void KiwiStreamController::setFrequency(uint64_t frequencyHz, std::function<void()> applied)
+{
+    m_stream->setFrequency(frequencyHz);
+    if (applied) applied();
+}
+
+void KiwiStreamController::setMode(const QString& mode, std::function<void()> applied)
+{
+    m_stream->setMode(mode);
+    if (applied) applied();
+}
+
+void KiwiStreamController::tune(uint64_t frequencyHz, const QString& mode, std::function<void()> applied)
+{
+    m_stream->tune(frequencyHz, mode);
+    if (applied) applied();
+}
+
+void KiwiStreamController::setPassband(int lowCutHz, int highCutHz)
+{
+    m_stream->setPassband(lowCutHz, highCutHz);
+}
+
+void KiwiStreamController::setAudioSink(AudioSink sink)
+{
+    m_stream->setAudioSink(std::move(sink));
+}
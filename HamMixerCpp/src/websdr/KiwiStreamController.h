@@ -0,0 +1,58 @@
+/*
+ * KiwiStreamController.h
+ *
+ * SdrController backend for the native KiwiSDR audio stream
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef KIWISTREAMCONTROLLER_H
+#define KIWISTREAMCONTROLLER_H
+
+#include "SdrController.h"
+#include "KiwiSdrStream.h"
+
+/**
+ * @brief Drives a KiwiSDR through KiwiSdrStream instead of its web page
+ *
+ * No browser: the audio goes to the audio sink from the moment the site is
+ * loaded, the S-meter comes from the packet headers and tuning is a single
+ * message, queued by the stream until the server is set up.
+ */
+class KiwiStreamController : public SdrController
+{
+    Q_OBJECT
+
+public:
+    explicit KiwiStreamController(QObject* parent = nullptr);
+    ~KiwiStreamController() override;
+
+    Capabilities capabilities() const override;
+
+    KiwiSdrStream* stream() const { return m_stream; }
+
+    // Load/unload site
+    void loadSite(const WebSdrSite& site) override;
+    void unload() override;
+
+    // State (Connecting is reported as Loading)
+    State state() const override;
+    const WebSdrSite& currentSite() const override { return m_stream->currentSite(); }
+
+    // Tuning: sent straight away, applied runs at once
+    void setFrequency(uint64_t frequencyHz, std::function<void()> applied = nullptr) override;
+    void setMode(const QString& mode, std::function<void()> applied = nullptr) override;
+    void tune(uint64_t frequencyHz, const QString& mode, std::function<void()> applied = nullptr) override;
+    void setPassband(int lowCutHz, int highCutHz) override;
+
+    void setAudioSink(AudioSink sink) override;
+
+private slots:
+    void onStreamStateChanged(KiwiSdrStream::State state);
+
+private:
+    static State mapState(KiwiSdrStream::State state);
+
+    KiwiSdrStream* m_stream;
+};
+
+#endif // KIWISTREAMCONTROLLER_H
@@ -0,0 +1,309 @@
+/*
+ * PageAudioTap.cpp
+ *
+ * Captures an SDR page's WebAudio output and forwards it to the mixer
+ * Part of HamMixer CT7BAC
+ */
+
+#include "PageAudioTap.h"
+#include <QWebEnginePage>
+#include <QWebEngineScript>
+#include <QWebEngineScriptCollection>
+#include <QWebChannel>
+#include <QByteArray>
+#include <QDebug>
+#include <cstdint>
+
+namespace {
+
+const char* kScriptName = "hammixer-audio-tap";
+
+// Wraps AudioNode.connect()/disconnect() so that what the page sends to a
+// destination goes through a tap first. Installed before the page's own
+// scripts, so every AudioContext it creates is covered. The channel object
+// is picked up once SmeterBridge's script has connected the page.
+const char* kTapScript = R"JS(
+(function() {
+    window.__hammixerCapture = %STATE%;
+    if (window.__hammixerAudioTap || typeof AudioNode === 'undefined') {
+        return;
+    }
+    var tap = window.__hammixerAudioTap = { nodes: [] };
+    var nativeConnect = AudioNode.prototype.connect;
+    var nativeDisconnect = AudioNode.prototype.disconnect;
+    var inputs = new WeakMap();
+    var bridge = null;
+    var workletUrl = null;
+
+    // Until the channel is up the audio keeps playing out, never into nothing
+    function capturing() {
+        return !!(bridge && window.__hammixerCapture);
+    }
+
+    function update() {
+        var capture = capturing();
+        tap.nodes.forEach(function(node) { node.port.postMessage(capture); });
+    }
+
+    function attachBridge() {
+        if (window.__hammixerChannel) {
+            bridge = window.__hammixerChannel.objects.hammixerAudio || null;
+            update();
+        }
+    }
+    window.addEventListener('hammixerchannel', attachBridge);
+    attachBridge();
+
+    tap.setCapture = function(enabled) {
+        window.__hammixerCapture = enabled;
+        update();
+    };
+
+    // 16-bit PCM as base64: a quarter of the JSON of a float array
+    function send(samples, rate) {
+        if (!capturing()) return;
+        var pcm = new Int16Array(samples.length);
+        for (var i = 0; i < samples.length; i++) {
+            var s = samples[i];
+            pcm[i] = s >= 1 ? 32767 : (s <= -1 ? -32767 : s * 32767);
+        }
+        var bytes = new Uint8Array(pcm.buffer);
+        var binary = '';
+        for (var j = 0; j < bytes.length; j += 8192) {
+            binary += String.fromCharCode.apply(null, bytes.subarray(j, j + 8192));
+        }
+        bridge.push(btoa(binary), rate);
+    }
+
+    // Mixes to mono and posts ~20 ms blocks; silent while capturing, else a pass-through
+    var workletSource = `
+        class HamMixerTap extends AudioWorkletProcessor {
+            constructor(options) {
+                super();
+                this.capture = options.processorOptions.capture;
+                this.size = options.processorOptions.block;
+                this.block = new Float32Array(this.size);
+                this.fill = 0;
+                this.port.onmessage = (e) => { this.capture = e.data; };
+            }
+            process(inputs, outputs) {
+                var input = inputs[0], output = outputs[0];
+                if (!input || input.length === 0) return true;
+                if (!this.capture) {
+                    for (var c = 0; c < output.length; c++) {
+                        output[c].set(input[Math.min(c, input.length - 1)]);
+                    }
+                    this.fill = 0;
+                    return true;
+                }
+                var scale = 1 / input.length;
+                for (var i = 0; i < input[0].length; i++) {
+                    var sum = 0;
+                    for (var ch = 0; ch < input.length; ch++) sum += input[ch][i];
+                    this.block[this.fill++] = sum * scale;
+                    if (this.fill === this.size) {
+                        this.port.postMessage(this.block, [this.block.buffer]);
+                        this.block = new Float32Array(this.size);
+                        this.fill = 0;
+                    }
+                }
+                return true;
+            }
+        }
+        registerProcessor('hammixer-tap', HamMixerTap);
+    `;
+
+    // Worklets need a secure context; plain http pages get a ScriptProcessor
+    function scriptTap(ctx, input) {
+        var node = ctx.createScriptProcessor(1024, 2, 2);
+        node.onaudioprocess = function(e) {
+            var inBuf = e.inputBuffer, outBuf = e.outputBuffer;
+            var capture = capturing();
+            for (var c = 0; c < outBuf.numberOfChannels; c++) {
+                var out = outBuf.getChannelData(c);
+                if (capture) {
+                    out.fill(0);
+                } else {
+                    out.set(inBuf.getChannelData(Math.min(c, inBuf.numberOfChannels - 1)));
+                }
+            }
+            if (!capture) return;
+
+            var channels = inBuf.numberOfChannels;
+            var mono = new Float32Array(inBuf.length);
+            for (var ch = 0; ch < channels; ch++) {
+                var data = inBuf.getChannelData(ch);
+                for (var i = 0; i < data.length; i++) mono[i] += data[i] / channels;
+            }
+            send(mono, ctx.sampleRate);
+        };
+        nativeConnect.call(input, node);
+        nativeConnect.call(node, ctx.destination);
+    }
+
+    function tapInput(ctx) {
+        if (typeof OfflineAudioContext !== 'undefined' && ctx instanceof OfflineAudioContext) {
+            return null;
+        }
+        var input = inputs.get(ctx);
+        if (input) return input;
+
+        input = ctx.createGain();
+        inputs.set(ctx, input);
+        if (!ctx.audioWorklet || typeof AudioWorkletNode === 'undefined') {
+            scriptTap(ctx, input);
+            return input;
+        }
+
+        // Plays straight through until the worklet has loaded
+        nativeConnect.call(input, ctx.destination);
+        if (!workletUrl) {
+            workletUrl = URL.createObjectURL(new Blob([workletSource], { type: 'application/javascript' }));
+        }
+        ctx.audioWorklet.addModule(workletUrl).then(function() {
+            var node = new AudioWorkletNode(ctx, 'hammixer-tap', {
+                outputChannelCount: [2],
+                processorOptions: {
+                    capture: capturing(),
+                    block: Math.round(ctx.sampleRate / 50)
+                }
+            });
+            node.port.onmessage = function(e) { send(e.data, ctx.sampleRate); };
+            tap.nodes.push(node);
+            nativeConnect.call(input, node);
+            nativeConnect.call(node, ctx.destination);
+            nativeDisconnect.call(input, ctx.destination);
+        }).catch(function(e) {
+            console.log('HamMixer: Audio worklet unavailable (' + e.message + '), using ScriptProcessor');
+            nativeDisconnect.call(input, ctx.destination);
+            scriptTap(ctx, input);
+        });
+        return input;
+    }
+
+    AudioNode.prototype.connect = function(target) {
+        if (typeof AudioDestinationNode !== 'undefined' && target instanceof AudioDestinationNode) {
+            var input = tapInput(target.context);
+            if (input) {
+                nativeConnect.call(this, input, arguments.length > 1 ? arguments[1] : 0);
+                return target;
+            }
+        }
+        return nativeConnect.apply(this, arguments);
+    };
+
+    AudioNode.prototype.disconnect = function(target) {
+        if (typeof AudioDestinationNode !== 'undefined' && target instanceof AudioDestinationNode) {
+            var input = inputs.get(target.context);
+            if (input) {
+                try { nativeDisconnect.call(this, input); } catch (e) {}
+                return;
+            }
+        }
+        return nativeDisconnect.apply(this, arguments);
+    };
+})();
+)JS";
+
+} // namespace
+
+PageAudioTap::PageAudioTap(QWebEnginePage* page, QWebChannel* channel, QObject* parent)
+    : QObject(parent)
+    , m_page(page)
+    , m_channel(channel)
+    , m_stallTimer(new QTimer(this))
+    , m_enabled(false)
+    , m_delivering(false)
+{
+    m_channel->registerObject(OBJECT_NAME, this);
+
+    m_stallTimer->setSingleShot(true);
+    connect(m_stallTimer, &QTimer::timeout, this, [this]() {
+        setDelivering(false);
+    });
+
+    injectState();
+}
+
+PageAudioTap::~PageAudioTap()
+{
+    if (m_channel) {
+        m_channel->deregisterObject(this);
+    }
+}
+
+void PageAudioTap::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) {
+        return;
+    }
+    m_enabled = enabled;
+
+    injectState();
+    m_page->runJavaScript(QString("if (window.__hammixerAudioTap) {"
+                                  "  window.__hammixerAudioTap.setCapture(%1);"
+                                  "} else {"
+                                  "  window.__hammixerCapture = %1;"
+                                  "}").arg(enabled ? "true" : "false"));
+
+    if (!enabled) {
+        m_stallTimer->stop();
+        setDelivering(false);
+    }
+    qDebug() << "PageAudioTap: Page audio capture" << (enabled ? "on" : "off");
+}
+
+void PageAudioTap::push(const QString& pcm, int sampleRate)
+{
+    if (!m_enabled || sampleRate <= 0) {
+        return;
+    }
+
+    QByteArray bytes = QByteArray::fromBase64(pcm.toLatin1());
+    int frames = static_cast<int>(bytes.size() / 2);
+    if (frames <= 0) {
+        return;
+    }
+
+    m_samples.resize(frames);
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(bytes.constData());
+    for (int i = 0; i < frames; i++) {
+        int16_t value = static_cast<int16_t>(data[2 * i] | (data[2 * i + 1] << 8));
+        m_samples[i] = value / 32768.0f;
+    }
+
+    // Announce before the first block so channel 2 is switched over to take it
+    m_stallTimer->start(STALL_MS);
+    setDelivering(true);
+
+    if (m_sink) {
+        m_sink(m_samples.data(), frames, sampleRate);
+    }
+}
+
+void PageAudioTap::injectState()
+{
+    QWebEngineScriptCollection& scripts = m_page->scripts();
+    for (const QWebEngineScript& old : scripts.find(kScriptName)) {
+        scripts.remove(old);
+    }
+
+    QWebEngineScript script;
+    script.setName(kScriptName);
+    script.setSourceCode(QString::fromLatin1(kTapScript)
+                             .replace("%STATE%", m_enabled ? "true" : "false"));
+    script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+    script.setWorldId(QWebEngineScript::MainWorld);
+    script.setRunsOnSubFrames(false);
+    scripts.insert(script);
+}
+
+void PageAudioTap::setDelivering(bool delivering)
+{
+    if (m_delivering == delivering) {
+        return;
+    }
+    m_delivering = delivering;
+    qDebug() << "PageAudioTap:" << (delivering ? "Receiving page audio" : "Page audio stopped");
+    emit deliveringChanged(delivering);
+}
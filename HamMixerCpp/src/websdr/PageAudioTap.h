@@ -0,0 +1,96 @@
+/*
+ * PageAudioTap.h
+ *
+ * Captures an SDR page's WebAudio output and forwards it to the mixer
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef PAGEAUDIOTAP_H
+#define PAGEAUDIOTAP_H
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <functional>
+#include <vector>
+
+class QWebEnginePage;
+class QWebChannel;
+
+/**
+ * @brief Takes the SDR page's audio before it reaches the sound card
+ *
+ * Without it, channel 2 is captured from a WASAPI loopback of the whole
+ * endpoint, which also picks up notification sounds, other browsers and
+ * anything else playing there, and needs a dedicated virtual cable to keep
+ * HamMixer's own output out. Both SDR types play through WebAudio, so a
+ * script injected at document creation wraps AudioNode.connect(): whatever
+ * the page connects to its AudioContext's destination goes through a tap
+ * node instead - an AudioWorklet, or a ScriptProcessor where worklets are
+ * not available (they need a secure context, and most WebSDRs are http).
+ *
+ * While capturing, the tap mixes to mono, sends 16-bit PCM in ~20 ms
+ * blocks over the page's web channel to push(), and outputs silence, so
+ * nothing of the page reaches the loopback. When capture is off it passes
+ * the audio through untouched and the loopback path works as before.
+ *
+ * The tap is delivering while blocks keep arriving; it stops counting as
+ * such after STALL_MS without one (page reloading, audio not started, or a
+ * page the hook could not reach), so the caller can fall back to loopback.
+ */
+class PageAudioTap : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Receives captured audio (mono, -1..1) on the GUI thread
+     */
+    using AudioSink = std::function<void(const float* samples, int frames, double sampleRate)>;
+
+    /**
+     * @param page Page to capture (the script applies from its next load)
+     * @param channel The page's web channel (see SmeterBridge::channel())
+     * @param parent QObject parent
+     */
+    PageAudioTap(QWebEnginePage* page, QWebChannel* channel, QObject* parent = nullptr);
+    ~PageAudioTap();
+
+    void setAudioSink(AudioSink sink) { m_sink = std::move(sink); }
+
+    /**
+     * @brief Capture the page's audio (true) or let it play out (false)
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    bool isDelivering() const { return m_delivering; }
+
+    /**
+     * @brief Page-side entry point (called through the web channel)
+     * @param pcm Base64 of little-endian 16-bit mono samples
+     * @param sampleRate Rate of the page's AudioContext
+     */
+    Q_INVOKABLE void push(const QString& pcm, int sampleRate);
+
+signals:
+    void deliveringChanged(bool delivering);
+
+private:
+    void injectState();
+    void setDelivering(bool delivering);
+
+    QWebEnginePage* m_page;
+    QPointer<QWebChannel> m_channel;    // Owned by SmeterBridge, may go first
+    QTimer* m_stallTimer;
+    AudioSink m_sink;
+    bool m_enabled;
+    bool m_delivering;
+    std::vector<float> m_samples;   // Decode scratch
+
+    static constexpr const char* OBJECT_NAME = "hammixerAudio";
+    static constexpr int STALL_MS = 500;
+};
+
+#endif // PAGEAUDIOTAP_H
@@ -0,0 +1,107 @@
+/*
+ * PageThrottle.cpp
+ *
+ * Audio-only mode for SDR pages (waterfall and spectrum rendering suspended)
+ * Part of HamMixer CT7BAC
+ */
+
+#include "PageThrottle.h"
+#include <QWebEnginePage>
+#include <QWebEngineView>
+#include <QWebEngineScript>
+#include <QWebEngineScriptCollection>
+#include <QWebEngineSettings>
+#include <QDebug>
+
+namespace {
+
+const char* kScriptName = "hammixer-throttle";
+
+// Gates the 2D canvas drawing calls on a page flag. Installed before the
+// page's own scripts so every context it creates goes through the gate.
+const char* kCanvasGate = R"(
+(function() {
+    window.__hammixerAudioOnly = %STATE%;
+    if (window.__hammixerCanvasGate || typeof CanvasRenderingContext2D === 'undefined') {
+        return;
+    }
+    window.__hammixerCanvasGate = true;
+
+    var proto = CanvasRenderingContext2D.prototype;
+    ['drawImage', 'putImageData', 'fillRect', 'clearRect', 'fill', 'stroke',
+     'fillText', 'strokeText'].forEach(function(name) {
+        var original = proto[name];
+        if (typeof original !== 'function') return;
+        proto[name] = function() {
+            if (window.__hammixerAudioOnly) return;
+            return original.apply(this, arguments);
+        };
+    });
+})();
+)";
+
+} // namespace
+
+PageThrottle::PageThrottle(QWebEnginePage* page, const QString& suspendHook,
+                           const QString& resumeHook, QObject* parent)
+    : QObject(parent)
+    , m_page(page)
+    , m_suspendHook(suspendHook)
+    , m_resumeHook(resumeHook)
+    , m_audioOnly(false)
+{
+    injectState();
+}
+
+void PageThrottle::setAudioOnly(bool enabled)
+{
+    if (m_audioOnly == enabled) {
+        return;
+    }
+    m_audioOnly = enabled;
+
+    injectState();
+    m_page->settings()->setAttribute(QWebEngineSettings::AutoLoadImages, !enabled);
+
+    if (enabled) {
+        m_page->setVisible(false);
+    } else {
+        // Visible again only if the view showing it is
+        QWebEngineView* view = QWebEngineView::forPage(m_page);
+        m_page->setVisible(!view || view->isVisible());
+    }
+
+    runHook(enabled);
+    qDebug() << "PageThrottle: Audio-only mode" << (enabled ? "on" : "off");
+}
+
+void PageThrottle::reapply()
+{
+    if (m_audioOnly) {
+        runHook(true);
+    }
+}
+
+void PageThrottle::injectState()
+{
+    QWebEngineScriptCollection& scripts = m_page->scripts();
+    for (const QWebEngineScript& old : scripts.find(kScriptName)) {
+        scripts.remove(old);
+    }
+
+    QWebEngineScript script;
+    script.setName(kScriptName);
+    script.setSourceCode(QString::fromLatin1(kCanvasGate)
+                             .replace("%STATE%", m_audioOnly ? "true" : "false"));
+    script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+    script.setWorldId(QWebEngineScript::MainWorld);
+    script.setRunsOnSubFrames(false);
+    scripts.insert(script);
+}
+
+void PageThrottle::runHook(bool enabled)
+{
+    const QString& hook = enabled ? m_suspendHook : m_resumeHook;
+    m_page->runJavaScript(QString("window.__hammixerAudioOnly = %1; try { %2 } catch (e) {}")
+                              .arg(enabled ? "true" : "false", hook));
+}
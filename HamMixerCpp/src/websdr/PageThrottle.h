@@ -0,0 +1,66 @@
+/*
+ * PageThrottle.h
+ *
+ * Audio-only mode for SDR pages (waterfall and spectrum rendering suspended)
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef PAGETHROTTLE_H
+#define PAGETHROTTLE_H
+
+#include <QObject>
+#include <QString>
+
+class QWebEnginePage;
+
+/**
+ * @brief Stops an SDR page from rendering while keeping its audio running
+ *
+ * A hidden QWebEngineView still runs the page's timers, and the waterfall
+ * and spectrum are redrawn from those at full rate, which is most of the
+ * CPU HamMixer uses while the browser is collapsed. In audio-only mode:
+ *
+ * - a script injected at document creation turns the 2D canvas drawing
+ *   calls into no-ops, so the waterfall code still runs but draws nothing
+ * - the page is marked hidden (document.visibilityState), which stops
+ *   compositing and requestAnimationFrame. It is not frozen: a frozen page
+ *   runs no script, and the SDR's audio is decoded in script
+ * - image loading is turned off
+ * - a per-site hook can ask the server to stop sending the waterfall
+ *
+ * The state is re-injected on every change, so reloads and site switches
+ * start throttled.
+ */
+class PageThrottle : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param page Page to throttle
+     * @param suspendHook Page-side JavaScript run on entering audio-only mode
+     * @param resumeHook Page-side JavaScript run on leaving it
+     * @param parent QObject parent
+     */
+    PageThrottle(QWebEnginePage* page, const QString& suspendHook,
+                 const QString& resumeHook, QObject* parent = nullptr);
+
+    void setAudioOnly(bool enabled);
+    bool isAudioOnly() const { return m_audioOnly; }
+
+    /**
+     * @brief Run the site hook again once a newly loaded page has initialized
+     */
+    void reapply();
+
+private:
+    void injectState();
+    void runHook(bool enabled);
+
+    QWebEnginePage* m_page;
+    QString m_suspendHook;
+    QString m_resumeHook;
+    bool m_audioOnly;
+};
+
+#endif // PAGETHROTTLE_H
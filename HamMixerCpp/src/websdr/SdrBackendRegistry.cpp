@@ -0,0 +1,84 @@
+/*
+ * SdrBackendRegistry.cpp
+ *
+ * Registry of the SdrController backends, by site type and capability
+ * Part of HamMixer CT7BAC
+ */
+
+#include "SdrBackendRegistry.h"
+#include "WebSdrController.h"
+#include "KiwiSdrController.h"
+#include "KiwiStreamController.h"
+#include <QDebug>
+
+void SdrBackendRegistry::registerBackend(const SdrBackend& backend)
+{
+    for (SdrBackend& existing : m_backends) {
+        if (existing.name == backend.name) {
+            existing = backend;
+            return;
+        }
+    }
+    m_backends.append(backend);
+    qDebug() << "SdrBackendRegistry: Registered" << backend.name;
+}
+
+SdrBackend SdrBackendRegistry::find(SdrSiteType siteType, SdrController::Capabilities wanted) const
+{
+    SdrBackend fallback;
+    for (const SdrBackend& backend : m_backends) {
+        if (backend.siteType != siteType) continue;
+        if ((backend.capabilities & wanted) == wanted) {
+            return backend;
+        }
+        if (!fallback.isValid()) {
+            fallback = backend;
+        }
+    }
+    return fallback;
+}
+
+SdrBackend SdrBackendRegistry::backend(const QString& name) const
+{
+    for (const SdrBackend& backend : m_backends) {
+        if (backend.name == name) {
+            return backend;
+        }
+    }
+    return SdrBackend();
+}
+
+void SdrBackendRegistry::registerBuiltins(SdrBackendRegistry& registry)
+{
+    SdrBackend webSdr;
+    webSdr.name = "websdr";
+    webSdr.siteType = SdrSiteType::WebSDR;
+    webSdr.capabilities = SdrController::SmeterPush | SdrController::BrowserPage
+                        | SdrController::PageAudio;
+    webSdr.keepWhenIdle = true;
+    webSdr.create = [](QWebEngineProfile* profile, QWidget* parentWidget, QObject* parent) -> SdrController* {
+        return new WebSdrController(profile, parentWidget, parent);
+    };
+    registry.registerBackend(webSdr);
+
+    // Page first: the native stream is only picked when NativeAudio is asked for
+    SdrBackend kiwiSdr;
+    kiwiSdr.name = "kiwisdr";
+    kiwiSdr.siteType = SdrSiteType::KiwiSDR;
+    kiwiSdr.capabilities = SdrController::SmeterPush | SdrController::Passband
+                         | SdrController::BrowserPage | SdrController::PageAudio;
+    kiwiSdr.create = [](QWebEngineProfile* profile, QWidget* parentWidget, QObject* parent) -> SdrController* {
+        return new KiwiSdrController(profile, parentWidget, parent);
+    };
+    registry.registerBackend(kiwiSdr);
+
+    SdrBackend kiwiStream;
+    kiwiStream.name = "kiwisdr-native";
+    kiwiStream.siteType = SdrSiteType::KiwiSDR;
+    kiwiStream.capabilities = SdrController::NativeAudio | SdrController::SmeterPush
+                            | SdrController::Passband;
+    kiwiStream.create = [](QWebEngineProfile*, QWidget*, QObject* parent) -> SdrController* {
+        return new KiwiStreamController(parent);
+    };
+    registry.registerBackend(kiwiStream);
+}
@@ -0,0 +1,75 @@
+/*
+ * SdrBackendRegistry.h
+ *
+ * Registry of the SdrController backends, by site type and capability
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef SDRBACKENDREGISTRY_H
+#define SDRBACKENDREGISTRY_H
+
+#include <QList>
+#include <QString>
+#include <functional>
+
+#include "SdrController.h"
+
+class QWebEngineProfile;
+class QWidget;
+
+/**
+ * @brief How to make a controller for one kind of SDR site
+ */
+struct SdrBackend {
+    QString name;                               // Unique, e.g. "kiwisdr-native"
+    SdrSiteType siteType = SdrSiteType::WebSDR;
+    SdrController::Capabilities capabilities;
+    bool keepWhenIdle = false;                  // Reuse one instance rather than delete it (browser start-up)
+
+    /**
+     * @brief Create a controller; profile and parentWidget are only used by page backends
+     */
+    std::function<SdrController*(QWebEngineProfile* profile, QWidget* parentWidget,
+                                 QObject* parent)> create;
+
+    bool isValid() const { return !name.isEmpty() && create; }
+};
+
+/**
+ * @brief Backends WebSdrManager can pick from
+ *
+ * A new receiver type is supported by registering a backend for its site
+ * type; the manager and the UI only see SdrController. Registration order
+ * is preference order.
+ */
+class SdrBackendRegistry
+{
+public:
+    /**
+     * @brief Add a backend, replacing one registered under the same name
+     */
+    void registerBackend(const SdrBackend& backend);
+
+    /**
+     * @brief First backend for a site type having all wanted capabilities,
+     * or failing that the first one for the type (invalid if none)
+     */
+    SdrBackend find(SdrSiteType siteType, SdrController::Capabilities wanted = {}) const;
+
+    /**
+     * @brief Backend by name (invalid if not registered)
+     */
+    SdrBackend backend(const QString& name) const;
+
+    const QList<SdrBackend>& backends() const { return m_backends; }
+
+    /**
+     * @brief The WebSDR page, the KiwiSDR page and the native KiwiSDR stream
+     */
+    static void registerBuiltins(SdrBackendRegistry& registry);
+
+private:
+    QList<SdrBackend> m_backends;
+};
+
+#endif // SDRBACKENDREGISTRY_H
@@ -0,0 +1,120 @@
+/*
+ * SdrController.h
+ *
+ * Common interface of the SDR receiver backends
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef SDRCONTROLLER_H
+#define SDRCONTROLLER_H
+
+#include <QObject>
+#include <QString>
+#include <functional>
+#include <cstdint>
+
+#include "WebSdrSite.h"
+
+/**
+ * @brief One receiver on one SDR site, whatever drives it
+ *
+ * WebSdrManager only talks to this interface; backends are created through
+ * the SdrBackendRegistry. What a backend can do beyond loading, tuning and
+ * reporting its state is announced by capabilities(); the calls that
+ * belong to a capability the backend lacks are no-ops here.
+ *
+ * Tuning calls are accepted in any state: a backend that is not ready yet
+ * keeps the latest values and applies them once it is. applied (optional)
+ * runs when the change has been executed, or straight away if it was only
+ * stored.
+ */
+class SdrController : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State {
+        Unloaded,
+        Loading,
+        Ready,
+        Error
+    };
+    Q_ENUM(State)
+
+    enum Capability {
+        NativeAudio = 0x01,  // Audio goes to the audio sink itself, no browser or loopback
+        SmeterPush  = 0x02,  // S-meter pushed as it changes, timestamped at the source
+        Passband    = 0x04,  // setPassband() is honoured
+        BrowserPage = 0x08,  // Shows a page: window, audio-only throttling, warm standby
+        PageAudio   = 0x10   // Page audio can be captured to the sink (setPageAudioCapture())
+    };
+    Q_DECLARE_FLAGS(Capabilities, Capability)
+
+    /**
+     * @brief Receives audio (mono, -1..1) on the GUI thread, at the sender's
+     * exact rate in Hz (a KiwiSDR's is fractional)
+     */
+    using AudioSink = std::function<void(const float* samples, int frames, double sampleRate)>;
+
+    explicit SdrController(QObject* parent = nullptr) : QObject(parent) {}
+    ~SdrController() override = default;
+
+    virtual Capabilities capabilities() const = 0;
+    bool hasCapability(Capability capability) const { return capabilities().testFlag(capability); }
+
+    // Load/unload site
+    virtual void loadSite(const WebSdrSite& site) = 0;
+    virtual void unload() = 0;
+
+    // State
+    virtual State state() const = 0;
+    bool isReady() const { return state() == Ready; }
+    virtual bool isPageReady() const { return isReady(); }  // Set up and following tuning
+    virtual const WebSdrSite& currentSite() const = 0;
+
+    // Tuning: frequency in Hz, mode "lsb", "usb", "cw", "am", "fm"
+    virtual void setFrequency(uint64_t frequencyHz, std::function<void()> applied = nullptr) = 0;
+    virtual void setMode(const QString& mode, std::function<void()> applied = nullptr) = 0;
+    virtual void tune(uint64_t frequencyHz, const QString& mode, std::function<void()> applied = nullptr) = 0;
+
+    /**
+     * @brief Receiver passband in Hz from the carrier (Passband)
+     */
+    virtual void setPassband(int lowCutHz, int highCutHz) { Q_UNUSED(lowCutHz); Q_UNUSED(highCutHz); }
+
+    // Start/stop forwarding S-meter readings
+    virtual void startSmeterUpdates() {}
+    virtual void stopSmeterUpdates() {}
+
+    /**
+     * @brief Where audio goes (NativeAudio, or PageAudio while capturing)
+     */
+    virtual void setAudioSink(AudioSink sink) { Q_UNUSED(sink); }
+
+    // Browser page (BrowserPage)
+    virtual void showWindow() {}
+    virtual void hideWindow() {}
+    virtual void warmUp() {}                        // Start the browser engine without a site
+    virtual void setAudioOnly(bool enabled) { Q_UNUSED(enabled); }
+    virtual void setStandby(bool standby) { Q_UNUSED(standby); }
+    virtual bool isStandby() const { return false; }
+    virtual qint64 pageLoadMs() const { return -1; }  // Load start to page ready, -1 if not loaded live
+
+    // Page audio capture (PageAudio)
+    virtual void setPageAudioCapture(bool enabled) { Q_UNUSED(enabled); }
+
+signals:
+    void stateChanged(SdrController::State state);
+    void ready();                                     // Site set up; isPageReady() is now true
+    void errorOccurred(const QString& error);
+    void smeterChanged(int value, qint64 sampledMs);  // WebSDR scale; sampledMs on RadioController::monotonicMs()
+
+    /**
+     * @brief The site's audio started or stopped arriving through the audio sink
+     */
+    void sinkAudioChanged(bool active);
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(SdrController::Capabilities)
+
+#endif // SDRCONTROLLER_H
@@ -0,0 +1,352 @@
+/*
+ * SdrDirectory.cpp
+ *
+ * Catalogue of public SDR sites with cached per-band probe results
+ * Part of HamMixer CT7BAC
+ */
+
+#include "SdrDirectory.h"
+#include "config/BandPlan.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QUrl>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Pages that list receivers rather than being one
+const char* const LIST_HOSTS[] = {
+    "kiwisdr.com", "www.kiwisdr.com", "websdr.org", "www.websdr.org",
+    "receiverbook.de", "www.receiverbook.de", "sdr.hu"
+};
+
+constexpr int KIWISDR_DEFAULT_PORT = 8073;
+
+QString siteIdFor(const QUrl& url)
+{
+    QString id = "dir-" + url.host().toLower();
+    if (url.port() > 0) id += "-" + QString::number(url.port());
+    return id.replace('.', '-');
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// ProbeResult
+// ----------------------------------------------------------------------------
+
+double SdrDirectory::ProbeResult::score() const
+{
+    if (!reachable) return std::numeric_limits<double>::infinity();
+
+    double delay = delayValid ? std::abs(delayMs) : UNMEASURED_PENALTY_MS;
+    double setup = std::max(0, connectMs) + std::max(0, audioStartMs);
+    return delay + 0.1 * setup;
+}
+
+bool SdrDirectory::ProbeResult::isStale() const
+{
+    return !probedAt.isValid()
+        || probedAt.secsTo(QDateTime::currentDateTimeUtc()) > CACHE_TTL_HOURS * 3600;
+}
+
+QJsonObject SdrDirectory::ProbeResult::toJson() const
+{
+    QJsonObject obj;
+    obj["reachable"] = reachable;
+    obj["connect_ms"] = connectMs;
+    obj["audio_start_ms"] = audioStartMs;
+    if (delayValid) {
+        obj["delay_ms"] = delayMs;
+        obj["confidence"] = static_cast<double>(confidence);
+    }
+    obj["probed_at"] = probedAt.toString(Qt::ISODate);
+    return obj;
+}
+
+SdrDirectory::ProbeResult SdrDirectory::ProbeResult::fromJson(const QJsonObject& obj)
+{
+    ProbeResult result;
+    result.reachable = obj["reachable"].toBool(false);
+    result.connectMs = obj["connect_ms"].toInt(-1);
+    result.audioStartMs = obj["audio_start_ms"].toInt(-1);
+    result.delayValid = obj.contains("delay_ms");
+    result.delayMs = obj["delay_ms"].toInt(0);
+    result.confidence = static_cast<float>(obj["confidence"].toDouble(0.0));
+    result.probedAt = QDateTime::fromString(obj["probed_at"].toString(), Qt::ISODate);
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+// SdrDirectory
+// ----------------------------------------------------------------------------
+
+SdrDirectory::SdrDirectory(const QString& cachePath, QObject* parent)
+    : QObject(parent)
+    , m_cachePath(cachePath)
+    , m_saveTimer(this)
+{
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(SAVE_DELAY_MS);
+    connect(&m_saveTimer, &QTimer::timeout, this, [this]() { save(); });
+}
+
+SdrDirectory::~SdrDirectory()
+{
+    // Results still waiting for the save timer
+    if (m_saveTimer.isActive()) {
+        save();
+    }
+}
+
+bool SdrDirectory::load()
+{
+    QFile file(m_cachePath);
+    if (!file.exists()) {
+        return false;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "SdrDirectory: Failed to open" << m_cachePath;
+        return false;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+    if (!doc.isObject()) {
+        qWarning() << "SdrDirectory: Invalid cache file format";
+        return false;
+    }
+
+    m_entries.clear();
+    m_index.clear();
+    const QJsonArray sites = doc.object()["sites"].toArray();
+    for (const QJsonValue& value : sites) {
+        QJsonObject obj = value.toObject();
+        if (!addSite(WebSdrSite::fromJson(obj))) continue;
+
+        Entry& entry = m_entries.last();
+        const QJsonObject results = obj["results"].toObject();
+        for (auto it = results.begin(); it != results.end(); ++it) {
+            entry.results.insert(it.key(), ProbeResult::fromJson(it.value().toObject()));
+        }
+    }
+
+    qDebug() << "SdrDirectory: Loaded" << m_entries.size() << "sites from" << m_cachePath;
+    emit changed();
+    return true;
+}
+
+bool SdrDirectory::save()
+{
+    m_saveTimer.stop();
+    QDir().mkpath(QFileInfo(m_cachePath).absolutePath());
+
+    QFile file(m_cachePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "SdrDirectory: Failed to save" << m_cachePath;
+        return false;
+    }
+
+    QJsonArray sites;
+    for (const Entry& entry : m_entries) {
+        QJsonObject obj = entry.site.toJson();
+        QJsonObject results;
+        for (auto it = entry.results.begin(); it != entry.results.end(); ++it) {
+            results[it.key()] = it.value().toJson();
+        }
+        obj["results"] = results;
+        sites.append(obj);
+    }
+
+    QJsonObject root;
+    root["sites"] = sites;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    file.close();
+    return true;
+}
+
+int SdrDirectory::importFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "SdrDirectory: Failed to open" << path;
+        return -1;
+    }
+    QByteArray data = file.readAll();
+    file.close();
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(data, &error);
+    int added = (error.error == QJsonParseError::NoError)
+        ? importJson(doc)
+        : importText(QString::fromUtf8(data));
+
+    qDebug() << "SdrDirectory: Imported" << added << "new sites from" << path;
+    if (added > 0) {
+        save();
+        emit changed();
+    }
+    return added;
+}
+
+int SdrDirectory::importJson(const QJsonDocument& doc)
+{
+    QJsonArray sites = doc.isArray() ? doc.array() : doc.object()["sites"].toArray();
+
+    int added = 0;
+    for (const QJsonValue& value : sites) {
+        QJsonObject obj = value.toObject();
+        WebSdrSite site = WebSdrSite::fromJson(obj);
+        QUrl url(site.effectiveUrl());
+        if (!url.isValid() || url.host().isEmpty()) continue;
+
+        // Public lists carry no type; KiwiSDRs are recognised by their port
+        if (!obj.contains("type") && url.port() == KIWISDR_DEFAULT_PORT) {
+            site.type = SdrSiteType::KiwiSDR;
+        }
+        if (site.id.isEmpty()) site.id = siteIdFor(url);
+        if (site.name.isEmpty()) site.name = url.host();
+        site.standby = false;
+        site.diversity = false;
+
+        if (addSite(site)) added++;
+    }
+    return added;
+}
+
+int SdrDirectory::importText(const QString& text)
+{
+    static const QRegularExpression urlPattern(QStringLiteral("https?://[^\\s\"'<>()]+"),
+                                               QRegularExpression::CaseInsensitiveOption);
+
+    int added = 0;
+    const QStringList lines = text.split('\n');
+    for (const QString& line : lines) {
+        bool kiwiLine = line.contains("kiwi", Qt::CaseInsensitive);
+
+        auto matches = urlPattern.globalMatch(line);
+        while (matches.hasNext()) {
+            QUrl url(matches.next().captured(0));
+            if (!url.isValid() || url.host().isEmpty()) continue;
+
+            QString host = url.host().toLower();
+            bool listPage = std::any_of(std::begin(LIST_HOSTS), std::end(LIST_HOSTS),
+                                        [&host](const char* h) { return host == h; });
+            if (listPage) continue;
+
+            // A site is its server; links into it (scripts, pages) collapse onto it
+            QUrl server;
+            server.setScheme(url.scheme().toLower());
+            server.setHost(host);
+            server.setPort(url.port());
+            server.setPath("/");
+
+            WebSdrSite site;
+            site.id = siteIdFor(server);
+            site.name = host;
+            site.url = server.toString();
+            site.type = (url.port() == KIWISDR_DEFAULT_PORT || kiwiLine)
+                ? SdrSiteType::KiwiSDR : SdrSiteType::WebSDR;
+
+            if (addSite(site)) added++;
+        }
+    }
+    return added;
+}
+
+bool SdrDirectory::addSite(const WebSdrSite& site)
+{
+    if (!site.isValid() || m_index.contains(site.id)) return false;
+
+    if (QUrl(site.effectiveUrl()).host().isEmpty()) return false;
+    for (const Entry& entry : m_entries) {
+        if (entry.site.isSameServer(site)) return false;
+    }
+
+    Entry entry;
+    entry.site = site;
+    m_index.insert(site.id, m_entries.size());
+    m_entries.append(entry);
+    return true;
+}
+
+const SdrDirectory::Entry* SdrDirectory::find(const QString& siteId) const
+{
+    auto it = m_index.constFind(siteId);
+    return it == m_index.constEnd() ? nullptr : &m_entries[it.value()];
+}
+
+void SdrDirectory::clear()
+{
+    m_entries.clear();
+    m_index.clear();
+    save();
+    emit changed();
+}
+
+bool SdrDirectory::needsProbe(const QString& siteId, const QString& band) const
+{
+    const Entry* entry = find(siteId);
+    if (!entry) return false;
+
+    auto it = entry->results.constFind(band);
+    return it == entry->results.constEnd() || it.value().isStale();
+}
+
+void SdrDirectory::setResult(const QString& siteId, const QString& band, const ProbeResult& result)
+{
+    auto it = m_index.constFind(siteId);
+    if (it == m_index.constEnd()) return;
+
+    // A probe sweep sets many results in a row: write them out together.
+    // Not restarted, so a long sweep still saves every SAVE_DELAY_MS
+    m_entries[it.value()].results.insert(band, result);
+    if (!m_saveTimer.isActive()) {
+        m_saveTimer.start();
+    }
+    emit changed();
+}
+
+QList<const SdrDirectory::Entry*> SdrDirectory::ranked(const QString& band) const
+{
+    QList<const Entry*> list;
+    for (const Entry& entry : m_entries) {
+        auto it = entry.results.constFind(band);
+        if (it == entry.results.constEnd()) continue;
+        if (!it.value().reachable || it.value().isStale()) continue;
+        list.append(&entry);
+    }
+
+    std::stable_sort(list.begin(), list.end(), [&band](const Entry* a, const Entry* b) {
+        return a->results.value(band).score() < b->results.value(band).score();
+    });
+    return list;
+}
+
+WebSdrSite SdrDirectory::best(const QString& band) const
+{
+    QList<const Entry*> list = ranked(band);
+    return list.isEmpty() ? WebSdrSite() : list.first()->site;
+}
+
+QString SdrDirectory::bandForFrequency(uint64_t frequencyHz)
+{
+    int index = BandPlan::bandIndex(frequencyHz);
+    return index < 0 ? QString() : QString::fromLatin1(BandPlan::BANDS[index].label);
+}
+
+QStringList SdrDirectory::bands()
+{
+    QStringList labels;
+    for (const BandPlan::Band& band : BandPlan::BANDS) {
+        labels.append(QString::fromLatin1(band.label));
+    }
+    return labels;
+}
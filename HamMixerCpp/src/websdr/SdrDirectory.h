@@ -0,0 +1,146 @@
+/*
+ * SdrDirectory.h
+ *
+ * Catalogue of public SDR sites with cached per-band probe results
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef SDRDIRECTORY_H
+#define SDRDIRECTORY_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QMap>
+#include <QStringList>
+#include <QHash>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QTimer>
+#include <cstdint>
+
+#include "WebSdrSite.h"
+
+/**
+ * @brief Sites imported from public KiwiSDR/WebSDR lists, ranked per band
+ *
+ * The user's own site list stays in Settings; the directory is a larger
+ * pool of candidates to pick from. Lists are imported from a local file:
+ * JSON (an array of site objects in the config.json format, or an object
+ * with a "sites" array), or any text/HTML page, from which every http(s)
+ * URL is taken - saved copies of the public KiwiSDR and WebSDR lists work
+ * as they are.
+ *
+ * SdrProber measures each candidate per band; results are kept with the
+ * sites in a JSON cache file and go stale after CACHE_TTL_HOURS (band
+ * conditions and site load change through the day). Sites are ranked by
+ * ProbeResult::score(), lowest first. Probe results are written to the
+ * cache at most every SAVE_DELAY_MS, and on destruction.
+ */
+class SdrDirectory : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int CACHE_TTL_HOURS = 24;
+    static constexpr double UNMEASURED_PENALTY_MS = 2000.0;  // Score of a delay that could not be measured
+    static constexpr int SAVE_DELAY_MS = 5000;               // Probe results are written out in batches
+
+    /**
+     * @brief Outcome of probing one site on one band
+     */
+    struct ProbeResult {
+        bool reachable = false;
+        int connectMs = -1;       // TCP connection setup
+        int audioStartMs = -1;    // Stream open to first audio (KiwiSDR only)
+        int delayMs = 0;          // Audio delay behind the radio (AudioSync)
+        bool delayValid = false;
+        float confidence = 0.0f;  // Of the delay measurement
+        QDateTime probedAt;
+
+        /**
+         * @brief Ranking cost (lower is better, unreachable sites last)
+         *
+         * The measured delay dominates, since that is what has to be made up
+         * on the radio side; setup times count a tenth, as they are paid
+         * once per switch.
+         */
+        double score() const;
+
+        bool isStale() const;
+
+        QJsonObject toJson() const;
+        static ProbeResult fromJson(const QJsonObject& obj);
+    };
+
+    struct Entry {
+        WebSdrSite site;
+        QMap<QString, ProbeResult> results;  // Per band label ("40m")
+    };
+
+    /**
+     * @param cachePath JSON file holding the sites and their probe results
+     */
+    explicit SdrDirectory(const QString& cachePath, QObject* parent = nullptr);
+    ~SdrDirectory() override;
+
+    bool load();
+
+    /**
+     * @brief Write the cache file now (setResult() only schedules a write)
+     */
+    bool save();
+
+    /**
+     * @brief Add the sites found in a local list file
+     * @return Number of new sites, or -1 if the file could not be read
+     */
+    int importFile(const QString& path);
+
+    const QList<Entry>& entries() const { return m_entries; }
+    const Entry* find(const QString& siteId) const;
+    void clear();
+
+    /**
+     * @brief Whether a site has no fresh result for a band
+     */
+    bool needsProbe(const QString& siteId, const QString& band) const;
+
+    void setResult(const QString& siteId, const QString& band, const ProbeResult& result);
+
+    /**
+     * @brief Reachable sites with a fresh result for a band, best first
+     */
+    QList<const Entry*> ranked(const QString& band) const;
+
+    /**
+     * @brief Best-ranked site for a band (invalid site if none)
+     */
+    WebSdrSite best(const QString& band) const;
+
+    /**
+     * @brief Amateur band label of a frequency ("40m"), empty outside the bands
+     */
+    static QString bandForFrequency(uint64_t frequencyHz);
+
+    /**
+     * @brief Band labels, lowest first
+     */
+    static QStringList bands();
+
+signals:
+    void changed();
+
+private:
+    bool addSite(const WebSdrSite& site);
+    int importJson(const QJsonDocument& doc);
+    int importText(const QString& text);
+
+    QString m_cachePath;
+    QList<Entry> m_entries;
+    QHash<QString, int> m_index;  // Site id -> position in m_entries
+    QTimer m_saveTimer;           // Pending write of probe results
+};
+
+#endif // SDRDIRECTORY_H
@@ -0,0 +1,231 @@
+/*
+ * SdrProber.cpp
+ *
+ * Background latency/quality probing of SDR directory sites
+ * Part of HamMixer CT7BAC
+ */
+
+#include "SdrProber.h"
+#include <QUrl>
+#include <QDebug>
+#include <cmath>
+
+SdrProber::SdrProber(SdrDirectory* directory, QObject* parent)
+    : QObject(parent)
+    , m_directory(directory)
+    , m_socket(new QTcpSocket(this))
+    , m_stream(new KiwiSdrStream(this))
+    , m_stageTimer(new QTimer(this))
+    , m_pollTimer(new QTimer(this))
+    , m_stage(Idle)
+    , m_frequencyHz(0)
+{
+    m_stageTimer->setSingleShot(true);
+    connect(m_stageTimer, &QTimer::timeout, this, &SdrProber::onStageTimeout);
+
+    m_pollTimer->setInterval(POLL_INTERVAL_MS);
+    connect(m_pollTimer, &QTimer::timeout, this, &SdrProber::onPoll);
+
+    connect(m_socket, &QTcpSocket::connected, this, &SdrProber::onConnected);
+    connect(m_socket, &QTcpSocket::errorOccurred, this, [this]() {
+        if (m_stage == Connecting) {
+            qDebug() << "SdrProber:" << m_site.name << "unreachable:" << m_socket->errorString();
+            finish();
+        }
+    });
+
+    connect(m_stream, &KiwiSdrStream::streamReady, this, &SdrProber::onStreamReady);
+    connect(m_stream, &KiwiSdrStream::errorOccurred, this, [this](const QString&) {
+        // Busy or refused: reachable, but no audio to rank it by
+        if (m_stage == StartingAudio || m_stage == Settling || m_stage == Measuring) {
+            finish();
+        }
+    });
+}
+
+SdrProber::~SdrProber()
+{
+    cancel();
+}
+
+void SdrProber::setAudioSink(KiwiSdrStream::AudioSink sink)
+{
+    m_stream->setAudioSink(std::move(sink));
+}
+
+void SdrProber::setTuning(uint64_t frequencyHz, const QString& mode)
+{
+    m_frequencyHz = frequencyHz;
+    if (!mode.isEmpty()) {
+        m_mode = mode;
+    }
+
+    // Keep a stream being measured on the radio's frequency
+    if (m_stage == Settling || m_stage == Measuring) {
+        m_stream->tune(m_frequencyHz, m_mode);
+    }
+}
+
+void SdrProber::probeBand(const QString& band, bool force)
+{
+    if (band.isEmpty()) return;
+    if (isBusy() && band == m_band && !force) return;
+
+    cancel();
+    m_band = band;
+
+    for (const SdrDirectory::Entry& entry : m_directory->entries()) {
+        if (m_queue.size() >= MAX_SITES_PER_BATCH) break;
+        if (force || m_directory->needsProbe(entry.site.id, band)) {
+            m_queue.append(entry.site.id);
+        }
+    }
+
+    if (m_queue.isEmpty()) {
+        emit bandProbed(band);
+        return;
+    }
+
+    qDebug() << "SdrProber: Probing" << m_queue.size() << "sites on" << band;
+    probeNext();
+}
+
+void SdrProber::cancel()
+{
+    m_queue.clear();
+    closeConnections();
+    m_stage = Idle;
+}
+
+void SdrProber::probeNext()
+{
+    m_stage = Idle;
+    while (!m_queue.isEmpty()) {
+        const SdrDirectory::Entry* entry = m_directory->find(m_queue.takeFirst());
+        if (!entry) continue;
+
+        m_site = entry->site;
+        m_result = SdrDirectory::ProbeResult();
+
+        QUrl url(m_site.effectiveUrl());
+        int defaultPort = url.scheme() == "https" ? 443 : 80;
+
+        emit probeStarted(m_site.id);
+        m_stage = Connecting;
+        m_clock.start();
+        m_stageTimer->start(CONNECT_TIMEOUT_MS);
+        m_socket->connectToHost(url.host(), static_cast<quint16>(url.port(defaultPort)));
+        return;
+    }
+
+    emit bandProbed(m_band);
+}
+
+void SdrProber::onConnected()
+{
+    if (m_stage != Connecting) return;
+
+    m_stageTimer->stop();
+    m_result.reachable = true;
+    m_result.connectMs = static_cast<int>(m_clock.elapsed());
+    m_socket->abort();
+
+    if (m_site.isKiwiSDR() && m_frequencyHz > 0) {
+        startAudio();
+    } else {
+        finish();
+    }
+}
+
+void SdrProber::startAudio()
+{
+    m_stage = StartingAudio;
+    m_stream->tune(m_frequencyHz, m_mode);
+    m_clock.start();
+    m_stageTimer->start(AUDIO_TIMEOUT_MS);
+    m_stream->open(m_site);
+}
+
+void SdrProber::onStreamReady()
+{
+    if (m_stage != StartingAudio) return;
+
+    m_stageTimer->stop();
+    m_result.audioStartMs = static_cast<int>(m_clock.elapsed());
+
+    m_stage = Settling;
+    m_stageTimer->start(SETTLE_MS);
+}
+
+void SdrProber::startMeasurement()
+{
+    if (!m_meter.start || !m_meter.start()) {
+        finish();
+        return;
+    }
+
+    m_stage = Measuring;
+    m_stageTimer->start(MEASURE_TIMEOUT_MS);
+    m_pollTimer->start();
+}
+
+void SdrProber::onPoll()
+{
+    if (m_stage != Measuring || !m_meter.poll) return;
+
+    AudioSync::SyncResult sync;
+    if (!m_meter.poll(sync)) return;
+
+    if (sync.success) {
+        m_result.delayValid = true;
+        m_result.delayMs = static_cast<int>(std::lround(sync.delayMs));
+        m_result.confidence = sync.confidence;
+    }
+    finish();
+}
+
+void SdrProber::onStageTimeout()
+{
+    switch (m_stage) {
+    case Settling:
+        startMeasurement();
+        break;
+    case Waiting:
+        probeNext();
+        break;
+    case Connecting:
+        qDebug() << "SdrProber:" << m_site.name << "connect timed out";
+        finish();
+        break;
+    default:
+        // No audio, or no usable measurement: keep what was found so far
+        finish();
+        break;
+    }
+}
+
+void SdrProber::finish()
+{
+    closeConnections();
+
+    m_result.probedAt = QDateTime::currentDateTimeUtc();
+    m_directory->setResult(m_site.id, m_band, m_result);
+    emit probeFinished(m_site.id, m_result);
+
+    m_stage = Waiting;
+    m_stageTimer->start(PROBE_GAP_MS);
+}
+
+void SdrProber::closeConnections()
+{
+    m_stageTimer->stop();
+    m_pollTimer->stop();
+    m_socket->abort();
+
+    // The stream fed the probe input from its first packet
+    bool streamed = m_stream->state() != KiwiSdrStream::Unloaded;
+    m_stream->close();
+    if (streamed && m_meter.stop) {
+        m_meter.stop();
+    }
+}
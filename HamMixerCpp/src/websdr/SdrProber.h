@@ -0,0 +1,141 @@
+/*
+ * SdrProber.h
+ *
+ * Background latency/quality probing of SDR directory sites
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef SDRPROBER_H
+#define SDRPROBER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QTcpSocket>
+#include <cstdint>
+#include <functional>
+
+#include "SdrDirectory.h"
+#include "KiwiSdrStream.h"
+#include "audio/AudioSync.h"
+
+/**
+ * @brief Measures directory sites one at a time for the band in use
+ *
+ * For every site that has no fresh result on the band (at most
+ * MAX_SITES_PER_BATCH per call, so a large list is worked through a few at
+ * a time instead of hammering public receivers), the prober records:
+ *
+ * 1. connection setup: TCP connect time to the site's host and port
+ * 2. audio start: a native KiwiSdrStream tuned to the radio's frequency
+ *    and mode, from open() to the first audio packet
+ * 3. audio delay: after SETTLE_MS, the stream is measured against the radio
+ *    through a DelayMeter (the mixer's probe sync)
+ *
+ * WebSDR sites only get step 1: their audio is only available through a
+ * browser page on the shared loopback device, which is busy with the live
+ * site. Every stage has a timeout; a site that does not connect is stored
+ * as unreachable, so it is not retried until its result goes stale.
+ */
+class SdrProber : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MAX_SITES_PER_BATCH = 12;
+    static constexpr int CONNECT_TIMEOUT_MS = 3000;
+    static constexpr int AUDIO_TIMEOUT_MS = 5000;
+    static constexpr int SETTLE_MS = 1500;           // Let the stream's prefill and AGC settle
+    static constexpr int MEASURE_TIMEOUT_MS = 8000;
+    static constexpr int POLL_INTERVAL_MS = 100;
+    static constexpr int PROBE_GAP_MS = 1000;        // Between two sites
+
+    /**
+     * @brief Hooks into the audio engine for the delay measurement
+     *
+     * start() begins a capture of the probe audio against the radio and
+     * returns false if no measurement is possible (radio not connected);
+     * poll() returns true once the capture has finished, with its result;
+     * stop() abandons any capture and disconnects the probe input (called
+     * whenever a probe stream closes).
+     */
+    struct DelayMeter {
+        std::function<bool()> start;
+        std::function<bool(AudioSync::SyncResult& result)> poll;
+        std::function<void()> stop;
+    };
+
+    explicit SdrProber(SdrDirectory* directory, QObject* parent = nullptr);
+    ~SdrProber();
+
+    /**
+     * @brief Where probed audio goes (AudioManager::writeProbe())
+     */
+    void setAudioSink(KiwiSdrStream::AudioSink sink);
+    void setDelayMeter(DelayMeter meter) { m_meter = std::move(meter); }
+
+    /**
+     * @brief Radio frequency/mode the KiwiSDR probes are tuned to
+     */
+    void setTuning(uint64_t frequencyHz, const QString& mode);
+
+    /**
+     * @brief Probe the sites that need it on a band (replaces a batch for another band)
+     * @param force Probe every site again, fresh or not
+     */
+    void probeBand(const QString& band, bool force = false);
+
+    void cancel();
+
+    bool isBusy() const { return m_stage != Idle; }
+    QString band() const { return m_band; }
+    int pendingCount() const { return m_queue.size(); }
+
+signals:
+    void probeStarted(const QString& siteId);
+    void probeFinished(const QString& siteId, const SdrDirectory::ProbeResult& result);
+    void bandProbed(const QString& band);
+
+private slots:
+    void onConnected();
+    void onStreamReady();
+    void onStageTimeout();
+    void onPoll();
+
+private:
+    enum Stage {
+        Idle,
+        Connecting,
+        StartingAudio,
+        Settling,
+        Measuring,
+        Waiting    // Gap before the next site
+    };
+
+    void probeNext();
+    void startAudio();
+    void startMeasurement();
+    void finish();
+    void closeConnections();
+
+    SdrDirectory* m_directory;
+    QTcpSocket* m_socket;
+    KiwiSdrStream* m_stream;
+    QTimer* m_stageTimer;
+    QTimer* m_pollTimer;
+    QElapsedTimer m_clock;
+    DelayMeter m_meter;
+
+    Stage m_stage;
+    QString m_band;
+    QStringList m_queue;
+    WebSdrSite m_site;
+    SdrDirectory::ProbeResult m_result;
+
+    uint64_t m_frequencyHz;
+    QString m_mode;
+};
+
+#endif // SDRPROBER_H
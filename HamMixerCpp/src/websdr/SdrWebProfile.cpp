@@ -0,0 +1,115 @@
+/*
+ * SdrWebProfile.cpp
+ *
+ * Shared, disk-backed browser profile for all SDR pages
+ * Part of HamMixer CT7BAC
+ */
+
+#include "SdrWebProfile.h"
+#include <QWebEngineProfile>
+#include <QWebEngineUrlRequestInterceptor>
+#include <QWebEngineUrlRequestInfo>
+#include <QDebug>
+#include <atomic>
+
+namespace {
+
+// Counters, visitor maps and analytics seen on WebSDR/KiwiSDR pages
+const char* const kBlockedHosts[] = {
+    "google-analytics.com",
+    "googletagmanager.com",
+    "doubleclick.net",
+    "googlesyndication.com",
+    "facebook.net",
+    "hotjar.com",
+    "statcounter.com",
+    "histats.com",
+    "flagcounter.com",
+    "clustrmaps.com",
+    "revolvermaps.com",
+    "amung.us",
+    "addthis.com",
+    "sharethis.com",
+};
+
+bool isBlockedHost(const QString& host)
+{
+    for (const char* blocked : kBlockedHosts) {
+        QLatin1String domain(blocked);
+        if (host == domain
+            || (host.endsWith(domain) && host.at(host.size() - domain.size() - 1) == '.')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+/**
+ * @brief Drops requests to kBlockedHosts while enabled
+ */
+class SdrRequestFilter : public QWebEngineUrlRequestInterceptor
+{
+public:
+    explicit SdrRequestFilter(QObject* parent)
+        : QWebEngineUrlRequestInterceptor(parent)
+    {
+    }
+
+    void interceptRequest(QWebEngineUrlRequestInfo& info) override
+    {
+        if (!enabled.load()) {
+            return;
+        }
+        QString host = info.requestUrl().host().toLower();
+        if (isBlockedHost(host)) {
+            info.block(true);
+            blocked.fetch_add(1);
+        }
+    }
+
+    std::atomic<bool> enabled{true};
+    std::atomic<int> blocked{0};
+};
+
+SdrWebProfile::SdrWebProfile(QObject* parent)
+    : QObject(parent)
+    , m_profile(new QWebEngineProfile(STORAGE_NAME, this))
+    , m_filter(new SdrRequestFilter(this))
+{
+    m_profile->setHttpCacheType(QWebEngineProfile::DiskHttpCache);
+    m_profile->setPersistentCookiesPolicy(QWebEngineProfile::ForcePersistentCookies);
+    m_profile->setUrlRequestInterceptor(m_filter);
+    setCacheSizeMB(DEFAULT_CACHE_MB);
+
+    qDebug() << "SdrWebProfile: Cache in" << m_profile->cachePath()
+             << "- storage in" << m_profile->persistentStoragePath();
+}
+
+SdrWebProfile::~SdrWebProfile()
+{
+    m_profile->setUrlRequestInterceptor(nullptr);
+    qDebug() << "SdrWebProfile: Blocked" << m_filter->blocked.load() << "requests this session";
+}
+
+void SdrWebProfile::setCacheSizeMB(int megabytes)
+{
+    // The limit is an int in bytes
+    m_profile->setHttpCacheMaximumSize(qBound(0, megabytes, 2047) * 1024 * 1024);
+}
+
+void SdrWebProfile::setBlockTrackers(bool enabled)
+{
+    m_filter->enabled.store(enabled);
+}
+
+bool SdrWebProfile::blockTrackers() const
+{
+    return m_filter->enabled.load();
+}
+
+int SdrWebProfile::blockedCount() const
+{
+    return m_filter->blocked.load();
+}
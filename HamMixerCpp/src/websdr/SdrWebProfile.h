@@ -0,0 +1,67 @@
+/*
+ * SdrWebProfile.h
+ *
+ * Shared, disk-backed browser profile for all SDR pages
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef SDRWEBPROFILE_H
+#define SDRWEBPROFILE_H
+
+#include <QObject>
+
+class QWebEngineProfile;
+class SdrRequestFilter;
+
+/**
+ * @brief One QWebEngineProfile for every SDR page HamMixer opens
+ *
+ * Without it, each controller's view uses Qt's default profile, which is
+ * off-the-record: its HTTP cache lives in memory and goes with the page,
+ * so every site switch downloads the SDR's scripts, images and waterfall
+ * colour maps again, and a KiwiSDR password is asked for on every visit.
+ *
+ * This profile is stored on disk under STORAGE_NAME, with:
+ * - a disk HTTP cache (size set by setCacheSizeMB())
+ * - persistent cookies, so protected KiwiSDR sites remember their login
+ * - a request filter that drops the visitor counters, maps and analytics
+ *   many SDR pages embed (never displayed by us, often the slowest part of
+ *   the load)
+ *
+ * Pages must be deleted before the profile (WebSdrManager does so).
+ */
+class SdrWebProfile : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr const char* STORAGE_NAME = "HamMixerSDR";
+    static constexpr int DEFAULT_CACHE_MB = 256;
+
+    explicit SdrWebProfile(QObject* parent = nullptr);
+    ~SdrWebProfile();
+
+    QWebEngineProfile* profile() const { return m_profile; }
+
+    /**
+     * @brief HTTP disk cache limit (0 lets Chromium choose)
+     */
+    void setCacheSizeMB(int megabytes);
+
+    /**
+     * @brief Drop requests to known trackers and page widgets
+     */
+    void setBlockTrackers(bool enabled);
+    bool blockTrackers() const;
+
+    /**
+     * @brief Requests dropped by the filter since start
+     */
+    int blockedCount() const;
+
+private:
+    QWebEngineProfile* m_profile;
+    SdrRequestFilter* m_filter;
+};
+
+#endif // SDRWEBPROFILE_H
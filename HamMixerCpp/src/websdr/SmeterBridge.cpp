@@ -0,0 +1,99 @@
+/*
+ * SmeterBridge.cpp
+ *
+ * Page-to-application S-meter push over QWebChannel
+ * Part of HamMixer CT7BAC
+ */
+
+#include "SmeterBridge.h"
+#include <QWebEnginePage>
+#include <QWebEngineScript>
+#include <QWebEngineScriptCollection>
+#include <QWebChannel>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QFile>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+// Connects to the channel once per document and hands push() to the hook
+const char* kBridgeScript = R"(
+(function() {
+    if (window.__hammixerSmeter || typeof QWebChannel === 'undefined'
+        || typeof qt === 'undefined' || !qt.webChannelTransport) {
+        return;
+    }
+    window.__hammixerSmeter = true;
+
+    new QWebChannel(qt.webChannelTransport, function(channel) {
+        // Only one client per transport: share it with the other page scripts
+        window.__hammixerChannel = channel;
+        window.dispatchEvent(new Event('hammixerchannel'));
+
+        var bridge = channel.objects.hammixer;
+        var last = null;
+
+        function push(value) {
+            if (typeof value !== 'number' || !isFinite(value)) return;
+            value = Math.round(value);
+            if (value === last) return;
+            last = value;
+            bridge.report(value, performance.timeOrigin + performance.now());
+        }
+
+        try {
+            %HOOK%
+        } catch (e) {
+            console.log('HamMixer: S-meter hook error: ' + e.message);
+        }
+    });
+})();
+)";
+
+} // namespace
+
+SmeterBridge::SmeterBridge(QWebEnginePage* page, const QString& hookScript, QObject* parent)
+    : QObject(parent)
+    , m_channel(new QWebChannel(this))
+{
+    m_channel->registerObject(OBJECT_NAME, this);
+
+    // The page's globals (soundapplet, smeter_dBm...) are only visible from
+    // the main world, so the channel and script live there
+    page->setWebChannel(m_channel, QWebEngineScript::MainWorld);
+
+    QFile channelJs(":/qtwebchannel/qwebchannel.js");
+    if (!channelJs.open(QIODevice::ReadOnly)) {
+        qWarning() << "SmeterBridge: qwebchannel.js not available, S-meter disabled";
+        return;
+    }
+
+    QString source = QString::fromUtf8(channelJs.readAll());
+    source += QString::fromLatin1(kBridgeScript).replace("%HOOK%", hookScript);
+
+    QWebEngineScript script;
+    script.setName("hammixer-smeter");
+    script.setSourceCode(source);
+    script.setInjectionPoint(QWebEngineScript::DocumentReady);
+    script.setWorldId(QWebEngineScript::MainWorld);
+    script.setRunsOnSubFrames(false);
+    page->scripts().insert(script);
+}
+
+SmeterBridge::~SmeterBridge()
+{
+    m_channel->deregisterObject(this);
+}
+
+void SmeterBridge::report(double value, double pageTimeMs)
+{
+    // Rebase the page timestamp onto the monotonic clock through its age
+    qint64 ageMs = QDateTime::currentMSecsSinceEpoch() - static_cast<qint64>(pageTimeMs);
+    ageMs = std::clamp<qint64>(ageMs, 0, MAX_AGE_MS);
+
+    QElapsedTimer now;
+    now.start();
+    emit sampled(value, now.msecsSinceReference() - ageMs);
+}
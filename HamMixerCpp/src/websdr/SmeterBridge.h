@@ -0,0 +1,70 @@
+/*
+ * SmeterBridge.h
+ *
+ * Page-to-application S-meter push over QWebChannel
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef SMETERBRIDGE_H
+#define SMETERBRIDGE_H
+
+#include <QObject>
+#include <QString>
+
+class QWebEnginePage;
+class QWebChannel;
+
+/**
+ * @brief Receives S-meter readings pushed by a script living in the SDR page
+ *
+ * Replaces polling the page with runJavaScript(), which costs a script
+ * compile, a renderer IPC round trip and a QVariant per reading. A
+ * persistent script is injected into every document the page loads; it
+ * hooks the SDR's own S-meter path (supplied per site type as hookScript)
+ * and calls push(value) in the page. push() forwards only changed values,
+ * stamped with the page's clock, over a QWebChannel to report().
+ *
+ * The hook script runs inside the channel callback with push() in scope.
+ */
+class SmeterBridge : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param page Page to inject into (scripts apply from its next load)
+     * @param hookScript Page-side JavaScript that calls push(value)
+     * @param parent QObject parent
+     */
+    SmeterBridge(QWebEnginePage* page, const QString& hookScript, QObject* parent = nullptr);
+    ~SmeterBridge();
+
+    /**
+     * @brief Page-side entry point (called through the web channel)
+     * @param value Reading in the SDR's own units
+     * @param pageTimeMs Page clock (ms since epoch) when the reading was taken
+     */
+    Q_INVOKABLE void report(double value, double pageTimeMs);
+
+    /**
+     * @brief The page's web channel, for other objects to register on
+     *
+     * The page-side client is published as window.__hammixerChannel, with a
+     * 'hammixerchannel' event on window once it is connected.
+     */
+    QWebChannel* channel() const { return m_channel; }
+
+signals:
+    /**
+     * @brief A reading, timestamped on the monotonic clock of RadioController::monotonicMs()
+     */
+    void sampled(double value, qint64 sampledMs);
+
+private:
+    QWebChannel* m_channel;
+
+    static constexpr const char* OBJECT_NAME = "hammixer";
+    static constexpr qint64 MAX_AGE_MS = 2000;  // Clamp for clock steps between the two sides
+};
+
+#endif // SMETERBRIDGE_H
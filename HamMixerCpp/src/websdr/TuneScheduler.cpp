@@ -0,0 +1,159 @@
+/*
+ * TuneScheduler.cpp
+ *
+ * Coalescing, rate-limited frequency/mode pipeline from the radio to the SDR
+ * Part of HamMixer CT7BAC
+ */
+
+#include "TuneScheduler.h"
+#include <QPointer>
+#include <QDebug>
+#include <algorithm>
+
+TuneScheduler::TuneScheduler(Dispatch dispatch, int minGapMs, int timeoutMs, QObject* parent)
+    : QObject(parent)
+    , m_dispatch(std::move(dispatch))
+    , m_minGapMs(std::max(0, minGapMs))
+    , m_timeoutMs(std::max(1, timeoutMs))
+    , m_gapTimer(this)
+    , m_timeoutTimer(this)
+{
+    m_gapTimer.setSingleShot(true);
+    m_gapTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_gapTimer, &QTimer::timeout, this, &TuneScheduler::pump);
+
+    m_timeoutTimer.setSingleShot(true);
+    connect(&m_timeoutTimer, &QTimer::timeout, this, &TuneScheduler::onTimeout);
+    m_clock.start();
+}
+
+void TuneScheduler::requestFrequency(uint64_t frequencyHz)
+{
+    m_stats.requests++;
+    if (frequencyHz == m_targetHz) {
+        m_stats.skipped++;
+        return;
+    }
+
+    // An earlier frequency that never went out is overtaken
+    if (m_targetHz != m_sentHz) {
+        m_stats.coalesced++;
+    }
+    m_targetHz = frequencyHz;
+    request();
+}
+
+void TuneScheduler::requestMode(const QString& mode)
+{
+    m_stats.requests++;
+    QString normalized = mode.toLower();
+    if (normalized.isEmpty() || normalized == m_targetMode) {
+        m_stats.skipped++;
+        return;
+    }
+
+    if (m_targetMode != m_sentMode) {
+        m_stats.coalesced++;
+    }
+    m_targetMode = normalized;
+    request();
+}
+
+void TuneScheduler::request()
+{
+    m_targetAtMs = m_clock.elapsed();
+    pump();
+}
+
+void TuneScheduler::reset()
+{
+    // The new SDR's state is unknown: the next send carries everything
+    m_inFlight = false;
+    m_generation++;
+    m_sentHz = 0;
+    m_sentMode.clear();
+    m_lastSendMs = -1;
+    m_gapTimer.stop();
+    m_timeoutTimer.stop();
+}
+
+void TuneScheduler::logStatistics(const char* owner) const
+{
+    qDebug().nospace() << owner << ": tune requests " << m_stats.requests
+                       << ", sent " << m_stats.sent << ", coalesced " << m_stats.coalesced
+                       << ", skipped " << m_stats.skipped << ", timeouts " << m_stats.timeouts
+                       << ", latency mean " << m_stats.meanLatencyMs << " ms, max "
+                       << m_stats.maxLatencyMs << " ms";
+}
+
+void TuneScheduler::pump()
+{
+    if (m_inFlight) {
+        return;  // onApplied() or onTimeout() comes back here
+    }
+
+    bool frequencyChanged = m_targetHz != m_sentHz;
+    bool modeChanged = m_targetMode != m_sentMode;
+    if (!frequencyChanged && !modeChanged) {
+        return;
+    }
+
+    qint64 now = m_clock.elapsed();
+    if (m_lastSendMs >= 0 && now - m_lastSendMs < m_minGapMs) {
+        if (!m_gapTimer.isActive()) {
+            m_gapTimer.start(static_cast<int>(m_lastSendMs + m_minGapMs - now));
+        }
+        return;
+    }
+
+    m_sentHz = m_targetHz;
+    m_sentMode = m_targetMode;
+    m_lastSendMs = now;
+    m_stats.sent++;
+
+    // In flight before dispatching: done() may run straight away
+    m_inFlight = true;
+    uint64_t generation = ++m_generation;
+    m_inFlightRequestedAtMs = m_targetAtMs;
+    m_timeoutTimer.start(m_timeoutMs);
+
+    QPointer<TuneScheduler> self(this);
+    m_dispatch(m_sentHz, m_sentMode, frequencyChanged, modeChanged, [self, generation]() {
+        if (self) {
+            self->onApplied(generation);
+        }
+    });
+}
+
+void TuneScheduler::onApplied(uint64_t generation)
+{
+    // Late acknowledgements from before a reset() or timeout are ignored
+    if (!m_inFlight || generation != m_generation) {
+        return;
+    }
+
+    m_inFlight = false;
+    m_timeoutTimer.stop();
+    recordLatency(m_clock.elapsed() - m_inFlightRequestedAtMs);
+    pump();
+}
+
+void TuneScheduler::onTimeout()
+{
+    if (!m_inFlight) {
+        return;
+    }
+
+    m_inFlight = false;
+    m_stats.timeouts++;
+    qWarning() << "TuneScheduler: SDR did not acknowledge tune to" << m_sentHz << "Hz";
+    pump();
+}
+
+void TuneScheduler::recordLatency(qint64 latencyMs)
+{
+    m_stats.acknowledged++;
+    m_stats.lastLatencyMs = latencyMs;
+    m_stats.meanLatencyMs += (latencyMs - m_stats.meanLatencyMs) / m_stats.acknowledged;
+    m_stats.maxLatencyMs = std::max(m_stats.maxLatencyMs, latencyMs);
+}
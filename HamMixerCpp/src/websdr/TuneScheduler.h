@@ -0,0 +1,121 @@
+/*
+ * TuneScheduler.h
+ *
+ * Coalescing, rate-limited frequency/mode pipeline from the radio to the SDR
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef TUNESCHEDULER_H
+#define TUNESCHEDULER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief Forwards the latest radio frequency/mode to the SDR at a rate it can absorb
+ *
+ * Every radio frequency report used to become its own runJavaScript() call,
+ * so spinning the dial queued dozens of scripts in the renderer and the SDR
+ * trailed the dial. The scheduler keeps only the latest requested target:
+ *
+ * - leading edge: a request after a quiet period is sent at once
+ * - one tune in flight: the next is sent when the SDR has taken the last
+ *   one (its script returned), or after the timeout
+ * - at least minGapMs between sends; requests in between overwrite each
+ *   other and the last one goes out when the gap ends (trailing edge)
+ * - requests for what the SDR already has are dropped
+ *
+ * End-to-end latency is measured from the request of the value that was
+ * sent to the SDR's acknowledgement.
+ */
+class TuneScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t sent = 0;
+        uint64_t acknowledged = 0;
+        uint64_t coalesced = 0;   // Overtaken by a newer request before being sent
+        uint64_t skipped = 0;     // Asked for what the SDR already had
+        uint64_t timeouts = 0;    // Never acknowledged
+        qint64 lastLatencyMs = 0;
+        double meanLatencyMs = 0.0;
+        qint64 maxLatencyMs = 0;
+    };
+
+    /**
+     * @brief Applies a tune; must call done() once the SDR has taken it
+     * (straight away if nothing is sent). Only the changed parts are flagged.
+     */
+    using Dispatch = std::function<void(uint64_t frequencyHz, const QString& mode,
+                                        bool frequencyChanged, bool modeChanged,
+                                        std::function<void()> done)>;
+
+    /**
+     * @param dispatch Sends a tune to the SDR
+     * @param minGapMs Minimum time between two sends
+     * @param timeoutMs Acknowledgement timeout
+     */
+    TuneScheduler(Dispatch dispatch, int minGapMs, int timeoutMs, QObject* parent = nullptr);
+
+    void requestFrequency(uint64_t frequencyHz);
+    void requestMode(const QString& mode);
+
+    /**
+     * @brief Change the send gap (per site type)
+     */
+    void setMinGap(int minGapMs) { m_minGapMs = minGapMs; }
+
+    /**
+     * @brief Forget what the SDR has and any tune in flight (site changed)
+     */
+    void reset();
+
+    const Stats& statistics() const { return m_stats; }
+    void resetStatistics() { m_stats = Stats(); }
+
+    /**
+     * @brief Write a one-line summary to the debug log
+     */
+    void logStatistics(const char* owner) const;
+
+private slots:
+    void pump();
+    void onTimeout();
+
+private:
+    void request();
+    void onApplied(uint64_t generation);
+    void recordLatency(qint64 latencyMs);
+
+    Dispatch m_dispatch;
+    int m_minGapMs;
+    int m_timeoutMs;
+
+    // Latest target and what was last sent
+    uint64_t m_targetHz = 0;
+    QString m_targetMode;
+    uint64_t m_sentHz = 0;
+    QString m_sentMode;
+    qint64 m_targetAtMs = 0;    // When the target was last changed
+    int m_waiting = 0;          // Requests folded into the current target
+
+    // Tune in flight
+    bool m_inFlight = false;
+    uint64_t m_generation = 0;
+    qint64 m_inFlightRequestedAtMs = 0;
+
+    QTimer m_gapTimer;
+    QTimer m_timeoutTimer;
+    QElapsedTimer m_clock;
+    qint64 m_lastSendMs = -1;
+    Stats m_stats;
+};
+
+#endif // TUNESCHEDULER_H
@@ -6,6 +6,8 @@
  */
 
 #include "WebSdrController.h"
+#include "SmeterBridge.h"
+#include "PageThrottle.h"
 #include "HamMixer/Version.h"
 #include <QDebug>
 #include <QUrl>
@@ -17,8 +19,44 @@
 #include <QIcon>
 #include <cmath>
 
-WebSdrController::WebSdrController(QWidget* parentWidget, QObject* parent)
-    : QObject(parent)
+namespace {
+
+// Page-side S-meter hook (runs with push() in scope, see SmeterBridge).
+// Wrapping soundapplet.smeter() catches the page's own meter redraws; the
+// in-page sampler covers layouts without a meter. Only changes leave the page.
+// Note: some sites have soundapplet defined but null.
+const char* kSmeterHook = R"(
+    function hook() {
+        if (typeof soundapplet === 'undefined' || soundapplet === null
+            || typeof soundapplet.smeter !== 'function') {
+            return false;
+        }
+        if (!soundapplet.smeter.__hammixer) {
+            var original = soundapplet.smeter;
+            var wrapped = function() {
+                var s = original.apply(this, arguments);
+                push(s + (typeof scale4wf !== 'undefined' ? scale4wf : 0));
+                return s;
+            };
+            wrapped.__hammixer = true;
+            soundapplet.smeter = wrapped;
+        }
+        return true;
+    }
+    setInterval(function() {
+        try { if (hook()) soundapplet.smeter(); } catch (e) {}
+    }, 50);
+)";
+
+// Audio-only hooks: WebSDR has no call to pause its waterfall stream, so
+// the canvas gate in PageThrottle does all the work
+const char* kSuspendHook = "";
+const char* kResumeHook = "";
+
+} // namespace
+
+WebSdrController::WebSdrController(QWebEngineProfile* profile, QWidget* parentWidget, QObject* parent)
+    : SdrController(parent)
     , m_browserWindow(nullptr)
     , m_webView(nullptr)
     , m_state(Unloaded)
@@ -26,8 +64,16 @@ WebSdrController::WebSdrController(QWidget* parentWidget, QObject* parent)
     , m_embedded(parentWidget != nullptr)
     , m_pendingFrequencyHz(0)
     , m_hasPendingTune(false)
-    , m_smeterTimer(nullptr)
+    , m_smeterBridge(nullptr)
+    , m_smeterActive(false)
     , m_lastSmeterValue(-1)
+    , m_pageThrottle(nullptr)
+    , m_audioTap(nullptr)
+    , m_pageAudioRequested(false)
+    , m_audioOnlyRequested(false)
+    , m_standby(false)
+    , m_pageReady(false)
+    , m_pageLoadMs(-1)
 {
     if (m_embedded) {
         // Embedded mode: create web view and add to parent's layout
@@ -61,6 +107,11 @@ WebSdrController::WebSdrController(QWidget* parentWidget, QObject* parent)
         qDebug() << "WebSdrController: Created with separate window";
     }
 
+    // Shared profile: disk cache and cookies survive site switches
+    if (profile) {
+        m_webView->setPage(new QWebEnginePage(profile, m_webView));
+    }
+
     // Configure web engine settings to allow autoplay without user gesture
     QWebEngineSettings* settings = m_webView->page()->settings();
     settings->setAttribute(QWebEngineSettings::PlaybackRequiresUserGesture, false);
@@ -69,6 +120,19 @@ WebSdrController::WebSdrController(QWidget* parentWidget, QObject* parent)
     settings->setAttribute(QWebEngineSettings::LocalContentCanAccessRemoteUrls, true);
     qDebug() << "WebSdrController: Configured WebEngine to allow autoplay";
 
+    // S-meter readings are pushed by a script in the page
+    m_smeterBridge = new SmeterBridge(m_webView->page(), kSmeterHook, this);
+    QObject::connect(m_smeterBridge, &SmeterBridge::sampled,
+                     this, &WebSdrController::onSmeterSampled);
+
+    // Rendering can be suspended while the browser is hidden
+    m_pageThrottle = new PageThrottle(m_webView->page(), kSuspendHook, kResumeHook, this);
+
+    // Page audio can be taken before the sound card, over the S-meter's channel
+    m_audioTap = new PageAudioTap(m_webView->page(), m_smeterBridge->channel(), this);
+    QObject::connect(m_audioTap, &PageAudioTap::deliveringChanged,
+                     this, &SdrController::sinkAudioChanged);
+
     // Connect signals
     QObject::connect(m_webView, &QWebEngineView::loadStarted,
                      this, &WebSdrController::onLoadStarted);
@@ -93,7 +157,7 @@ bool WebSdrController::eventFilter(QObject* obj, QEvent* event)
 
 WebSdrController::~WebSdrController()
 {
-    stopSmeterPolling();
+    stopSmeterUpdates();
     unload();
 
     if (m_embedded) {
@@ -114,6 +178,19 @@ WebSdrController::~WebSdrController()
     }
 }
 
+SdrController::Capabilities WebSdrController::capabilities() const
+{
+    return SmeterPush | BrowserPage | PageAudio;
+}
+
+void WebSdrController::warmUp()
+{
+    // Load blank page to trigger Chromium initialization
+    if (m_webView) {
+        m_webView->load(QUrl("about:blank"));
+    }
+}
+
 void WebSdrController::showWindow()
 {
     if (m_embedded) {
@@ -181,8 +258,10 @@ void WebSdrController::loadSite(const WebSdrSite& site)
     qDebug() << "WebSdrController: Loading site" << site.name << "from" << site.url;
     setState(Loading);
 
-    // Show the window/view and load the site
-    showWindow();
+    // Show the window/view (unless kept in standby) and load the site
+    if (!m_standby) {
+        showWindow();
+    }
     m_webView->load(QUrl(site.url));
 }
 
@@ -190,7 +269,7 @@ void WebSdrController::unload()
 {
     if (m_state != Unloaded) {
         // Stop S-meter polling first
-        stopSmeterPolling();
+        stopSmeterUpdates();
 
         // Stop audio before unloading
         if (m_webView && m_webView->page()) {
@@ -217,6 +296,7 @@ void WebSdrController::unload()
         }
 
         m_currentSite = WebSdrSite();
+        m_pageReady = false;
         m_audioStarted = false;
         m_hasPendingTune = false;
         m_lastSmeterValue = -1;
@@ -233,12 +313,13 @@ void WebSdrController::reload()
     }
 }
 
-void WebSdrController::setFrequency(uint64_t frequencyHz)
+void WebSdrController::setFrequency(uint64_t frequencyHz, std::function<void()> applied)
 {
     if (m_state != Ready) {
         // Store for when page is ready
         m_pendingFrequencyHz = frequencyHz;
         m_hasPendingTune = true;
+        if (applied) applied();
         return;
     }
 
@@ -249,17 +330,20 @@ void WebSdrController::setFrequency(uint64_t frequencyHz)
     freqKHz = std::round(freqKHz * 100.0) / 100.0;
 
     // setfreqif() automatically switches to the correct band
-    QString script = QString("setfreqif(%1);").arg(freqKHz, 0, 'f', 2);
-    runJavaScript(script);
+    QString script = QString("try { setfreqif(%1); } catch(e) { console.log('HamMixer JS error: ' + e.message); }").arg(freqKHz, 0, 'f', 2);
+    runJavaScript(script, [applied](const QVariant&) {
+        if (applied) applied();
+    });
 
     qDebug() << "WebSdrController: Set frequency to" << freqKHz << "kHz";
 }
 
-void WebSdrController::setMode(const QString& mode)
+void WebSdrController::setMode(const QString& mode, std::function<void()> applied)
 {
     if (m_state != Ready) {
         m_pendingMode = mode;
         m_hasPendingTune = true;
+        if (applied) applied();
         return;
     }
 
@@ -274,10 +358,14 @@ void WebSdrController::setMode(const QString& mode)
     }
 
     QString script = QString(
-        "if (typeof set_mode === 'function') {"
-        "  set_mode('%1');"
-        "}").arg(normalizedMode);
-    runJavaScript(script);
+        "try {"
+        "  if (typeof set_mode === 'function') {"
+        "    set_mode('%1');"
+        "  }"
+        "} catch(e) { console.log('HamMixer JS error: ' + e.message); }").arg(normalizedMode);
+    runJavaScript(script, [applied](const QVariant&) {
+        if (applied) applied();
+    });
 
     qDebug() << "WebSdrController: Set mode to" << normalizedMode;
 }
@@ -372,22 +460,26 @@ void WebSdrController::stopAudio()
     qDebug() << "WebSdrController: Stopped audio";
 }
 
-void WebSdrController::tune(uint64_t frequencyHz, const QString& mode)
+void WebSdrController::tune(uint64_t frequencyHz, const QString& mode, std::function<void()> applied)
 {
     if (m_state != Ready) {
         m_pendingFrequencyHz = frequencyHz;
         m_pendingMode = mode;
         m_hasPendingTune = true;
+        if (applied) applied();
         return;
     }
 
     // Set mode first, then frequency
     setMode(mode);
-    setFrequency(frequencyHz);
+    setFrequency(frequencyHz, std::move(applied));
 }
 
 void WebSdrController::onLoadStarted()
 {
+    m_pageReady = false;
+    m_pageLoadMs = -1;
+    m_loadClock.start();
     setState(Loading);
     emit loadProgress(0);
 }
@@ -491,11 +583,21 @@ void WebSdrController::initializeWebSdr()
                         m_webView->page()->runJavaScript(confirmScript);
                     }
 
-                    // Start S-meter polling
-                    startSmeterPolling(100);
+                    // Forward S-meter readings from the page
+                    startSmeterUpdates();
 
-                    // Finally emit pageReady - site is fully configured
-                    emit pageReady();
+                    // Re-run the audio-only hook against the fresh page
+                    m_pageThrottle->reapply();
+
+                    // A page that finished loading in standby has no meaningful time
+                    if (!m_standby) {
+                        m_pageLoadMs = m_loadClock.elapsed();
+                        qDebug() << "WebSdrController: Page ready in" << m_pageLoadMs << "ms" << m_currentSite.name;
+                    }
+
+                    // Finally emit ready - site is fully configured
+                    m_pageReady = true;
+                    emit ready();
                     qDebug() << "WebSdrController: Initialization complete - page ready";
                 });
             });
@@ -546,54 +648,80 @@ void WebSdrController::runJavaScript(const QString& script,
     m_webView->page()->runJavaScript(script, callback);
 }
 
-void WebSdrController::startSmeterPolling(int intervalMs)
+void WebSdrController::startSmeterUpdates()
+{
+    m_smeterActive = true;
+    qDebug() << "WebSdrController: S-meter updates started";
+}
+
+void WebSdrController::stopSmeterUpdates()
 {
-    if (!m_smeterTimer) {
-        m_smeterTimer = new QTimer(this);
-        connect(m_smeterTimer, &QTimer::timeout, this, &WebSdrController::pollSmeter);
+    if (m_smeterActive) {
+        m_smeterActive = false;
+        m_lastSmeterValue = -1;
+        qDebug() << "WebSdrController: S-meter updates stopped";
     }
+}
 
-    m_smeterTimer->start(intervalMs);
-    qDebug() << "WebSdrController: Started S-meter polling at" << intervalMs << "ms";
+void WebSdrController::setAudioOnly(bool enabled)
+{
+    m_audioOnlyRequested = enabled;
+    m_pageThrottle->setAudioOnly(m_audioOnlyRequested || m_standby);
 }
 
-void WebSdrController::stopSmeterPolling()
+void WebSdrController::setStandby(bool standby)
 {
-    if (m_smeterTimer) {
-        m_smeterTimer->stop();
-        qDebug() << "WebSdrController: Stopped S-meter polling";
+    if (m_standby == standby) {
+        return;
+    }
+    m_standby = standby;
+    m_pageLoadMs = -1;
+
+    // Show before lifting the throttle so the page knows it is visible again
+    if (standby) {
+        hideWindow();
+    } else {
+        showWindow();
     }
+
+    // Muted in Chromium, so the page's own volume setup stays untouched
+    m_webView->page()->setAudioMuted(standby);
+    m_pageThrottle->setAudioOnly(m_audioOnlyRequested || standby);
+    m_audioTap->setEnabled(m_pageAudioRequested && !standby);
+
+    qDebug() << "WebSdrController:" << (standby ? "In standby" : "Live") << m_currentSite.name;
 }
 
-void WebSdrController::pollSmeter()
+bool WebSdrController::isAudioOnly() const
 {
-    if (m_state != Ready) {
+    return m_pageThrottle->isAudioOnly();
+}
+
+void WebSdrController::setAudioSink(AudioSink sink)
+{
+    m_audioTap->setAudioSink(std::move(sink));
+}
+
+void WebSdrController::setPageAudioCapture(bool enabled)
+{
+    m_pageAudioRequested = enabled;
+    m_audioTap->setEnabled(m_pageAudioRequested && !m_standby);
+}
+
+bool WebSdrController::isPageAudioDelivering() const
+{
+    return m_audioTap->isDelivering();
+}
+
+void WebSdrController::onSmeterSampled(double value, qint64 sampledMs)
+{
+    if (m_state != Ready || !m_smeterActive) {
         return;
     }
 
-    // JavaScript to read the WebSDR S-meter value
-    // Note: Some sites (e.g., Bordeaux) have soundapplet defined but null
-    QString script =
-        "(function() {"
-        "  try {"
-        "    if (typeof soundapplet !== 'undefined' && soundapplet !== null && typeof soundapplet.smeter === 'function') {"
-        "      var s = soundapplet.smeter();"
-        "      if (typeof scale4wf !== 'undefined') {"
-        "        s = s + scale4wf;"
-        "      }"
-        "      return s;"
-        "    }"
-        "  } catch(e) {}"
-        "  return -1;"
-        "})();";
-
-    runJavaScript(script, [this](const QVariant& result) {
-        if (result.isValid()) {
-            int value = result.toInt();
-            if (value >= 0 && value != m_lastSmeterValue) {
-                m_lastSmeterValue = value;
-                emit smeterChanged(value);
-            }
-        }
-    });
+    int smeter = static_cast<int>(value);
+    if (smeter >= 0 && smeter != m_lastSmeterValue) {
+        m_lastSmeterValue = smeter;
+        emit smeterChanged(smeter, sampledMs);
+    }
 }
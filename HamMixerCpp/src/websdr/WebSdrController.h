@@ -13,73 +13,87 @@
 #include <QWebEngineView>
 #include <QWebEnginePage>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QString>
 #include <functional>
 #include <cstdint>
 
-#include "WebSdrSite.h"
+#include "SdrController.h"
+#include "PageAudioTap.h"
 
-class WebSdrController : public QObject
+class QWebEngineProfile;
+class SmeterBridge;
+class PageThrottle;
+
+class WebSdrController : public SdrController
 {
     Q_OBJECT
 
 public:
-    enum State {
-        Unloaded,
-        Loading,
-        Ready,
-        Error
-    };
-    Q_ENUM(State)
+    WebSdrController(QWebEngineProfile* profile, QWidget* parentWidget = nullptr, QObject* parent = nullptr);
+    ~WebSdrController() override;
 
-    explicit WebSdrController(QWidget* parentWidget = nullptr, QObject* parent = nullptr);
-    ~WebSdrController();
+    Capabilities capabilities() const override;
 
     // Get the web view widget for embedding in another window
     QWebEngineView* webView() const { return m_webView; }
 
     // Show/hide the browser window (only when using separate window mode)
-    void showWindow();
-    void hideWindow();
+    void showWindow() override;
+    void hideWindow() override;
     bool isWindowVisible() const;
+    void warmUp() override;
 
     // Check if using embedded mode
     bool isEmbedded() const { return m_embedded; }
 
     // Load/unload site
-    void loadSite(const WebSdrSite& site);
-    void unload();
+    void loadSite(const WebSdrSite& site) override;
+    void unload() override;
     void reload();
 
     // State
-    State state() const { return m_state; }
-    bool isReady() const { return m_state == Ready; }
-    const WebSdrSite& currentSite() const { return m_currentSite; }
+    State state() const override { return m_state; }
+    bool isPageReady() const override { return m_pageReady; }  // Initialization sequence finished
+    qint64 pageLoadMs() const override { return m_pageLoadMs; }
+    const WebSdrSite& currentSite() const override { return m_currentSite; }
 
     // Control methods (via JavaScript injection)
     // Frequency in Hz, will be converted to kHz for WebSDR
-    void setFrequency(uint64_t frequencyHz);
+    // applied (optional) runs once the page has executed the change, or
+    // straight away if it was only stored for when the page is ready
+    void setFrequency(uint64_t frequencyHz, std::function<void()> applied = nullptr) override;
 
     // Mode: "lsb", "usb", "cw", "am", "fm"
-    void setMode(const QString& mode);
+    void setMode(const QString& mode, std::function<void()> applied = nullptr) override;
 
     // Audio control
     void startAudio();
     void stopAudio();
 
     // Combined set frequency and mode
-    void tune(uint64_t frequencyHz, const QString& mode);
+    void tune(uint64_t frequencyHz, const QString& mode, std::function<void()> applied = nullptr) override;
+
+    // Start/stop forwarding S-meter readings pushed by the page
+    void startSmeterUpdates() override;
+    void stopSmeterUpdates() override;
+
+    // Audio-only mode: waterfall/spectrum rendering suspended (see PageThrottle)
+    void setAudioOnly(bool enabled) override;
+    bool isAudioOnly() const;
 
-    // Start/stop S-meter polling
-    void startSmeterPolling(int intervalMs = 100);
-    void stopSmeterPolling();
+    // Warm standby: loaded and tuned, but hidden, muted and not rendering
+    void setStandby(bool standby) override;
+    bool isStandby() const override { return m_standby; }
+
+    // Page audio capture: the page's WebAudio output goes to the sink
+    // instead of the sound card (see PageAudioTap); not while in standby
+    void setAudioSink(AudioSink sink) override;
+    void setPageAudioCapture(bool enabled) override;
+    bool isPageAudioDelivering() const;
 
 signals:
-    void stateChanged(WebSdrController::State state);
     void loadProgress(int percent);
-    void pageReady();
-    void errorOccurred(const QString& error);
-    void smeterChanged(int value);  // WebSDR S-meter value (raw units)
 
 protected:
     // Event filter to handle window close
@@ -89,7 +103,7 @@ private slots:
     void onLoadStarted();
     void onLoadProgress(int progress);
     void onLoadFinished(bool ok);
-    void pollSmeter();
+    void onSmeterSampled(double value, qint64 sampledMs);
 
 private:
     void setState(State newState);
@@ -109,9 +123,19 @@ private:
     QString m_pendingMode;
     bool m_hasPendingTune;
 
-    // S-meter polling
-    QTimer* m_smeterTimer;
+    // S-meter, pushed from the page (see SmeterBridge)
+    SmeterBridge* m_smeterBridge;
+    bool m_smeterActive;
     int m_lastSmeterValue;
+
+    PageThrottle* m_pageThrottle;
+    PageAudioTap* m_audioTap;
+    bool m_pageAudioRequested;
+    bool m_audioOnlyRequested;
+    bool m_standby;
+    bool m_pageReady;
+    QElapsedTimer m_loadClock;     // Since the page load started
+    qint64 m_pageLoadMs;
 };
 
 #endif // WEBSDRCONTROLLER_H
@@ -1,7 +1,7 @@
 /*
  * WebSdrManager.cpp
  *
- * Manages SDR controllers (WebSDR 2.x and KiwiSDR) - only one site loaded at a time
+ * Manages the SDR receivers: one live site, warm standby pages and diversity streams
  * Part of HamMixer CT7BAC
  */
 
@@ -11,38 +11,71 @@
 WebSdrManager::WebSdrManager(QWidget* parentWidget, QObject* parent)
     : QObject(parent)
     , m_parentWidget(parentWidget)
-    , m_webSdrController(nullptr)
-    , m_kiwiSdrController(nullptr)
+    , m_controller(nullptr)
+    , m_kiwiNativeAudio(false)
+    , m_pageAudioCapture(false)
+    , m_sinkAudioActive(false)
+    , m_browserVisible(true)
     , m_activeSiteType(SdrSiteType::WebSDR)
     , m_lastFrequencyHz(0)
 {
+    m_tuneScheduler = new TuneScheduler(
+        [this](uint64_t frequencyHz, const QString& mode, bool frequencyChanged,
+               bool modeChanged, std::function<void()> done) {
+            dispatchTune(frequencyHz, mode, frequencyChanged, modeChanged, std::move(done));
+        },
+        TUNE_GAP_PAGE_MS, TUNE_TIMEOUT_MS, this);
+
+    m_webProfile = new SdrWebProfile(this);
+    SdrBackendRegistry::registerBuiltins(m_backends);
 }
 
 WebSdrManager::~WebSdrManager()
 {
     unloadCurrent();
+
+    // Pages have to go before the profile they use, including controllers
+    // still waiting for deleteLater()
+    for (SdrController* controller : findChildren<SdrController*>(QString(), Qt::FindDirectChildrenOnly)) {
+        delete controller;
+    }
+}
+
+void WebSdrManager::setKiwiNativeAudio(bool enabled)
+{
+    m_kiwiNativeAudio = enabled;
+
+    // Native KiwiSDR sites connect in well under a second; no standby page
+    refreshStandby();
 }
 
 void WebSdrManager::setSiteList(const QList<WebSdrSite>& sites)
 {
     m_sites = sites;
     qDebug() << "WebSdrManager: Site list set with" << sites.size() << "sites";
+
+    // The active site's options may have been edited
+    applyAudioOnly();
+    refreshStandby();
+    refreshDiversity();
 }
 
 void WebSdrManager::preInitialize()
 {
-    // Pre-create the WebSDR controller to initialize Chromium engine at startup
+    // Pre-create a page controller to initialize Chromium engine at startup
     // This avoids the visual blink/glitch that occurs on first WebEngine use
-    if (!m_webSdrController && m_parentWidget) {
-        m_webSdrController = new WebSdrController(m_parentWidget, this);
-        connectWebSdrSignals();
+    if (!m_parentWidget) return;
 
-        // Load blank page to trigger Chromium initialization
-        if (m_webSdrController->webView()) {
-            m_webSdrController->webView()->load(QUrl("about:blank"));
-        }
+    for (const SdrBackend& backend : m_backends.backends()) {
+        if (!backend.keepWhenIdle || !backend.capabilities.testFlag(SdrController::BrowserPage)) continue;
+        if (m_idleControllers.contains(backend.name)) return;
+
+        SdrController* controller = backend.create(m_webProfile->profile(), m_parentWidget, this);
+        controller->warmUp();
+        m_idleControllers.insert(backend.name, controller);
 
         qDebug() << "WebSdrManager: Pre-initialized WebEngine";
+        return;
     }
 }
 
@@ -56,32 +89,69 @@ WebSdrSite WebSdrManager::findSite(const QString& siteId) const
     return WebSdrSite();  // Return invalid site if not found
 }
 
-void WebSdrManager::connectWebSdrSignals()
+
+SdrController::Capabilities WebSdrManager::wantedCapabilities() const
+{
+    // Types without a NativeAudio backend still get their page (see SdrBackendRegistry::find())
+    if (m_kiwiNativeAudio) {
+        return SdrController::NativeAudio;
+    }
+    return SdrController::Capabilities();
+}
+
+SdrController* WebSdrManager::acquireController(const SdrBackend& backend)
 {
-    if (!m_webSdrController) return;
+    // An idle instance avoids Chromium reinitialization
+    SdrController* controller = m_idleControllers.take(backend.name);
+    if (!controller) {
+        controller = backend.create(m_webProfile->profile(), m_parentWidget, this);
+    }
+    return controller;
+}
+
+void WebSdrManager::connectControllerSignals()
+{
+    if (!m_controller) return;
+
+    connect(m_controller, &SdrController::stateChanged,
+            this, &WebSdrManager::onControllerStateChanged);
+    connect(m_controller, &SdrController::smeterChanged,
+            this, &WebSdrManager::smeterChanged);
+    connect(m_controller, &SdrController::ready,
+            this, &WebSdrManager::onControllerReady);
+    connect(m_controller, &SdrController::errorOccurred,
+            this, &WebSdrManager::onControllerError);
+    connect(m_controller, &SdrController::sinkAudioChanged,
+            this, &WebSdrManager::onSinkAudioChanged);
+
+    m_controller->setAudioSink(m_audioSink);
+    m_controller->setPageAudioCapture(m_pageAudioCapture);
+}
 
-    connect(m_webSdrController, &WebSdrController::stateChanged,
-            this, &WebSdrManager::onWebSdrStateChanged);
-    connect(m_webSdrController, &WebSdrController::smeterChanged,
-            this, &WebSdrManager::onWebSdrSmeterChanged);
-    connect(m_webSdrController, &WebSdrController::pageReady,
-            this, &WebSdrManager::onWebSdrPageReady);
-    connect(m_webSdrController, &WebSdrController::errorOccurred,
-            this, &WebSdrManager::onWebSdrError);
+void WebSdrManager::setAudioSink(SdrController::AudioSink sink)
+{
+    m_audioSink = std::move(sink);
+    if (m_controller) {
+        m_controller->setAudioSink(m_audioSink);
+    }
 }
 
-void WebSdrManager::connectKiwiSdrSignals()
+void WebSdrManager::setPageAudioCapture(bool enabled)
 {
-    if (!m_kiwiSdrController) return;
+    m_pageAudioCapture = enabled;
+    if (m_controller) {
+        m_controller->setPageAudioCapture(enabled);
+    }
+}
 
-    connect(m_kiwiSdrController, &KiwiSdrController::stateChanged,
-            this, &WebSdrManager::onKiwiSdrStateChanged);
-    connect(m_kiwiSdrController, &KiwiSdrController::smeterChanged,
-            this, &WebSdrManager::onKiwiSdrSmeterChanged);
-    connect(m_kiwiSdrController, &KiwiSdrController::pageReady,
-            this, &WebSdrManager::onKiwiSdrPageReady);
-    connect(m_kiwiSdrController, &KiwiSdrController::errorOccurred,
-            this, &WebSdrManager::onKiwiSdrError);
+void WebSdrManager::onSinkAudioChanged(bool active)
+{
+    // Only report a change of source
+    if (active == m_sinkAudioActive) {
+        return;
+    }
+    m_sinkAudioActive = active;
+    emit nativeAudioChanged(active);
 }
 
 void WebSdrManager::loadSite(const QString& siteId)
@@ -101,250 +171,460 @@ void WebSdrManager::loadSite(const QString& siteId)
         return;
     }
 
+    SdrBackend backend = m_backends.find(site.type, wantedCapabilities());
+    if (!backend.isValid()) {
+        qWarning() << "WebSdrManager: No backend for site:" << siteId;
+        emit siteError(siteId, "No receiver backend for this site type");
+        return;
+    }
+
     qDebug() << "WebSdrManager: Loading site" << site.name << "(" << siteId << ")"
-             << "Type:" << (site.isKiwiSDR() ? "KiwiSDR" : "WebSDR");
+             << "Backend:" << backend.name;
 
-    // Unload the opposite controller type if active
-    if (site.isKiwiSDR()) {
-        // Loading KiwiSDR - unload WebSDR if active
-        unloadWebSdr();
-    } else {
-        // Loading WebSDR - unload KiwiSDR if active
-        unloadKiwiSdr();
+    // A warm standby page only has to be made live
+    if (promoteStandby(site)) {
+        emit activeSiteChanged(siteId);
+        refreshStandby();
+        refreshDiversity();
+        return;
+    }
+
+    // Keep a flagged live site warm rather than unloading it
+    if (findSite(m_activeSiteId).standby) {
+        parkActive();
+    }
+
+    // A controller of the same backend loads the new site in place
+    if (m_controller && m_backend.name != backend.name) {
+        unloadController();
     }
 
     // Store active site info
     m_activeSiteId = siteId;
     m_activeSiteType = site.type;
 
-    if (site.isKiwiSDR()) {
-        // Create KiwiSDR controller if needed
-        if (!m_kiwiSdrController) {
-            m_kiwiSdrController = new KiwiSdrController(m_parentWidget, this);
-            connectKiwiSdrSignals();
-        }
+    if (!m_controller) {
+        m_controller = acquireController(backend);
+        m_backend = backend;
+        connectControllerSignals();
+    }
+    resetTuning();
 
-        // Apply pending frequency/mode before loading
-        if (m_lastFrequencyHz > 0) {
-            m_kiwiSdrController->tune(m_lastFrequencyHz, m_lastMode);
-        }
+    // Apply pending frequency/mode before loading; the controller holds
+    // them until the site is set up
+    if (m_lastFrequencyHz > 0) {
+        m_controller->tune(m_lastFrequencyHz, m_lastMode);
+    }
+
+    // Load the site (throttled from the start if it is audio-only)
+    applyAudioOnly();
+    m_controller->loadSite(site);
+
+    emit activeSiteChanged(siteId);
+    refreshStandby();
+    refreshDiversity();
+}
 
-        // Load the site
-        m_kiwiSdrController->loadSite(site);
+void WebSdrManager::unloadController()
+{
+    if (!m_controller) return;
+
+    // Hide the webview in embedded mode so it doesn't take up space
+    m_controller->stopSmeterUpdates();
+    m_controller->hideWindow();
+    m_controller->unload();
+
+    disconnect(m_controller, nullptr, this, nullptr);
+    onSinkAudioChanged(false);
 
+    if (m_backend.keepWhenIdle && !m_idleControllers.contains(m_backend.name)) {
+        // Don't delete - keep for reuse and to avoid Chromium reinitialization
+        m_idleControllers.insert(m_backend.name, m_controller);
     } else {
-        // WebSDR 2.x site
-        if (!m_webSdrController) {
-            m_webSdrController = new WebSdrController(m_parentWidget, this);
-            connectWebSdrSignals();
+        m_controller->deleteLater();
+    }
+    m_controller = nullptr;
+    m_backend = SdrBackend();
+}
+
+void WebSdrManager::unloadCurrent()
+{
+    qDebug() << "WebSdrManager: Unloading current site:" << m_activeSiteId;
+    m_tuneScheduler->logStatistics("WebSdrManager");
+
+    unloadController();
+    m_activeSiteId.clear();
+
+    // Standby and diversity only make sense next to a live site
+    refreshStandby();
+    refreshDiversity();
+}
+
+QStringList WebSdrManager::standbySiteIds() const
+{
+    QStringList ids;
+    for (const StandbySlot& slot : m_standby) {
+        ids.append(slot.siteId);
+    }
+    return ids;
+}
+
+void WebSdrManager::refreshStandby()
+{
+    // Wanted: the first flagged sites other than the live one, if they are
+    // loaded as a page (a native stream connects in well under a second)
+    QStringList wanted;
+    if (!m_activeSiteId.isEmpty()) {
+        for (const WebSdrSite& site : m_sites) {
+            if (wanted.size() >= MAX_STANDBY_SITES) break;
+            if (!site.standby || site.id == m_activeSiteId) continue;
+            SdrBackend backend = m_backends.find(site.type, wantedCapabilities());
+            if (!backend.capabilities.testFlag(SdrController::BrowserPage)) continue;
+            wanted.append(site.id);
         }
+    }
+
+    // Drop pages no longer wanted, or whose site was edited since loading
+    auto stale = [this](const StandbySlot& slot) {
+        WebSdrSite site = findSite(slot.siteId);
+        const WebSdrSite& loaded = slot.controller->currentSite();
+        return site.effectiveUrl() != loaded.effectiveUrl() || site.password != loaded.password;
+    };
+    for (int i = m_standby.size() - 1; i >= 0; i--) {
+        if (!wanted.contains(m_standby[i].siteId) || stale(m_standby[i])) {
+            releaseStandby(m_standby.takeAt(i));
+        }
+    }
+
+    for (const QString& siteId : wanted) {
+        if (standbySiteIds().contains(siteId)) continue;
 
-        // Apply pending frequency/mode before loading (same as KiwiSDR)
-        // This sets controller's m_pendingFrequencyHz which gets applied during init
+        WebSdrSite site = findSite(siteId);
+        StandbySlot slot;
+        slot.siteId = siteId;
+        slot.backend = m_backends.find(site.type, wantedCapabilities());
+
+        // Not connected to the manager's slots until made live
+        slot.controller = slot.backend.create(m_webProfile->profile(), m_parentWidget, this);
+        slot.controller->setStandby(true);
         if (m_lastFrequencyHz > 0) {
-            m_webSdrController->tune(m_lastFrequencyHz, m_lastMode);
+            slot.controller->tune(m_lastFrequencyHz, m_lastMode);
         }
+        slot.controller->loadSite(site);
 
-        // Load the site
-        m_webSdrController->loadSite(site);
+        m_standby.append(slot);
+        qDebug() << "WebSdrManager: Standby preloading" << site.name;
     }
-
-    emit activeSiteChanged(siteId);
 }
 
-void WebSdrManager::unloadWebSdr()
+void WebSdrManager::releaseStandby(const StandbySlot& slot)
 {
-    if (m_webSdrController) {
-        m_webSdrController->stopSmeterPolling();
-        m_webSdrController->unload();
-        // Hide the webview in embedded mode so it doesn't take up space
-        m_webSdrController->hideWindow();
-        // Don't delete - keep for reuse and to avoid Chromium reinitialization
-    }
+    qDebug() << "WebSdrManager: Releasing standby" << slot.siteId;
+
+    slot.controller->stopSmeterUpdates();
+    slot.controller->unload();
+    slot.controller->deleteLater();
 }
 
-void WebSdrManager::unloadKiwiSdr()
+void WebSdrManager::parkActive()
 {
-    if (m_kiwiSdrController) {
-        m_kiwiSdrController->stopSmeterPolling();
-        m_kiwiSdrController->hideWindow();
-        m_kiwiSdrController->unload();
-        m_kiwiSdrController->deleteLater();
-        m_kiwiSdrController = nullptr;
+    // Keep the live site warm if it is flagged and has a page to keep;
+    // refreshStandby() trims extras
+    bool keep = findSite(m_activeSiteId).standby && m_controller
+                && m_controller->hasCapability(SdrController::BrowserPage)
+                && m_controller->state() != SdrController::Unloaded;
+    if (!keep) {
+        unloadController();
+        return;
     }
+
+    StandbySlot slot;
+    slot.siteId = m_activeSiteId;
+    slot.backend = m_backend;
+    slot.controller = m_controller;
+
+    // Its tap stops with standby, but the signal is disconnected first
+    disconnect(m_controller, nullptr, this, nullptr);
+    onSinkAudioChanged(false);
+    m_controller->setStandby(true);
+
+    m_standby.append(slot);
+    m_controller = nullptr;
+    m_backend = SdrBackend();
 }
 
-void WebSdrManager::unloadCurrent()
+bool WebSdrManager::promoteStandby(const WebSdrSite& site)
 {
-    qDebug() << "WebSdrManager: Unloading current site:" << m_activeSiteId;
+    int index = standbySiteIds().indexOf(site.id);
+    if (index < 0) {
+        return false;
+    }
+    StandbySlot slot = m_standby.takeAt(index);
 
-    if (m_activeSiteType == SdrSiteType::KiwiSDR) {
-        unloadKiwiSdr();
-    } else {
-        unloadWebSdr();
+    parkActive();
+    m_activeSiteId = site.id;
+    m_activeSiteType = site.type;
+
+    // The idle controller of the same backend (if any) is replaced by the standby one
+    if (SdrController* idle = m_idleControllers.take(slot.backend.name)) {
+        idle->deleteLater();
     }
 
-    m_activeSiteId.clear();
+    m_controller = slot.controller;
+    m_backend = slot.backend;
+    connectControllerSignals();
+    m_controller->setStandby(false);
+    resetTuning();
+    applyAudioOnly();
+    onControllerStateChanged(m_controller->state());
+    // Still initializing: ready() arrives through the new connection
+    if (m_controller->isPageReady()) {
+        onControllerReady();
+    }
+
+    qDebug() << "WebSdrManager: Switched to standby site" << site.name;
+    return true;
 }
 
-bool WebSdrManager::isLoaded() const
+QStringList WebSdrManager::diversitySiteIds() const
 {
-    if (m_activeSiteType == SdrSiteType::KiwiSDR) {
-        return m_kiwiSdrController != nullptr && m_kiwiSdrController->isReady();
-    } else {
-        return m_webSdrController != nullptr && m_webSdrController->isReady();
+    QStringList ids;
+    for (const DiversitySlot& slot : m_diversity) {
+        ids.append(slot.siteId);
     }
+    return ids;
 }
 
-void WebSdrManager::setFrequency(uint64_t frequencyHz)
+QString WebSdrManager::diversitySiteId(int source) const
 {
-    m_lastFrequencyHz = frequencyHz;
-
-    if (m_activeSiteType == SdrSiteType::KiwiSDR) {
-        if (m_kiwiSdrController && m_kiwiSdrController->isReady()) {
-            m_kiwiSdrController->setFrequency(frequencyHz);
-        }
-    } else {
-        if (m_webSdrController && m_webSdrController->isReady()) {
-            m_webSdrController->setFrequency(frequencyHz);
+    for (const DiversitySlot& slot : m_diversity) {
+        if (slot.source == source) {
+            return slot.siteId;
         }
     }
+    return QString();
 }
 
-void WebSdrManager::setMode(const QString& mode)
+void WebSdrManager::refreshDiversity()
 {
-    m_lastMode = mode;
-
-    if (m_activeSiteType == SdrSiteType::KiwiSDR) {
-        if (m_kiwiSdrController && m_kiwiSdrController->isReady()) {
-            m_kiwiSdrController->setMode(mode);
+    // Wanted: the first flagged sites other than the live one that have a
+    // NativeAudio backend. Only a native stream delivers a receiver's audio
+    // on its own; pages all share the loopback device.
+    QStringList wanted;
+    if (!m_activeSiteId.isEmpty()) {
+        for (const WebSdrSite& site : m_sites) {
+            if (wanted.size() >= MAX_DIVERSITY_SITES) break;
+            if (!site.diversity || site.id == m_activeSiteId) continue;
+            SdrBackend backend = m_backends.find(site.type, SdrController::NativeAudio);
+            if (!backend.capabilities.testFlag(SdrController::NativeAudio)) continue;
+            wanted.append(site.id);
         }
-    } else {
-        if (m_webSdrController && m_webSdrController->isReady()) {
-            m_webSdrController->setMode(mode);
+    }
+
+    // Drop streams no longer wanted, or whose site was edited since opening
+    for (int i = m_diversity.size() - 1; i >= 0; i--) {
+        const DiversitySlot& slot = m_diversity[i];
+        WebSdrSite site = findSite(slot.siteId);
+        const WebSdrSite& opened = slot.controller->currentSite();
+        if (!wanted.contains(slot.siteId) || site.effectiveUrl() != opened.effectiveUrl()
+            || site.password != opened.password) {
+            releaseDiversity(m_diversity.takeAt(i));
         }
     }
-}
 
-void WebSdrManager::showWindow()
-{
-    if (m_activeSiteType == SdrSiteType::KiwiSDR) {
-        if (m_kiwiSdrController) {
-            m_kiwiSdrController->showWindow();
+    for (const QString& siteId : wanted) {
+        if (diversitySiteIds().contains(siteId)) continue;
+
+        // Lowest free mixer source
+        auto taken = [this](int source) {
+            for (const DiversitySlot& slot : m_diversity) {
+                if (slot.source == source) return true;
+            }
+            return false;
+        };
+        int source = 1;
+        while (taken(source)) {
+            source++;
         }
-    } else {
-        if (m_webSdrController) {
-            m_webSdrController->showWindow();
+
+        WebSdrSite site = findSite(siteId);
+        SdrBackend backend = m_backends.find(site.type, SdrController::NativeAudio);
+        DiversitySlot slot;
+        slot.siteId = siteId;
+        slot.source = source;
+        slot.controller = backend.create(m_webProfile->profile(), nullptr, this);
+        slot.controller->setAudioSink([this, source](const float* samples, int frames, double sampleRate) {
+            if (m_diversitySink) {
+                m_diversitySink(source, samples, frames, sampleRate);
+            }
+        });
+        connect(slot.controller, &SdrController::errorOccurred, this, [siteId](const QString& error) {
+            qWarning() << "WebSdrManager: Diversity stream error for site" << siteId << ":" << error;
+        });
+        if (m_lastFrequencyHz > 0) {
+            slot.controller->tune(m_lastFrequencyHz, m_lastMode);
         }
+        slot.controller->loadSite(site);
+        m_diversity.append(slot);
+
+        qDebug() << "WebSdrManager: Diversity receiver" << source << "streaming" << site.name;
+        emit diversitySourceChanged(source, siteId);
     }
 }
 
-void WebSdrManager::hideWindow()
+void WebSdrManager::releaseDiversity(const DiversitySlot& slot)
 {
-    if (m_activeSiteType == SdrSiteType::KiwiSDR) {
-        if (m_kiwiSdrController) {
-            m_kiwiSdrController->hideWindow();
-        }
-    } else {
-        if (m_webSdrController) {
-            m_webSdrController->hideWindow();
-        }
+    qDebug() << "WebSdrManager: Releasing diversity receiver" << slot.source << slot.siteId;
+
+    slot.controller->setAudioSink(nullptr);
+    slot.controller->unload();
+    slot.controller->deleteLater();
+    emit diversitySourceChanged(slot.source, QString());
+}
+
+void WebSdrManager::setBrowserVisible(bool visible)
+{
+    m_browserVisible = visible;
+    applyAudioOnly();
+}
+
+void WebSdrManager::applyAudioOnly()
+{
+    bool audioOnly = !m_browserVisible && findSite(m_activeSiteId).audioOnly;
+
+    if (m_controller) {
+        m_controller->setAudioOnly(audioOnly);
     }
 }
 
-// WebSDR signal handlers
-void WebSdrManager::onWebSdrStateChanged(WebSdrController::State state)
+bool WebSdrManager::isLoaded() const
+{
+    return m_controller != nullptr && m_controller->isReady();
+}
+
+void WebSdrManager::setFrequency(uint64_t frequencyHz)
+{
+    m_lastFrequencyHz = frequencyHz;
+    m_tuneScheduler->requestFrequency(frequencyHz);
+}
+
+void WebSdrManager::setMode(const QString& mode)
+{
+    m_lastMode = mode;
+    m_tuneScheduler->requestMode(mode);
+}
+
+void WebSdrManager::setPassband(int lowCutHz, int highCutHz)
 {
-    if (m_activeSiteType == SdrSiteType::WebSDR) {
-        emit stateChanged(state);
+    if (m_controller && m_controller->hasCapability(SdrController::Passband)) {
+        m_controller->setPassband(lowCutHz, highCutHz);
     }
 }
 
-void WebSdrManager::onWebSdrSmeterChanged(int value)
+void WebSdrManager::resetTuning()
 {
-    if (m_activeSiteType == SdrSiteType::WebSDR) {
-        emit smeterChanged(value);
+    // The new site's tune is unknown, and a native stream takes commands faster
+    m_tuneScheduler->reset();
+    bool stream = m_controller && m_controller->hasCapability(SdrController::NativeAudio);
+    m_tuneScheduler->setMinGap(stream ? TUNE_GAP_STREAM_MS : TUNE_GAP_PAGE_MS);
+}
+
+void WebSdrManager::applyTune(SdrController* controller, uint64_t frequencyHz, const QString& mode,
+                              bool frequencyChanged, bool modeChanged, std::function<void()> done)
+{
+    // Mode first, then frequency; done() goes with the last command sent
+    if (frequencyChanged && modeChanged) {
+        controller->tune(frequencyHz, mode, std::move(done));
+    } else if (frequencyChanged) {
+        controller->setFrequency(frequencyHz, std::move(done));
+    } else {
+        controller->setMode(mode, std::move(done));
     }
 }
 
-void WebSdrManager::onWebSdrPageReady()
+void WebSdrManager::dispatchTune(uint64_t frequencyHz, const QString& mode,
+                                 bool frequencyChanged, bool modeChanged,
+                                 std::function<void()> done)
 {
-    if (m_activeSiteType == SdrSiteType::WebSDR) {
-        qDebug() << "WebSdrManager: WebSDR site ready:" << m_activeSiteId;
+    // A controller that is not set up yet keeps the tune and calls done() at once
+    if (m_controller) {
+        applyTune(m_controller, frequencyHz, mode, frequencyChanged, modeChanged, std::move(done));
+    } else {
+        done();
+    }
 
-        // Apply current frequency/mode
-        if (m_lastFrequencyHz > 0) {
-            m_webSdrController->setFrequency(m_lastFrequencyHz);
-        }
-        if (!m_lastMode.isEmpty()) {
-            m_webSdrController->setMode(m_lastMode);
-        }
+    // Standby pages follow along (held as pending until they are ready)
+    for (const StandbySlot& slot : m_standby) {
+        applyTune(slot.controller, frequencyHz, mode, frequencyChanged, modeChanged, nullptr);
+    }
 
-        emit siteReady(m_activeSiteId);
+    // So do the diversity receivers (one message each, queued until set up)
+    for (const DiversitySlot& slot : m_diversity) {
+        applyTune(slot.controller, frequencyHz, mode, frequencyChanged, modeChanged, nullptr);
     }
 }
 
-void WebSdrManager::onWebSdrError(const QString& error)
+void WebSdrManager::showWindow()
 {
-    if (m_activeSiteType == SdrSiteType::WebSDR) {
-        qWarning() << "WebSdrManager: WebSDR error for site" << m_activeSiteId << ":" << error;
-        emit siteError(m_activeSiteId, error);
+    if (m_controller) {
+        m_controller->showWindow();
     }
 }
 
-// KiwiSDR signal handlers
-void WebSdrManager::onKiwiSdrStateChanged(KiwiSdrController::State state)
+void WebSdrManager::hideWindow()
 {
-    if (m_activeSiteType == SdrSiteType::KiwiSDR) {
-        // Map KiwiSdrController::State to WebSdrController::State for compatibility
-        WebSdrController::State mappedState;
-        switch (state) {
-            case KiwiSdrController::Unloaded:
-                mappedState = WebSdrController::Unloaded;
-                break;
-            case KiwiSdrController::Loading:
-                mappedState = WebSdrController::Loading;
-                break;
-            case KiwiSdrController::Ready:
-                mappedState = WebSdrController::Ready;
-                break;
-            case KiwiSdrController::Error:
-            default:
-                mappedState = WebSdrController::Error;
-                break;
-        }
-        emit stateChanged(mappedState);
+    if (m_controller) {
+        m_controller->hideWindow();
     }
 }
 
-void WebSdrManager::onKiwiSdrSmeterChanged(int value)
+// Live controller signal handlers
+void WebSdrManager::onControllerStateChanged(SdrController::State state)
 {
-    if (m_activeSiteType == SdrSiteType::KiwiSDR) {
-        emit smeterChanged(value);
-    }
+    emit stateChanged(state);
 }
 
-void WebSdrManager::onKiwiSdrPageReady()
+void WebSdrManager::onControllerReady()
 {
-    if (m_activeSiteType == SdrSiteType::KiwiSDR) {
-        qDebug() << "WebSdrManager: KiwiSDR site ready:" << m_activeSiteId;
+    if (!m_controller) return;
 
-        // Frequency/mode already applied during load, but ensure current state
-        if (m_lastFrequencyHz > 0) {
-            m_kiwiSdrController->setFrequency(m_lastFrequencyHz);
-        }
-        if (!m_lastMode.isEmpty()) {
-            m_kiwiSdrController->setMode(m_lastMode);
-        }
+    qDebug() << "WebSdrManager: Site ready:" << m_activeSiteId << "(" << m_backend.name << ")";
+    recordPageLoad(m_controller->pageLoadMs());
 
-        emit siteReady(m_activeSiteId);
+    // Frequency/mode already applied during load, but ensure current state
+    if (m_lastFrequencyHz > 0) {
+        m_controller->setFrequency(m_lastFrequencyHz);
+    }
+    if (!m_lastMode.isEmpty()) {
+        m_controller->setMode(m_lastMode);
     }
+
+    emit siteReady(m_activeSiteId);
 }
 
-void WebSdrManager::onKiwiSdrError(const QString& error)
+void WebSdrManager::recordPageLoad(qint64 loadMs)
 {
-    if (m_activeSiteType == SdrSiteType::KiwiSDR) {
-        qWarning() << "WebSdrManager: KiwiSDR error for site" << m_activeSiteId << ":" << error;
-        emit siteError(m_activeSiteId, error);
+    // Promoted standby pages report -1: they loaded in the background, and
+    // backends without a page have no load time
+    if (loadMs < 0) {
+        return;
     }
+
+    PageLoadStats& stats = m_pageLoads[m_activeSiteId];
+    stats.siteName = findSite(m_activeSiteId).name;
+    stats.bestMs = stats.loads == 0 ? loadMs : qMin(stats.bestMs, loadMs);
+    stats.worstMs = qMax(stats.worstMs, loadMs);
+    stats.lastMs = loadMs;
+    stats.totalMs += loadMs;
+    stats.loads++;
+
+    qDebug() << "WebSdrManager: Page load" << stats.siteName << loadMs << "ms"
+             << "(best" << stats.bestMs << "ms, average" << stats.averageMs()
+             << "ms over" << stats.loads << "loads)";
+}
+
+void WebSdrManager::onControllerError(const QString& error)
+{
+    qWarning() << "WebSdrManager:" << m_backend.name << "error for site" << m_activeSiteId << ":" << error;
+    emit siteError(m_activeSiteId, error);
 }
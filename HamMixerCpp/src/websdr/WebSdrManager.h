@@ -1,7 +1,7 @@
 /*
  * WebSdrManager.h
  *
- * Manages SDR controllers (WebSDR 2.x and KiwiSDR) - only one site loaded at a time
+ * Manages the SDR receivers: one live site, warm standby pages and diversity streams
  * Part of HamMixer CT7BAC
  */
 
@@ -10,16 +10,34 @@
 
 #include <QObject>
 #include <QList>
-#include "WebSdrController.h"
-#include "KiwiSdrController.h"
+#include <QStringList>
+#include <QMap>
+#include "SdrController.h"
+#include "SdrBackendRegistry.h"
+#include "TuneScheduler.h"
+#include "SdrWebProfile.h"
 #include "WebSdrSite.h"
 
 /**
- * @brief Manages SDR site controllers (WebSDR 2.x and KiwiSDR)
+ * @brief Manages the SDR receivers (WebSDR 2.x and KiwiSDR)
  *
- * Only one site is loaded at a time to minimize CPU usage.
- * When switching sites, the current site is unloaded before loading the new one.
- * Supports both WebSDR 2.x and KiwiSDR site types.
+ * Every receiver is an SdrController, made by the backend that an
+ * SdrBackendRegistry picks for the site's type and wanted capabilities, so
+ * a new receiver type only needs a backend registered (see backends()).
+ *
+ * One site is live: it is tuned with the radio, its audio feeds channel 2
+ * and, for a browser page, it is the page on screen. Switching sites
+ * unloads the live one first, unless either is flagged standby. Browser
+ * page sites flagged standby (up to MAX_STANDBY_SITES) are kept loaded,
+ * hidden, muted and tuned along, and are made live in place without a
+ * page load. Sites flagged diversity (up to MAX_DIVERSITY_SITES) are
+ * streamed natively next to the live site, each to its own mixer source.
+ *
+ * Audio reaches AudioManager in one of three ways: the native stream of a
+ * NativeAudio backend, the live page's audio captured in the browser
+ * (PageAudioTap) while page audio capture is on, or otherwise the loopback
+ * device. All pages share one disk-backed browser profile (SdrWebProfile),
+ * and the time from load start to page ready is kept per site.
  */
 class WebSdrManager : public QObject
 {
@@ -68,14 +86,66 @@ public:
     QString activeSiteId() const { return m_activeSiteId; }
 
     /**
-     * Get active WebSDR controller (nullptr if KiwiSDR is active)
+     * Get the live site's controller (nullptr if none)
+     */
+    SdrController* activeController() const { return m_controller; }
+
+    /**
+     * Backends sites are loaded with; register more before loading sites
+     */
+    SdrBackendRegistry& backends() { return m_backends; }
+
+    /**
+     * Stream audio natively instead of loading the web page, for site types
+     * with a NativeAudio backend (takes effect on the next loadSite())
+     */
+    void setKiwiNativeAudio(bool enabled);
+    bool kiwiNativeAudio() const { return m_kiwiNativeAudio; }
+
+    /**
+     * Set where natively streamed and page-captured audio goes (see SdrController::AudioSink)
+     */
+    void setAudioSink(SdrController::AudioSink sink);
+
+    /**
+     * Capture the live page's audio instead of playing it to the loopback device
+     */
+    void setPageAudioCapture(bool enabled);
+    bool pageAudioCapture() const { return m_pageAudioCapture; }
+
+    /**
+     * Check if the active site's audio arrives through the sink rather than via loopback
+     */
+    bool isNativeAudioActive() const { return m_sinkAudioActive; }
+
+    /**
+     * Sites kept loaded in the background (see WebSdrSite::standby)
+     */
+    QStringList standbySiteIds() const;
+
+    /**
+     * Receives an extra receiver's audio (source 1..MAX_DIVERSITY_SITES,
+     * the DiversityCombiner source number)
+     */
+    using DiversitySink = std::function<void(int source, const float* samples,
+                                             int frames, double sampleRate)>;
+    void setDiversitySink(DiversitySink sink) { m_diversitySink = std::move(sink); }
+
+    /**
+     * Sites streamed as extra receivers (see WebSdrSite::diversity)
+     */
+    QStringList diversitySiteIds() const;
+
+    /**
+     * Site streaming to a mixer source (empty if none)
      */
-    WebSdrController* activeWebSdrController() const { return m_webSdrController; }
+    QString diversitySiteId(int source) const;
 
     /**
-     * Get active KiwiSDR controller (nullptr if WebSDR is active)
+     * Tell the manager whether the SDR browser is on screen. Sites with
+     * audioOnly set stop rendering while it is not.
      */
-    KiwiSdrController* activeKiwiSdrController() const { return m_kiwiSdrController; }
+    void setBrowserVisible(bool visible);
 
     /**
      * Get the active site type
@@ -88,17 +158,53 @@ public:
     bool isLoaded() const;
 
     /**
-     * Set frequency on active controller
+     * Set frequency on active controller (and standby pages). Requests are
+     * coalesced and rate-limited by a TuneScheduler; only the latest is sent.
      * @param frequencyHz Frequency in Hz
      */
     void setFrequency(uint64_t frequencyHz);
 
     /**
-     * Set mode on active controller
+     * Set mode on active controller (and standby pages), coalesced like setFrequency()
      * @param mode Mode string: "lsb", "usb", "cw", "am", "fm"
      */
     void setMode(const QString& mode);
 
+    /**
+     * Passband of the live site in Hz from the carrier, for backends with
+     * the Passband capability; 0, 0 restores the mode's default
+     */
+    void setPassband(int lowCutHz, int highCutHz);
+
+    /**
+     * Browser cache size and request filtering of the shared page profile
+     */
+    void setHttpCacheSizeMB(int megabytes) { m_webProfile->setCacheSizeMB(megabytes); }
+    void setBlockTrackers(bool enabled) { m_webProfile->setBlockTrackers(enabled); }
+    int blockedRequestCount() const { return m_webProfile->blockedCount(); }
+
+    /**
+     * Page load times (load start to page ready) of one site, this session
+     */
+    struct PageLoadStats {
+        QString siteName;
+        int loads = 0;
+        qint64 lastMs = 0;
+        qint64 bestMs = 0;
+        qint64 worstMs = 0;
+        qint64 totalMs = 0;
+
+        qint64 averageMs() const { return loads > 0 ? totalMs / loads : 0; }
+    };
+    const QMap<QString, PageLoadStats>& pageLoadStatistics() const { return m_pageLoads; }
+    void resetPageLoadStatistics() { m_pageLoads.clear(); }
+
+    /**
+     * Tune pipeline counters and radio-to-SDR latency
+     */
+    const TuneScheduler::Stats& tuneStatistics() const { return m_tuneScheduler->statistics(); }
+    void resetTuneStatistics() { m_tuneScheduler->resetStatistics(); }
+
     /**
      * Show the WebSDR window
      */
@@ -127,40 +233,99 @@ signals:
 
     /**
      * Emitted when S-meter value changes
+     * @param sampledMs When the SDR measured it, on RadioController::monotonicMs()
      */
-    void smeterChanged(int value);
+    void smeterChanged(int value, qint64 sampledMs);
 
     /**
      * Emitted when WebSDR state changes
      */
-    void stateChanged(WebSdrController::State state);
+    void stateChanged(SdrController::State state);
 
-private slots:
-    void onWebSdrStateChanged(WebSdrController::State state);
-    void onWebSdrSmeterChanged(int value);
-    void onWebSdrPageReady();
-    void onWebSdrError(const QString& error);
+    /**
+     * Emitted when the active site's audio starts or stops arriving through
+     * the audio sink (native stream, or page capture delivering)
+     */
+    void nativeAudioChanged(bool active);
 
-    void onKiwiSdrStateChanged(KiwiSdrController::State state);
-    void onKiwiSdrSmeterChanged(int value);
-    void onKiwiSdrPageReady();
-    void onKiwiSdrError(const QString& error);
+    /**
+     * Emitted when an extra receiver starts streaming to a mixer source, or
+     * stops (siteId empty)
+     */
+    void diversitySourceChanged(int source, const QString& siteId);
+
+private slots:
+    void onControllerStateChanged(SdrController::State state);
+    void onControllerReady();
+    void onControllerError(const QString& error);
+    void onSinkAudioChanged(bool active);
 
 private:
     WebSdrSite findSite(const QString& siteId) const;
-    void connectWebSdrSignals();
-    void connectKiwiSdrSignals();
-    void unloadWebSdr();
-    void unloadKiwiSdr();
+    SdrController::Capabilities wantedCapabilities() const;
+    SdrController* acquireController(const SdrBackend& backend);
+    void connectControllerSignals();
+    void unloadController();
+    void applyAudioOnly();
+    void resetTuning();
+    void recordPageLoad(qint64 loadMs);
+    void dispatchTune(uint64_t frequencyHz, const QString& mode,
+                      bool frequencyChanged, bool modeChanged, std::function<void()> done);
+    static void applyTune(SdrController* controller, uint64_t frequencyHz, const QString& mode,
+                          bool frequencyChanged, bool modeChanged, std::function<void()> done);
+
+    // Warm standby
+    struct StandbySlot {
+        QString siteId;
+        SdrBackend backend;
+        SdrController* controller = nullptr;
+    };
+    void refreshStandby();
+    void releaseStandby(const StandbySlot& slot);
+    void parkActive();
+    bool promoteStandby(const WebSdrSite& site);
+
+    // Diversity receivers
+    struct DiversitySlot {
+        QString siteId;
+        int source = 0;
+        SdrController* controller = nullptr;
+    };
+    void refreshDiversity();
+    void releaseDiversity(const DiversitySlot& slot);
 
     QWidget* m_parentWidget;              // Parent widget for embedded mode
-    WebSdrController* m_webSdrController; // WebSDR 2.x controller
-    KiwiSdrController* m_kiwiSdrController; // KiwiSDR controller
+    SdrBackendRegistry m_backends;
+    SdrController* m_controller;          // Live site's controller
+    SdrBackend m_backend;                 // ...and its backend
+    QMap<QString, SdrController*> m_idleControllers;  // keepWhenIdle backends, by name
+    SdrController::AudioSink m_audioSink;
+    bool m_kiwiNativeAudio;
+    bool m_pageAudioCapture;
+    bool m_sinkAudioActive;               // Live site's audio arrives through the sink
+    bool m_browserVisible;
     QList<WebSdrSite> m_sites;            // Available sites (not all loaded)
     QString m_activeSiteId;
     SdrSiteType m_activeSiteType;         // Track which type is currently active
     uint64_t m_lastFrequencyHz;           // For applying to newly loaded sites
     QString m_lastMode;
+    TuneScheduler* m_tuneScheduler;
+    SdrWebProfile* m_webProfile;          // Shared by every page; outlives them
+    QMap<QString, PageLoadStats> m_pageLoads;  // By site ID
+
+    // Tune pacing: a page runs a script per tune, the native stream sends one message
+    static constexpr int TUNE_GAP_PAGE_MS = 50;
+    static constexpr int TUNE_GAP_STREAM_MS = 20;
+    static constexpr int TUNE_TIMEOUT_MS = 1000;
+
+    // Preloaded, muted and throttled pages for the sites flagged standby
+    QList<StandbySlot> m_standby;
+    static constexpr int MAX_STANDBY_SITES = 2;
+
+    // Native streams of the sites flagged diversity (matches AudioManager::DIVERSITY_SOURCES)
+    QList<DiversitySlot> m_diversity;
+    DiversitySink m_diversitySink;
+    static constexpr int MAX_DIVERSITY_SITES = 2;
 };
 
 #endif // WEBSDRMANAGER_H
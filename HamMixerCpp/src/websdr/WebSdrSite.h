@@ -29,6 +29,9 @@ struct WebSdrSite {
     SdrSiteType type = SdrSiteType::WebSDR;  // Site type (default: WebSDR)
     int port = 0;           // Custom port (0 = use URL default)
     QString password;       // Optional password for protected KiwiSDR sites
+    bool audioOnly = false; // Suspend waterfall/spectrum rendering while the browser is hidden
+    bool standby = false;   // Keep preloaded in the background for instant switching
+    bool diversity = false; // Stream alongside the live site as an extra receiver (KiwiSDR)
 
     WebSdrSite()
     {}
@@ -74,6 +77,17 @@ struct WebSdrSite {
         return parsed.toString();
     }
 
+    /**
+     * Check if another site entry points at the same server (host and port)
+     */
+    bool isSameServer(const WebSdrSite& other) const {
+        QUrl a(effectiveUrl());
+        QUrl b(other.effectiveUrl());
+        if (a.host().isEmpty()) return false;
+        return a.host().compare(b.host(), Qt::CaseInsensitive) == 0
+            && a.port(a.scheme() == "https" ? 443 : 80) == b.port(b.scheme() == "https" ? 443 : 80);
+    }
+
     /**
      * Serialize to JSON
      */
@@ -85,6 +99,9 @@ struct WebSdrSite {
         obj["type"] = (type == SdrSiteType::KiwiSDR) ? "kiwisdr" : "websdr";
         if (port > 0) obj["port"] = port;
         if (!password.isEmpty()) obj["password"] = password;
+        if (audioOnly) obj["audio_only"] = true;
+        if (standby) obj["standby"] = true;
+        if (diversity) obj["diversity"] = true;
         return obj;
     }
 
@@ -102,6 +119,9 @@ struct WebSdrSite {
 
         site.port = obj["port"].toInt(0);
         site.password = obj["password"].toString();
+        site.audioOnly = obj["audio_only"].toBool(false);
+        site.standby = obj["standby"].toBool(false);
+        site.diversity = obj["diversity"].toBool(false);
         return site;
     }
 
@@ -0,0 +1,295 @@
+/*
+ * KiwiSimulator.cpp
+ *
+ * Local stand-in for a KiwiSDR's SND WebSocket, for testing the native audio client
+ * Part of HamMixer CT7BAC
+ */
+
+#include "KiwiSimulator.h"
+#include <QWebSocketServer>
+#include <QWebSocket>
+#include <QHostAddress>
+#include <QRegularExpression>
+#include <QUrl>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+// IMA ADPCM tables (same as the decoder in KiwiSdrStream.cpp)
+const int kStepSizes[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+const int kIndexAdjust[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+int encodeNibble(int sample, KiwiSdrStream::AdpcmState& state)
+{
+    int step = kStepSizes[state.index];
+    int diff = sample - state.previous;
+    int code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+
+    // Mirror the decoder's reconstruction so both sides track the same value
+    int delta = step >> 3;
+    if (diff >= step) { code |= 4; diff -= step; delta += step; }
+    if (diff >= (step >> 1)) { code |= 2; diff -= step >> 1; delta += step >> 1; }
+    if (diff >= (step >> 2)) { code |= 1; delta += step >> 2; }
+
+    state.previous = std::clamp(state.previous + ((code & 8) ? -delta : delta), -32768, 32767);
+    state.index = std::clamp(state.index + kIndexAdjust[code & 7], 0, 88);
+    return code;
+}
+
+} // namespace
+
+KiwiSimulator::KiwiSimulator(QObject* parent)
+    : QObject(parent)
+    , m_server(new QWebSocketServer("kiwisim", QWebSocketServer::NonSecureMode, this))
+    , m_tickTimer(new QTimer(this))
+{
+    connect(m_server, &QWebSocketServer::newConnection, this, &KiwiSimulator::onNewConnection);
+
+    m_tickTimer->setTimerType(Qt::PreciseTimer);
+    m_tickTimer->setInterval(TICK_MS);
+    connect(m_tickTimer, &QTimer::timeout, this, &KiwiSimulator::onTick);
+    m_uptime.start();
+}
+
+KiwiSimulator::~KiwiSimulator()
+{
+    m_server->close();
+}
+
+bool KiwiSimulator::listen(quint16 port)
+{
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        qWarning() << "KiwiSimulator: Cannot listen on port" << port << ":" << m_server->errorString();
+        return false;
+    }
+    m_tickTimer->start();
+    return true;
+}
+
+quint16 KiwiSimulator::port() const
+{
+    return m_server->serverPort();
+}
+
+KiwiSimulator::Statistics KiwiSimulator::statistics() const
+{
+    Statistics stats = m_stats;
+    stats.clients = m_clients.size();
+    return stats;
+}
+
+void KiwiSimulator::encodeAdpcm(const int16_t* samples, int count, uint8_t* out,
+                                KiwiSdrStream::AdpcmState& state)
+{
+    for (int i = 0; i + 1 < count; i += 2) {
+        int low = encodeNibble(samples[i], state);
+        int high = encodeNibble(samples[i + 1], state);
+        out[i / 2] = static_cast<uint8_t>(low | (high << 4));
+    }
+}
+
+KiwiSimulator::Client* KiwiSimulator::findClient(QWebSocket* socket)
+{
+    for (Client& client : m_clients) {
+        if (client.socket == socket) {
+            return &client;
+        }
+    }
+    return nullptr;
+}
+
+void KiwiSimulator::sendMessage(QWebSocket* socket, const QByteArray& body)
+{
+    socket->sendBinaryMessage("MSG " + body);
+}
+
+void KiwiSimulator::onNewConnection()
+{
+    while (QWebSocket* socket = m_server->nextPendingConnection()) {
+        QString path = socket->requestUrl().path();
+        emit clientConnected(path);
+
+        static const QRegularExpression sndPath("^(/kiwi)?/\\d+/SND$");
+        if (!sndPath.match(path).hasMatch()) {
+            qWarning() << "KiwiSimulator: Rejecting" << path;
+            socket->close(QWebSocketProtocol::CloseCodePolicyViolated);
+            socket->deleteLater();
+            continue;
+        }
+        if (m_clients.size() >= m_channels) {
+            sendMessage(socket, "too_busy=" + QByteArray::number(m_channels));
+            socket->close();
+            socket->deleteLater();
+            continue;
+        }
+
+        Client client;
+        client.socket = socket;
+        client.lastMessageMs = m_uptime.elapsed();
+        m_clients.append(client);
+
+        connect(socket, &QWebSocket::textMessageReceived, this, [this, socket](const QString& message) {
+            onTextMessage(socket, message);
+        });
+        connect(socket, &QWebSocket::disconnected, this, [this, socket]() {
+            removeClient(socket);
+        });
+    }
+}
+
+void KiwiSimulator::removeClient(QWebSocket* socket)
+{
+    for (int i = 0; i < m_clients.size(); i++) {
+        if (m_clients[i].socket == socket) {
+            m_clients.removeAt(i);
+            socket->deleteLater();
+            return;
+        }
+    }
+}
+
+void KiwiSimulator::onTextMessage(QWebSocket* socket, const QString& message)
+{
+    Client* client = findClient(socket);
+    if (!client) return;
+    client->lastMessageMs = m_uptime.elapsed();
+
+    if (!message.startsWith("SET ")) return;
+    QString body = message.mid(4);
+
+    if (body.startsWith("auth ")) {
+        QString password;
+        static const QRegularExpression passwordArg("\\bp=(\\S*)");
+        QRegularExpressionMatch match = passwordArg.match(body);
+        if (match.hasMatch()) {
+            password = QUrl::fromPercentEncoding(match.captured(1).toLatin1());
+        }
+        if (!m_password.isEmpty() && password != m_password) {
+            sendMessage(socket, "badp=1");
+            return;
+        }
+        client->authenticated = true;
+        sendMessage(socket, "badp=0");
+        sendMessage(socket, "audio_init=0 audio_rate=" + QByteArray::number(m_audioRate));
+        // Real Kiwis run a hair off nominal; the client must cope
+        sendMessage(socket, "sample_rate=" + QByteArray::number(m_audioRate * 1.0001, 'f', 3));
+    } else if (body == "keepalive") {
+        m_stats.keepalives++;
+    } else if (body.startsWith("compression=")) {
+        client->compression = body.mid(12).toInt() != 0;
+    } else if (body.startsWith("mod=") && client->authenticated) {
+        static const QRegularExpression tuneArgs("mod=(\\S+).*\\bfreq=([0-9.]+)");
+        QRegularExpressionMatch match = tuneArgs.match(body);
+        if (match.hasMatch()) {
+            client->mode = match.captured(1);
+            client->frequencyKHz = match.captured(2).toDouble();
+            if (!client->tuned) {
+                client->tuned = true;
+                client->clock.start();
+            }
+            m_stats.tuneCommands++;
+            emit tuned(client->frequencyKHz, client->mode);
+        }
+    }
+}
+
+void KiwiSimulator::onTick()
+{
+    qint64 now = m_uptime.elapsed();
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    for (int i = m_clients.size() - 1; i >= 0; i--) {
+        Client& client = m_clients[i];
+
+        if (now - client.lastMessageMs > IDLE_TIMEOUT_MS) {
+            qWarning() << "KiwiSimulator: Client idle, closing";
+            client.lastMessageMs = now;  // Removed once the close completes
+            client.socket->close();
+            continue;
+        }
+        if (!client.tuned || now < client.holdUntilMs) continue;
+
+        // Send whatever the audio clock says is due (in a burst after a hold)
+        uint64_t due = static_cast<uint64_t>(client.clock.nsecsElapsed() * 1e-9 * m_audioRate);
+        while (client.samplesSent + SAMPLES_PER_PACKET <= due) {
+            sendPacket(client);
+        }
+
+        if (m_impairments.jitterMs > 0) {
+            client.holdUntilMs = now + static_cast<qint64>(unit(m_rng) * m_impairments.jitterMs);
+        }
+    }
+}
+
+void KiwiSimulator::sendPacket(Client& client)
+{
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<double> noise(0.0, 300.0);
+
+    // Tone pitch follows the last kHz digits so tuning is audible
+    double toneHz = 400.0 + std::fmod(client.frequencyKHz * 1000.0, 1000.0);
+    double increment = 2.0 * M_PI * toneHz / m_audioRate;
+
+    int16_t samples[SAMPLES_PER_PACKET];
+    for (int i = 0; i < SAMPLES_PER_PACKET; i++) {
+        double value = 8000.0 * std::sin(client.phase) + noise(m_rng);
+        samples[i] = static_cast<int16_t>(std::clamp(value, -32768.0, 32767.0));
+        client.phase = std::fmod(client.phase + increment, 2.0 * M_PI);
+    }
+    client.samplesSent += SAMPLES_PER_PACKET;
+    uint32_t sequence = client.sequence++;
+
+    if (unit(m_rng) < m_impairments.lossRate) {
+        m_stats.packetsDropped++;
+        return;
+    }
+
+    // S-meter wanders around S9 over a few seconds (tenths of a dB above -127 dBm)
+    double seconds = client.samplesSent / static_cast<double>(m_audioRate);
+    double dBm = -73.0 + 10.0 * std::sin(seconds * 2.0 * M_PI / 4.0);
+    uint16_t smeter = static_cast<uint16_t>(std::lround((dBm + 127.0) * 10.0));
+
+    uint8_t flags = client.compression ? KiwiSdrStream::FLAG_COMPRESSED : 0;
+    QByteArray packet("SND");
+    packet.append(static_cast<char>(flags));
+    for (int shift = 0; shift < 32; shift += 8) {
+        packet.append(static_cast<char>((sequence >> shift) & 0xFF));
+    }
+    packet.append(static_cast<char>(smeter >> 8));
+    packet.append(static_cast<char>(smeter & 0xFF));
+
+    if (client.compression) {
+        // Encoder state restarts every packet, as on the real server
+        KiwiSdrStream::AdpcmState state;
+        uint8_t encoded[SAMPLES_PER_PACKET / 2];
+        encodeAdpcm(samples, SAMPLES_PER_PACKET, encoded, state);
+        packet.append(reinterpret_cast<const char*>(encoded), sizeof(encoded));
+    } else {
+        for (int16_t sample : samples) {
+            packet.append(static_cast<char>((sample >> 8) & 0xFF));
+            packet.append(static_cast<char>(sample & 0xFF));
+        }
+    }
+
+    client.socket->sendBinaryMessage(packet);
+    m_stats.packetsSent++;
+}
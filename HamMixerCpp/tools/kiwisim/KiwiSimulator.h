@@ -0,0 +1,126 @@
+/*
+ * KiwiSimulator.h
+ *
+ * Local stand-in for a KiwiSDR's SND WebSocket, for testing the native audio client
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef KIWISIMULATOR_H
+#define KIWISIMULATOR_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <cstdint>
+#include <random>
+
+#include "websdr/KiwiSdrStream.h"
+
+class QWebSocketServer;
+class QWebSocket;
+
+/**
+ * @brief Serves the KiwiSDR audio protocol on a local port
+ *
+ * Speaks enough of the KiwiSDR server to exercise KiwiSdrStream: the
+ * /kiwi/<ts>/SND endpoint, "SET auth", the audio_rate / sample_rate
+ * handshake, "SET compression", "SET mod ... freq=..." and keepalives.
+ * Each client gets its own stream of SND packets at the audio rate
+ * carrying a tone (pitch follows the tuned frequency), a little noise and
+ * a slowly moving S-meter, ADPCM-compressed or as big-endian PCM.
+ *
+ * Impairments model a real link: packet loss (sequence gaps) and jitter
+ * (packets held back and delivered in a burst).
+ */
+class KiwiSimulator : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Impairments {
+        double lossRate = 0.0;   // Probability each SND packet is dropped
+        int jitterMs = 0;        // Hold packets up to this long, then burst
+    };
+
+    struct Statistics {
+        int clients = 0;
+        uint64_t packetsSent = 0;
+        uint64_t packetsDropped = 0;
+        uint64_t tuneCommands = 0;
+        uint64_t keepalives = 0;
+    };
+
+    static constexpr int DEFAULT_PORT = 8073;
+    static constexpr int SAMPLES_PER_PACKET = 512;
+
+    explicit KiwiSimulator(QObject* parent = nullptr);
+    ~KiwiSimulator();
+
+    /**
+     * @brief Start listening on localhost
+     * @param port TCP port, 0 picks a free one (see port())
+     */
+    bool listen(quint16 port);
+    quint16 port() const;
+
+    void setAudioRate(int rate) { m_audioRate = rate; }
+    void setChannels(int channels) { m_channels = channels; }
+    void setPassword(const QString& password) { m_password = password; }
+    void setImpairments(const Impairments& impairments) { m_impairments = impairments; }
+
+    Statistics statistics() const;
+
+    /**
+     * @brief IMA ADPCM encode, low nibble first (inverse of KiwiSdrStream::decodeAdpcm)
+     */
+    static void encodeAdpcm(const int16_t* samples, int count, uint8_t* out,
+                            KiwiSdrStream::AdpcmState& state);
+
+signals:
+    void clientConnected(const QString& path);
+    void tuned(double frequencyKHz, const QString& mode);
+
+private slots:
+    void onNewConnection();
+    void onTick();
+
+private:
+    struct Client {
+        QWebSocket* socket = nullptr;
+        bool authenticated = false;
+        bool compression = false;
+        bool tuned = false;
+        double frequencyKHz = 0.0;
+        QString mode;
+        uint32_t sequence = 0;
+        uint64_t samplesSent = 0;
+        double phase = 0.0;
+        QElapsedTimer clock;       // Audio clock, started when tuned
+        qint64 holdUntilMs = 0;    // Jitter: nothing leaves before this
+        qint64 lastMessageMs = 0;
+    };
+
+    Client* findClient(QWebSocket* socket);
+    void onTextMessage(QWebSocket* socket, const QString& message);
+    void removeClient(QWebSocket* socket);
+    void sendPacket(Client& client);
+    static void sendMessage(QWebSocket* socket, const QByteArray& body);
+
+    QWebSocketServer* m_server;
+    QTimer* m_tickTimer;
+    QElapsedTimer m_uptime;
+    QList<Client> m_clients;
+    int m_audioRate = 12000;
+    int m_channels = 4;
+    QString m_password;
+    Impairments m_impairments;
+    Statistics m_stats;
+    std::mt19937 m_rng{7300};
+
+    static constexpr int TICK_MS = 5;
+    static constexpr int IDLE_TIMEOUT_MS = 30000;  // No keepalive: drop the client
+};
+
+#endif // KIWISIMULATOR_H
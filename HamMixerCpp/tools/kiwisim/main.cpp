@@ -0,0 +1,241 @@
+/*
+ * main.cpp
+ *
+ * kiwisim - simulated KiwiSDR audio server and native stream benchmark
+ * Part of HamMixer CT7BAC
+ *
+ *   kiwisim --port 8073 --jitter 150 --loss 0.01
+ *       Serve the KiwiSDR SND protocol on localhost:8073. Add a KiwiSDR site
+ *       with URL http://localhost:8073/ in HamMixer and enable
+ *       Tools > KiwiSDR Native Audio.
+ *
+ *   kiwisim --bench --seconds 10
+ *       Run KiwiSdrStream against an in-process server: time to first
+ *       audio, tune round trips, packet loss accounting, delivered sample
+ *       rate and ADPCM decode throughput.
+ */
+
+#include "KiwiSimulator.h"
+#include "websdr/KiwiSdrStream.h"
+#include "websdr/WebSdrSite.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+namespace {
+
+QTextStream& out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+// Run the event loop until done() holds or the timeout expires
+bool waitUntil(const std::function<bool()>& done, int timeoutMs)
+{
+    if (done()) {
+        return true;
+    }
+
+    QEventLoop loop;
+    QTimer check;
+    check.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&check, &QTimer::timeout, &loop, [&]() {
+        if (done()) {
+            loop.quit();
+        }
+    });
+    QTimer::singleShot(timeoutMs, &loop, &QEventLoop::quit);
+    check.start(1);
+    loop.exec();
+    return done();
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+void benchDecode()
+{
+    static constexpr int PACKETS = 20000;
+    static constexpr int SAMPLES = KiwiSimulator::SAMPLES_PER_PACKET;
+
+    std::vector<int16_t> pcm(SAMPLES);
+    for (int i = 0; i < SAMPLES; i++) {
+        pcm[i] = static_cast<int16_t>(8000 * ((i / 8) % 2 ? 1 : -1) + i);
+    }
+    std::vector<uint8_t> encoded(SAMPLES / 2);
+    KiwiSdrStream::AdpcmState encoder;
+    KiwiSimulator::encodeAdpcm(pcm.data(), SAMPLES, encoded.data(), encoder);
+
+    std::vector<float> decoded(SAMPLES);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < PACKETS; i++) {
+        KiwiSdrStream::AdpcmState state;
+        KiwiSdrStream::decodeAdpcm(encoded.data(), static_cast<int>(encoded.size()), decoded.data(), state);
+    }
+    double seconds = timer.nsecsElapsed() * 1e-9;
+
+    // Round-trip error of the codec on this signal
+    float worst = 0.0f;
+    for (int i = 0; i < SAMPLES; i++) {
+        worst = std::max(worst, std::abs(decoded[i] - pcm[i] / 32768.0f));
+    }
+
+    out() << QString("ADPCM decode: %1 M samples/s (%2x real time at 12 kHz), max error %3\n")
+                 .arg(PACKETS * SAMPLES / seconds / 1e6, 0, 'f', 1)
+                 .arg(PACKETS * SAMPLES / seconds / 12000.0, 0, 'f', 0)
+                 .arg(worst, 0, 'f', 4);
+}
+
+int runBench(const KiwiSimulator::Impairments& impairments, int seconds)
+{
+    KiwiSimulator simulator;
+    simulator.setImpairments(impairments);
+    if (!simulator.listen(0)) {
+        return 1;
+    }
+
+    WebSdrSite site("kiwisim", "kiwisim", QString("http://localhost:%1/").arg(simulator.port()),
+                    SdrSiteType::KiwiSDR);
+
+    uint64_t frames = 0;
+    int sampleRate = 0;
+    KiwiSdrStream stream;
+    stream.setAudioSink([&](const float*, int count, int rate) {
+        frames += static_cast<uint64_t>(count);
+        sampleRate = rate;
+    });
+    int smeterMin = INT_MAX;
+    int smeterMax = 0;
+    QObject::connect(&stream, &KiwiSdrStream::smeterChanged, [&](int value) {
+        smeterMin = std::min(smeterMin, value);
+        smeterMax = std::max(smeterMax, value);
+    });
+    QString lastError;
+    QObject::connect(&stream, &KiwiSdrStream::errorOccurred, [&](const QString& error) {
+        lastError = error;
+    });
+
+    double tunedKHz = 0.0;
+    QObject::connect(&simulator, &KiwiSimulator::tuned, [&](double kHz, const QString&) {
+        tunedKHz = kHz;
+    });
+
+    // Connect and wait for audio
+    out() << QString("Native stream against kiwisim on port %1\n").arg(simulator.port());
+    QElapsedTimer timer;
+    timer.start();
+    stream.tune(14074000, "usb");
+    stream.open(site);
+    if (!waitUntil([&]() { return stream.isReady() || stream.state() == KiwiSdrStream::Error; }, 5000)
+        || !stream.isReady()) {
+        out() << "  no audio: " << (lastError.isEmpty() ? QString("timeout") : lastError) << "\n";
+        return 1;
+    }
+    out() << QString("  first audio after %1 ms\n").arg(timer.elapsed());
+
+    // Retune and time the command's arrival at the server
+    std::vector<double> tuneMs;
+    for (int i = 1; i <= 50; i++) {
+        uint64_t hz = 14074000 + static_cast<uint64_t>(i) * 100;
+        QElapsedTimer tuneTimer;
+        tuneTimer.start();
+        stream.setFrequency(hz);
+        if (waitUntil([&]() { return std::abs(tunedKHz * 1000.0 - hz) < 0.5; }, 1000)) {
+            tuneMs.push_back(tuneTimer.nsecsElapsed() / 1e6);
+        }
+    }
+    out() << QString("  tune: %1 of 50 arrived, median %2 ms, p95 %3 ms\n")
+                 .arg(tuneMs.size())
+                 .arg(percentile(tuneMs, 0.5), 0, 'f', 2)
+                 .arg(percentile(tuneMs, 0.95), 0, 'f', 2);
+
+    // Steady-state streaming
+    uint64_t startFrames = frames;
+    QElapsedTimer streamTimer;
+    streamTimer.start();
+    waitUntil([]() { return false; }, seconds * 1000);
+    double elapsed = streamTimer.nsecsElapsed() * 1e-9;
+
+    KiwiSimulator::Statistics stats = simulator.statistics();
+    out() << QString("  %1 s: %2 samples/s delivered at %3 Hz nominal\n")
+                 .arg(elapsed, 0, 'f', 1)
+                 .arg((frames - startFrames) / elapsed, 0, 'f', 0)
+                 .arg(sampleRate);
+    out() << QString("  packets: %1 received, %2 counted lost (server sent %3, dropped %4)\n")
+                 .arg(stream.packetsReceived())
+                 .arg(stream.packetsLost())
+                 .arg(stats.packetsSent)
+                 .arg(stats.packetsDropped);
+    out() << QString("  S-meter range %1..%2 (S9 = 5400), %3 keepalives\n")
+                 .arg(smeterMin).arg(smeterMax).arg(stats.keepalives);
+
+    stream.close();
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("kiwisim");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulated KiwiSDR audio server and native stream benchmark");
+    parser.addHelpOption();
+    parser.addOption({"port", "TCP port to serve on", "port", QString::number(KiwiSimulator::DEFAULT_PORT)});
+    parser.addOption({"rate", "Audio rate in Hz", "hz", "12000"});
+    parser.addOption({"channels", "Receiver channels before too_busy", "n", "4"});
+    parser.addOption({"password", "Require this password", "password"});
+    parser.addOption({"loss", "Packet loss probability", "p", "0"});
+    parser.addOption({"jitter", "Maximum packet hold-back in ms", "ms", "0"});
+    parser.addOption({"bench", "Benchmark KiwiSdrStream against an in-process server"});
+    parser.addOption({"seconds", "Streaming time for --bench", "s", "10"});
+    parser.process(app);
+
+    KiwiSimulator::Impairments impairments;
+    impairments.lossRate = parser.value("loss").toDouble();
+    impairments.jitterMs = parser.value("jitter").toInt();
+
+    if (parser.isSet("bench")) {
+        benchDecode();
+        return runBench(impairments, std::max(1, parser.value("seconds").toInt()));
+    }
+
+    KiwiSimulator simulator;
+    simulator.setAudioRate(parser.value("rate").toInt());
+    simulator.setChannels(parser.value("channels").toInt());
+    simulator.setPassword(parser.value("password"));
+    simulator.setImpairments(impairments);
+    if (!simulator.listen(static_cast<quint16>(parser.value("port").toUInt()))) {
+        return 1;
+    }
+
+    QObject::connect(&simulator, &KiwiSimulator::clientConnected, [](const QString& path) {
+        out() << "Client connected: " << path << Qt::endl;
+    });
+    QObject::connect(&simulator, &KiwiSimulator::tuned, [](double kHz, const QString& mode) {
+        out() << QString("Tuned %1 kHz %2").arg(kHz, 0, 'f', 3).arg(mode) << Qt::endl;
+    });
+
+    out() << QString("KiwiSDR simulator on http://localhost:%1/ (%2 Hz audio)")
+                 .arg(simulator.port()).arg(parser.value("rate")) << Qt::endl;
+    return app.exec();
+}
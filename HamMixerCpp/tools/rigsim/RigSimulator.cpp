@@ -0,0 +1,826 @@
+/*
+ * RigSimulator.cpp
+ *
+ * Simulated Icom CI-V / Kenwood CAT / rigctld transceiver for load and latency testing
+ * Part of HamMixer CT7BAC
+ */
+
+#include "RigSimulator.h"
+#include "serial/CIVProtocol.h"
+#include "serial/RigctldController.h"
+#include <QSocketNotifier>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QDebug>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+uint8_t bcdByte(int value)
+{
+    return static_cast<uint8_t>(((value / 10) % 10) << 4 | (value % 10));
+}
+
+} // namespace
+
+RigSimulator::RigSimulator(RadioController::Protocol protocol, QObject* parent)
+    : QObject(parent)
+    , m_protocol(protocol)
+    , m_drainTimer(this)
+    , m_scopeTimer(this)
+    , m_signalTimer(this)
+{
+    if (m_protocol == RadioController::KenwoodCAT) {
+        m_mode = 2;  // USB
+    }
+
+    m_clock.start();
+    m_sweep.resize(SCOPE_POINTS);
+
+    m_drainTimer.setTimerType(Qt::PreciseTimer);
+    m_drainTimer.setInterval(2);
+    connect(&m_drainTimer, &QTimer::timeout, this, &RigSimulator::drainLine);
+
+    m_scopeTimer.setInterval(SCOPE_INTERVAL_MS);
+    connect(&m_scopeTimer, &QTimer::timeout, this, &RigSimulator::sendScopeSweep);
+
+    m_signalTimer.setInterval(100);
+    connect(&m_signalTimer, &QTimer::timeout, this, [this]() {
+        std::uniform_int_distribution<int> step(-6, 6);
+        setSignalLevel(m_signalLevel + step(m_random));
+    });
+}
+
+QString RigSimulator::description() const
+{
+    if (m_protocol == RadioController::IcomCIV) {
+        QString model = CIVProtocol::addressToModelName(m_civAddress);
+        return QString("%1 (CI-V 0x%2, transceive %3)")
+            .arg(model.isEmpty() ? QString("Icom") : model)
+            .arg(static_cast<int>(m_civAddress), 2, 16, QChar('0'))
+            .arg(m_transceive ? "on" : "off");
+    }
+    if (m_protocol == RadioController::HamlibRigctld) {
+        return QString("rigctld (Hamlib NET, polled)");
+    }
+    return QString("Kenwood CAT (%1)").arg(m_ai2Supported ? "AI2" : "AI1 only");
+}
+
+void RigSimulator::setImpairments(const Impairments& impairments)
+{
+    m_impairments = impairments;
+}
+
+void RigSimulator::setSignalWalk(bool enabled)
+{
+    if (enabled) {
+        m_signalTimer.start();
+    } else {
+        m_signalTimer.stop();
+    }
+}
+
+// ========== Front panel ==========
+
+void RigSimulator::turnDial(uint64_t frequencyHz)
+{
+    m_frequencyHz = frequencyHz;
+
+    if (m_protocol == RadioController::IcomCIV) {
+        if (m_transceive) {
+            QByteArray payload(1, static_cast<char>(CIVProtocol::CMD_TRANSCEIVE_FREQ));
+            payload.append(CIVProtocol::encodeFrequency(frequencyHz));
+            civSend(0x00, payload);
+        }
+    } else if (m_aiLevel > 0) {
+        catReply(QString("FA%1;").arg(frequencyHz, 11, 10, QChar('0')).toLatin1());
+    }
+}
+
+void RigSimulator::selectMode(uint8_t mode)
+{
+    m_mode = mode;
+
+    if (m_protocol == RadioController::IcomCIV) {
+        if (m_transceive) {
+            QByteArray payload;
+            payload.append(static_cast<char>(CIVProtocol::CMD_TRANSCEIVE_MODE));
+            payload.append(static_cast<char>(mode));
+            payload.append(static_cast<char>(CIVProtocol::FILTER_WIDE));
+            civSend(0x00, payload);
+        }
+    } else if (m_aiLevel > 0) {
+        catReply(QString("MD%1;").arg(static_cast<int>(mode)).toLatin1());
+    }
+}
+
+void RigSimulator::setPtt(bool transmitting)
+{
+    m_transmitting = transmitting;
+
+    if (m_protocol == RadioController::IcomCIV) {
+        if (m_transceive) {
+            QByteArray payload;
+            payload.append(static_cast<char>(CIVProtocol::CMD_TX_STATUS));
+            payload.append(static_cast<char>(CIVProtocol::SUBCMD_TX_STATE));
+            payload.append(static_cast<char>(transmitting ? 0x01 : 0x00));
+            civSend(0x00, payload);
+        }
+    } else if (m_aiLevel > 0) {
+        catReply(transmitting ? "TX0;" : "RX;");
+    }
+}
+
+void RigSimulator::setSignalLevel(int level)
+{
+    m_signalLevel = std::clamp(level, 0, 241);  // 241 = S9+60dB
+}
+
+// ========== Host link ==========
+
+void RigSimulator::receive(const QByteArray& bytes)
+{
+    m_stats.bytesReceived += bytes.size();
+
+    if (m_impairments.baudRate <= 0) {
+        process(bytes);
+        return;
+    }
+
+    // The rig sees the command once its last byte has crossed the line
+    qint64 now = m_clock.nsecsElapsed();
+    qint64 wireNs = static_cast<qint64>(bytes.size()) * 10 * 1000000000LL / m_impairments.baudRate;
+    m_rxBusyUntilNs = std::max(m_rxBusyUntilNs, now) + wireNs;
+    int delayMs = static_cast<int>((m_rxBusyUntilNs - now) / 1000000);
+    QTimer::singleShot(delayMs, Qt::PreciseTimer, this, [this, bytes]() { process(bytes); });
+}
+
+void RigSimulator::process(const QByteArray& bytes)
+{
+    if (m_protocol == RadioController::HamlibRigctld) {
+        // One command per line
+        m_rigctldLine.append(bytes);
+        int start = 0;
+        int end;
+        while ((end = m_rigctldLine.indexOf('\n', start)) >= 0) {
+            processRigctldCommand(m_rigctldLine.mid(start, end - start));
+            start = end + 1;
+        }
+        m_rigctldLine.remove(0, start);
+        return;
+    }
+
+    int offset = 0;
+    while (offset < bytes.size()) {
+        int accepted;
+        if (m_protocol == RadioController::IcomCIV) {
+            accepted = m_civParser.feed(reinterpret_cast<const uint8_t*>(bytes.constData()) + offset,
+                                        bytes.size() - offset);
+            CIVFrame frame;
+            while (m_civParser.next(frame)) {
+                processCivFrame(frame);
+            }
+        } else {
+            accepted = m_catParser.feed(bytes.constData() + offset, bytes.size() - offset);
+            KenwoodResponse command;
+            while (m_catParser.next(command)) {
+                processCatCommand(command);
+            }
+        }
+        if (accepted <= 0) {
+            break;
+        }
+        offset += accepted;
+    }
+}
+
+void RigSimulator::processCivFrame(const CIVFrame& frame)
+{
+    // Our own frames echoed on a single-wire bus, or frames for another rig
+    if (frame.source == m_civAddress || (frame.dest != m_civAddress && frame.dest != 0x00)) {
+        return;
+    }
+
+    m_stats.commandsReceived++;
+    m_hostAddress = frame.source;
+
+    const QByteArray ok(1, static_cast<char>(CIVProtocol::CMD_OK));
+    const QByteArray ng(1, static_cast<char>(CIVProtocol::CMD_NG));
+    QByteArray payload(1, static_cast<char>(frame.command));
+
+    switch (frame.command) {
+        case CIVProtocol::CMD_READ_FREQ:
+            payload.append(CIVProtocol::encodeFrequency(m_frequencyHz));
+            civSend(m_hostAddress, payload);
+            return;
+
+        case CIVProtocol::CMD_READ_MODE:
+            payload.append(static_cast<char>(m_mode));
+            payload.append(static_cast<char>(CIVProtocol::FILTER_WIDE));
+            civSend(m_hostAddress, payload);
+            return;
+
+        case CIVProtocol::CMD_WRITE_FREQ:
+            if (frame.dataSize >= 5) {
+                m_frequencyHz = CIVProtocol::parseFrequency(frame.data, frame.dataSize);
+                m_stats.frequencyWrites++;
+                emit frequencySet(m_frequencyHz);
+                civSend(m_hostAddress, ok);
+                return;
+            }
+            break;
+
+        case CIVProtocol::CMD_WRITE_MODE:
+            if (frame.dataSize >= 1) {
+                m_mode = frame.at(0);
+                civSend(m_hostAddress, ok);
+                return;
+            }
+            break;
+
+        case CIVProtocol::CMD_READ_METER:
+            if (frame.dataSize == 1 && frame.at(0) == CIVProtocol::SUBCMD_SMETER) {
+                payload.append(static_cast<char>(CIVProtocol::SUBCMD_SMETER));
+                payload.append(bcdLevel(m_signalLevel));
+                civSend(m_hostAddress, payload);
+                return;
+            }
+            break;
+
+        case CIVProtocol::CMD_TX_STATUS:
+            if (frame.dataSize == 1 && frame.at(0) == CIVProtocol::SUBCMD_TX_STATE) {
+                payload.append(static_cast<char>(CIVProtocol::SUBCMD_TX_STATE));
+                payload.append(static_cast<char>(m_transmitting ? 0x01 : 0x00));
+                civSend(m_hostAddress, payload);
+                return;
+            }
+            if (frame.dataSize == 1 && frame.at(0) == CIVProtocol::SUBCMD_TUNER_STATE) {
+                payload.append(static_cast<char>(CIVProtocol::SUBCMD_TUNER_STATE));
+                payload.append(static_cast<char>(m_tunerOn ? 0x01 : 0x00));
+                civSend(m_hostAddress, payload);
+                return;
+            }
+            if (frame.dataSize == 2 && frame.at(0) == CIVProtocol::SUBCMD_TX_STATE) {
+                m_transmitting = frame.at(1) != 0;
+                civSend(m_hostAddress, ok);
+                return;
+            }
+            if (frame.dataSize == 2 && frame.at(0) == CIVProtocol::SUBCMD_TUNER_STATE) {
+                // 00 off, 01 on, 02 start tuning (turns the tuner on)
+                m_tunerOn = frame.at(1) != 0;
+                civSend(m_hostAddress, ok);
+                return;
+            }
+            break;
+
+        case CIVProtocol::CMD_SCOPE_DATA:
+            if (frame.dataSize == 2 && frame.at(0) == CIVProtocol::SUBCMD_SCOPE_ON) {
+                civSend(m_hostAddress, ok);
+                return;
+            }
+            if (frame.dataSize == 2 && frame.at(0) == CIVProtocol::SUBCMD_SCOPE_OUTPUT) {
+                m_scopeOutput = frame.at(1) != 0;
+                if (m_scopeOutput) {
+                    m_scopeTimer.start();
+                } else {
+                    m_scopeTimer.stop();
+                }
+                civSend(m_hostAddress, ok);
+                return;
+            }
+            break;
+
+        case CIVProtocol::CMD_SPEECH:
+            if (frame.dataSize == 2 && frame.at(0) == CIVProtocol::SUBCMD_VOICE_TX_PLAY) {
+                civSend(m_hostAddress, ok);
+                return;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    m_stats.commandsRejected++;
+    civSend(m_hostAddress, ng);
+}
+
+void RigSimulator::processCatCommand(const KenwoodResponse& command)
+{
+    m_stats.commandsReceived++;
+
+    // Reads are the bare command ("FA;"), sets carry parameters and are silent
+    bool isRead = command.size == 3;
+    bool ok = false;
+
+    if (command.hasPrefix('F', 'A')) {
+        if (isRead) {
+            catReply(QString("FA%1;").arg(m_frequencyHz, 11, 10, QChar('0')).toLatin1());
+            return;
+        }
+        uint64_t freq = command.number(2, -1, &ok);
+        if (ok && freq > 0) {
+            m_frequencyHz = freq;
+            m_stats.frequencyWrites++;
+            emit frequencySet(freq);
+            // Auto-Information reports changes whatever their source
+            if (m_aiLevel > 0) {
+                catReply(QString("FA%1;").arg(m_frequencyHz, 11, 10, QChar('0')).toLatin1());
+            }
+            return;
+        }
+    } else if (command.hasPrefix('M', 'D')) {
+        if (isRead) {
+            catReply(QString("MD%1;").arg(static_cast<int>(m_mode)).toLatin1());
+            return;
+        }
+        uint64_t mode = command.number(2, 1, &ok);
+        if (ok && mode >= 1 && mode <= 9) {
+            m_mode = static_cast<uint8_t>(mode);
+            return;
+        }
+    } else if (command.hasPrefix('S', 'M')) {
+        // "SM;" or "SM0;" (main receiver); Kenwood scale is 0-30
+        catReply(QString("SM%1;").arg(m_signalLevel * 30 / 255, 4, 10, QChar('0')).toLatin1());
+        return;
+    } else if (command.hasPrefix('A', 'I')) {
+        if (isRead) {
+            catReply(QString("AI%1;").arg(m_aiLevel).toLatin1());
+            return;
+        }
+        uint64_t level = command.number(2, 1, &ok);
+        if (ok && (level <= 1 || (level == 2 && m_ai2Supported))) {
+            m_aiLevel = static_cast<int>(level);
+            return;
+        }
+    } else if (command.hasPrefix('A', 'C')) {
+        if (isRead) {
+            catReply(m_tunerOn ? "AC110;" : "AC000;");
+            return;
+        }
+        if (command.size == 6) {
+            m_tunerOn = command.text[3] == '1';
+            return;
+        }
+    } else if (command.hasPrefix('I', 'F') && isRead) {
+        catReply(catInformation());
+        return;
+    } else if (command.hasPrefix('I', 'D') && isRead) {
+        catReply("ID020;");  // TS-480
+        return;
+    } else if (command.hasPrefix('P', 'B') && command.size == 5) {
+        return;  // Voice keyer: nothing to report
+    } else if (command.hasPrefix('T', 'X')) {
+        m_transmitting = true;
+        return;
+    } else if (command.hasPrefix('R', 'X')) {
+        m_transmitting = false;
+        return;
+    }
+
+    m_stats.commandsRejected++;
+    catReply("?;");
+}
+
+void RigSimulator::processRigctldCommand(const QByteArray& line)
+{
+    QByteArray text = line.trimmed();
+    if (text.isEmpty()) {
+        return;
+    }
+    m_stats.commandsReceived++;
+
+    // "+\get_freq" asks for the extended (self-describing) reply
+    bool extended = text.startsWith('+');
+    if (extended) {
+        text.remove(0, 1);
+    }
+    if (text.startsWith('\\')) {
+        text.remove(0, 1);
+    }
+    QList<QByteArray> args = text.simplified().split(' ');
+    QByteArray command = args.takeFirst();
+
+    // Short forms rigctl clients commonly use
+    if (command == "f") command = "get_freq";
+    else if (command == "F") command = "set_freq";
+    else if (command == "m") command = "get_mode";
+    else if (command == "M") command = "set_mode";
+    else if (command == "l") command = "get_level";
+    else if (command == "u") command = "get_func";
+    else if (command == "U") command = "set_func";
+    else if (command == "t") command = "get_ptt";
+    else if (command == "T") command = "set_ptt";
+    else if (command == "G") command = "vfo_op";
+
+    QList<QPair<QByteArray, QByteArray>> values;
+    int result = 0;  // Hamlib: 0 ok, -1 invalid parameter, -4 not implemented
+    QByteArray arg = args.value(0);
+
+    if (command == "get_freq") {
+        values.append({"Frequency", QByteArray::number(static_cast<qulonglong>(m_frequencyHz))});
+    } else if (command == "set_freq") {
+        bool ok = false;
+        uint64_t freq = static_cast<uint64_t>(arg.toDouble(&ok));
+        if (ok && freq > 0) {
+            m_frequencyHz = freq;
+            m_stats.frequencyWrites++;
+            emit frequencySet(freq);
+        } else {
+            result = -1;
+        }
+    } else if (command == "get_mode") {
+        values.append({"Mode", RigctldController::modeToHamlib(m_mode)});
+        values.append({"Passband", "2400"});
+    } else if (command == "set_mode") {
+        uint8_t mode = RigctldController::modeFromHamlib(arg);
+        if (mode != 0xFF) {
+            m_mode = mode;
+        } else {
+            result = -1;
+        }
+    } else if (command == "get_level" && arg == "STRENGTH") {
+        // dB relative to S9, the inverse of RigctldController::strengthToSMeter()
+        int db = (m_signalLevel <= 120) ? m_signalLevel * 54 / 120 - 54
+                                        : (m_signalLevel - 120) * 60 / 121;
+        values.append({"Level Value", QByteArray::number(db)});
+    } else if (command == "get_func" && arg == "TUNER") {
+        values.append({"Func Status", m_tunerOn ? "1" : "0"});
+    } else if (command == "set_func" && arg == "TUNER" && args.size() >= 2) {
+        m_tunerOn = args.at(1) == "1";
+    } else if (command == "get_ptt") {
+        values.append({"PTT", m_transmitting ? "1" : "0"});
+    } else if (command == "set_ptt" && !arg.isEmpty()) {
+        m_transmitting = arg != "0";
+    } else if (command == "vfo_op" && arg == "TUNE") {
+        m_tunerOn = true;
+    } else if (command == "send_voice_mem" || command == "stop_voice_mem") {
+        // Voice keyer: nothing to report
+    } else {
+        result = -4;
+    }
+
+    if (result != 0) {
+        m_stats.commandsRejected++;
+    }
+
+    QByteArray reply;
+    if (extended) {
+        reply += command + ":";
+        if (!args.isEmpty()) {
+            reply += " " + args.join(' ');
+        }
+        reply += "\n";
+    }
+    for (const auto& value : values) {
+        reply += extended ? value.first + ": " + value.second + "\n" : value.second + "\n";
+    }
+    // Plain replies to reads are just the values; everything else reports a result
+    if (extended || values.isEmpty() || result != 0) {
+        reply += "RPRT " + QByteArray::number(result) + "\n";
+    }
+    catReply(reply);
+}
+
+QByteArray RigSimulator::catInformation() const
+{
+    // Kenwood TS-480 layout, 38 bytes: frequency at 2, TX/RX at 28, mode at 29
+    QByteArray text = "IF" + QByteArray::number(static_cast<qulonglong>(m_frequencyHz)).rightJustified(11, '0');
+    text += "     +000000000";
+    text += m_transmitting ? '1' : '0';
+    text += static_cast<char>('0' + m_mode % 10);
+    text += "0000000;";
+    return text;
+}
+
+QByteArray RigSimulator::bcdLevel(int level)
+{
+    // 0000-0255 as two BCD bytes
+    QByteArray bcd(2, 0);
+    bcd[0] = static_cast<char>(bcdByte(level / 100));
+    bcd[1] = static_cast<char>(bcdByte(level % 100));
+    return bcd;
+}
+
+void RigSimulator::sendScopeSweep()
+{
+    // A radio paces its sweeps to the line; skip one if the last is still queued
+    if (m_txQueue.size() > SCOPE_POINTS) {
+        return;
+    }
+
+    // Noise floor with a few carriers around the middle of the span
+    std::uniform_int_distribution<int> noise(18, 34);
+    std::uniform_int_distribution<int> fading(-8, 8);
+    for (int i = 0; i < SCOPE_POINTS; i++) {
+        m_sweep[i] = static_cast<char>(noise(m_random));
+    }
+    const int carriers[] = {SCOPE_POINTS / 2 + 12, SCOPE_POINTS / 2 + 40, SCOPE_POINTS / 2 + 71};
+    for (int carrier : carriers) {
+        int peak = std::min(m_signalLevel / 2 + 60 + fading(m_random), 160);
+        for (int d = -2; d <= 2; d++) {
+            int level = peak - std::abs(d) * 25;
+            char& point = m_sweep[carrier + d];
+            point = static_cast<char>(std::max<int>(static_cast<uint8_t>(point), level));
+        }
+    }
+
+    auto division = [this](int seq) {
+        QByteArray payload;
+        payload.append(static_cast<char>(CIVProtocol::CMD_SCOPE_DATA));
+        payload.append(static_cast<char>(CIVProtocol::SUBCMD_SCOPE_WAVE));
+        payload.append(static_cast<char>(0x00));  // Main receiver
+        payload.append(static_cast<char>(bcdByte(seq)));
+        payload.append(static_cast<char>(bcdByte(SCOPE_DIVISIONS)));
+        return payload;
+    };
+
+    // Sequence 1: center mode, center frequency, half span, in range
+    QByteArray header = division(1);
+    header.append(static_cast<char>(0x00));
+    header.append(CIVProtocol::encodeFrequency(m_frequencyHz));
+    header.append(CIVProtocol::encodeFrequency(SCOPE_HALF_SPAN_HZ));
+    header.append(static_cast<char>(0x00));
+    civSend(m_hostAddress, header);
+
+    const int perDivision = (SCOPE_POINTS + SCOPE_DIVISIONS - 2) / (SCOPE_DIVISIONS - 1);
+    for (int seq = 2; seq <= SCOPE_DIVISIONS; seq++) {
+        int start = (seq - 2) * perDivision;
+        QByteArray payload = division(seq);
+        payload.append(m_sweep.mid(start, std::min(perDivision, SCOPE_POINTS - start)));
+        civSend(m_hostAddress, payload);
+    }
+    m_stats.scopeSweeps++;
+}
+
+// ========== Rig side line ==========
+
+void RigSimulator::civSend(uint8_t to, const QByteArray& payload)
+{
+    reply(CIVProtocol::buildFrame(to, m_civAddress, payload));
+}
+
+void RigSimulator::catReply(const QByteArray& text)
+{
+    reply(text);
+}
+
+void RigSimulator::reply(const QByteArray& bytes)
+{
+    if (m_impairments.replyLatencyMs > 0) {
+        QTimer::singleShot(m_impairments.replyLatencyMs, Qt::PreciseTimer, this,
+                           [this, bytes]() { enqueue(bytes); });
+    } else {
+        enqueue(bytes);
+    }
+}
+
+void RigSimulator::enqueue(const QByteArray& bytes)
+{
+    if (m_impairments.baudRate <= 0) {
+        deliver(bytes.constData(), bytes.size());
+        return;
+    }
+
+    m_txQueue.append(bytes);
+    if (!m_drainTimer.isActive()) {
+        m_lastDrainNs = m_clock.nsecsElapsed();
+        m_lineCredit = 0.0;
+        m_drainTimer.start();
+    }
+}
+
+void RigSimulator::drainLine()
+{
+    // Bytes the line carried since the last tick, 10 bits each
+    qint64 now = m_clock.nsecsElapsed();
+    m_lineCredit += (now - m_lastDrainNs) * 1e-9 * m_impairments.baudRate / 10.0;
+    m_lastDrainNs = now;
+
+    int count = std::min(static_cast<int>(m_lineCredit), static_cast<int>(m_txQueue.size()));
+    if (count > 0) {
+        deliver(m_txQueue.constData(), count);
+        m_txQueue.remove(0, count);
+        m_lineCredit -= count;
+    }
+
+    if (m_txQueue.isEmpty()) {
+        m_drainTimer.stop();
+    }
+}
+
+void RigSimulator::deliver(const char* data, int size)
+{
+    QByteArray out;
+    out.reserve(size);
+
+    bool impaired = m_impairments.lossRate > 0.0 || m_impairments.corruptRate > 0.0;
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    std::uniform_int_distribution<int> bit(0, 7);
+
+    for (int i = 0; i < size; i++) {
+        char byte = data[i];
+        if (impaired) {
+            if (chance(m_random) < m_impairments.lossRate) {
+                m_stats.bytesDropped++;
+                continue;
+            }
+            if (chance(m_random) < m_impairments.corruptRate) {
+                byte = static_cast<char>(byte ^ (1 << bit(m_random)));
+                m_stats.bytesCorrupted++;
+            }
+        }
+        out.append(byte);
+    }
+
+    if (!out.isEmpty()) {
+        m_stats.bytesSent += out.size();
+        emit transmit(out);
+    }
+}
+
+// ========== RigSimulatorDevice ==========
+
+RigSimulatorDevice::RigSimulatorDevice(RigSimulator* rig, QObject* parent)
+    : QIODevice(parent)
+    , m_rig(rig)
+{
+    connect(m_rig, &RigSimulator::transmit, this, [this](const QByteArray& bytes) {
+        m_rxBuffer.append(bytes);
+        // Queued, so a reader reacting to readyRead never re-enters the rig
+        QMetaObject::invokeMethod(this, &RigSimulatorDevice::readyRead, Qt::QueuedConnection);
+    });
+}
+
+qint64 RigSimulatorDevice::bytesAvailable() const
+{
+    return m_rxBuffer.size() + QIODevice::bytesAvailable();
+}
+
+qint64 RigSimulatorDevice::readData(char* data, qint64 maxSize)
+{
+    int count = static_cast<int>(std::min<qint64>(maxSize, m_rxBuffer.size()));
+    std::memcpy(data, m_rxBuffer.constData(), count);
+    m_rxBuffer.remove(0, count);
+    return count;
+}
+
+qint64 RigSimulatorDevice::writeData(const char* data, qint64 size)
+{
+    m_rig->receive(QByteArray(data, static_cast<int>(size)));
+    return size;
+}
+
+// ========== RigSimulatorPty ==========
+
+RigSimulatorPty::RigSimulatorPty(RigSimulator* rig, QObject* parent)
+    : QObject(parent)
+    , m_rig(rig)
+{
+}
+
+RigSimulatorPty::~RigSimulatorPty()
+{
+    close();
+}
+
+bool RigSimulatorPty::open()
+{
+    close();
+
+    m_master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    if (m_master < 0 || ::grantpt(m_master) != 0 || ::unlockpt(m_master) != 0) {
+        m_error = QString("Cannot create pseudo-terminal: %1").arg(std::strerror(errno));
+        close();
+        return false;
+    }
+
+    const char* name = ::ptsname(m_master);
+    m_slaveHold = name ? ::open(name, O_RDWR | O_NOCTTY) : -1;
+    if (m_slaveHold < 0) {
+        m_error = QString("Cannot open pseudo-terminal slave: %1").arg(std::strerror(errno));
+        close();
+        return false;
+    }
+    m_slavePath = QString::fromLocal8Bit(name);
+
+    // Raw until the host configures the port, so nothing is echoed or translated
+    struct termios tio;
+    if (::tcgetattr(m_slaveHold, &tio) == 0) {
+        ::cfmakeraw(&tio);
+        ::tcsetattr(m_slaveHold, TCSANOW, &tio);
+    }
+    ::fcntl(m_master, F_SETFL, ::fcntl(m_master, F_GETFL) | O_NONBLOCK);
+
+    m_notifier = new QSocketNotifier(m_master, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &RigSimulatorPty::onMasterReadable);
+    connect(m_rig, &RigSimulator::transmit, this, &RigSimulatorPty::writeToHost);
+    return true;
+}
+
+void RigSimulatorPty::close()
+{
+    QObject::disconnect(m_rig, &RigSimulator::transmit, this, &RigSimulatorPty::writeToHost);
+
+    delete m_notifier;
+    m_notifier = nullptr;
+
+    if (m_slaveHold >= 0) {
+        ::close(m_slaveHold);
+        m_slaveHold = -1;
+    }
+    if (m_master >= 0) {
+        ::close(m_master);
+        m_master = -1;
+    }
+    m_slavePath.clear();
+}
+
+void RigSimulatorPty::onMasterReadable()
+{
+    char buffer[4096];
+    ssize_t count;
+    while ((count = ::read(m_master, buffer, sizeof(buffer))) > 0) {
+        m_rig->receive(QByteArray(buffer, static_cast<int>(count)));
+    }
+}
+
+void RigSimulatorPty::writeToHost(const QByteArray& bytes)
+{
+    const char* data = bytes.constData();
+    qint64 remaining = bytes.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(m_master, data, static_cast<size_t>(remaining));
+        if (written < 0) {
+            // The host is not reading and the pty buffer is full: the bytes are lost
+            qWarning() << "RigSimulatorPty: Dropped" << remaining << "bytes:" << std::strerror(errno);
+            return;
+        }
+        data += written;
+        remaining -= written;
+    }
+}
+
+// ========== RigSimulatorTcp ==========
+
+RigSimulatorTcp::RigSimulatorTcp(RigSimulator* rig, QObject* parent)
+    : QObject(parent)
+    , m_rig(rig)
+    , m_server(new QTcpServer(this))
+{
+    connect(m_server, &QTcpServer::newConnection, this, &RigSimulatorTcp::onNewConnection);
+    connect(m_rig, &RigSimulator::transmit, this, &RigSimulatorTcp::writeToHost);
+}
+
+bool RigSimulatorTcp::listen(quint16 port)
+{
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        m_error = QString("Cannot listen on port %1: %2").arg(port).arg(m_server->errorString());
+        return false;
+    }
+    return true;
+}
+
+quint16 RigSimulatorTcp::serverPort() const
+{
+    return m_server->serverPort();
+}
+
+void RigSimulatorTcp::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        if (m_client) {
+            m_client->disconnectFromHost();
+            m_client->deleteLater();
+        }
+        m_client = socket;
+        m_client->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(m_client, &QTcpSocket::readyRead, this, &RigSimulatorTcp::onClientReadable);
+        connect(m_client, &QTcpSocket::disconnected, this, [this, socket]() {
+            if (m_client == socket) {
+                m_client = nullptr;
+            }
+            socket->deleteLater();
+        });
+    }
+}
+
+void RigSimulatorTcp::onClientReadable()
+{
+    if (m_client) {
+        m_rig->receive(m_client->readAll());
+    }
+}
+
+void RigSimulatorTcp::writeToHost(const QByteArray& bytes)
+{
+    if (m_client) {
+        m_client->write(bytes);
+    }
+}
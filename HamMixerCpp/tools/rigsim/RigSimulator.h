@@ -0,0 +1,261 @@
+/*
+ * RigSimulator.h
+ *
+ * Simulated Icom CI-V / Kenwood CAT / rigctld transceiver for load and latency testing
+ * Part of HamMixer CT7BAC
+ */
+
+#ifndef RIGSIMULATOR_H
+#define RIGSIMULATOR_H
+
+#include <QObject>
+#include <QIODevice>
+#include <QByteArray>
+#include <QString>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <cstdint>
+#include <random>
+
+#include "serial/RadioController.h"
+#include "serial/CIVParser.h"
+#include "serial/KenwoodParser.h"
+
+class QSocketNotifier;
+class QTcpServer;
+class QTcpSocket;
+
+/**
+ * @brief Virtual transceiver speaking CI-V, Kenwood CAT or the rigctld protocol
+ *
+ * Host bytes go in through receive(); rig bytes come out of transmit().
+ * The rig answers the commands the HamMixer controllers send (frequency,
+ * mode, S-meter, TX status, tuner, voice keyer, scope on/off), broadcasts
+ * front-panel changes when CI-V transceive or CAT Auto-Information is on,
+ * and streams 0x27 scope sweeps while scope output is enabled. As a rigctld
+ * stand-in it answers the Hamlib NET commands RigctldController uses, in
+ * plain or extended ("+\cmd") form.
+ *
+ * Impairments model a real link: a fixed reply latency, the byte rate of
+ * the configured baud rate (10 bits per byte, both directions), and random
+ * byte loss and corruption on the rig-to-host side.
+ *
+ * The simulator is transport-agnostic: RigSimulatorDevice exposes it as an
+ * in-process QIODevice, RigSimulatorPty as a pseudo-terminal that
+ * QSerialPort (and so the real controllers) can open, RigSimulatorTcp as a
+ * TCP server (a stub rigctld).
+ */
+class RigSimulator : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Impairments {
+        int replyLatencyMs = 0;    // Delay before each reply leaves the rig
+        int baudRate = 0;          // Line speed to throttle to (0 = unlimited)
+        double lossRate = 0.0;     // Probability each rig->host byte is dropped
+        double corruptRate = 0.0;  // Probability each rig->host byte has a bit flipped
+    };
+
+    struct Statistics {
+        uint64_t bytesReceived = 0;
+        uint64_t commandsReceived = 0;
+        uint64_t commandsRejected = 0;   // Answered NG / "?;"
+        uint64_t frequencyWrites = 0;
+        uint64_t bytesSent = 0;
+        uint64_t bytesDropped = 0;
+        uint64_t bytesCorrupted = 0;
+        uint64_t scopeSweeps = 0;
+    };
+
+    explicit RigSimulator(RadioController::Protocol protocol, QObject* parent = nullptr);
+
+    RadioController::Protocol protocol() const { return m_protocol; }
+    QString description() const;
+
+    void setImpairments(const Impairments& impairments);
+    const Impairments& impairments() const { return m_impairments; }
+
+    // Rig configuration
+    void setCivAddress(uint8_t address) { m_civAddress = address; }
+    void setTransceive(bool enabled) { m_transceive = enabled; }  // CI-V menu setting
+    void setAi2Supported(bool supported) { m_ai2Supported = supported; }  // false = Yaesu style
+    void setSignalWalk(bool enabled);  // Random-walk the S-meter every 100 ms
+
+    // Front panel (changes broadcast to the host when events are on)
+    void turnDial(uint64_t frequencyHz);
+    void selectMode(uint8_t mode);
+    void setPtt(bool transmitting);
+    void setSignalLevel(int level);  // 0-255 (Icom scale)
+
+    uint64_t frequency() const { return m_frequencyHz; }
+    uint8_t mode() const { return m_mode; }
+    bool isTransmitting() const { return m_transmitting; }
+
+    const Statistics& statistics() const { return m_stats; }
+    void resetStatistics() { m_stats = Statistics(); }
+
+public slots:
+    /**
+     * @brief Bytes written by the host
+     */
+    void receive(const QByteArray& bytes);
+
+signals:
+    /**
+     * @brief Bytes on their way to the host (after impairments)
+     */
+    void transmit(const QByteArray& bytes);
+
+    /**
+     * @brief The host set the frequency
+     */
+    void frequencySet(uint64_t frequencyHz);
+
+private:
+    void process(const QByteArray& bytes);
+    void processCivFrame(const CIVFrame& frame);
+    void processCatCommand(const KenwoodResponse& command);
+    void processRigctldCommand(const QByteArray& line);
+
+    void reply(const QByteArray& bytes);
+    void civSend(uint8_t to, const QByteArray& payload);
+    void catReply(const QByteArray& text);
+    void enqueue(const QByteArray& bytes);
+    void drainLine();
+    void deliver(const char* data, int size);
+
+    void sendScopeSweep();
+    QByteArray catInformation() const;
+    static QByteArray bcdLevel(int level);
+
+    RadioController::Protocol m_protocol;
+    Impairments m_impairments;
+    Statistics m_stats;
+
+    // Rig state
+    uint64_t m_frequencyHz = 14074000;
+    uint8_t m_mode = 0x01;  // CI-V USB / CAT 2
+    bool m_transmitting = false;
+    bool m_tunerOn = false;
+    int m_signalLevel = 40;
+    uint8_t m_civAddress = 0x94;  // IC-7300
+    uint8_t m_hostAddress = 0xE0;  // Source of the last host frame
+    bool m_transceive = true;
+    bool m_ai2Supported = true;
+    int m_aiLevel = 0;
+    bool m_scopeOutput = false;
+
+    // Host side
+    CIVParser m_civParser;
+    KenwoodParser m_catParser;
+    QByteArray m_rigctldLine;  // Partial rigctld command line
+    qint64 m_rxBusyUntilNs = 0;  // When the host's bytes finish arriving at the line rate
+
+    // Rig side line
+    QByteArray m_txQueue;
+    QTimer m_drainTimer;
+    QTimer m_scopeTimer;
+    QTimer m_signalTimer;
+    QElapsedTimer m_clock;
+    qint64 m_lastDrainNs = 0;
+    double m_lineCredit = 0.0;  // Bytes the line may carry now
+
+    std::mt19937 m_random{0x7300};
+    QByteArray m_sweep;
+
+    static constexpr int SCOPE_INTERVAL_MS = 50;
+    static constexpr int SCOPE_POINTS = 475;      // IC-7300
+    static constexpr int SCOPE_DIVISIONS = 11;    // Header + 10 waveform divisions
+    static constexpr int SCOPE_HALF_SPAN_HZ = 25000;
+};
+
+/**
+ * @brief The simulator as an in-process QIODevice
+ *
+ * Writes go to the rig; the rig's bytes are buffered for reading and
+ * announced with readyRead(). With no latency or throttling the round trip
+ * is synchronous.
+ */
+class RigSimulatorDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit RigSimulatorDevice(RigSimulator* rig, QObject* parent = nullptr);
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 size) override;
+
+private:
+    RigSimulator* m_rig;
+    QByteArray m_rxBuffer;
+};
+
+/**
+ * @brief The simulator behind a pseudo-terminal (Linux/macOS)
+ *
+ * slavePath() is a port name QSerialPort can open, so the real controllers
+ * and the radio detector can be exercised unmodified.
+ */
+class RigSimulatorPty : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RigSimulatorPty(RigSimulator* rig, QObject* parent = nullptr);
+    ~RigSimulatorPty() override;
+
+    bool open();
+    void close();
+    QString slavePath() const { return m_slavePath; }
+    QString errorString() const { return m_error; }
+
+private slots:
+    void onMasterReadable();
+    void writeToHost(const QByteArray& bytes);
+
+private:
+    RigSimulator* m_rig;
+    int m_master = -1;
+    int m_slaveHold = -1;  // Keeps the pty up while no host has it open
+    QSocketNotifier* m_notifier = nullptr;
+    QString m_slavePath;
+    QString m_error;
+};
+
+/**
+ * @brief The simulator behind a TCP port
+ *
+ * With the rigctld protocol this is a stand-in for a real rigctld, so
+ * RigctldController can be run against it. One client at a time: a new
+ * connection replaces the previous one.
+ */
+class RigSimulatorTcp : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RigSimulatorTcp(RigSimulator* rig, QObject* parent = nullptr);
+
+    bool listen(quint16 port);  // 0 = any free port
+    quint16 serverPort() const;
+    QString errorString() const { return m_error; }
+
+private slots:
+    void onNewConnection();
+    void onClientReadable();
+    void writeToHost(const QByteArray& bytes);
+
+private:
+    RigSimulator* m_rig;
+    QTcpServer* m_server;
+    QTcpSocket* m_client = nullptr;
+    QString m_error;
+};
+
+#endif // RIGSIMULATOR_H
@@ -0,0 +1,450 @@
+/*
+ * main.cpp
+ *
+ * rigsim - simulated transceiver on a pseudo-terminal or TCP port, and serial benchmarks
+ * Part of HamMixer CT7BAC
+ *
+ *   rigsim --protocol civ --baud 19200 --latency 5
+ *       Run a virtual IC-7300 and print the port to point HamMixer (or any
+ *       CAT program) at. --sweep 500 turns the dial every 500 ms.
+ *
+ *   rigsim --protocol rigctld --port 4532
+ *       Stand in for rigctld on localhost:4532 (select "rigctld" as the
+ *       HamMixer port).
+ *
+ *   rigsim --bench --protocol cat --loss 0.001
+ *       Parser throughput, in-process round trips, VFO-change latency of the
+ *       real controller over the pty, and command-queue behaviour under a
+ *       burst of frequency changes.
+ */
+
+#include "RigSimulator.h"
+#include "serial/CIVParser.h"
+#include "serial/CIVProtocol.h"
+#include "serial/KenwoodParser.h"
+#include "serial/RadioController.h"
+#include "serial/RigctldController.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace {
+
+QTextStream& out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+struct Options {
+    RadioController::Protocol protocol = RadioController::IcomCIV;
+    RigSimulator::Impairments impairments;
+    bool events = true;
+    bool scope = false;
+    int iterations = 200;
+    int pollMs = 100;
+    int sweepMs = 0;
+    quint16 tcpPort = RigctldController::DEFAULT_TCP_PORT;
+};
+
+// Run the event loop until done() holds or the timeout expires
+bool waitUntil(const std::function<bool()>& done, int timeoutMs)
+{
+    if (done()) {
+        return true;
+    }
+
+    QEventLoop loop;
+    QTimer check;
+    check.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&check, &QTimer::timeout, &loop, [&]() {
+        if (done()) {
+            loop.quit();
+        }
+    });
+    QTimer::singleShot(timeoutMs, &loop, &QEventLoop::quit);
+    check.start(1);
+    loop.exec();
+    return done();
+}
+
+void pause(int ms)
+{
+    waitUntil([]() { return false; }, ms);
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+// ========== Parser throughput ==========
+
+template <typename Parser, typename Frame, typename Byte>
+void runParser(const char* name, const QByteArray& stream, int framesPerPass)
+{
+    static constexpr int PASSES = 8;
+    static constexpr int CHUNK = 4096;  // Typical QSerialPort read size
+
+    Parser parser;
+    Frame frame;
+    qint64 frames = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int pass = 0; pass < PASSES; pass++) {
+        const Byte* data = reinterpret_cast<const Byte*>(stream.constData());
+        int remaining = stream.size();
+        while (remaining > 0) {
+            int accepted = parser.feed(data, std::min(remaining, CHUNK));
+            while (parser.next(frame)) {
+                frames++;
+            }
+            if (accepted == 0) {
+                break;
+            }
+            data += accepted;
+            remaining -= accepted;
+        }
+    }
+    double seconds = timer.nsecsElapsed() * 1e-9;
+
+    out() << QString("  %1 parser: %2 MB/s, %3 M frames/s (%4 of %5 frames, %6 bytes dropped)\n")
+                 .arg(name)
+                 .arg(stream.size() * PASSES / seconds / 1e6, 0, 'f', 1)
+                 .arg(frames / seconds / 1e6, 0, 'f', 2)
+                 .arg(frames)
+                 .arg(static_cast<qint64>(framesPerPass) * PASSES)
+                 .arg(parser.droppedBytes());
+}
+
+void benchParsers()
+{
+    static constexpr int STREAM_BYTES = 4 * 1024 * 1024;
+
+    out() << "Parser throughput\n";
+
+    // What a radio streams with transceive and the scope on
+    QByteArray freq(1, static_cast<char>(CIVProtocol::CMD_TRANSCEIVE_FREQ));
+    freq.append(CIVProtocol::encodeFrequency(14074000));
+    QByteArray meter("\x15\x02\x01\x20", 4);
+    QByteArray scope("\x27\x00\x00\x05\x11", 5);
+    scope.append(QByteArray(48, 40));
+
+    QByteArray civ;
+    int civFrames = 0;
+    while (civ.size() < STREAM_BYTES) {
+        civ.append(CIVProtocol::buildFrame(0x00, CIVProtocol::ADDR_IC7300, freq));
+        civ.append(CIVProtocol::buildFrame(CIVProtocol::ADDR_CONTROLLER, CIVProtocol::ADDR_IC7300, meter));
+        civ.append(CIVProtocol::buildFrame(CIVProtocol::ADDR_CONTROLLER, CIVProtocol::ADDR_IC7300, scope));
+        civFrames += 3;
+    }
+    runParser<CIVParser, CIVFrame, uint8_t>("CI-V", civ, civFrames);
+
+    QByteArray cat;
+    int catFrames = 0;
+    while (cat.size() < STREAM_BYTES) {
+        cat.append("FA00014074000;SM0012;IF00014074000     +000000000020000000;");
+        catFrames += 3;
+    }
+    runParser<KenwoodParser, KenwoodResponse, char>("CAT", cat, catFrames);
+}
+
+// ========== In-process round trips ==========
+
+void benchRoundTrips(RadioController::Protocol protocol)
+{
+    static constexpr int COMMANDS = 200000;
+    static constexpr int BATCH = 32;
+
+    RigSimulator rig(protocol);
+    RigSimulatorDevice device(&rig);
+    device.open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+
+    QByteArray batch;
+    for (int i = 0; i < BATCH; i++) {
+        if (protocol == RadioController::IcomCIV) {
+            batch.append(CIVProtocol::buildCommand(CIVProtocol::CMD_READ_FREQ));
+        } else if (protocol == RadioController::HamlibRigctld) {
+            batch.append("+\\get_freq\n");
+        } else {
+            batch.append("FA;");
+        }
+    }
+
+    CIVParser civParser;
+    KenwoodParser catParser;
+    qint64 replies = 0;
+    char buffer[4096];
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int sent = 0; sent < COMMANDS; sent += BATCH) {
+        device.write(batch);
+        qint64 count;
+        while ((count = device.read(buffer, sizeof(buffer))) > 0) {
+            if (protocol == RadioController::HamlibRigctld) {
+                // Every extended reply ends with one "RPRT n" line
+                replies += QByteArray::fromRawData(buffer, static_cast<int>(count)).count("RPRT");
+            } else if (protocol == RadioController::IcomCIV) {
+                civParser.feed(reinterpret_cast<const uint8_t*>(buffer), static_cast<int>(count));
+                CIVFrame frame;
+                while (civParser.next(frame)) {
+                    replies++;
+                }
+            } else {
+                catParser.feed(buffer, static_cast<int>(count));
+                KenwoodResponse response;
+                while (catParser.next(response)) {
+                    replies++;
+                }
+            }
+        }
+    }
+    double seconds = timer.nsecsElapsed() * 1e-9;
+
+    out() << QString("  In-process round trips: %1 k commands/s (%2 replies to %3 reads)\n")
+                 .arg(COMMANDS / seconds / 1e3, 0, 'f', 0)
+                 .arg(replies)
+                 .arg(COMMANDS);
+}
+
+// ========== Controller over the pty (or TCP for rigctld) ==========
+
+int benchController(const Options& options)
+{
+    RigSimulator rig(options.protocol);
+    rig.setImpairments(options.impairments);
+    rig.setTransceive(options.events);
+    rig.setSignalWalk(true);
+
+    // rigctld is reached over TCP, the serial protocols over the pty
+    RigSimulatorPty pty(&rig);
+    RigSimulatorTcp tcp(&rig);
+    QString port;
+    if (options.protocol == RadioController::HamlibRigctld) {
+        if (!tcp.listen(0)) {
+            out() << tcp.errorString() << "\n";
+            return 1;
+        }
+        port = QString("127.0.0.1:%1").arg(tcp.serverPort());
+    } else {
+        if (!pty.open()) {
+            out() << pty.errorString() << "\n";
+            return 1;
+        }
+        port = pty.slavePath();
+    }
+
+    // Same arrangement as the application: controller on its own I/O thread
+    QThread ioThread;
+    ioThread.setObjectName("RadioIO");
+    ioThread.start();
+
+    RadioController* controller = RadioController::create(options.protocol, nullptr);
+    controller->moveToThread(&ioThread);
+    QObject::connect(&ioThread, &QThread::finished, controller, &QObject::deleteLater);
+    controller->setEventDrivenUpdates(options.events);
+
+    int baud = options.impairments.baudRate > 0 ? options.impairments.baudRate : 115200;
+    if (!controller->connect(port, baud)) {
+        out() << "Controller failed to open " << port << ": " << controller->lastError() << "\n";
+        ioThread.quit();
+        ioThread.wait();
+        return 1;
+    }
+    controller->startPolling(options.pollMs);
+
+    QElapsedTimer clock;
+    clock.start();
+    std::atomic<qint64> seenNs{0};
+    std::atomic<uint64_t> seenFrequency{0};
+    std::atomic<int> scopeLines{0};
+    // Direct: timestamp the emit on the I/O thread, not the hop to this one
+    QObject::connect(controller, &RadioController::frequencyChanged, controller,
+                     [&](uint64_t frequencyHz) {
+                         seenNs = clock.nsecsElapsed();
+                         seenFrequency = frequencyHz;
+                     }, Qt::DirectConnection);
+    QObject::connect(controller, &RadioController::scopeLineReady, controller,
+                     [&]() { scopeLines++; }, Qt::DirectConnection);
+
+    if (options.scope && controller->supportsScope()) {
+        controller->setScopeEnabled(true);
+    }
+
+    // Let the controller negotiate transceive/AI and see a few changes
+    uint64_t frequency = 7000000;
+    for (int i = 0; i < 5; i++) {
+        rig.turnDial(frequency += 1000);
+        pause(300);
+    }
+
+    out() << QString("VFO change -> frequencyChanged (%1, %2)\n")
+                 .arg(rig.description())
+                 .arg(controller->eventDrivenActive() ? "event-driven" : QString("polling every %1 ms").arg(options.pollMs));
+
+    std::vector<double> latencies;
+    int timeouts = 0;
+    for (int i = 0; i < options.iterations; i++) {
+        uint64_t target = (frequency += 100);
+        qint64 startNs = clock.nsecsElapsed();
+        rig.turnDial(target);
+        if (waitUntil([&]() { return seenFrequency == target; }, 2000)) {
+            latencies.push_back((seenNs - startNs) / 1e6);
+        } else {
+            timeouts++;
+        }
+        pause(20 + (i * 37) % 80);  // Land at different points of the poll cycle
+    }
+
+    out() << QString("  n=%1  min %2  median %3  p95 %4  max %5 ms  (%6 timed out)\n")
+                 .arg(latencies.size())
+                 .arg(percentile(latencies, 0.0), 0, 'f', 2)
+                 .arg(percentile(latencies, 0.5), 0, 'f', 2)
+                 .arg(percentile(latencies, 0.95), 0, 'f', 2)
+                 .arg(percentile(latencies, 1.0), 0, 'f', 2)
+                 .arg(timeouts);
+    if (options.scope) {
+        out() << QString("  Scope: %1 sweeps sent, %2 decoded\n")
+                     .arg(rig.statistics().scopeSweeps)
+                     .arg(scopeLines.load());
+    }
+
+    // Queue under stress: a burst of tuning steps, as from a fast knob or sync
+    static constexpr int BURST = 1000;
+    rig.resetStatistics();
+    uint64_t last = 0;
+    QElapsedTimer burst;
+    burst.start();
+    for (int i = 0; i < BURST; i++) {
+        last = 21000000 + i * 10;
+        controller->setFrequency(last);
+    }
+    qint64 postedMs = burst.elapsed();
+
+    bool rigSettled = waitUntil([&]() { return rig.frequency() == last; }, 10000);
+    qint64 rigMs = burst.elapsed();
+    bool controllerSettled = waitUntil([&]() { return controller->currentFrequency() == last; }, 5000);
+    qint64 controllerMs = burst.elapsed();
+
+    const RigSimulator::Statistics& stats = rig.statistics();
+    out() << QString("Burst of %1 setFrequency() calls (posted in %2 ms)\n").arg(BURST).arg(postedMs);
+    out() << QString("  Rig received %1 frequency writes in %2 commands, %3 rejected\n")
+                 .arg(stats.frequencyWrites)
+                 .arg(stats.commandsReceived)
+                 .arg(stats.commandsRejected);
+    out() << QString("  Rig on final frequency: %1; controller caught up: %2\n")
+                 .arg(rigSettled ? QString("%1 ms").arg(rigMs) : QString("no"))
+                 .arg(controllerSettled ? QString("%1 ms").arg(controllerMs) : QString("no"));
+    out() << QString("  Link: %1 bytes in, %2 bytes out, %3 dropped, %4 corrupted\n")
+                 .arg(stats.bytesReceived)
+                 .arg(stats.bytesSent)
+                 .arg(stats.bytesDropped)
+                 .arg(stats.bytesCorrupted);
+    out().flush();
+
+    // Scheduler statistics are logged by disconnect()
+    controller->disconnect();
+    ioThread.quit();
+    ioThread.wait();
+    return timeouts == 0 && rigSettled ? 0 : 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("rigsim");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulated Icom CI-V / Kenwood CAT / rigctld transceiver and serial benchmarks");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"protocol", "civ, cat or rigctld (default civ).", "protocol", "civ"},
+        {"port", "TCP port for the rigctld protocol (default 4532).", "port", "4532"},
+        {"baud", "Throttle the link to this baud rate (default unlimited).", "rate", "0"},
+        {"latency", "Reply latency in ms.", "ms", "0"},
+        {"loss", "Probability of dropping each byte sent by the rig.", "p", "0"},
+        {"corrupt", "Probability of flipping a bit in each byte sent by the rig.", "p", "0"},
+        {"no-events", "Disable CI-V transceive / CAT Auto-Information."},
+        {"sweep", "Turn the dial every N ms (run mode).", "ms", "0"},
+        {"bench", "Run the benchmarks instead of serving the port."},
+        {"iterations", "VFO changes to time (default 200).", "n", "200"},
+        {"poll", "Controller poll interval in ms (default 100).", "ms", "100"},
+        {"scope", "Stream scope sweeps during the CI-V benchmark."},
+    });
+    parser.process(app);
+
+    Options options;
+    QString protocol = parser.value("protocol");
+    if (protocol == "cat") {
+        options.protocol = RadioController::KenwoodCAT;
+    } else if (protocol == "rigctld") {
+        options.protocol = RadioController::HamlibRigctld;
+    } else {
+        options.protocol = RadioController::IcomCIV;
+    }
+    options.tcpPort = static_cast<quint16>(parser.value("port").toUInt());
+    options.impairments.baudRate = parser.value("baud").toInt();
+    options.impairments.replyLatencyMs = parser.value("latency").toInt();
+    options.impairments.lossRate = parser.value("loss").toDouble();
+    options.impairments.corruptRate = parser.value("corrupt").toDouble();
+    options.events = !parser.isSet("no-events");
+    options.scope = parser.isSet("scope");
+    options.iterations = std::max(1, parser.value("iterations").toInt());
+    options.pollMs = std::max(10, parser.value("poll").toInt());
+    options.sweepMs = parser.value("sweep").toInt();
+
+    if (parser.isSet("bench")) {
+        benchParsers();
+        benchRoundTrips(options.protocol);
+        return benchController(options);
+    }
+
+    RigSimulator rig(options.protocol);
+    rig.setImpairments(options.impairments);
+    rig.setTransceive(options.events);
+    rig.setSignalWalk(true);
+
+    RigSimulatorPty pty(&rig);
+    RigSimulatorTcp tcp(&rig);
+    if (options.protocol == RadioController::HamlibRigctld) {
+        if (!tcp.listen(options.tcpPort)) {
+            out() << tcp.errorString() << "\n";
+            return 1;
+        }
+        out() << rig.description() << " on localhost:" << tcp.serverPort() << "\n";
+    } else {
+        if (!pty.open()) {
+            out() << pty.errorString() << "\n";
+            return 1;
+        }
+        out() << rig.description() << " on " << pty.slavePath() << "\n";
+    }
+    out().flush();
+
+    QTimer sweep;
+    if (options.sweepMs > 0) {
+        QObject::connect(&sweep, &QTimer::timeout, &rig, [&rig]() {
+            rig.turnDial(rig.frequency() + 1000);
+        });
+        sweep.start(options.sweepMs);
+    }
+
+    return app.exec();
+}